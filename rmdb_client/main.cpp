@@ -10,12 +10,19 @@
 #include <unistd.h>
 
 #include <cassert>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
+
+#include "common/result_protocol.h"
 
-#define MAX_MEM_BUFFER_SIZE 8192
 #define PORT_DEFAULT 8765
+#define COL_WIDTH 16
+
+using namespace result_protocol;
 
 bool is_exit_command(std::string &cmd) { return cmd == "exit" || cmd == "exit;" || cmd == "bye" || cmd == "bye;"; }
 
@@ -68,6 +75,108 @@ int init_tcp_sock(const char *server_host, int server_port) {
     return sockfd;
 }
 
+// 按服务端 RecordPrinter 的格式打印结果表格
+void print_separator(size_t num_cols) {
+    std::string line;
+    for (size_t i = 0; i < num_cols; i++) {
+        line += "+" + std::string(COL_WIDTH + 2, '-');
+    }
+    std::cout << line << "+\n";
+}
+
+void print_record(const std::vector<std::string> &rec) {
+    std::stringstream ss;
+    for (auto col: rec) {
+        if (col.size() > COL_WIDTH) {
+            col = col.substr(0, COL_WIDTH - 3) + "...";
+        }
+        ss << "| " << std::setw(COL_WIDTH) << col << " ";
+    }
+    ss << "|\n";
+    std::cout << ss.str();
+}
+
+// 解码一个 DATA_ROWS 帧并逐行打印
+void print_rows(const std::string &payload, const std::vector<ColumnType> &types) {
+    const char *p = payload.data();
+    uint32_t num_rows = get_u32(p);
+    p += 4;
+    std::vector<std::string> rec(types.size());
+    for (uint32_t r = 0; r < num_rows; ++r) {
+        for (size_t i = 0; i < types.size(); ++i) {
+            if (types[i] == COL_STRING) {
+                uint16_t len = get_u16(p);
+                rec[i].assign(p + 2, len);
+                p += 2 + len;
+                continue;
+            }
+            uint32_t bits = get_u32(p);
+            p += 4;
+            if (types[i] == COL_INT) {
+                rec[i] = std::to_string(static_cast<int32_t>(bits));
+            } else {
+                float val;
+                memcpy(&val, &bits, sizeof(val));
+                rec[i] = std::to_string(val);
+            }
+        }
+        print_record(rec);
+    }
+}
+
+/**
+ * 接收一条语句的全部响应帧并打印，直到 COMPLETE 或 ERROR，连接断开时返回 false。
+ * 结果边接收边打印，不会把整个结果集放在内存里
+ */
+bool receive_result(int sockfd) {
+    FrameType type;
+    std::string payload;
+    std::vector<ColumnType> types;
+    bool has_rows = false;
+    while (recv_frame(sockfd, type, payload)) {
+        switch (type) {
+            case ROW_DESC: {
+                const char *p = payload.data();
+                uint16_t num_cols = get_u16(p);
+                p += 2;
+                std::vector<std::string> captions;
+                for (uint16_t i = 0; i < num_cols; ++i) {
+                    types.push_back(static_cast<ColumnType>(*p));
+                    uint16_t len = get_u16(p + 1);
+                    captions.emplace_back(p + 3, len);
+                    p += 3 + len;
+                }
+                has_rows = true;
+                print_separator(types.size());
+                print_record(captions);
+                print_separator(types.size());
+                break;
+            }
+            case DATA_ROWS:
+                print_rows(payload, types);
+                break;
+            case MESSAGE:
+                std::cout << payload;
+                break;
+            case COMPLETE:
+                if (has_rows) {
+                    print_separator(types.size());
+                    std::cout << "Total record(s): " << get_u64(payload.data()) << "\n";
+                }
+                std::cout.flush();
+                return true;
+            case ERROR:
+                std::cout << payload << "\n";
+                std::cout.flush();
+                return true;
+            default:
+                fprintf(stderr, "Unknown response frame '%c'\n", type);
+                return false;
+        }
+    }
+    return false;
+}
+
 int main(int argc, char *argv[]) {
     int ret = 0;  // set_terminal_noncanonical();
                   //    if (ret < 0) {
@@ -99,7 +208,7 @@ int main(int argc, char *argv[]) {
 
     // const char *prompt_str = "RucBase > ";
 
-    int sockfd, send_bytes;
+    int sockfd;
     // char send[MAXLINE];
 
     if (unix_socket_path != nullptr) {
@@ -111,7 +220,15 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    char recv_buf[MAX_MEM_BUFFER_SIZE];
+    // 切换到二进制结果协议，结果集不再受服务端发送缓冲区大小的限制
+    FrameType type;
+    std::string payload;
+    if (!send_all(sockfd, HANDSHAKE, strlen(HANDSHAKE) + 1) || !recv_frame(sockfd, type, payload) ||
+        type != COMPLETE) {
+        fprintf(stderr, "Failed to negotiate result protocol with server\n");
+        close(sockfd);
+        return 1;
+    }
 
     while (1) {
         char *line_read = readline("Rucbase> ");
@@ -129,27 +246,17 @@ int main(int argc, char *argv[]) {
                 break;
             }
 
-            if ((send_bytes = write(sockfd, command.c_str(), command.length() + 1)) == -1) {
+            std::string request;
+            put_u32(request, static_cast<uint32_t>(command.length()));
+            request += command;
+            if (!send_all(sockfd, request.data(), request.size())) {
                 // fprintf(stderr, "send error: %d:%s \n", errno, strerror(errno));
                 std::cerr << "send error: " << errno << ":" << strerror(errno) << " \n" << std::endl;
                 exit(1);
             }
-            int len = recv(sockfd, recv_buf, MAX_MEM_BUFFER_SIZE, 0);
-            if (len < 0) {
-                fprintf(stderr, "Connection was broken: %s\n", strerror(errno));
-                break;
-            } else if (len == 0) {
+            if (!receive_result(sockfd)) {
                 printf("Connection has been closed\n");
                 break;
-            } else {
-                for (int i = 0; i <= len; i++) {
-                    if (recv_buf[i] == '\0') {
-                        break;
-                    } else {
-                        printf("%c", recv_buf[i]);
-                    }
-                }
-                memset(recv_buf, 0, MAX_MEM_BUFFER_SIZE);
             }
         }
     }
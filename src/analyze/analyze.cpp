@@ -142,10 +142,19 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
         get_having_clause(x->havings, query->havings);
 
         // 处理 sortby 条件
-        if (x->has_sort) {
-            TabCol tab_col = {std::move(x->order->cols->tab_name), std::move(x->order->cols->col_name)};
+        for (auto &order: x->orders) {
+            TabCol tab_col = {std::move(order->cols->tab_name), std::move(order->cols->col_name)};
             check_column(query->tables, tab_col);
-            query->sort_bys = std::move(tab_col);
+            query->sort_bys.push_back({std::move(tab_col), order->orderby_dir == ast::OrderBy_DESC});
+        }
+
+        // 处理 limit
+        if (x->limit != nullptr) {
+            if (x->limit->count < 0 || x->limit->offset < 0) {
+                throw InternalError("LIMIT and OFFSET must be non-negative");
+            }
+            query->limit = x->limit->count;
+            query->offset = x->limit->offset;
         }
 
         // 推断表名和检查左右类型是否匹配
@@ -438,6 +447,9 @@ void Analyze::check_clause(std::vector<Condition> &conds, const std::vector<std:
                     }
                     value.init_raw(lhs_col->len);
                 }
+                if (cond.op == OP_IN) {
+                    cond.build_value_set();
+                }
                 continue;
             }
             // 子查询右边是唯一列
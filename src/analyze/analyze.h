@@ -33,8 +33,8 @@ public:
     // having 条件
     std::vector<Condition> havings;
 
-    // TODO sortby 条件，支持多列
-    TabCol sort_bys;
+    // ORDER BY 的各列，按优先级排列
+    std::vector<OrderCol> sort_bys;
 
     // 投影列
     std::vector<TabCol> cols;
@@ -53,8 +53,10 @@ public:
     // min asc true
     // max asc false
     bool asc = true;
-    // limit > 0 available
+    // limit >= 0 available
     int limit = -1;
+    // 跳过的结果条数
+    int offset = 0;
 
     Query() = default;
 };
@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <parser/ast.h>
@@ -40,6 +41,12 @@ struct TabCol {
     }
 };
 
+/* ORDER BY 中的一列 */
+struct OrderCol {
+    TabCol col;
+    bool is_desc;
+};
+
 struct Value {
     ColType type; // type of value
     union {
@@ -177,6 +184,26 @@ struct Condition {
     TabCol rhs_col; // right-hand side column
     Value rhs_val; // right-hand side value
     std::vector<Value> rhs_value_list; // 值列表
+    // IN 谓词的值集合，元素是按左列长度补齐的原始字节；子查询在生成算子时只执行一次，结果缓存在这里
+    std::shared_ptr<std::unordered_set<std::string> > rhs_value_set;
+
+    // IN 谓词查找用的键，float 的 -0 和 +0 相等，统一成 +0
+    static std::string in_key(const char *data, int len, ColType type) {
+        if (type == TYPE_FLOAT && *reinterpret_cast<const float *>(data) == 0) {
+            static constexpr float zero = 0;
+            return {reinterpret_cast<const char *>(&zero), sizeof(float)};
+        }
+        return {data, static_cast<size_t>(len)};
+    }
+
+    // 用已经 init_raw 的值列表生成 IN 谓词的值集合
+    void build_value_set() {
+        rhs_value_set = std::make_shared<std::unordered_set<std::string> >();
+        rhs_value_set->reserve(rhs_value_list.size());
+        for (auto &value: rhs_value_list) {
+            rhs_value_set->emplace(in_key(value.raw->data, value.raw->size, value.type));
+        }
+    }
 
     // Condition() noexcept = default;
     //
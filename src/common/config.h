@@ -18,6 +18,8 @@ See the Mulan PSL v2 for more details. */
 #define BUFFER_LENGTH 1500
 // 定义日志控制宏
 #define ENABLE_LOGGING
+// 批量磁盘 I/O 使用 io_uring，内核不支持时自动回退到 pread/pwrite
+#define ENABLE_IO_URING
 
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
 extern std::chrono::milliseconds cycle_detection_interval;
@@ -38,9 +40,36 @@ static constexpr int PAGE_SIZE = 4096 * 4;
 // static constexpr int BUFFER_POOL_SIZE = 65536;                                // size of buffer pool 256MB
 static constexpr int BUFFER_POOL_SIZE = 262144;                           // size of buffer pool 1GB
 static constexpr int BUFFER_POOL_INSTANCES = 16;                               // instances of buffer pool
+static constexpr int BUFFER_POOL_MIN_INSTANCE_SIZE = 16;                       // min frames per instance, smaller pools use fewer instances
 static constexpr int BUFFER_POOL_INSTANCE_SIZE = BUFFER_POOL_SIZE / BUFFER_POOL_INSTANCES;
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE / 4);                    // size of a log buffer in byte
+static constexpr int LOG_BUFFER_NUM = 2;                                      // log buffers filled/flushed in turn
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int IO_URING_QUEUE_DEPTH = 256;                              // io_uring submission queue entries
+static constexpr int LOAD_WRITE_BATCH_PAGES = 64;                             // table pages written per batch by load
+static constexpr int GROUP_COMMIT_MAX_BATCH = 64;                             // max commits flushed by one log fsync
+static constexpr int GROUP_COMMIT_MAX_WAIT_US = 200;                          // max wait (us) for a commit group to fill
+static constexpr int REDO_WORKER_NUM = 8;                                     // threads applying redo in parallel
+static constexpr size_t REDO_BATCH_SIZE = 64 * 1024;                          // bytes of log handed to a redo thread at once
+static constexpr size_t REDO_QUEUE_DEPTH = 16;                                // max pending batches per redo thread
+static constexpr int HASH_JOIN_PARTITIONS = 32;                               // spill partitions per partitioning pass
+static constexpr int HASH_JOIN_MAX_LEVEL = 3;                                 // max recursive re-partitioning depth
+static constexpr size_t TUPLE_BATCH_SIZE = 1024;                              // tuples per batch in NextBatch
+static constexpr int PARALLEL_SCAN_MAX_WORKERS = 32;                          // max threads of one parallel seq scan
+static constexpr int PARALLEL_SCAN_MORSEL_PAGES = 64;                         // pages handed to a scan worker at once
+static constexpr int PARALLEL_SCAN_MIN_PAGES = 1024;                          // tables smaller than this are scanned serially
+static constexpr size_t PARALLEL_SCAN_WINDOW_PER_WORKER = 2;                  // morsels a worker may run ahead of the consumer
+static constexpr size_t AGGREGATE_PARTITIONS = 64;                            // hash partitions of a parallel aggregation
+static constexpr size_t AGGREGATE_TABLE_INIT_SLOTS = 16;                      // initial slots of an aggregate hash table
+static constexpr size_t SORT_WORKERS = 8;                                     // threads sorting runs concurrently
+static constexpr size_t SORT_PARALLEL_MIN_ROWS = 64 * 1024;                   // in-memory sorts smaller than this use one thread
+static constexpr size_t SORT_MERGE_FAN_IN = 64;                               // runs merged at once
+static constexpr size_t SPILL_QUERY_MEMORY_BUDGET = 512 * 1024 * 1024;        // bytes the spilling operators of a query share
+static constexpr size_t SPILL_RESERVE_CHUNK = 1024 * 1024;                    // granularity of operator memory reservations
+static constexpr size_t SPILL_IO_BUFFER_SIZE = 256 * 1024;                    // bytes buffered per spill file read/write
+static constexpr size_t SPILL_WRITE_BEHIND_BYTES = 8 * 1024 * 1024;           // page cache a spill file may hold while written
+static constexpr size_t RESULT_CHUNK_SIZE = 64 * 1024;                        // bytes of rows sent per binary result frame
+static constexpr size_t MAX_REQUEST_SIZE = 64 * 1024 * 1024;                  // longest SQL accepted by the binary protocol
 
 using frame_id_t = int32_t;  // frame id type, 帧页ID, 页在BufferPool中的存储单元称为帧,一帧对应一页
 using page_id_t = int32_t;   // page id type , 页ID
@@ -52,8 +81,30 @@ using timestamp_t = int32_t;  // timestamp type, used for transaction concurrenc
 
 // log file
 static const std::string LOG_FILE_NAME = "db.log";
+// 日志主记录，指向最近一次模糊检查点
+static const std::string LOG_MASTER_FILE_NAME = "db.log.master";
+// 模糊检查点的间隔（秒）
+static constexpr int CHECKPOINT_INTERVAL_SEC = 60;
 
 // replacer
 static const std::string REPLACER_TYPE = "LRU";
 
 static const std::string DB_META_NAME = "db.meta";
+// ANALYZE 收集的统计信息，和 DB_META_NAME 放在同一目录下
+static const std::string DB_STATS_NAME = "db.stats";
+// 溢出文件的临时目录，相对于数据库目录，可以用环境变量 RMDB_SPILL_DIR 指定
+static const std::string SPILL_DIR_NAME = "spill";
+// 统计信息中等深直方图的桶数
+static constexpr int STATS_HISTOGRAM_BUCKETS = 32;
+// ANALYZE 为每张表抽样的行数，直方图由样本构造
+static constexpr int STATS_SAMPLE_ROWS = 30000;
+// ANALYZE 估计不同值个数时 HyperLogLog 的寄存器个数为 2^STATS_HLL_PRECISION
+static constexpr int STATS_HLL_PRECISION = 12;
+// 有统计信息时，索引条件估计命中的行数超过这个比例就改用顺序扫描
+static constexpr double INDEX_SCAN_MAX_SELECTIVITY = 0.2;
+// 索引条件估计命中的行数超过这个比例（且不超过 INDEX_SCAN_MAX_SELECTIVITY）时，先收集 rid 按页号排序再回表
+static constexpr double BITMAP_SCAN_MIN_SELECTIVITY = 0.05;
+// 位图扫描回表时每次预读的堆页面数
+static constexpr int BITMAP_SCAN_PREFETCH_PAGES = 64;
+// 多个索引的 rid 求交集时，单个索引的条件估计命中的行数超过这个比例就不参与（扫描它的代价太大）
+static constexpr double INDEX_AND_MAX_SELECTIVITY = 0.5;
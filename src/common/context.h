@@ -15,6 +15,8 @@ See the Mulan PSL v2 for more details. */
 #include "recovery/log_manager.h"
 
 // class TransactionManager;
+class SpillContext;
+class ResultWriter;
 
 // used for data_send
 static int const_offset = -1;
@@ -35,4 +37,8 @@ public:
     char *data_send_;
     int *offset_;
     bool ellipsis_;
+    // 当前查询的溢出上下文，由 Portal 在生成算子树时设置
+    std::shared_ptr<SpillContext> spill_;
+    // 二进制协议的连接上结果直接流式发送给客户端，文本协议时为 nullptr，结果写入 data_send_
+    ResultWriter *result_ = nullptr;
 };
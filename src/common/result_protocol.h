@@ -0,0 +1,126 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ * 二进制结果协议，服务端和 rmdb_client 共用，只依赖标准库和 socket 接口。
+ *
+ * 连接建立后默认是文本协议（请求和响应都以 '\0' 结尾，结果是最多 BUFFER_LENGTH 字节的表格文本）。
+ * 客户端发送 HANDSHAKE 以后切换为二进制协议，服务端回复一个 COMPLETE 帧，之后：
+ *   请求：u32 长度 + SQL 文本
+ *   响应帧：u8 类型 + u32 负载长度 + 负载
+ * 一条语句的响应依次是 [ROW_DESC DATA_ROWS*] [MESSAGE]，最后是 COMPLETE 或 ERROR 之一。
+ * DATA_ROWS 在算子产生结果的同时分块发送，结果集大小没有上限；socket 阻塞写提供背压。
+ * 所有整数都是小端序。
+ */
+namespace result_protocol {
+
+static constexpr const char *HANDSHAKE = "\\protocol binary";
+static constexpr size_t FRAME_HEADER_SIZE = 5;
+
+enum FrameType : uint8_t {
+    ROW_DESC = 'T',  // u16 列数，每列：u8 类型 + u16 列名长度 + 列名
+    DATA_ROWS = 'D', // u32 行数，每行按列依次编码：INT 为 i32，FLOAT 为 f32，STRING 为 u16 长度 + 字节
+    MESSAGE = 'M',   // 文本，比如 show tables、desc 的输出
+    COMPLETE = 'C',  // u64 结果行数，语句成功结束
+    ERROR = 'E'      // 错误信息，语句失败（包括事务回滚）
+};
+
+// 列类型，取值和服务端的 ColType 相同
+enum ColumnType : uint8_t { COL_INT = 0, COL_FLOAT = 1, COL_STRING = 2 };
+
+inline void put_u16(std::string &out, uint16_t v) {
+    char b[2] = {static_cast<char>(v), static_cast<char>(v >> 8)};
+    out.append(b, 2);
+}
+
+inline void put_u32(std::string &out, uint32_t v) {
+    char b[4] = {static_cast<char>(v), static_cast<char>(v >> 8), static_cast<char>(v >> 16),
+                 static_cast<char>(v >> 24)};
+    out.append(b, 4);
+}
+
+inline void put_u64(std::string &out, uint64_t v) {
+    put_u32(out, static_cast<uint32_t>(v));
+    put_u32(out, static_cast<uint32_t>(v >> 32));
+}
+
+inline uint16_t get_u16(const char *p) {
+    auto u = reinterpret_cast<const unsigned char *>(p);
+    return static_cast<uint16_t>(u[0] | u[1] << 8);
+}
+
+inline uint32_t get_u32(const char *p) {
+    auto u = reinterpret_cast<const unsigned char *>(p);
+    return static_cast<uint32_t>(u[0]) | static_cast<uint32_t>(u[1]) << 8 | static_cast<uint32_t>(u[2]) << 16 |
+           static_cast<uint32_t>(u[3]) << 24;
+}
+
+inline uint64_t get_u64(const char *p) { return get_u32(p) | static_cast<uint64_t>(get_u32(p + 4)) << 32; }
+
+// 写完 len 字节，连接断开时返回 false
+inline bool send_all(int fd, const char *data, size_t len, int flags = 0) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, flags | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// 读满 len 字节，连接断开时返回 false
+inline bool recv_all(int fd, char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = recv(fd, data, len, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// 发送一帧，帧头和负载合并成一个 TCP 段
+inline bool send_frame(int fd, FrameType type, const char *payload, size_t len) {
+    std::string header(1, static_cast<char>(type));
+    put_u32(header, static_cast<uint32_t>(len));
+    return send_all(fd, header.data(), header.size(), len > 0 ? MSG_MORE : 0) && send_all(fd, payload, len);
+}
+
+// 读取一帧，负载放在 payload 中
+inline bool recv_frame(int fd, FrameType &type, std::string &payload) {
+    char header[FRAME_HEADER_SIZE];
+    if (!recv_all(fd, header, FRAME_HEADER_SIZE)) {
+        return false;
+    }
+    type = static_cast<FrameType>(header[0]);
+    payload.resize(get_u32(header + 1));
+    return recv_all(fd, &payload[0], payload.size());
+}
+
+}  // namespace result_protocol
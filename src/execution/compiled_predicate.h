@@ -0,0 +1,340 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "common/common.h"
+#include "errors.h"
+#include "system/sm_meta.h"
+
+/**
+ * @description: 编译好的一组合取谓词。生成算子时把条件翻译成按列类型和比较运算符实例化的比较函数，
+ * 执行时不再判断条件种类、列类型和运算符。谓词最多读两条记录：单表扫描只有 rec0，
+ * 连接时左边的列在 rec0，右边的列在 rec1
+ */
+class CompiledPredicate {
+private:
+    struct Term;
+    using EvalFn = bool (*)(const Term &term, const char *rec0, const char *rec1);
+    // 在 sel 中 n 条记录的下标上判断条件，满足条件的下标依次写到 out 中（可以和 sel 是同一个数组），返回个数
+    using FilterFn = size_t (*)(const Term &term, const char *const *recs, const uint32_t *sel, size_t n,
+                                uint32_t *out);
+
+    struct Term {
+        EvalFn eval;
+        FilterFn filter;
+        ColType type;
+        CompOp op;
+        int len; // 比较的字节数，即左列的长度
+        int lhs_side;
+        int lhs_off;
+        int rhs_side;
+        int rhs_off;
+        bool rhs_is_col;
+        std::string rhs; // 右值是常量时的原始字节
+        std::shared_ptr<std::unordered_set<std::string> > value_set; // IN 谓词的值集合
+        std::string error; // 条件不合法时在执行时抛出的错误信息
+        ColType error_rhs_type;
+    };
+
+    std::vector<Term> terms_;
+
+    template<typename T>
+    static inline T load(const char *data) {
+        T val;
+        memcpy(&val, data, sizeof(T));
+        return val;
+    }
+
+    template<CompOp op, typename T>
+    static inline bool apply(const T &lhs, const T &rhs) {
+        if constexpr (op == OP_EQ) {
+            return lhs == rhs;
+        } else if constexpr (op == OP_NE) {
+            return lhs != rhs;
+        } else if constexpr (op == OP_LT) {
+            return lhs < rhs;
+        } else if constexpr (op == OP_GT) {
+            return lhs > rhs;
+        } else if constexpr (op == OP_LE) {
+            return lhs <= rhs;
+        } else {
+            return lhs >= rhs;
+        }
+    }
+
+    template<ColType type, CompOp op>
+    static inline bool test(const char *lhs, const char *rhs, int len) {
+        if constexpr (type == TYPE_INT) {
+            return apply<op>(load<int>(lhs), load<int>(rhs));
+        } else if constexpr (type == TYPE_FLOAT) {
+            return apply<op>(load<float>(lhs), load<float>(rhs));
+        } else {
+            return apply<op>(memcmp(lhs, rhs, len), 0);
+        }
+    }
+
+    template<ColType type, CompOp op, bool rhs_is_col>
+    static bool eval_cmp(const Term &term, const char *rec0, const char *rec1) {
+        const char *lhs = (term.lhs_side == 0 ? rec0 : rec1) + term.lhs_off;
+        const char *rhs = rhs_is_col ? (term.rhs_side == 0 ? rec0 : rec1) + term.rhs_off : term.rhs.data();
+        return test<type, op>(lhs, rhs, term.len);
+    }
+
+    // 右值是常量的条件：常量只取一次，循环体中没有分支，满足条件时写指针前进
+    template<ColType type, CompOp op>
+    static size_t filter_const(const Term &term, const char *const *recs, const uint32_t *sel, size_t n,
+                               uint32_t *out) {
+        size_t cnt = 0;
+        if constexpr (type == TYPE_INT || type == TYPE_FLOAT) {
+            using T = std::conditional_t<type == TYPE_INT, int, float>;
+            const T rhs = load<T>(term.rhs.data());
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t idx = sel[i];
+                out[cnt] = idx;
+                cnt += apply<op>(load<T>(recs[idx] + term.lhs_off), rhs);
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t idx = sel[i];
+                out[cnt] = idx;
+                cnt += apply<op>(memcmp(recs[idx] + term.lhs_off, term.rhs.data(), term.len), 0);
+            }
+        }
+        return cnt;
+    }
+
+    static size_t filter_generic(const Term &term, const char *const *recs, const uint32_t *sel, size_t n,
+                                 uint32_t *out) {
+        size_t cnt = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t idx = sel[i];
+            out[cnt] = idx;
+            cnt += term.eval(term, recs[idx], nullptr);
+        }
+        return cnt;
+    }
+
+    static bool eval_in(const Term &term, const char *rec0, const char *rec1) {
+        const char *lhs = (term.lhs_side == 0 ? rec0 : rec1) + term.lhs_off;
+        return term.value_set->count(Condition::in_key(lhs, term.len, term.type)) > 0;
+    }
+
+    static bool eval_false(const Term &, const char *, const char *) { return false; }
+
+    static bool eval_error(const Term &term, const char *, const char *) {
+        if (term.error.empty()) {
+            throw IncompatibleTypeError(coltype2str(term.type), coltype2str(term.error_rhs_type));
+        }
+        throw InternalError(term.error);
+    }
+
+    template<ColType type, CompOp op>
+    static void bind(Term &term, bool rhs_is_col) {
+        term.eval = rhs_is_col ? eval_cmp<type, op, true> : eval_cmp<type, op, false>;
+        term.filter = rhs_is_col || term.lhs_side != 0 ? filter_generic : filter_const<type, op>;
+    }
+
+    template<ColType type>
+    static void bind(Term &term, bool rhs_is_col) {
+        switch (term.op) {
+            case OP_EQ: return bind<type, OP_EQ>(term, rhs_is_col);
+            case OP_NE: return bind<type, OP_NE>(term, rhs_is_col);
+            case OP_LT: return bind<type, OP_LT>(term, rhs_is_col);
+            case OP_GT: return bind<type, OP_GT>(term, rhs_is_col);
+            case OP_LE: return bind<type, OP_LE>(term, rhs_is_col);
+            case OP_GE: return bind<type, OP_GE>(term, rhs_is_col);
+            default:
+                throw InternalError("Unexpected op type！");
+        }
+    }
+
+    static void bind(Term &term, bool rhs_is_col) {
+        switch (term.type) {
+            case TYPE_INT: return bind<TYPE_INT>(term, rhs_is_col);
+            case TYPE_FLOAT: return bind<TYPE_FLOAT>(term, rhs_is_col);
+            case TYPE_STRING: return bind<TYPE_STRING>(term, rhs_is_col);
+            default:
+                throw InternalError("Unexpected data type！");
+        }
+    }
+
+    static void set_error(Term &term, std::string error, ColType rhs_type = TYPE_INT) {
+        term.eval = eval_error;
+        term.filter = filter_generic;
+        term.error = std::move(error);
+        term.error_rhs_type = rhs_type;
+    }
+
+    static const ColMeta *find_col(const std::vector<ColMeta> &cols, const TabCol &target) {
+        auto pos = std::find_if(cols.begin(), cols.end(), [&](const ColMeta &col) {
+            return col.tab_name == target.tab_name && col.name == target.col_name;
+        });
+        return pos == cols.end() ? nullptr : &*pos;
+    }
+
+    // 常量按左列长度截断或补 0
+    static void set_rhs(Term &term, const RmRecord &raw) {
+        term.rhs.assign(raw.data, std::min(raw.size, term.len));
+        term.rhs.resize(term.len, '\0');
+    }
+
+    // 列在 cols 中的偏移量不小于 split 时属于 rec1
+    static void locate(const ColMeta &col, size_t split, int &side, int &off) {
+        side = static_cast<size_t>(col.offset) < split ? 0 : 1;
+        off = side == 0 ? col.offset : col.offset - static_cast<int>(split);
+    }
+
+    Term compile(const Condition &cond, const std::vector<ColMeta> &cols, size_t split) {
+        Term term{};
+        term.op = cond.op;
+        const ColMeta *lhs_col = find_col(cols, cond.lhs_col);
+        if (lhs_col == nullptr) {
+            throw ColumnNotFoundError(cond.lhs_col.tab_name + '.' + cond.lhs_col.col_name);
+        }
+        term.type = lhs_col->type;
+        term.len = lhs_col->len;
+        locate(*lhs_col, split, term.lhs_side, term.lhs_off);
+
+        if (cond.is_rhs_val) {
+            if (cond.rhs_val.type != term.type) {
+                // 和原来一样，遇到第一条记录时才报类型错误
+                set_error(term, "", cond.rhs_val.type);
+                return term;
+            }
+            set_rhs(term, *cond.rhs_val.raw);
+            bind(term, false);
+            return term;
+        }
+        if (cond.is_sub_query) {
+            // 值列表和子查询结果在生成算子时已经物化
+            if (cond.op == OP_IN) {
+                term.value_set = cond.rhs_value_set;
+                term.eval = eval_in;
+                term.filter = filter_generic;
+                return term;
+            }
+            // 标量子查询没有结果时不满足条件
+            if (cond.rhs_value_list.empty()) {
+                term.eval = eval_false;
+                term.filter = filter_generic;
+                return term;
+            }
+            auto &value = cond.rhs_value_list[0];
+            if (value.type != term.type) {
+                set_error(term, "", value.type);
+                return term;
+            }
+            set_rhs(term, *value.raw);
+            bind(term, false);
+            return term;
+        }
+        const ColMeta *rhs_col = find_col(cols, cond.rhs_col);
+        if (rhs_col == nullptr) {
+            set_error(term, "Unexpected condition on column " + cond.rhs_col.tab_name + '.' + cond.rhs_col.col_name);
+            return term;
+        }
+        if (rhs_col->type != term.type) {
+            set_error(term, "", rhs_col->type);
+            return term;
+        }
+        locate(*rhs_col, split, term.rhs_side, term.rhs_off);
+        term.rhs_is_col = true;
+        bind(term, true);
+        return term;
+    }
+
+public:
+    CompiledPredicate() = default;
+
+    /**
+     * @description: 编译条件，cols 是算子输出元组的字段
+     * @param {size_t} split 连接时左元组的长度，cols 中偏移量不小于它的列从 rec1 中读取；单表时不用传
+     */
+    CompiledPredicate(const std::vector<Condition> &conds, const std::vector<ColMeta> &cols,
+                      size_t split = static_cast<size_t>(-1)) {
+        terms_.reserve(conds.size());
+        for (auto &cond: conds) {
+            terms_.emplace_back(compile(cond, cols, split));
+        }
+    }
+
+    bool empty() const { return terms_.empty(); }
+
+    size_t size() const { return terms_.size(); }
+
+    bool eval(const char *rec0, const char *rec1 = nullptr) const {
+        for (auto &term: terms_) {
+            if (!term.eval(term, rec0, rec1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 返回第一个不满足的条件的序号，都满足时返回 size()
+    size_t first_failed(const char *rec0, const char *rec1 = nullptr) const {
+        for (size_t i = 0; i < terms_.size(); ++i) {
+            if (!terms_[i].eval(terms_[i], rec0, rec1)) {
+                return i;
+            }
+        }
+        return terms_.size();
+    }
+
+    // 第 i 个条件左右两边的三路比较结果，IN 谓词和不合法的条件返回 0
+    int compare(size_t i, const char *rec0, const char *rec1) const {
+        auto &term = terms_[i];
+        if (!term.rhs_is_col && term.rhs.empty()) {
+            return 0;
+        }
+        const char *lhs = (term.lhs_side == 0 ? rec0 : rec1) + term.lhs_off;
+        const char *rhs = term.rhs_is_col ? (term.rhs_side == 0 ? rec0 : rec1) + term.rhs_off : term.rhs.data();
+        switch (term.type) {
+            case TYPE_INT: {
+                int a = load<int>(lhs), b = load<int>(rhs);
+                return (a > b) - (a < b);
+            }
+            case TYPE_FLOAT: {
+                float a = load<float>(lhs), b = load<float>(rhs);
+                return (a > b) - (a < b);
+            }
+            default:
+                return memcmp(lhs, rhs, term.len);
+        }
+    }
+
+    /**
+     * @description: 一次判断 n 条单表记录，按条件逐个收缩选择向量
+     * @param {const char *const *} recs 记录地址
+     * @param {size_t} n 记录个数
+     * @param {uint32_t *} sel 输出满足所有条件的记录下标，至少能放 n 个
+     * @return {size_t} 满足条件的记录个数
+     */
+    size_t filter(const char *const *recs, size_t n, uint32_t *sel) const {
+        for (size_t i = 0; i < n; ++i) {
+            sel[i] = static_cast<uint32_t>(i);
+        }
+        for (auto &term: terms_) {
+            if (n == 0) {
+                break;
+            }
+            n = term.filter(term, recs, sel, n, sel);
+        }
+        return n;
+    }
+};
@@ -20,6 +20,7 @@ See the Mulan PSL v2 for more details. */
 #include "executor_sortmerge_join.h"
 #include "index/ix.h"
 #include "record_printer.h"
+#include "result_writer.h"
 
 const char *help_info = "Supported SQL syntax:\n"
         "  command ;\n"
@@ -32,6 +33,7 @@ const char *help_info = "Supported SQL syntax:\n"
         "  DELETE FROM table_name [WHERE where_clause]\n"
         "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
         "  SELECT selector FROM table_name [WHERE where_clause]\n"
+        "  ANALYZE [table_name]\n"
         "type:\n"
         "  {INT | FLOAT | CHAR(n)}\n"
         "where_clause:\n"
@@ -133,6 +135,10 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> &plan, const txn_id_t *txn
                 sm_manager_->desc_table(x->tab_name_, context);
                 break;
             }
+            case T_Analyze: {
+                sm_manager_->analyze(x->tab_name_, context);
+                break;
+            }
             case T_Transaction_begin: {
                 // 显示开启一个事务
                 context->txn_->set_txn_mode(true);
@@ -170,6 +176,10 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> &plan, const txn_id_t *txn
                 planner_->set_enable_sortmerge_join(x->bool_value_);
                 break;
             }
+            case ast::SetKnobType::EnableHashJoin: {
+                planner_->set_enable_hash_join(x->bool_value_);
+                break;
+            }
             default: {
                 throw RMDBError("Not implemented!\n");
             }
@@ -212,6 +222,11 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> &plan, const txn_id_t *txn
 
         std::ofstream ofs(LOG_FILE_NAME, std::ios::trunc);
         ofs.close();
+        // 日志清空后之前的模糊检查点也失效
+        if (disk_manager->is_file(LOG_MASTER_FILE_NAME)) {
+            disk_manager->destroy_file(LOG_MASTER_FILE_NAME);
+        }
+        context->log_mgr_->set_log_offset(context->log_mgr_->get_next_lsn(), 0);
 
         // exit(1);
         // 5.把日志文件中检查点记录的地址写到“重新启动文件”中 忽略
@@ -227,11 +242,17 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> &executorTreeRoot,
         captions.emplace_back(std::move(sel_col.col_name));
     }
 
-    // Print header into buffer
+    // 二进制协议直接发送元组中的列值，只有写 output.txt 时才需要格式化成字符串
+    ResultWriter *result = context->result_;
     RecordPrinter rec_printer(sel_cols.size());
-    rec_printer.print_separator(context);
-    rec_printer.print_record(captions, context);
-    rec_printer.print_separator(context);
+    if (result != nullptr) {
+        result->begin_rows(captions, executorTreeRoot->cols());
+    } else {
+        // Print header into buffer
+        rec_printer.print_separator(context);
+        rec_printer.print_record(captions, context);
+        rec_printer.print_separator(context);
+    }
     // print header into file
     std::fstream outfile;
     if (planner_->enable_output_file) {
@@ -242,6 +263,7 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> &executorTreeRoot,
         }
         outfile << "\n";
     }
+    bool format = result == nullptr || planner_->enable_output_file;
 
     // Print records
     size_t num_rec = 0;
@@ -249,36 +271,51 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> &executorTreeRoot,
     // 预留空间
     columns.reserve(executorTreeRoot->cols().size());
     // 执行query_plan
-    for (executorTreeRoot->beginTuple(); !executorTreeRoot->is_end(); executorTreeRoot->nextTuple()) {
-        columns.clear();
-        auto Tuple = executorTreeRoot->Next();
-        for (auto &col: executorTreeRoot->cols()) {
-            std::string col_str;
-            char *rec_buf = Tuple->data + col.offset;
-            if (col.type == TYPE_INT) {
-                col_str = std::to_string(*(int *) rec_buf);
-            } else if (col.type == TYPE_FLOAT) {
-                col_str = std::to_string(*(float *) rec_buf);
-            } else if (col.type == TYPE_STRING) {
-                col_str = std::string((char *) rec_buf, col.len);
-                col_str.resize(strlen(col_str.c_str()));
+    TupleBatch batch;
+    for (executorTreeRoot->beginBatch(); executorTreeRoot->NextBatch(batch);) {
+        for (size_t row = 0; row < batch.size(); ++row) {
+            const char *tuple = batch.get(row);
+            num_rec++;
+            if (result != nullptr) {
+                result->add_row(tuple);
             }
-            // 移动语义
-            columns.emplace_back(std::move(col_str));
-        }
-        // print record into buffer
-        rec_printer.print_record(columns, context);
-        // print record into file
-        if (planner_->enable_output_file) {
-            outfile << "|";
-            for (size_t i = 0; i < columns.size(); ++i) {
-                outfile << " " << columns[i] << " |";
+            if (!format) {
+                continue;
+            }
+            columns.clear();
+            for (auto &col: executorTreeRoot->cols()) {
+                std::string col_str;
+                const char *rec_buf = tuple + col.offset;
+                if (col.type == TYPE_INT) {
+                    col_str = std::to_string(*(const int *) rec_buf);
+                } else if (col.type == TYPE_FLOAT) {
+                    col_str = std::to_string(*(const float *) rec_buf);
+                } else if (col.type == TYPE_STRING) {
+                    col_str = std::string(rec_buf, col.len);
+                    col_str.resize(strlen(col_str.c_str()));
+                }
+                // 移动语义
+                columns.emplace_back(std::move(col_str));
+            }
+            // print record into buffer
+            if (result == nullptr) {
+                rec_printer.print_record(columns, context);
+            }
+            // print record into file
+            if (planner_->enable_output_file) {
+                outfile << "|";
+                for (size_t i = 0; i < columns.size(); ++i) {
+                    outfile << " " << columns[i] << " |";
+                }
+                outfile << "\n";
             }
-            outfile << "\n";
         }
-        num_rec++;
     }
     outfile.close();
+    if (result != nullptr) {
+        result->end_rows();
+        return;
+    }
     // Print footer into buffer
     rec_printer.print_separator(context);
     // Print record count into buffer
@@ -290,11 +327,21 @@ void QlManager::select_fast_count_star(int count, std::string &sel_col, Context
     std::vector<std::string> captions;
     captions.emplace_back(std::move(sel_col));
 
-    // Print header into buffer
     RecordPrinter rec_printer(1);
-    rec_printer.print_separator(context);
-    rec_printer.print_record(captions, context);
-    rec_printer.print_separator(context);
+    if (context->result_ != nullptr) {
+        ColMeta col;
+        col.type = TYPE_INT;
+        col.len = sizeof(int);
+        col.offset = 0;
+        context->result_->begin_rows(captions, {col});
+        context->result_->add_row(reinterpret_cast<const char *>(&count));
+        context->result_->end_rows();
+    } else {
+        // Print header into buffer
+        rec_printer.print_separator(context);
+        rec_printer.print_record(captions, context);
+        rec_printer.print_separator(context);
+    }
     // print header into file
     std::fstream outfile;
     if (planner_->enable_output_file) {
@@ -312,8 +359,6 @@ void QlManager::select_fast_count_star(int count, std::string &sel_col, Context
     char buffer[20]{};
     columns.emplace_back(my_itoa(count, buffer, 10));
 
-    // print record into buffer
-    rec_printer.print_record(columns, context);
     // print record into file
     if (planner_->enable_output_file) {
         outfile << "|";
@@ -323,6 +368,11 @@ void QlManager::select_fast_count_star(int count, std::string &sel_col, Context
         outfile << "\n";
     }
     outfile.close();
+    if (context->result_ != nullptr) {
+        return;
+    }
+    // print record into buffer
+    rec_printer.print_record(columns, context);
     // Print footer into buffer
     rec_printer.print_separator(context);
     // Print record count into buffer
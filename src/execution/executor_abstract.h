@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/common.h"
 #include "index/ix.h"
 #include "system/sm.h"
+#include "tuple_batch.h"
 
 class AbstractExecutor {
 public:
@@ -44,6 +45,19 @@ public:
 
     virtual std::unique_ptr<RmRecord> Next() = 0;
 
+    // 批量执行接口：先调用 beginBatch，再反复调用 NextBatch 直到返回 false，同一轮执行中不要和 Next/nextTuple 混用
+    // 默认实现在逐行接口上适配，原生支持的算子直接把元组写进 batch 的缓冲区
+    virtual void beginBatch() { beginTuple(); }
+
+    virtual bool NextBatch(TupleBatch &batch) {
+        batch.reset(tupleLen());
+        for (; !is_end() && !batch.full(); nextTuple()) {
+            auto record = Next();
+            batch.push_back(record->data, rid());
+        }
+        return !batch.empty();
+    }
+
     virtual ColMeta get_col_offset(const TabCol &target) { return ColMeta(); }
 
     // 弃用
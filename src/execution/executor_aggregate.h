@@ -1,197 +1,203 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <string_view>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
+#include "executor_parallel_seq_scan.h"
 #include "index/ix.h"
 #include "system/sm.h"
 
-struct AggregateKey {
-    // 用 rmcord 可能更好
-    std::vector<Value> group_bys;
-};
-
-struct AggregateValue {
-    // 用 rmcord 可能更好，select 里面的聚合值
-    std::vector<Value> values;
-    // having 里面的聚合值
-    std::vector<Value> having_values;
-};
+/**
+ * @description: 聚合的定长行格式。每个分组在 arena 中占一行，依次是打包好的分组键、select 中的聚合状态、
+ * having 中的聚合状态。count 的状态是 int，max/min/sum 的状态是和输入列同样格式的值，
+ * 因此分组键和 select 中的聚合状态拼起来就是算子输出的元组
+ */
+struct AggregateLayout {
+    struct Agg {
+        AggType type;
+        ColType col_type; // 状态的类型，count 为 int
+        int col_off; // 输入元组中的偏移，count 不使用
+        int len; // 状态的长度
+        int state_off; // 在行中的偏移
+    };
+
+    std::vector<std::pair<int, int>> key_cols; // 分组列在输入元组中的偏移和长度
+    int key_len = 0;
+    std::vector<Agg> aggs; // 先是 select 中的聚合，再是 having 中的聚合，select 中的非聚合列不占状态
+    int sel_len = 0; // select 中聚合状态的总长度
+    int row_len = 0;
+
+    void add_agg(AggType type, const ColMeta &col) {
+        aggs.push_back({type, col.type, static_cast<int>(col.offset), col.len, row_len});
+        row_len += col.len;
+    }
 
-struct AggregateKeyHash {
-    std::size_t operator()(const AggregateKey &key) const {
-        std::size_t hash = 0;
-        for (const auto &value: key.group_bys) {
-            switch (value.type) {
-                case TYPE_INT: {
-                    hash ^= std::hash<int>()(value.int_val);
-                    break;
-                }
-                case TYPE_FLOAT: {
-                    hash ^= std::hash<float>()(value.float_val);
-                    break;
-                }
-                case TYPE_STRING: {
-                    hash ^= std::hash<std::string>()(value.str_val);
-                    break;
-                }
+    // 分组第一次出现时用这条输入元组初始化状态
+    void init(char *row, const char *rec) const {
+        for (auto &agg: aggs) {
+            if (agg.type == AGG_COUNT) {
+                int one = 1;
+                memcpy(row + agg.state_off, &one, sizeof(int));
+            } else {
+                memcpy(row + agg.state_off, rec + agg.col_off, agg.len);
             }
-            // hash ^= std::hash<int>()(value.int_val) ^ std::hash<float>()(value.float_val) ^ std::hash<std::string>()(
-            //     value.str_val);
         }
-        return hash;
-    }
-};
-
-struct AggregateKeyEqual {
-    bool operator()(const AggregateKey &lhs, const AggregateKey &rhs) const {
-        return lhs.group_bys == rhs.group_bys;
-    }
-};
-
-class AggregateHashTable {
-public:
-    AggregateHashTable(const std::vector<AggType> &agg_types,
-                       const std::vector<Condition> &having_conds) : agg_types_(agg_types),
-                                                                     having_conds_(having_conds) {
     }
 
-    auto generateInitialAggregateValue(const AggregateValue &input) -> AggregateValue {
-        std::vector<Value> values;
-        std::vector<Value> having_values;
-        for (std::size_t i = 0; i < agg_types_.size(); ++i) {
-            switch (agg_types_[i]) {
+    // 把一条输入元组累加到状态中
+    void update(char *row, const char *rec) const {
+        for (auto &agg: aggs) {
+            char *state = row + agg.state_off;
+            switch (agg.type) {
                 case AGG_COUNT: {
-                    Value v;
-                    v.set_int(1);
-                    v.init_raw(sizeof(int));
-                    values.emplace_back(v);
+                    int cnt;
+                    memcpy(&cnt, state, sizeof(int));
+                    ++cnt;
+                    memcpy(state, &cnt, sizeof(int));
                     break;
                 }
                 case AGG_MAX:
+                    if (compare(state, rec + agg.col_off, agg.len, agg.col_type) < 0) {
+                        memcpy(state, rec + agg.col_off, agg.len);
+                    }
+                    break;
                 case AGG_MIN:
-                case AGG_SUM:
-                    // 直接初始化为输入值
-                    values.emplace_back(input.values[i]);
+                    if (compare(state, rec + agg.col_off, agg.len, agg.col_type) > 0) {
+                        memcpy(state, rec + agg.col_off, agg.len);
+                    }
                     break;
-                case AGG_COL:
-                    // 占位
-                    values.emplace_back();
+                case AGG_SUM:
+                    add(state, rec + agg.col_off, agg.col_type);
                     break;
                 default:
                     throw InternalError("Unexpected aggregate type！");
             }
         }
+    }
 
-        for (std::size_t i = 0; i < having_conds_.size(); ++i) {
-            switch (having_conds_[i].agg_type) {
+    // 合并同一分组的另一份部分聚合状态
+    void merge(char *row, const char *other) const {
+        for (auto &agg: aggs) {
+            char *state = row + agg.state_off;
+            const char *input = other + agg.state_off;
+            switch (agg.type) {
                 case AGG_COUNT: {
-                    Value v;
-                    v.set_int(1);
-                    v.init_raw(sizeof(int));
-                    having_values.emplace_back(v);
+                    int cnt, delta;
+                    memcpy(&cnt, state, sizeof(int));
+                    memcpy(&delta, input, sizeof(int));
+                    cnt += delta;
+                    memcpy(state, &cnt, sizeof(int));
                     break;
                 }
                 case AGG_MAX:
+                    if (compare(state, input, agg.len, agg.col_type) < 0) {
+                        memcpy(state, input, agg.len);
+                    }
+                    break;
                 case AGG_MIN:
+                    if (compare(state, input, agg.len, agg.col_type) > 0) {
+                        memcpy(state, input, agg.len);
+                    }
+                    break;
                 case AGG_SUM:
-                    // 直接初始化为输入值
-                    having_values.emplace_back(input.having_values[i]);
+                    add(state, input, agg.col_type);
                     break;
-                case AGG_COL:
                 default:
                     throw InternalError("Unexpected aggregate type！");
             }
         }
-
-        return {values, having_values};
     }
+};
 
-    void combineAggregateValues(AggregateValue *result, const AggregateValue &input) {
-        for (std::size_t i = 0; i < agg_types_.size(); i++) {
-            switch (agg_types_[i]) {
-                case AGG_COUNT:
-                    // result->values[i].set_int(result->values[i].int_val + 1);
-                    result->values[i].int_val += 1;
-                    break;
-                case AGG_MAX: {
-                    auto &lhs = result->values[i];
-                    auto &rhs = input.values[i];
-                    if (compare(lhs.raw->data, rhs.raw->data, lhs.str_val.size(),
-                                lhs.type) < 0) {
-                        lhs = rhs;
-                    }
-                    break;
-                }
-                case AGG_MIN: {
-                    auto &lhs = result->values[i];
-                    const auto &rhs = input.values[i];
-                    if (compare(lhs.raw->data, rhs.raw->data, lhs.str_val.size(),
-                                lhs.type) > 0) {
-                        lhs = rhs;
-                    }
-                    break;
-                }
-                case AGG_SUM: {
-                    auto &lhs = result->values[i];
-                    const auto &rhs = input.values[i];
-                    add(lhs.raw->data, rhs.raw->data, lhs.type);
-                    break;
+/**
+ * @description: 以打包的分组键为键的开放定址哈希表（线性探测），分组的行连续存放在 arena 中。
+ * 每个分组记录它第一次出现的序号，并行聚合合并以后按序号输出，分组顺序和串行时相同
+ */
+class AggregateHashTable {
+private:
+    const AggregateLayout *layout_;
+    std::vector<char> arena_; // 所有分组的行
+    std::vector<size_t> hashes_; // 每个分组的键的哈希值，合并时不用重新计算
+    std::vector<uint64_t> ordinals_; // 每个分组第一次出现的序号
+    // 槽位的高 32 位是哈希值的高 32 位，低 32 位是分组下标加一，0 表示空槽
+    std::vector<uint64_t> slots_;
+    size_t mask_ = 0;
+
+    void grow() {
+        std::vector<uint64_t> slots(slots_.empty() ? AGGREGATE_TABLE_INIT_SLOTS : slots_.size() * 2, 0);
+        mask_ = slots.size() - 1;
+        for (uint64_t slot: slots_) {
+            if (slot != 0) {
+                size_t pos = hashes_[(slot & 0xffffffff) - 1] & mask_;
+                while (slots[pos] != 0) {
+                    pos = (pos + 1) & mask_;
                 }
-                case AGG_COL:
-                    break;
+                slots[pos] = slot;
             }
         }
+        slots_.swap(slots);
+    }
 
-        for (std::size_t i = 0; i < having_conds_.size(); i++) {
-            switch (having_conds_[i].agg_type) {
-                case AGG_COUNT:
-                    // result->values[i].set_int(result->values[i].int_val + 1);
-                    result->having_values[i].int_val += 1;
-                    break;
-                case AGG_MAX: {
-                    auto &lhs = result->having_values[i];
-                    auto &rhs = input.having_values[i];
-                    if (compare(lhs.raw->data, rhs.raw->data, lhs.str_val.size(),
-                                lhs.type) < 0) {
-                        lhs = rhs;
-                    }
-                    break;
-                }
-                case AGG_MIN: {
-                    auto &lhs = result->having_values[i];
-                    const auto &rhs = input.having_values[i];
-                    if (compare(lhs.raw->data, rhs.raw->data, lhs.str_val.size(),
-                                lhs.type) > 0) {
-                        lhs = rhs;
-                    }
-                    break;
-                }
-                case AGG_SUM: {
-                    auto &lhs = result->having_values[i];
-                    const auto &rhs = input.having_values[i];
-                    add(lhs.raw->data, rhs.raw->data, lhs.type);
-                    break;
-                }
-                case AGG_COL:
-                default:
-                    throw InternalError("Unexpected aggregate type！");
+public:
+    explicit AggregateHashTable(const AggregateLayout *layout) : layout_(layout) {}
+
+    static size_t hash_key(const char *key, int key_len) {
+        return std::hash<std::string_view>()(std::string_view(key, key_len));
+    }
+
+    size_t size() const { return hashes_.size(); }
+
+    char *row(size_t i) { return arena_.data() + i * layout_->row_len; }
+
+    uint64_t ordinal(size_t i) const { return ordinals_[i]; }
+
+    /**
+     * @description: 查找分组，不存在时在 arena 末尾追加一行，只拷贝分组键，状态由调用者初始化
+     * @return {size_t} 分组的下标
+     */
+    size_t find_or_insert(const char *key, size_t hash, uint64_t ordinal, bool &inserted) {
+        // 负载因子不超过 1/2
+        if (2 * (hashes_.size() + 1) > slots_.size()) {
+            grow();
+        }
+        uint64_t tag = hash >> 32 << 32;
+        size_t pos = hash & mask_;
+        for (; slots_[pos] != 0; pos = (pos + 1) & mask_) {
+            uint64_t slot = slots_[pos];
+            size_t i = (slot & 0xffffffff) - 1;
+            if ((slot >> 32 << 32) == tag && memcmp(row(i), key, layout_->key_len) == 0) {
+                inserted = false;
+                return i;
             }
         }
+        size_t i = hashes_.size();
+        slots_[pos] = tag | (i + 1);
+        hashes_.push_back(hash);
+        ordinals_.push_back(ordinal);
+        arena_.resize(arena_.size() + layout_->row_len);
+        memcpy(row(i), key, layout_->key_len);
+        inserted = true;
+        return i;
     }
 
-    void insertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-        if (hash_table_.count(agg_key) == 0) {
-            hash_table_.emplace(agg_key, generateInitialAggregateValue(agg_val));
-        } else {
-            combineAggregateValues(&hash_table_[agg_key], agg_val);
+    // 把另一张表中的分组合并进来，两张表的行格式相同
+    void merge(AggregateHashTable &other) {
+        for (size_t i = 0; i < other.size(); ++i) {
+            const char *src = other.row(i);
+            bool inserted;
+            size_t j = find_or_insert(src, other.hashes_[i], other.ordinals_[i], inserted);
+            if (inserted) {
+                memcpy(row(j) + layout_->key_len, src + layout_->key_len, layout_->row_len - layout_->key_len);
+            } else {
+                layout_->merge(row(j), src);
+                ordinals_[j] = std::min(ordinals_[j], other.ordinals_[i]);
+            }
         }
     }
-
-public:
-    std::unordered_map<AggregateKey, AggregateValue, AggregateKeyHash, AggregateKeyEqual> hash_table_;
-    const std::vector<AggType> &agg_types_;
-    const std::vector<Condition> &having_conds_;
 };
 
 class AggregateExecutor : public AbstractExecutor {
@@ -213,18 +219,169 @@ private:
     std::vector<Condition> having_conds_;
     std::vector<ColMeta> group_bys_;
 
-    AggregateHashTable ht_;
-    std::unordered_map<AggregateKey, AggregateValue, AggregateKeyHash, AggregateKeyEqual>::iterator it_;
+    AggregateLayout layout_;
+    size_t sel_aggs_{0}; // select 中聚合的个数，having 的聚合状态排在它们后面
+    std::vector<AggregateHashTable> tables_; // 聚合结果，并行聚合时每个分区一张表
+    std::vector<const char *> groups_; // 按第一次出现的顺序排列的分组
+    size_t pos_{0}; // 当前输出的分组
     bool has_group_col_{false};
     bool is_empty_table_{false};
 
+    /**
+     * @description: 把一条输入元组累加到 tables 中，多张表时按分组键的哈希值选择分区
+     * @param {uint64_t} ordinal 元组的序号，分组按第一次出现的序号输出
+     * @param {char *} key 长度为 key_len 的缓冲区，用来打包分组键
+     */
+    void accumulate(const char *rec, uint64_t ordinal, std::vector<AggregateHashTable> &tables, char *key) const {
+        int offset = 0;
+        for (auto &[col_off, len]: layout_.key_cols) {
+            memcpy(key + offset, rec + col_off, len);
+            offset += len;
+        }
+        size_t hash = AggregateHashTable::hash_key(key, layout_.key_len);
+        auto &table = tables.size() == 1 ? tables[0] : tables[(hash >> 32) % tables.size()];
+        bool inserted;
+        size_t i = table.find_or_insert(key, hash, ordinal, inserted);
+        if (inserted) {
+            layout_.init(table.row(i), rec);
+        } else {
+            layout_.update(table.row(i), rec);
+        }
+    }
+
+    /**
+     * @description: 并行扫描时每个工作线程先聚合到自己的一组分区表中，再由多个线程按分区合并。
+     * 元组的序号是 morsel 编号和 morsel 中的位置拼起来的，和串行扫描的顺序一致
+     */
+    void parallel_aggregate(const ParallelSeqScanExecutor &scan) {
+        using BatchSource = ParallelSeqScanExecutor::BatchSource;
+        size_t num_workers = scan.num_workers();
+        std::vector<std::vector<AggregateHashTable>> locals(
+            num_workers, std::vector<AggregateHashTable>(AGGREGATE_PARTITIONS, AggregateHashTable(&layout_)));
+        std::vector<TupleBatch> batches(num_workers);
+        std::vector<std::vector<char>> keys(num_workers, std::vector<char>(layout_.key_len));
+        scan.for_each_morsel([&](size_t worker, size_t morsel, const BatchSource &next) {
+            uint64_t ordinal = static_cast<uint64_t>(morsel) << 32;
+            auto &batch = batches[worker];
+            while (next(batch)) {
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    accumulate(batch.get(i), ordinal++, locals[worker], keys[worker].data());
+                }
+            }
+        });
+
+        tables_.assign(AGGREGATE_PARTITIONS, AggregateHashTable(&layout_));
+        std::atomic<size_t> next_part{0};
+        run_workers(std::min<size_t>(num_workers, AGGREGATE_PARTITIONS), [&](size_t) {
+            for (size_t p; (p = next_part++) < tables_.size();) {
+                tables_[p] = std::move(locals[0][p]);
+                for (size_t w = 1; w < num_workers; ++w) {
+                    tables_[p].merge(locals[w][p]);
+                }
+            }
+        });
+    }
+
+    // 判断分组是否满足 having 中的所有条件
+    bool check_having(const char *row) const {
+        for (size_t i = 0; i < having_conds_.size(); ++i) {
+            auto &cond = having_conds_[i];
+            auto &agg = layout_.aggs[sel_aggs_ + i];
+            if (agg.col_type != cond.rhs_val.type) {
+                throw IncompatibleTypeError(coltype2str(agg.col_type), coltype2str(cond.rhs_val.type));
+            }
+            int cmp = compare(row + agg.state_off, cond.rhs_val.raw->data, agg.len, agg.col_type);
+            bool ok;
+            switch (cond.op) {
+                case OP_EQ: ok = cmp == 0; break;
+                case OP_NE: ok = cmp != 0; break;
+                case OP_LT: ok = cmp < 0; break;
+                case OP_GT: ok = cmp > 0; break;
+                case OP_LE: ok = cmp <= 0; break;
+                case OP_GE: ok = cmp >= 0; break;
+                default:
+                    throw InternalError("Unexpected op type！");
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 跳过不满足 having 条件的分组
+    void skip_unqualified() {
+        while (pos_ < groups_.size() && !check_having(groups_[pos_])) {
+            ++pos_;
+        }
+    }
+
+    // 把当前分组的结果写到 out 中
+    void write_row(char *out) {
+        // count 输出 0，其他输出空
+        if (is_empty_table_) {
+            int offset = 0;
+            for (std::size_t i = 0; i < agg_types_.size(); ++i) {
+                switch (agg_types_[i]) {
+                    case AGG_COUNT: {
+                        int zero = 0;
+                        memcpy(out + offset, &zero, sizeof(int));
+                        offset += sizeof(int);
+                        break;
+                    }
+                    case AGG_MAX:
+                    case AGG_MIN:
+                    case AGG_SUM:
+                    // {
+                    //     // 为了输出空改为字符串类型，原来 len 不变
+                    //     sel_cols_[i].type = TYPE_STRING;
+                    //     std::string s;
+                    //     memcpy(out + offset, s.c_str(), sel_cols_[i].len);
+                    //     offset += sel_cols_[i].len;
+                    //     break;
+                    // }
+                    case AGG_COL:
+                    default:
+                        throw InternalError("Unsupported aggregate null type！");
+                }
+            }
+            return;
+        }
+
+        int offset = 0;
+
+        // for (std::size_t i = 0; i < sel_cols_.size(); ++i) {
+        //     auto &sel_col = sel_cols_[i];
+        //     if (agg_types_[i] == AGG_COL) {
+        //         auto &&pos = std::find_if(group_bys_.begin(), group_bys_.end(), [&](ColMeta& col_meta) {
+        //             return col_meta.tab_name == sel_col.tab_name && col_meta.name == sel_col.name;
+        //         });
+        //         if (pos == group_bys_.end()) {
+        //             throw InternalError("SELECT 列表中不能出现没有在 GROUP BY 子句中的非聚集列！");
+        //         }
+        //         memcpy(out + offset, ->data, group_bys_[i].len);
+        //     }
+        //
+        //     memcpy(out + offset, key.raw->data, group_bys_[i].len);
+        //     offset += group_bys_[i].len;
+        // }
+
+        // 先生成左 key 右 value 的形式，具体列顺序由投影算子执行
+        const char *row = groups_[pos_];
+        if (has_group_col_) {
+            memcpy(out, row, layout_.key_len);
+            offset = layout_.key_len;
+        }
+        memcpy(out + offset, row + layout_.key_len, layout_.sel_len);
+    }
+
 public:
     AggregateExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols,
                       std::vector<AggType> agg_types, const std::vector<TabCol> &group_bys,
                       std::vector<Condition> having_conds,
                       Context *context)
         : prev_(std::move(prev)), agg_types_(std::move(agg_types)),
-          having_conds_(std::move(having_conds)), ht_(agg_types_, having_conds_) {
+          having_conds_(std::move(having_conds)) {
         // sm_manager_ = sm_manager;
         // tab_name_ = std::move(tab_name);
         // conds_ = std::move(conds);
@@ -291,6 +448,25 @@ public:
             group_bys_.emplace_back(*get_col(cols_, group_by));
         }
 
+        for (auto &group_by: group_bys_) {
+            layout_.key_cols.emplace_back(group_by.offset, group_by.len);
+            layout_.key_len += group_by.len;
+        }
+        layout_.row_len = layout_.key_len;
+        for (std::size_t i = 0; i < agg_types_.size(); ++i) {
+            if (agg_types_[i] != AGG_COL) {
+                layout_.add_agg(agg_types_[i], sel_cols_[i]);
+            }
+        }
+        layout_.sel_len = layout_.row_len - layout_.key_len;
+        sel_aggs_ = layout_.aggs.size();
+        for (std::size_t i = 0; i < having_conds_.size(); ++i) {
+            if (having_conds_[i].agg_type == AGG_COL) {
+                throw InternalError("Unexpected aggregate type！");
+            }
+            layout_.add_agg(having_conds_[i].agg_type, having_cols_[i]);
+        }
+
         // len_ = cols_.back().offset + cols_.back().len;
         context_ = context;
         // fed_conds_ = conds_;
@@ -298,136 +474,50 @@ public:
 
     void beginTuple() override {
         // 子查询要清空，也可以直接缓存？
-        ht_.hash_table_.clear();
-        prev_->beginTuple();
-
-        std::vector<Value> keys(group_bys_.size());
-        std::vector<Value> values(agg_types_.size());
-        std::vector<Value> having_values(having_conds_.size());
-
-        while (!prev_->is_end()) {
-            keys.clear();
-            values.clear();
-            having_values.clear();
-
-            rm_record_ = prev_->Next();
-            for (auto &group_by: group_bys_) {
-                keys.emplace_back();
-                if (group_by.type == TYPE_INT) {
-                    const int a = *reinterpret_cast<const int *>(rm_record_->data + group_by.offset);
-                    keys.back().set_int(a);
-                } else if (group_by.type == TYPE_FLOAT) {
-                    const float a = *reinterpret_cast<const float *>(rm_record_->data + group_by.offset);
-                    keys.back().set_float(a);
-                } else if (group_by.type == TYPE_STRING) {
-                    std::string s(rm_record_->data + group_by.offset, group_by.len);
-                    keys.back().set_str(s);
-                } else {
-                    throw InternalError("Unexpected data type！");
-                }
-                // memcpy(keys.back().raw->data, rm_record_->data + group_by.offset, group_by.len);
-                keys.back().init_raw(group_by.len);
-            }
+        tables_.clear();
+        groups_.clear();
+        pos_ = 0;
 
-            // 获取 select 里面的聚合值
-            for (std::size_t i = 0; i < agg_types_.size(); ++i) {
-                switch (agg_types_[i]) {
-                    case AGG_COUNT: {
-                        Value v;
-                        v.set_int(1);
-                        v.init_raw(sizeof(int));
-                        values.emplace_back(v);
-                        break;
-                    }
-                    case AGG_MAX:
-                    case AGG_MIN:
-                    case AGG_SUM: {
-                        // TODO 记得初始化
-                        Value v;
-                        if (sel_cols_[i].type == TYPE_INT) {
-                            const int a = *reinterpret_cast<const int *>(rm_record_->data + sel_cols_[i].offset);
-                            v.set_int(a);
-                        } else if (sel_cols_[i].type == TYPE_FLOAT) {
-                            const float a = *reinterpret_cast<const float *>(rm_record_->data + sel_cols_[i].offset);
-                            v.set_float(a);
-                        } else if (sel_cols_[i].type == TYPE_STRING) {
-                            // throw InternalError("You cant aggreagte string with max/min/sum");
-                            std::string s(rm_record_->data + sel_cols_[i].offset, sel_cols_[i].len);
-                            v.set_str(s);
-                        }
-                        v.init_raw(sel_cols_[i].len);
-                        values.emplace_back(v);
-                        break;
-                    }
-                    case AGG_COL:
-                        values.emplace_back();
-                        break;
-                    default:
-                        throw InternalError("Unexpected aggregate type！");
+        if (auto *scan = dynamic_cast<ParallelSeqScanExecutor *>(prev_.get())) {
+            parallel_aggregate(*scan);
+        } else {
+            tables_.emplace_back(&layout_);
+            std::vector<char> key(layout_.key_len);
+            uint64_t ordinal = 0;
+            TupleBatch batch;
+            for (prev_->beginBatch(); prev_->NextBatch(batch);) {
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    accumulate(batch.get(i), ordinal++, tables_, key.data());
                 }
             }
+        }
 
-            // 获取 having 里面的聚合值
-            for (std::size_t i = 0; i < having_conds_.size(); ++i) {
-                switch (having_conds_[i].agg_type) {
-                    case AGG_COUNT: {
-                        Value v;
-                        v.set_int(1);
-                        v.init_raw(sizeof(int));
-                        having_values.emplace_back(v);
-                        break;
-                    }
-                    case AGG_MAX:
-                    case AGG_MIN:
-                    case AGG_SUM: {
-                        // TODO 记得初始化
-                        Value v;
-                        if (having_cols_[i].type == TYPE_INT) {
-                            const int a = *reinterpret_cast<const int *>(rm_record_->data + having_cols_[i].offset);
-                            v.set_int(a);
-                        } else if (having_cols_[i].type == TYPE_FLOAT) {
-                            const float a = *reinterpret_cast<const float *>(rm_record_->data + having_cols_[i].offset);
-                            v.set_float(a);
-                        } else if (having_cols_[i].type == TYPE_STRING) {
-                            std::string s(rm_record_->data + having_cols_[i].offset, having_cols_[i].len);
-                            v.set_str(s);
-                        }
-                        v.init_raw(having_cols_[i].len);
-                        having_values.emplace_back(v);
-                        break;
-                    }
-                    case AGG_COL:
-                    default:
-                        throw InternalError("Unexpected aggregate type！");
+        if (tables_.size() == 1) {
+            for (size_t i = 0; i < tables_[0].size(); ++i) {
+                groups_.push_back(tables_[0].row(i));
+            }
+        } else {
+            std::vector<std::pair<uint64_t, const char *>> groups;
+            for (auto &table: tables_) {
+                for (size_t i = 0; i < table.size(); ++i) {
+                    groups.emplace_back(table.ordinal(i), table.row(i));
                 }
             }
-
-            ht_.insertCombine({keys}, {values, having_values});
-            prev_->nextTuple();
+            std::sort(groups.begin(), groups.end());
+            for (auto &group: groups) {
+                groups_.push_back(group.second);
+            }
         }
 
-        it_ = ht_.hash_table_.begin();
         // 空表
-        if (it_ == ht_.hash_table_.end()) {
+        if (groups_.empty()) {
             // 空表且有group by，但是没有key直接输出空表
             if (!group_bys_.empty() && has_group_col_) {
                 return;
             }
             is_empty_table_ = true;
         }
-
-        while (it_ != ht_.hash_table_.end()) {
-            std::size_t i = 0;
-            for (; i < it_->second.having_values.size(); ++i) {
-                if (!cmp_cond(it_->second.having_values[i], having_conds_[i].rhs_val, having_conds_[i])) {
-                    break;
-                }
-            }
-            if (i == having_conds_.size()) {
-                break;
-            }
-            ++it_;
-        }
+        skip_unqualified();
     }
 
     void nextTuple() override {
@@ -435,141 +525,37 @@ public:
             is_empty_table_ = false;
             return;
         }
-        ++it_;
-        while (it_ != ht_.hash_table_.end()) {
-            std::size_t i = 0;
-            for (; i < it_->second.having_values.size(); ++i) {
-                if (!cmp_cond(it_->second.having_values[i], having_conds_[i].rhs_val, having_conds_[i])) {
-                    break;
-                }
-            }
-            if (i == having_conds_.size()) {
-                break;
-            }
-            ++it_;
-        }
+        ++pos_;
+        skip_unqualified();
     }
 
     std::unique_ptr<RmRecord> Next() override {
         auto record = std::make_unique<RmRecord>(len_);
-        // count 输出 0，其他输出空
-        if (is_empty_table_) {
-            int offset = 0;
-            for (std::size_t i = 0; i < agg_types_.size(); ++i) {
-                switch (agg_types_[i]) {
-                    case AGG_COUNT: {
-                        int zero = 0;
-                        memcpy(record->data + offset, &zero, sizeof(int));
-                        offset += sizeof(int);
-                        break;
-                    }
-                    case AGG_MAX:
-                    case AGG_MIN:
-                    case AGG_SUM:
-                    // {
-                    //     // 为了输出空改为字符串类型，原来 len 不变
-                    //     sel_cols_[i].type = TYPE_STRING;
-                    //     std::string s;
-                    //     memcpy(record->data + offset, s.c_str(), sel_cols_[i].len);
-                    //     offset += sel_cols_[i].len;
-                    //     break;
-                    // }
-                    case AGG_COL:
-                    default:
-                        throw InternalError("Unsupported aggregate null type！");
-                }
-            }
-            return std::move(record);
-        }
-
-        int offset = 0;
-
-        // for (std::size_t i = 0; i < sel_cols_.size(); ++i) {
-        //     auto &sel_col = sel_cols_[i];
-        //     if (agg_types_[i] == AGG_COL) {
-        //         auto &&pos = std::find_if(group_bys_.begin(), group_bys_.end(), [&](ColMeta& col_meta) {
-        //             return col_meta.tab_name == sel_col.tab_name && col_meta.name == sel_col.name;
-        //         });
-        //         if (pos == group_bys_.end()) {
-        //             throw InternalError("SELECT 列表中不能出现没有在 GROUP BY 子句中的非聚集列！");
-        //         }
-        //         memcpy(record->data + offset, ->data, group_bys_[i].len);
-        //     }
-        //
-        //     memcpy(record->data + offset, key.raw->data, group_bys_[i].len);
-        //     offset += group_bys_[i].len;
-        // }
-
-        // 先生成左 key 右 value 的形式，具体列顺序由投影算子执行
-        if (has_group_col_) {
-            for (std::size_t i = 0; i < group_bys_.size(); ++i) {
-                auto &key = it_->first.group_bys[i];
-                memcpy(record->data + offset, key.raw->data, group_bys_[i].len);
-                offset += group_bys_[i].len;
-            }
-        }
+        write_row(record->data);
+        return record;
+    }
 
-        for (std::size_t i = 0; i < agg_types_.size(); ++i) {
-            if (agg_types_[i] == AGG_COL) {
-                continue;
-            }
-            auto &value = it_->second.values[i];
-            if (agg_types_[i] == AGG_COUNT) {
-                memcpy(record->data + offset, &value.int_val, sel_cols_[i].len);
-            } else {
-                memcpy(record->data + offset, value.raw->data, sel_cols_[i].len);
-            }
-            offset += sel_cols_[i].len;
+    bool NextBatch(TupleBatch &batch) override {
+        batch.reset(len_);
+        for (; !is_end() && !batch.full(); nextTuple()) {
+            write_row(batch.emplace_back());
         }
-
-        // assert(offset == len_);
-        return std::move(record);
+        return !batch.empty();
     }
 
     Rid &rid() override { return rid_; }
 
-    bool is_end() const {
+    bool is_end() const override {
         // 空表输出一次
         if (is_empty_table_) {
             return false;
         }
-        return it_ == ht_.hash_table_.end();
+        return pos_ == groups_.size();
     }
 
     const std::vector<ColMeta> &cols() const override { return sel_cols_; }
 
     size_t tupleLen() const override { return len_; }
 
-    // 判断是否满足单个谓词条件
-    static bool cmp_cond(const Value &l_rec, const Value &r_rec, const Condition &cond) {
-        if (l_rec.type != r_rec.type) {
-            throw IncompatibleTypeError(coltype2str(l_rec.type), coltype2str(r_rec.type));
-        }
-        if (l_rec.type == TYPE_INT) {
-            memcpy(l_rec.raw->data, &l_rec.int_val, sizeof(int));
-        }
-
-        auto &&lhs_value = l_rec.raw->data;
-        auto &&rhs_value = r_rec.raw->data;
-
-        int cmp = compare(lhs_value, rhs_value, l_rec.str_val.size(), l_rec.type);
-        switch (cond.op) {
-            case OP_EQ: return cmp == 0;
-            case OP_NE: return cmp != 0;
-            case OP_LT: return cmp < 0;
-            case OP_GT: return cmp > 0;
-            case OP_LE: return cmp <= 0;
-            case OP_GE: return cmp >= 0;
-            default:
-                throw InternalError("Unexpected op type！");
-        }
-    }
-
-    bool cmp_conds(const Value &l_rec, const Value &r_rec, const std::vector<Condition> &conds) {
-        return std::all_of(conds.begin(), conds.end(), [&](const Condition &cond) {
-            return cmp_cond(l_rec, r_rec, cond);
-        });
-    }
-
     std::string getType() { return "AggregateExecutor"; }
 };
@@ -0,0 +1,512 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <functional>
+#include <string_view>
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+#include "compiled_predicate.h"
+#include "spill_manager.h"
+
+// 等值连接的哈希连接算子：在较小的一侧（build 侧）上建哈希表，另一侧（probe 侧）逐条探测。
+// build 侧超出查询的溢出内存预算时退化为 hybrid hash join：按哈希值分成 HASH_JOIN_PARTITIONS 个分区，
+// 0 号分区留在内存中直接探测，其余分区两侧的元组都写入临时文件，等内存中的探测结束后再逐个分区连接，
+// 某个分区仍然放不下时换一个 level 递归分区
+class HashJoinExecutor : public AbstractExecutor {
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    // 写到临时文件中的一个分区
+    struct SpillPartition {
+        std::string build_file;
+        std::string probe_file;
+        size_t build_cnt{0};
+        size_t probe_cnt{0};
+        int level{0};
+    };
+
+    std::unique_ptr<AbstractExecutor> left_; // 左儿子节点（需要join的表）
+    std::unique_ptr<AbstractExecutor> right_; // 右儿子节点（需要join的表）
+    size_t len_; // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_; // join后获得的记录的字段
+    std::vector<Condition> fed_conds_; // join条件
+    std::vector<Condition> residual_conds_; // 连接键以外的条件，在拼接后的元组上判断
+    CompiledPredicate residual_;
+    bool build_left_; // 是否在左儿子上建哈希表
+    AbstractExecutor *build_;
+    AbstractExecutor *probe_;
+    size_t build_len_;
+    size_t probe_len_;
+    std::vector<ColMeta> build_keys_; // build 侧的连接键，偏移量为在 build 侧元组中的偏移量
+    std::vector<ColMeta> probe_keys_; // probe 侧的连接键
+    size_t key_len_{0};
+    // 条目格式：哈希值 + 规范化后的连接键 + 元组，哈希表和临时文件中都以条目为单位
+    size_t build_entry_len_;
+    size_t probe_entry_len_;
+
+    // 内存中的哈希表，拉链法，heads_ 和 next_ 中保存条目下标
+    std::vector<char> entries_;
+    size_t entry_cnt_{0};
+    std::vector<uint32_t> heads_;
+    std::vector<uint32_t> next_;
+    size_t mask_{0};
+    bool table_reusable_{false}; // 哈希表完整地留在内存中，再次 beginTuple 时不用重建
+
+    // 当前一轮（原始输入或者一个溢出分区）的状态
+    int level_{0};
+    bool partitioned_{false};
+    bool mem_spilled_{false}; // 0 号分区也超出了内存预算，已经写到文件中
+    std::vector<SpillPartition> parts_;
+    std::vector<std::unique_ptr<SpillWriter> > build_files_;
+    std::vector<std::unique_ptr<SpillWriter> > probe_files_;
+    bool probe_from_child_{true};
+    std::unique_ptr<SpillReader> probe_in_;
+    std::string probe_in_name_;
+    std::vector<SpillPartition> pending_; // 还没有连接的溢出分区
+
+    std::vector<char> probe_entry_;
+    uint32_t match_{NIL};
+    // 两侧儿子都按批读取
+    TupleBatch build_batch_;
+    TupleBatch probe_batch_;
+    size_t probe_pos_{0};
+    std::unique_ptr<RmRecord> rm_record_;
+    bool is_end_{false};
+    std::shared_ptr<SpillContext> spill_;
+    MemoryReservation mem_; // 内存中的哈希表占用的内存
+
+    // 同一个哈希值在不同 level 下落到不同的分区，递归分区才能把数据继续分开
+    static size_t partition_of(size_t hash, int level) {
+        uint64_t x = hash + 0x9e3779b97f4a7c15ULL * (level + 1);
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x % HASH_JOIN_PARTITIONS;
+    }
+
+    static size_t entry_hash(const char *entry) {
+        size_t hash;
+        memcpy(&hash, entry, sizeof(size_t));
+        return hash;
+    }
+
+    // 把元组的连接键拷贝到条目中并写入哈希值，float 的 -0.0 规范化为 0.0，保证相等的键字节也相同
+    size_t make_entry(const char *rec, const std::vector<ColMeta> &keys, size_t rec_len, char *entry) const {
+        char *key = entry + sizeof(size_t);
+        for (auto &col: keys) {
+            memcpy(key, rec + col.offset, col.len);
+            if (col.type == TYPE_FLOAT && *reinterpret_cast<float *>(key) == 0.0f) {
+                *reinterpret_cast<float *>(key) = 0.0f;
+            }
+            key += col.len;
+        }
+        memcpy(key, rec, rec_len);
+        size_t hash = std::hash<std::string_view>{}(std::string_view(entry + sizeof(size_t), key_len_));
+        memcpy(entry, &hash, sizeof(size_t));
+        return hash;
+    }
+
+    size_t mem_used() const {
+        return entries_.size() + entries_.size() / build_entry_len_ * 2 * sizeof(uint32_t);
+    }
+
+    // 哈希表超出已经预留的内存时按块扩大预留，超出查询预算时返回 false
+    bool reserve_memory() {
+        size_t used = mem_used();
+        return used <= mem_.size() || mem_.try_resize(used + SPILL_RESERVE_CHUNK);
+    }
+
+    void write_entry(std::vector<std::unique_ptr<SpillWriter> > &files, std::string &file_name, size_t part,
+                     const char *side, const char *entry, size_t entry_len) {
+        auto &file = files[part];
+        if (file == nullptr) {
+            file_name = spill_->create_file(std::string("hashjoin_") + side);
+            file = std::make_unique<SpillWriter>(spill_.get(), file_name);
+        }
+        file->append(entry, entry_len);
+    }
+
+    // 写完一个分区文件，之后才能读取
+    static void finish_files(std::vector<std::unique_ptr<SpillWriter> > &files) {
+        for (auto &file: files) {
+            if (file != nullptr) {
+                file->finish();
+                file = nullptr;
+            }
+        }
+    }
+
+    void remove_file(std::string &file_name) {
+        if (!file_name.empty()) {
+            spill_->remove_file(file_name);
+            file_name.clear();
+        }
+    }
+
+    void write_build(size_t part, const char *entry) {
+        write_entry(build_files_, parts_[part].build_file, part, "build", entry, build_entry_len_);
+        ++parts_[part].build_cnt;
+    }
+
+    void write_probe(size_t part, const char *entry) {
+        write_entry(probe_files_, parts_[part].probe_file, part, "probe", entry, probe_entry_len_);
+        ++parts_[part].probe_cnt;
+    }
+
+    void reset_round(int level) {
+        level_ = level;
+        partitioned_ = false;
+        mem_spilled_ = false;
+        entries_.clear();
+        entry_cnt_ = 0;
+        heads_.clear();
+        next_.clear();
+        match_ = NIL;
+        parts_.clear();
+        build_files_.clear();
+        probe_files_.clear();
+        mem_.resize(0);
+    }
+
+    // 0 号分区也放不下，整个写出到文件
+    void spill_memory_partition() {
+        for (size_t off = 0; off < entries_.size(); off += build_entry_len_) {
+            write_build(0, entries_.data() + off);
+        }
+        entries_.clear();
+        mem_spilled_ = true;
+    }
+
+    // 超出内存预算，开始分区：内存中只保留 0 号分区，其余条目写出到各自分区的文件
+    void start_partitioning() {
+        partitioned_ = true;
+        parts_.assign(HASH_JOIN_PARTITIONS, SpillPartition{});
+        for (auto &part: parts_) {
+            part.level = level_ + 1;
+        }
+        build_files_.resize(HASH_JOIN_PARTITIONS);
+        probe_files_.resize(HASH_JOIN_PARTITIONS);
+
+        size_t kept = 0;
+        for (size_t off = 0; off < entries_.size(); off += build_entry_len_) {
+            const char *entry = entries_.data() + off;
+            size_t part = partition_of(entry_hash(entry), level_);
+            if (part == 0) {
+                memmove(entries_.data() + kept, entry, build_entry_len_);
+                kept += build_entry_len_;
+            } else {
+                write_build(part, entry);
+            }
+        }
+        entries_.resize(kept);
+        if (!reserve_memory()) {
+            spill_memory_partition();
+        }
+    }
+
+    // 读入一轮的全部 build 条目并建哈希表，超出内存预算时分区写出
+    void load_build(const std::function<bool(char *)> &next_entry, int level) {
+        reset_round(level);
+        std::vector<char> entry(build_entry_len_);
+        while (next_entry(entry.data())) {
+            if (partitioned_) {
+                size_t part = partition_of(entry_hash(entry.data()), level_);
+                if (part != 0 || mem_spilled_) {
+                    write_build(part, entry.data());
+                    continue;
+                }
+            }
+            entries_.insert(entries_.end(), entry.begin(), entry.end());
+            // 递归到最大层数后不再分区（大量重复键时分区也分不开），直接在内存中连接
+            if (!reserve_memory()) {
+                if (level_ >= HASH_JOIN_MAX_LEVEL) {
+                    mem_.resize(mem_used());
+                } else if (!partitioned_) {
+                    start_partitioning();
+                } else {
+                    spill_memory_partition();
+                }
+            }
+        }
+        finish_files(build_files_);
+
+        entry_cnt_ = entries_.size() / build_entry_len_;
+        size_t buckets = 1;
+        while (buckets < entry_cnt_) {
+            buckets <<= 1;
+        }
+        mask_ = buckets - 1;
+        heads_.assign(buckets, NIL);
+        next_.resize(entry_cnt_);
+        // 倒序头插，链上的条目保持 build 侧的读入顺序
+        for (size_t i = entry_cnt_; i-- > 0;) {
+            auto &head = heads_[entry_hash(entries_.data() + i * build_entry_len_) & mask_];
+            next_[i] = head;
+            head = static_cast<uint32_t>(i);
+        }
+    }
+
+    // 从 probe 侧儿子或者溢出分区的文件中读一条 probe 条目
+    bool read_probe(char *entry) {
+        if (probe_from_child_) {
+            if (probe_pos_ == probe_batch_.size()) {
+                if (!probe_->NextBatch(probe_batch_)) {
+                    return false;
+                }
+                probe_pos_ = 0;
+            }
+            make_entry(probe_batch_.get(probe_pos_++), probe_keys_, probe_len_, entry);
+            return true;
+        }
+        return probe_in_->read(entry);
+    }
+
+    // 一轮的 probe 侧读完，把两侧都有元组的分区留到后面连接，其余的临时文件直接删除
+    void finish_round() {
+        probe_in_ = nullptr;
+        remove_file(probe_in_name_);
+        finish_files(probe_files_);
+        for (auto &part: parts_) {
+            if (part.build_cnt > 0 && part.probe_cnt > 0) {
+                pending_.emplace_back(std::move(part));
+                continue;
+            }
+            remove_file(part.build_file);
+            remove_file(part.probe_file);
+        }
+        parts_.clear();
+    }
+
+    void start_spilled_round(SpillPartition &part) {
+        {
+            SpillReader build_in(spill_.get(), part.build_file, build_entry_len_);
+            load_build([&](char *entry) { return build_in.read(entry); }, part.level);
+        }
+        remove_file(part.build_file);
+
+        probe_from_child_ = false;
+        probe_in_name_ = std::move(part.probe_file);
+        probe_in_ = std::make_unique<SpillReader>(spill_.get(), probe_in_name_, probe_entry_len_);
+    }
+
+    // 取下一条需要在内存哈希表中探测的 probe 条目，属于溢出分区的条目写到文件中
+    bool next_probe() {
+        char *entry = probe_entry_.data();
+        while (true) {
+            if (!read_probe(entry)) {
+                finish_round();
+                if (pending_.empty()) {
+                    return false;
+                }
+                auto part = std::move(pending_.back());
+                pending_.pop_back();
+                start_spilled_round(part);
+                continue;
+            }
+            if (partitioned_) {
+                size_t part = partition_of(entry_hash(entry), level_);
+                if (part != 0 || mem_spilled_) {
+                    // 分区中没有 build 元组，内连接不会有结果，直接丢弃
+                    if (parts_[part].build_cnt > 0) {
+                        write_probe(part, entry);
+                    }
+                    continue;
+                }
+            }
+            if (entry_cnt_ > 0) {
+                return true;
+            }
+        }
+    }
+
+    // 找到下一条连接结果写到 out 中，没有更多结果时返回 false
+    bool advance(char *out) {
+        while (!is_end_) {
+            while (match_ != NIL) {
+                const char *entry = entries_.data() + static_cast<size_t>(match_) * build_entry_len_;
+                match_ = next_[match_];
+                if (memcmp(entry, probe_entry_.data(), sizeof(size_t) + key_len_) != 0) {
+                    continue;
+                }
+                const char *build_rec = entry + sizeof(size_t) + key_len_;
+                const char *probe_rec = probe_entry_.data() + sizeof(size_t) + key_len_;
+                // 拷贝左右元组
+                memcpy(out, build_left_ ? build_rec : probe_rec, left_->tupleLen());
+                memcpy(out + left_->tupleLen(), build_left_ ? probe_rec : build_rec, right_->tupleLen());
+                if (residual_.eval(out)) {
+                    return true;
+                }
+            }
+            if (!next_probe()) {
+                is_end_ = true;
+                break;
+            }
+            match_ = heads_[entry_hash(probe_entry_.data()) & mask_];
+        }
+        return false;
+    }
+
+    void begin() {
+        is_end_ = false;
+        match_ = NIL;
+        if (!table_reusable_) {
+            cleanup();
+            build_->beginBatch();
+            size_t build_pos = 0;
+            build_batch_.reset(build_len_);
+            load_build([&](char *entry) {
+                if (build_pos == build_batch_.size()) {
+                    if (!build_->NextBatch(build_batch_)) {
+                        return false;
+                    }
+                    build_pos = 0;
+                }
+                make_entry(build_batch_.get(build_pos++), build_keys_, build_len_, entry);
+                return true;
+            }, 0);
+            table_reusable_ = !partitioned_;
+        }
+        // build 侧为空时内连接没有结果，不用再读 probe 侧
+        if (!partitioned_ && entry_cnt_ == 0) {
+            is_end_ = true;
+            return;
+        }
+        probe_from_child_ = true;
+        probe_->beginBatch();
+        probe_batch_.reset(probe_len_);
+        probe_pos_ = 0;
+    }
+
+    // 删除所有还没删掉的临时文件
+    void cleanup() {
+        build_files_.clear();
+        probe_files_.clear();
+        probe_in_ = nullptr;
+        remove_file(probe_in_name_);
+        for (auto *parts: {&parts_, &pending_}) {
+            for (auto &part: *parts) {
+                remove_file(part.build_file);
+                remove_file(part.probe_file);
+            }
+            parts->clear();
+        }
+    }
+
+public:
+    HashJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right,
+                     std::vector<Condition> conds, bool build_left, std::shared_ptr<SpillContext> spill)
+        : left_(std::move(left)), right_(std::move(right)), fed_conds_(std::move(conds)), build_left_(build_left),
+          spill_(std::move(spill)), mem_(spill_) {
+        len_ = left_->tupleLen() + right_->tupleLen();
+        cols_ = left_->cols();
+        auto right_cols = right_->cols();
+        for (auto &col: right_cols) {
+            col.offset += left_->tupleLen();
+        }
+        cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+
+        // 两侧类型和长度都相同的等值条件作为连接键，其余条件连接后再判断
+        auto find_col = [](const std::vector<ColMeta> &rec_cols, const TabCol &target) {
+            return std::find_if(rec_cols.begin(), rec_cols.end(), [&](const ColMeta &col) {
+                return col.tab_name == target.tab_name && col.name == target.col_name;
+            });
+        };
+        std::vector<ColMeta> left_keys, right_keys;
+        auto &lcols = left_->cols();
+        auto &rcols = right_->cols();
+        for (auto &cond: fed_conds_) {
+            if (cond.op == OP_EQ && !cond.is_rhs_val && !cond.is_sub_query) {
+                auto lpos = find_col(lcols, cond.lhs_col);
+                auto rpos = find_col(rcols, cond.rhs_col);
+                if (lpos == lcols.end() || rpos == rcols.end()) {
+                    lpos = find_col(lcols, cond.rhs_col);
+                    rpos = find_col(rcols, cond.lhs_col);
+                }
+                if (lpos != lcols.end() && rpos != rcols.end() && lpos->type == rpos->type &&
+                    lpos->len == rpos->len) {
+                    left_keys.emplace_back(*lpos);
+                    right_keys.emplace_back(*rpos);
+                    key_len_ += lpos->len;
+                    continue;
+                }
+            }
+            residual_conds_.emplace_back(cond);
+        }
+        if (left_keys.empty()) {
+            throw InternalError("Hash join without equi-join condition!");
+        }
+        residual_ = CompiledPredicate(residual_conds_, cols_);
+
+        build_ = build_left_ ? left_.get() : right_.get();
+        probe_ = build_left_ ? right_.get() : left_.get();
+        build_keys_ = build_left_ ? std::move(left_keys) : std::move(right_keys);
+        probe_keys_ = build_left_ ? std::move(right_keys) : std::move(left_keys);
+        build_len_ = build_->tupleLen();
+        probe_len_ = probe_->tupleLen();
+        build_entry_len_ = sizeof(size_t) + key_len_ + build_len_;
+        probe_entry_len_ = sizeof(size_t) + key_len_ + probe_len_;
+        probe_entry_.resize(probe_entry_len_);
+    }
+
+    ~HashJoinExecutor() override { cleanup(); }
+
+    void beginTuple() override {
+        begin();
+        rm_record_ = std::make_unique<RmRecord>(len_);
+        if (!advance(rm_record_->data)) {
+            rm_record_ = nullptr;
+        }
+    }
+
+    void nextTuple() override {
+        if (is_end_) {
+            return;
+        }
+        if (rm_record_ == nullptr) {
+            rm_record_ = std::make_unique<RmRecord>(len_);
+        }
+        if (!advance(rm_record_->data)) {
+            rm_record_ = nullptr;
+        }
+    }
+
+    std::unique_ptr<RmRecord> Next() override {
+        return std::move(rm_record_);
+    }
+
+    void beginBatch() override { begin(); }
+
+    bool NextBatch(TupleBatch &batch) override {
+        batch.reset(len_);
+        while (!batch.full()) {
+            if (!advance(batch.emplace_back())) {
+                batch.pop_back();
+                break;
+            }
+        }
+        return !batch.empty();
+    }
+
+    Rid &rid() override { return _abstract_rid; }
+
+    std::string getType() override { return "HashJoinExecutor"; }
+
+    bool is_end() const override { return is_end_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    size_t tupleLen() const override { return len_; }
+};
@@ -10,8 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
-#define MAX_RECORD_SIZE 81920
-
+#include <algorithm>
+#include <iterator>
 #include <float.h>
 #include <limits.h>
 
@@ -21,6 +21,8 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "system/sm.h"
 #include "predicate_manager.h"
+#include "compiled_predicate.h"
+#include "spill_manager.h"
 
 static std::map<CompOp, CompOp> swap_op = {
     {OP_EQ, OP_EQ}, {OP_NE, OP_NE}, {OP_LT, OP_GT}, {OP_GT, OP_LT}, {OP_LE, OP_GE}, {OP_GE, OP_LE},
@@ -35,19 +37,17 @@ private:
     TabMeta &tab_; // 表的元数据
     RmFileHandle *fh_; // 表的数据文件句柄
     // std::vector<ColMeta> cols_; // 没必要，通过 tab 获取需要读取的字段
-    std::vector<std::vector<ColMeta>::iterator> cond_cols_; // 谓词需要读取的字段
+    CompiledPredicate pred_; // 编译好的、没有被索引范围覆盖的条件
     size_t len_; // 选取出来的一条记录的长度
     IndexMeta &index_meta_; // index scan涉及到的索引元数据
     Rid rid_;
     std::unique_ptr<IxScan> scan_;
     std::unique_ptr<RmRecord> rm_record_;
-    std::deque<std::unique_ptr<RmRecord> > records_;
-    // 实际二进制文件名
-    std::string filename_;
-    // 排序结果实际读取文件，二进制
-    std::fstream outfile_;
+    // 归并连接时索引顺序的扫描结果写到溢出文件中，重新开始时从文件读
+    std::shared_ptr<SpillContext> spill_;
+    std::string sorted_file_;
+    std::unique_ptr<SpillReader> sorted_in_;
     bool is_end_{false};
-    size_t id_;
     bool mergesort_;
     constexpr static int int_min_ = INT32_MIN;
     constexpr static int int_max_ = INT32_MAX;
@@ -72,16 +72,149 @@ private:
     // 顺序扫描还是逆序
     bool asc_{true};
 
-    static std::size_t generateID() {
-        static size_t current_id = 0;
-        return ++current_id;
+    // 最多输出的元组数，-1 表示不限制，order by + limit 直接由索引顺序满足时输出够了就结束扫描
+    int limit_{-1};
+    int emitted_{0}; // 当前元组之前已经输出的元组数
+
+    // 覆盖索引：查询用到的列都在索引里，元组直接由索引中的key构造，不回表
+    bool index_only_{false};
+    std::vector<char> key_buf_;
+
+    // 位图扫描：索引范围内满足索引条件的 rid 按 (页号, 槽号) 排序后回表，每个堆页面只钉住一次，
+    // 并提前预读后面的页面。输出不再是索引顺序，依赖顺序的扫描不会走这里
+    bool bitmap_{false};
+    std::vector<Rid> bitmap_rids_;
+    size_t bitmap_pos_{0}; // 下一个要回表的 rid
+    size_t bitmap_prefetched_{0}; // 这个位置之前的 rid 所在的页面都已经发起了预读
+    RmPageHandle bitmap_page_; // 当前钉住的堆页面，bitmap_pinned_ 为 false 时无效
+    bool bitmap_pinned_{false};
+    // 其他索引上的扫描，位图扫描时和它们的 rid 求交集
+    std::vector<std::unique_ptr<IndexScanExecutor> > and_scans_;
+
+    static bool rid_before(const Rid &a, const Rid &b) {
+        return a.page_no != b.page_no ? a.page_no < b.page_no : a.slot_no < b.slot_no;
+    }
+
+    // 回表读取 rid_ 对应的记录，rm_record_ 没有被 Next 取走时复用它的缓冲区
+    void load_record() {
+        if (rm_record_ == nullptr) {
+            rm_record_ = std::make_unique<RmRecord>(len_);
+        }
+        fh_->read_record(rid_, rm_record_->data);
+    }
+
+    // 用解码后的key构造元组，只填索引列，其余列为 0（查询用不到）
+    void load_key(const char *key) {
+        if (rm_record_ == nullptr) {
+            rm_record_ = std::make_unique<RmRecord>(len_);
+            memset(rm_record_->data, 0, len_);
+        }
+        for (auto &[index_offset, col]: index_meta_.cols) {
+            memcpy(rm_record_->data + col.offset, key + index_offset, col.len);
+        }
+    }
+
+    // 收集扫描范围内满足索引条件的 rid，按堆文件中的物理位置排序
+    void collect_bitmap() {
+        bitmap_rids_.clear();
+        for (; !scan_->is_end(); scan_->next()) {
+            if (index_clean_ || predicate_manager_.cmpIndexConds(scan_->get_key())) {
+                bitmap_rids_.push_back(scan_->rid());
+            }
+        }
+        std::sort(bitmap_rids_.begin(), bitmap_rids_.end(), rid_before);
+    }
+
+    // 和其他索引上的扫描结果求交集，只回表同时满足各个索引条件的记录
+    void intersect_bitmap() {
+        for (auto &and_scan: and_scans_) {
+            if (bitmap_rids_.empty()) {
+                break;
+            }
+            auto other = and_scan->collect_rids();
+            std::vector<Rid> both;
+            both.reserve(std::min(bitmap_rids_.size(), other.size()));
+            std::set_intersection(bitmap_rids_.begin(), bitmap_rids_.end(), other.begin(), other.end(),
+                                  std::back_inserter(both), rid_before);
+            bitmap_rids_ = std::move(both);
+        }
+    }
+
+    void release_bitmap_page() {
+        if (bitmap_pinned_) {
+            sm_manager_->get_bpm()->unpin_page(bitmap_page_.page->get_page_id(), false);
+            bitmap_pinned_ = false;
+        }
+    }
+
+    // 对接下来 BITMAP_SCAN_PREFETCH_PAGES 个不同的堆页面发起预读
+    void prefetch_bitmap_pages() {
+        std::vector<PageId> page_ids;
+        while (bitmap_prefetched_ < bitmap_rids_.size() &&
+               page_ids.size() < static_cast<size_t>(BITMAP_SCAN_PREFETCH_PAGES)) {
+            page_id_t page_no = bitmap_rids_[bitmap_prefetched_].page_no;
+            page_ids.push_back({fh_->GetFd(), page_no});
+            while (bitmap_prefetched_ < bitmap_rids_.size() && bitmap_rids_[bitmap_prefetched_].page_no == page_no) {
+                ++bitmap_prefetched_;
+            }
+        }
+        sm_manager_->get_bpm()->prefetch_pages(page_ids);
+    }
+
+    // 从头开始按 rid 顺序回表
+    void begin_bitmap() {
+        is_end_ = false;
+        release_bitmap_page();
+        bitmap_pos_ = 0;
+        bitmap_prefetched_ = 0;
+        next_bitmap_tuple();
+    }
+
+    // 从 bitmap_pos_ 开始找下一个满足剩余条件的元组，没有了就结束扫描
+    void next_bitmap_tuple() {
+        if (rm_record_ == nullptr) {
+            rm_record_ = std::make_unique<RmRecord>(len_);
+        }
+        while (bitmap_pos_ < bitmap_rids_.size()) {
+            if (bitmap_pos_ == bitmap_prefetched_) {
+                prefetch_bitmap_pages();
+            }
+            rid_ = bitmap_rids_[bitmap_pos_++];
+            if (!bitmap_pinned_ || bitmap_page_.page->get_page_id().page_no != rid_.page_no) {
+                release_bitmap_page();
+                bitmap_page_ = fh_->fetch_page_handle(rid_.page_no);
+                bitmap_pinned_ = true;
+            }
+            // 和 read_record 一样，索引指向的记录不存在时报错
+            if (!Bitmap::is_set(bitmap_page_.bitmap, rid_.slot_no)) {
+                throw RecordNotFoundError(rid_.page_no, rid_.slot_no);
+            }
+            memcpy(rm_record_->data, bitmap_page_.get_slot(rid_.slot_no), len_);
+            if (pred_.eval(rm_record_->data)) {
+                return;
+            }
+        }
+        release_bitmap_page();
+        is_end_ = true;
+    }
+
+    // 读取扫描当前位置的元组
+    void load_current() {
+        rid_ = scan_->rid();
+        if (index_only_) {
+            scan_->get_key(key_buf_.data());
+            load_key(key_buf_.data());
+        } else {
+            load_record();
+        }
     }
 
     // for index scan
     void write_sorted_results() {
         // 以期望格式写入 sorted_results.txt
         auto out_expected_file = std::fstream("sorted_results.txt", std::ios::out | std::ios::app);
-        outfile_.open(filename_, std::ios::out);
+        sorted_file_ = spill_->create_file("indexscan");
+        SpillWriter sorted_out(spill_.get(), sorted_file_);
 
         // 打印右表头
         out_expected_file << "|";
@@ -95,7 +228,7 @@ private:
             // 打印记录
             rm_record_ = fh_->get_record(scan_->rid(), context_);
             // 写入文件中
-            outfile_.write(rm_record_->data, rm_record_->size);
+            sorted_out.append(rm_record_->data, len_);
 
             std::vector<std::string> columns;
             columns.reserve(tab_.cols.size());
@@ -122,19 +255,34 @@ private:
             out_expected_file << "\n";
         }
 
-        outfile_.close();
+        sorted_out.finish();
         out_expected_file.close();
     }
 
+    // 从溢出文件中读下一条记录，读完时结束
+    void read_sorted() {
+        if (sorted_in_->peek() == nullptr) {
+            is_end_ = true;
+            rm_record_ = nullptr;
+            sorted_in_ = nullptr;
+            return;
+        }
+        rm_record_ = std::make_unique<RmRecord>(len_);
+        sorted_in_->read(rm_record_->data);
+    }
+
 public:
     IndexScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
                       std::vector<std::string> index_col_names,
-                      Context *context, bool gap_mode = false, bool asc = true) : sm_manager_(sm_manager),
+                      Context *context, bool gap_mode = false, bool asc = true, int limit = -1,
+                      bool index_only = false, bool bitmap = false,
+                      std::vector<std::vector<std::string> > and_index_col_names = {})
+        : sm_manager_(sm_manager),
         tab_name_(std::move(tab_name)),
         conds_(std::move(conds)),
         index_col_names_(std::move(index_col_names)),
-        gap_mode_(gap_mode), asc_(asc),
-        tab_(sm_manager_->db_.get_table(tab_name_)), index_meta_(tab_.get_index_meta(index_col_names_)) {
+        tab_(sm_manager_->db_.get_table(tab_name_)), index_meta_(tab_.get_index_meta(index_col_names_)),
+        gap_mode_(gap_mode), asc_(asc), limit_(limit) {
         context_ = context;
         // index_no_ = index_no;
         // index_meta_ = tab_.get_index_meta(index_col_names_);
@@ -152,9 +300,11 @@ public:
         //         cond.op = swap_op.at(cond.op);
         //     }
         // }
-        id_ = generateID();
-        filename_ = "sorted_results_index_" + std::to_string(id_) + ".txt";
+        spill_ = context != nullptr ? context->spill_ : nullptr;
         mergesort_ = !conds_[0].is_rhs_val && conds_.size() == 1;
+        // 归并连接的扫描结果要按整行写到 sorted_results.txt，总是回表
+        index_only_ = index_only && !mergesort_;
+        key_buf_.resize(index_meta_.col_tot_len);
 
         // where w_id=:w_id and c_w_id=w_id and c_d_id=:d_id and c_id=:c_id;
         // 全表走索引 加 merge
@@ -163,6 +313,22 @@ public:
             // 擦掉第一个
             conds_.erase(conds_.begin());
         }
+        // 归并、连接列上的扫描和 limit、逆序扫描都依赖索引顺序；覆盖索引不回表，用不到位图
+        bitmap_ = bitmap && !index_only_ && !mergesort_ && !scan_index_ && asc_ && limit_ < 0;
+        if (bitmap_) {
+            // 每个索引只用它自己列上的常量条件确定范围，条件仍然由本算子的谓词完整检查一遍
+            for (auto &and_cols: and_index_col_names) {
+                std::vector<Condition> and_conds;
+                for (auto &cond: conds_) {
+                    if (cond.is_rhs_val && !cond.is_sub_query && cond.op != OP_NE && cond.op != OP_IN &&
+                        std::find(and_cols.begin(), and_cols.end(), cond.lhs_col.col_name) != and_cols.end()) {
+                        and_conds.push_back(cond);
+                    }
+                }
+                and_scans_.push_back(std::make_unique<IndexScanExecutor>(sm_manager_, tab_name_, std::move(and_conds),
+                                                                         std::move(and_cols), context, gap_mode));
+            }
+        }
 
         // 有点耗时
         const auto index_name = tab_.get_index_name(index_col_names_);
@@ -181,12 +347,7 @@ public:
             ++it;
         }
 
-        cond_cols_.reserve(conds_.size());
-
-        for (auto &cond: conds_) {
-            // 存对应的 col_meta 迭代器
-            cond_cols_.emplace_back(tab_.cols_map[cond.lhs_col.col_name]);
-        }
+        pred_ = CompiledPredicate(conds_, tab_.cols);
 
         // S 锁
         // if (context_ != nullptr) {
@@ -200,127 +361,16 @@ public:
         }
     }
 
-    void beginTuple() override {
-        // 已经解决空树问题
-        // if (is_empty_btree_) {
-        //     is_end_ = true;
-        //     return;
-        // }
-        if (already_begin_ && (!mergesort_ || scan_index_)) {
-            is_end_ = false;
-            scan_ = std::make_unique<IxScan>(ih_, lower_, upper_, sm_manager_->get_bpm());
-            while (!scan_->is_end()) {
-                // 不回表
-                // 全是等号或最后一个谓词是比较，不需要再扫索引
-                if (index_clean_ || predicate_manager_.cmpIndexConds(scan_->get_key())) {
-                    // 回表，查不在索引里的谓词
-                    rid_ = scan_->rid();
-                    rm_record_ = fh_->get_record(rid_, context_);
-                    if (conds_.empty() || cmp_conds(rm_record_.get(), conds_)) {
-                        return;
-                    }
-                }
-                scan_->next();
-            }
-            is_end_ = true;
-            return;
-        }
-
-        // 全表扫索引
-        if (scan_index_) {
-            scan_ = std::make_unique<IxScan>(ih_, lower_, upper_, sm_manager_->get_bpm());
-            already_begin_ = true;
-
-            // where a > 1, c < 1
-            while (!scan_->is_end()) {
-                // 不回表
-                // 全是等号或最后一个谓词是比较，不需要再扫索引
-                if (index_clean_ || predicate_manager_.cmpIndexConds(scan_->get_key())) {
-                    // 回表，查不在索引里的谓词
-                    rid_ = scan_->rid();
-                    rm_record_ = fh_->get_record(rid_, context_);
-                    if (conds_.empty() || cmp_conds(rm_record_.get(), conds_)) {
-                        return;
-                    }
-                }
-                scan_->next();
-            }
-            is_end_ = true;
-            return;
-        }
-
-        // 如果 '列 op 列'，走 sortmerge
-        // TODO 行多外部排序慢，但是为了通过归并连接测试
-        if (mergesort_) {
-            // 适用嵌套连接走索引的情况
-            // struct stat st;
-            // 当前算子排序过了，已经存在排序结果文件
-            if (already_begin_) {
-                // 可能是算子结束进来的，也有可能是到一部分重新开始了
-                if (!is_end_) {
-                    outfile_.close();
-                }
-
-                // 记得一定要重置，否则读到文件尾后算子会一直保持结束状态
-                is_end_ = false;
-
-                outfile_.open(filename_, std::ios::in);
-                if (!outfile_.is_open()) {
-                    std::stringstream s;
-                    s << "Failed to open file: " << std::strerror(errno);
-                    throw InternalError(s.str());
-                }
-
-                // 缓存记录
-                do {
-                    rm_record_ = std::make_unique<RmRecord>(len_);
-                    outfile_.read(rm_record_->data, rm_record_->size);
-                    if (outfile_.gcount() == 0) {
-                        break;
-                    }
-                    records_.emplace_back(std::move(rm_record_));
-                } while (records_.size() < MAX_RECORD_SIZE);
-
-                if (!records_.empty()) {
-                    rm_record_ = std::move(records_.front());
-                    records_.pop_front();
-                } else {
-                    is_end_ = true;
-                    rm_record_ = nullptr;
-                    outfile_.close();
-                }
-                return;
-            }
-
-            is_end_ = false;
-            scan_ = std::make_unique<IxScan>(ih_, lower_, upper_, sm_manager_->get_bpm());
-            write_sorted_results();
-
-            already_begin_ = true;
-
-            outfile_.open(filename_, std::ios::in);
-
-            // 缓存记录
-            do {
-                rm_record_ = std::make_unique<RmRecord>(len_);
-                outfile_.read(rm_record_->data, rm_record_->size);
-                if (outfile_.gcount() == 0) {
-                    break;
-                }
-                records_.emplace_back(std::move(rm_record_));
-            } while (records_.size() < MAX_RECORD_SIZE);
-
-            if (!records_.empty()) {
-                rm_record_ = std::move(records_.front());
-                records_.pop_front();
-            } else {
-                is_end_ = true;
-                rm_record_ = nullptr;
-                outfile_.close();
-            }
-            return;
+    ~IndexScanExecutor() override {
+        release_bitmap_page();
+        sorted_in_ = nullptr;
+        if (!sorted_file_.empty()) {
+            spill_->remove_file(sorted_file_);
         }
+    }
 
+    // 根据索引条件确定扫描范围 [lower_, upper_)，从下界开始扫描
+    void open_range() {
         char *left_key = new char[index_meta_.col_tot_len];
         char *right_key = new char[index_meta_.col_tot_len];
 
@@ -416,9 +466,11 @@ public:
 
             // 找出上界 )
             switch (last_right_op) {
-                // 在前面查下界时已经确定
+                // 前面有等号时在查下界时已经确定，不能覆盖成叶子末尾
                 case OP_INVALID: {
-                    upper_ = ih_->leaf_end();
+                    if (last_idx == 0) {
+                        upper_ = ih_->leaf_end();
+                    }
                     break;
                 }
                 // 全部都是等值查询
@@ -493,15 +545,101 @@ public:
 
         scan_ = std::make_unique<IxScan>(ih_, lower_, upper_, sm_manager_->get_bpm());
         already_begin_ = true;
+    }
+
+    void beginTuple() override {
+        emitted_ = 0;
+        if (limit_ == 0) {
+            is_end_ = true;
+            return;
+        }
+        // 已经解决空树问题
+        // if (is_empty_btree_) {
+        //     is_end_ = true;
+        //     return;
+        // }
+        if (already_begin_ && (!mergesort_ || scan_index_)) {
+            if (bitmap_) {
+                begin_bitmap();
+                return;
+            }
+            is_end_ = false;
+            scan_ = std::make_unique<IxScan>(ih_, lower_, upper_, sm_manager_->get_bpm());
+            while (!scan_->is_end()) {
+                // 不回表
+                // 全是等号或最后一个谓词是比较，不需要再扫索引
+                if (index_clean_ || predicate_manager_.cmpIndexConds(scan_->get_key())) {
+                    // 回表，查不在索引里的谓词
+                    load_current();
+                    if (pred_.eval(rm_record_->data)) {
+                        return;
+                    }
+                }
+                scan_->next();
+            }
+            is_end_ = true;
+            return;
+        }
+
+        // 全表扫索引
+        if (scan_index_) {
+            scan_ = std::make_unique<IxScan>(ih_, lower_, upper_, sm_manager_->get_bpm());
+            already_begin_ = true;
+
+            // where a > 1, c < 1
+            while (!scan_->is_end()) {
+                // 不回表
+                // 全是等号或最后一个谓词是比较，不需要再扫索引
+                if (index_clean_ || predicate_manager_.cmpIndexConds(scan_->get_key())) {
+                    // 回表，查不在索引里的谓词
+                    load_current();
+                    if (pred_.eval(rm_record_->data)) {
+                        return;
+                    }
+                }
+                scan_->next();
+            }
+            is_end_ = true;
+            return;
+        }
+
+        // 如果 '列 op 列'，走 sortmerge
+        // TODO 行多外部排序慢，但是为了通过归并连接测试
+        if (mergesort_) {
+            // 适用嵌套连接走索引的情况，排过序以后重新开始只需从头读溢出文件
+            is_end_ = false;
+            if (!already_begin_) {
+                scan_ = std::make_unique<IxScan>(ih_, lower_, upper_, sm_manager_->get_bpm());
+                write_sorted_results();
+                already_begin_ = true;
+            }
+            sorted_in_ = std::make_unique<SpillReader>(spill_.get(), sorted_file_, len_);
+            read_sorted();
+            return;
+        }
+
+        open_range();
 
         // max 找最后一个记录的情况
         if (!scan_->is_end() && !asc_) {
-            rid_ = scan_->prev_rid(upper_);
-            rm_record_ = fh_->get_record(rid_, context_);
+            Iid last = scan_->prev_iid(upper_);
+            rid_ = ih_->get_rid(last);
+            if (index_only_) {
+                load_key(ih_->get_key(last).data);
+            } else {
+                load_record();
+            }
             // std::cout << "fast max" << std::endl;
             return;
         }
 
+        if (bitmap_) {
+            collect_bitmap();
+            intersect_bitmap();
+            begin_bitmap();
+            return;
+        }
+
         // where a > 1, c < 1
         while (!scan_->is_end()) {
             // 不回表
@@ -509,9 +647,8 @@ public:
             // TODO 这里尽量把比较次数减少，如果选出来的记录都落在索引上了，就可以跳过
             if (index_clean_ || predicate_manager_.cmpIndexConds(scan_->get_key())) {
                 // 回表，查不在索引里的谓词
-                rid_ = scan_->rid();
-                rm_record_ = fh_->get_record(rid_, context_);
-                if (conds_.empty() || cmp_conds(rm_record_.get(), conds_)) {
+                load_current();
+                if (pred_.eval(rm_record_->data)) {
                     return;
                 }
             }
@@ -526,31 +663,17 @@ public:
         if (!asc_) {
             return;
         }
-        if (!records_.empty()) {
-            rm_record_ = std::move(records_.front());
-            records_.pop_front();
+        if (limit_ >= 0 && ++emitted_ >= limit_) {
+            is_end_ = true;
             return;
         }
         // sortmerge
         if (mergesort_) {
-            // 缓存记录
-            do {
-                rm_record_ = std::make_unique<RmRecord>(len_);
-                outfile_.read(rm_record_->data, rm_record_->size);
-                if (outfile_.gcount() == 0) {
-                    break;
-                }
-                records_.emplace_back(std::move(rm_record_));
-            } while (records_.size() < MAX_RECORD_SIZE);
-
-            if (!records_.empty()) {
-                rm_record_ = std::move(records_.front());
-                records_.pop_front();
-            } else {
-                is_end_ = true;
-                rm_record_ = nullptr;
-                outfile_.close();
-            }
+            read_sorted();
+            return;
+        }
+        if (bitmap_) {
+            next_bitmap_tuple();
             return;
         }
         if (scan_->is_end()) {
@@ -563,9 +686,8 @@ public:
             // TODO 待优化
             if (index_clean_ || predicate_manager_.cmpIndexConds(scan_->get_key())) {
                 // 回表，查不在索引里的谓词
-                rid_ = scan_->rid();
-                rm_record_ = fh_->get_record(rid_, context_);
-                if (conds_.empty() || cmp_conds(rm_record_.get(), conds_)) {
+                load_current();
+                if (pred_.eval(rm_record_->data)) {
                     return;
                 }
             }
@@ -577,6 +699,34 @@ public:
         return std::move(rm_record_);
     }
 
+    // 批量执行时不会调用 Next，回表的缓冲区一直复用，每个元组只拷贝到 batch 中一次
+    bool NextBatch(TupleBatch &batch) override {
+        batch.reset(len_);
+        // 逆序扫描只用来取最后一条记录（max），nextTuple 不会前进，只输出一个元组
+        if (!asc_) {
+            if (!is_end_) {
+                batch.push_back(rm_record_->data, rid_);
+                is_end_ = true;
+            }
+            return !batch.empty();
+        }
+        for (; !is_end_ && !batch.full(); nextTuple()) {
+            batch.push_back(rm_record_->data, rid_);
+        }
+        return !batch.empty();
+    }
+
+    // 只收集扫描范围内满足索引条件的 rid，按物理位置排序，不回表。用于和另一个索引的扫描结果求交集
+    std::vector<Rid> collect_rids() {
+        if (already_begin_) {
+            scan_ = std::make_unique<IxScan>(ih_, lower_, upper_, sm_manager_->get_bpm());
+        } else {
+            open_range();
+        }
+        collect_bitmap();
+        return std::move(bitmap_rids_);
+    }
+
     Rid &rid() override { return rid_; }
 
     bool is_end() const { return is_end_; }
@@ -624,128 +774,6 @@ public:
         }
     }
 
-    // 判断是否满足单个谓词条件
-    bool cmp_cond(int i, const RmRecord *rec, const Condition &cond) {
-        const auto &lhs_col_meta = cond_cols_[i];
-        const char *lhs_data = rec->data + lhs_col_meta->offset;
-        char *rhs_data;
-        ColType rhs_type;
-        // 全局record 防止作为临时变量离开作用域自动析构，char* 指针指向错误的地址
-        std::unique_ptr<RmRecord> record;
-        // 提取左值与右值的数据和类型
-        // 常值
-        if (cond.is_rhs_val) {
-            rhs_type = cond.rhs_val.type;
-            rhs_data = cond.rhs_val.raw->data;
-        } else if (cond.is_sub_query) {
-            // 查的是值列表
-            if (!cond.rhs_value_list.empty()) {
-                // in 谓词
-                if (cond.op == OP_IN) {
-                    // 前面已经强制转换和检查类型匹配过了，这里不需要
-                    for (auto &value: cond.rhs_value_list) {
-                        rhs_data = value.raw->data;
-                        if (compare(lhs_data, rhs_data, lhs_col_meta->len, value.type) == 0) {
-                            return true;
-                        }
-                    }
-                    return false;
-                }
-                // 比较谓词
-                assert(cond.rhs_value_list.size() == 1);
-                auto &value = cond.rhs_value_list[0];
-                int cmp = compare(lhs_data, value.raw->data, lhs_col_meta->len, value.type);
-                switch (cond.op) {
-                    case OP_EQ: return cmp == 0;
-                    case OP_NE: return cmp != 0;
-                    case OP_LT: return cmp < 0;
-                    case OP_GT: return cmp > 0;
-                    case OP_LE: return cmp <= 0;
-                    case OP_GE: return cmp >= 0;
-                    default:
-                        throw InternalError("Unexpected op type！");
-                }
-            }
-            // 查的是子算子，在算子生成阶段已经检查了合法性
-            cond.prev->beginTuple();
-
-            // where id <= (select count(*) from grade);
-            // where id <= (select id from grade where id = 1); // 返回单列单行
-            ColMeta rhs_col_meta;
-            if (cond.sub_query->agg_types[0] == AGG_COUNT && cond.sub_query->cols[0].tab_name.empty() && cond.sub_query
-                ->cols[0].col_name.empty()) {
-                rhs_type = TYPE_INT;
-            } else {
-                // ！子查询右边的列值类型应该由子算子决定
-                rhs_col_meta = cond.prev->cols()[0];
-                // where id > (select count(id) from grade);
-                if (cond.sub_query->agg_types[0] == AGG_COUNT) {
-                    rhs_type = TYPE_INT;
-                } else {
-                    rhs_type = rhs_col_meta.type;
-                }
-            }
-
-            // 处理 in 谓词，扫描算子直到找到一个完全相等的
-            if (cond.op == OP_IN) {
-                for (; !cond.prev->is_end(); cond.prev->nextTuple()) {
-                    record = cond.prev->Next();
-                    rhs_data = record->data;
-                    if (lhs_col_meta->type == TYPE_FLOAT && rhs_type == TYPE_INT) {
-                        rhs_type = TYPE_FLOAT;
-                        const float a = *reinterpret_cast<const int *>(rhs_data);
-                        memcpy(rhs_data, &a, sizeof(float));
-                    }
-                    if (compare(lhs_data, rhs_data, lhs_col_meta->len, rhs_type) == 0) {
-                        return true;
-                    }
-                }
-                return false;
-            }
-
-            // 聚合或列值只能有一行
-            record = cond.prev->Next();
-            rhs_data = record->data;
-            if (lhs_col_meta->type == TYPE_FLOAT && rhs_type == TYPE_INT) {
-                rhs_type = TYPE_FLOAT;
-                const float a = *reinterpret_cast<const int *>(rhs_data);
-                memcpy(rhs_data, &a, sizeof(float));
-            }
-        } else {
-            // 列值
-            assert(0);
-            // 没有 id1 = id2 的情况
-            // const auto &rhs_col_meta = get_col(rec_cols, cond.rhs_col);
-            // rhs_type = rhs_col_meta->type;
-            // rhs_data = rec->data + rhs_col_meta->offset;
-        }
-
-        if (lhs_col_meta->type != rhs_type) {
-            throw IncompatibleTypeError(coltype2str(lhs_col_meta->type), coltype2str(rhs_type));
-        }
-
-        int cmp = compare(lhs_data, rhs_data, lhs_col_meta->len, rhs_type);
-        switch (cond.op) {
-            case OP_EQ: return cmp == 0;
-            case OP_NE: return cmp != 0;
-            case OP_LT: return cmp < 0;
-            case OP_GT: return cmp > 0;
-            case OP_LE: return cmp <= 0;
-            case OP_GE: return cmp >= 0;
-            default:
-                throw InternalError("Unexpected op type！");
-        }
-    }
-
-    bool cmp_conds(const RmRecord *rec, const std::vector<Condition> &conds) {
-        for (int i = 0; i < conds.size(); ++i) {
-            if (!cmp_cond(i, rec, conds[i])) {
-                return false;
-            }
-        }
-        return true;
-    }
-
     IndexMeta &get_index_meta() {
         return index_meta_;
     }
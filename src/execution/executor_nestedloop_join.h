@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 #include "executor_abstract.h"
 #include "index/ix.h"
 #include "system/sm.h"
+#include "compiled_predicate.h"
 
 class NestedLoopJoinExecutor : public AbstractExecutor {
 private:
@@ -23,10 +24,76 @@ private:
     std::vector<ColMeta> cols_; // join后获得的记录的字段
     std::vector<Condition> fed_conds_; // join条件
     std::unique_ptr<RmRecord> rm_record_;
-    std::unique_ptr<RmRecord> lhs_rec_;
-    bool is_right_empty_;
+    // 左右儿子都按批读取，左边当前元组为 left_batch_ 中第 left_pos_ 个
+    TupleBatch left_batch_;
+    TupleBatch right_batch_;
+    size_t left_pos_{0};
+    size_t right_pos_{0};
+    bool right_done_{false}; // 当前左元组已经和右表比较完（排序模式下可以提前结束）
+    bool is_end_{false};
     bool sort_mode_{false};
-    int last_cmp_;
+    CompiledPredicate pred_; // 编译好的连接条件，左边的列从左元组读，右边的列从右元组读
+
+    void begin() {
+        is_end_ = false;
+        left_->beginBatch();
+        // 左表为空时直接结束
+        if (!left_->NextBatch(left_batch_)) {
+            is_end_ = true;
+            return;
+        }
+        left_pos_ = 0;
+        restart_right();
+        // 右表为空时直接结束
+        if (right_batch_.empty()) {
+            is_end_ = true;
+        }
+    }
+
+    void restart_right() {
+        right_->beginBatch();
+        right_->NextBatch(right_batch_);
+        right_pos_ = 0;
+        right_done_ = false;
+    }
+
+    // 找到下一条连接结果写到 out 中，没有更多结果时返回 false
+    bool produce(char *out) {
+        while (!is_end_) {
+            const char *lhs_rec = left_batch_.get(left_pos_);
+            while (!right_done_) {
+                if (right_pos_ == right_batch_.size()) {
+                    if (!right_->NextBatch(right_batch_)) {
+                        right_done_ = true;
+                        break;
+                    }
+                    right_pos_ = 0;
+                }
+                const char *rhs_rec = right_batch_.get(right_pos_++);
+                size_t failed = pred_.first_failed(lhs_rec, rhs_rec);
+                if (failed == pred_.size()) {
+                    // 拷贝左右元组
+                    memcpy(out, lhs_rec, left_->tupleLen());
+                    memcpy(out + left_->tupleLen(), rhs_rec, right_->tupleLen());
+                    return true;
+                }
+                // 排序模式下左值已经比右值小，右表后面的元组都不会再满足条件
+                if (sort_mode_ && pred_.compare(failed, lhs_rec, rhs_rec) < 0) {
+                    right_done_ = true;
+                }
+            }
+            // 当前左元组和右表比较完了，换下一个左元组并重新扫描右表
+            if (++left_pos_ == left_batch_.size()) {
+                if (!left_->NextBatch(left_batch_)) {
+                    is_end_ = true;
+                    break;
+                }
+                left_pos_ = 0;
+            }
+            restart_right();
+        }
+        return false;
+    }
 
 public:
     NestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right,
@@ -42,146 +109,51 @@ public:
             col.offset += left_->tupleLen();
         }
         cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
-        is_right_empty_ = false;
+        pred_ = CompiledPredicate(fed_conds_, cols_, left_->tupleLen());
     }
 
     void beginTuple() override {
-        left_->beginTuple();
-        // 左表为空时直接返回
-        if (left_->is_end()) {
-            return;
+        begin();
+        rm_record_ = std::make_unique<RmRecord>(len_);
+        if (!produce(rm_record_->data)) {
+            rm_record_ = nullptr;
         }
-        right_->beginTuple();
-        // 右表为空时直接返回
-        if (right_->is_end()) {
-            is_right_empty_ = true;
-            return;
-        }
-
-        do {
-            lhs_rec_ = left_->Next();
-            while (!right_->is_end()) {
-                auto &&rhs_rec = right_->Next();
-                if (fed_conds_.empty() || cmp_conds(lhs_rec_.get(), rhs_rec.get(), fed_conds_, cols_)) {
-                    rm_record_ = std::make_unique<RmRecord>(len_);
-                    // 拷贝左右元组
-                    memcpy(rm_record_->data, lhs_rec_->data, left_->tupleLen());
-                    memcpy(rm_record_->data + left_->tupleLen(), rhs_rec->data, right_->tupleLen());
-                    return;
-                }
-                if (sort_mode_ && last_cmp_ < 0) {
-                    break;
-                }
-                right_->nextTuple();
-            }
-            left_->nextTuple();
-            right_->beginTuple();
-        } while (!left_->is_end());
     }
 
     void nextTuple() override {
-        if (left_->is_end()) {
+        if (is_end_) {
             return;
         }
-        right_->nextTuple();
-
-        do {
-            while (!right_->is_end()) {
-                auto &&rhs_rec = right_->Next();
-                if (cmp_conds(lhs_rec_.get(), rhs_rec.get(), fed_conds_, cols_)) {
-                    rm_record_ = std::make_unique<RmRecord>(len_);
-                    // 拷贝左右元组
-                    memcpy(rm_record_->data, lhs_rec_->data, left_->tupleLen());
-                    memcpy(rm_record_->data + left_->tupleLen(), rhs_rec->data, right_->tupleLen());
-                    return;
-                }
-                if (sort_mode_ && last_cmp_ < 0) {
-                    break;
-                }
-                right_->nextTuple();
-            }
-            left_->nextTuple();
-            if (left_->is_end()) {
-                break;
-            }
-            lhs_rec_ = left_->Next();
-            right_->beginTuple();
-        } while (!left_->is_end());
+        if (rm_record_ == nullptr) {
+            rm_record_ = std::make_unique<RmRecord>(len_);
+        }
+        if (!produce(rm_record_->data)) {
+            rm_record_ = nullptr;
+        }
     }
 
     std::unique_ptr<RmRecord> Next() override {
         return std::move(rm_record_);
     }
 
-    Rid &rid() override { return _abstract_rid; }
-
-    bool is_end() const { return left_->is_end() || is_right_empty_; }
-
-    const std::vector<ColMeta> &cols() const override { return cols_; }
-
-    size_t tupleLen() const override { return len_; }
+    void beginBatch() override { begin(); }
 
-    static inline int compare(const char *a, const char *b, int col_len, ColType col_type) {
-        switch (col_type) {
-            case TYPE_INT: {
-                const int ai = *reinterpret_cast<const int *>(a);
-                const int bi = *reinterpret_cast<const int *>(b);
-                return (ai > bi) - (ai < bi);
-            }
-            case TYPE_FLOAT: {
-                const float af = *reinterpret_cast<const float *>(a);
-                const float bf = *reinterpret_cast<const float *>(b);
-                return (af > bf) - (af < bf);
+    bool NextBatch(TupleBatch &batch) override {
+        batch.reset(len_);
+        while (!batch.full()) {
+            if (!produce(batch.emplace_back())) {
+                batch.pop_back();
+                break;
             }
-            case TYPE_STRING:
-                return memcmp(a, b, col_len);
-            default:
-                throw InternalError("Unexpected data type！");
         }
+        return !batch.empty();
     }
 
-    // 判断是否满足单个谓词条件
-    bool cmp_cond(const RmRecord *lhs_rec, const RmRecord *rhs_rec, const Condition &cond,
-                  const std::vector<ColMeta> &rec_cols) {
-        // 左边必然为列值
-        const auto &lhs_col_meta = get_col(rec_cols, cond.lhs_col);
-        const char *lhs_data = lhs_rec->data + lhs_col_meta->offset;
-        const char *rhs_data;
-        ColType rhs_type;
+    Rid &rid() override { return _abstract_rid; }
 
-        // 提取左值与右值的数据和类型
-        // 常值
-        if (cond.is_rhs_val) {
-            rhs_type = cond.rhs_val.type;
-            rhs_data = cond.rhs_val.raw->data;
-        } else {
-            // 列值
-            const auto &rhs_col_meta = get_col(rec_cols, cond.rhs_col);
-            rhs_type = rhs_col_meta->type;
-            rhs_data = rhs_rec->data + rhs_col_meta->offset - left_->tupleLen(); // 记得减去左边的 tuplelen
-        }
+    bool is_end() const override { return is_end_; }
 
-        if (lhs_col_meta->type != rhs_type) {
-            throw IncompatibleTypeError(coltype2str(lhs_col_meta->type), coltype2str(rhs_type));
-        }
-
-        last_cmp_ = compare(lhs_data, rhs_data, lhs_col_meta->len, lhs_col_meta->type);
-        switch (cond.op) {
-            case OP_EQ: return last_cmp_ == 0;
-            case OP_NE: return last_cmp_ != 0;
-            case OP_LT: return last_cmp_ < 0;
-            case OP_GT: return last_cmp_ > 0;
-            case OP_LE: return last_cmp_ <= 0;
-            case OP_GE: return last_cmp_ >= 0;
-            default:
-                throw InternalError("Unexpected op type！");
-        }
-    }
+    const std::vector<ColMeta> &cols() const override { return cols_; }
 
-    bool cmp_conds(const RmRecord *lhs_rec, const RmRecord *rhs_rec, const std::vector<Condition> &conds,
-                   const std::vector<ColMeta> &rec_cols) {
-        return std::all_of(conds.begin(), conds.end(), [&](const Condition &cond) {
-            return cmp_cond(lhs_rec, rhs_rec, cond, rec_cols);
-        });
-    }
+    size_t tupleLen() const override { return len_; }
 };
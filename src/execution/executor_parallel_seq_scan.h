@@ -0,0 +1,297 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "executor_seq_scan.h"
+
+/**
+ * @description: 启动 num_workers 个线程执行 work(worker)，全部结束后返回，工作线程中的第一个异常在调用线程中重新抛出
+ */
+inline void run_workers(size_t num_workers, const std::function<void(size_t worker)> &work) {
+    std::vector<std::thread> threads;
+    std::mutex latch;
+    std::exception_ptr error;
+    for (size_t i = 0; i < num_workers; ++i) {
+        threads.emplace_back([&, i] {
+            try {
+                work(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(latch);
+                if (error == nullptr) {
+                    error = std::current_exception();
+                }
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    if (error != nullptr) {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * @description: 按页面范围把扫描切成 morsel，由一组工作线程按顺序领取并生成结果，
+ * 消费者按 morsel 的顺序取回结果，因此输出顺序和串行扫描相同。
+ * 工作线程最多领先消费者 window 个 morsel，未被取走的结果不会无限堆积
+ */
+template <typename Result>
+class MorselQueue {
+public:
+    // 生成 [start_page, end_page) 这个 morsel 的结果
+    using Producer = std::function<void(int start_page, int end_page, Result &out)>;
+
+    MorselQueue(int first_page, int end_page, size_t num_workers, Producer produce)
+        : first_page_(first_page), end_page_(end_page), produce_(std::move(produce)) {
+        num_morsels_ = end_page_ > first_page_
+                           ? (end_page_ - first_page_ + PARALLEL_SCAN_MORSEL_PAGES - 1) / PARALLEL_SCAN_MORSEL_PAGES
+                           : 0;
+        num_workers = std::max<size_t>(1, std::min(num_workers, num_morsels_));
+        slots_.resize(num_workers * PARALLEL_SCAN_WINDOW_PER_WORKER);
+        for (size_t i = 0; i < num_workers && num_morsels_ > 0; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+
+    MorselQueue(const MorselQueue &) = delete;
+
+    MorselQueue &operator=(const MorselQueue &) = delete;
+
+    // 提前结束时（比如上层只需要一部分结果或者抛出了异常）通知工作线程退出
+    ~MorselQueue() {
+        {
+            std::lock_guard<std::mutex> lock(latch_);
+            stop_ = true;
+        }
+        space_cv_.notify_all();
+        for (auto &worker: workers_) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @description: 按顺序取出下一个 morsel 的结果，所有 morsel 都取完时返回 false，工作线程中的异常在这里重新抛出
+     */
+    bool pop(Result &out) {
+        std::unique_lock<std::mutex> lock(latch_);
+        if (next_pop_ == num_morsels_) {
+            return false;
+        }
+        auto &slot = slots_[next_pop_ % slots_.size()];
+        ready_cv_.wait(lock, [&] { return slot.ready || error_ != nullptr; });
+        if (error_ != nullptr) {
+            std::rethrow_exception(error_);
+        }
+        out = std::move(slot.result);
+        slot.result = Result();
+        slot.ready = false;
+        ++next_pop_;
+        space_cv_.notify_all();
+        return true;
+    }
+
+private:
+    struct Slot {
+        Result result;
+        bool ready = false;
+    };
+
+    void work() {
+        while (true) {
+            size_t morsel;
+            {
+                std::unique_lock<std::mutex> lock(latch_);
+                // morsel 对应的结果槽位被消费者取走以后才能领取
+                space_cv_.wait(lock, [&] {
+                    return stop_ || error_ != nullptr || next_morsel_ == num_morsels_ ||
+                           next_morsel_ < next_pop_ + slots_.size();
+                });
+                if (stop_ || error_ != nullptr || next_morsel_ == num_morsels_) {
+                    return;
+                }
+                morsel = next_morsel_++;
+            }
+            int start = first_page_ + static_cast<int>(morsel) * PARALLEL_SCAN_MORSEL_PAGES;
+            Result result;
+            try {
+                produce_(start, std::min(end_page_, start + PARALLEL_SCAN_MORSEL_PAGES), result);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(latch_);
+                if (error_ == nullptr) {
+                    error_ = std::current_exception();
+                }
+                ready_cv_.notify_all();
+                space_cv_.notify_all();
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(latch_);
+                auto &slot = slots_[morsel % slots_.size()];
+                slot.result = std::move(result);
+                slot.ready = true;
+            }
+            ready_cv_.notify_all();
+        }
+    }
+
+    int first_page_;
+    int end_page_;
+    size_t num_morsels_;
+    Producer produce_;
+    std::vector<Slot> slots_; // 环形的结果槽位，morsel i 的结果放在 i % slots_.size()
+    std::vector<std::thread> workers_;
+    std::mutex latch_;
+    std::condition_variable ready_cv_; // 有结果生成或者出错时通知消费者
+    std::condition_variable space_cv_; // 有槽位空出来或者需要退出时通知工作线程
+    size_t next_morsel_ = 0; // 下一个要领取的 morsel
+    size_t next_pop_ = 0; // 下一个要取走的 morsel
+    bool stop_ = false;
+    std::exception_ptr error_;
+};
+
+/**
+ * @description: 并行顺序扫描，按页面把表切成 morsel 交给工作线程，谓词在工作线程中判断。
+ * NextBatch 是 exchange 算子，按 morsel 顺序把工作线程的结果交给上层，输出和 SeqScanExecutor 完全相同；
+ * 逐行接口和锁沿用 SeqScanExecutor，只有批量接口是并行的。
+ * 上层算子可以用 launch 或 for_each_morsel 在工作线程中直接消费元组，比如 AggregateExecutor 的并行聚合
+ */
+class ParallelSeqScanExecutor : public SeqScanExecutor {
+public:
+    // 依次返回一个 morsel 中满足条件的元组，morsel 扫描完返回 false
+    using BatchSource = std::function<bool(TupleBatch &batch)>;
+
+private:
+    // 一个 morsel 中满足条件的全部元组
+    using MorselRows = std::vector<TupleBatch>;
+
+    size_t num_workers_;
+    std::unique_ptr<MorselQueue<MorselRows>> queue_;
+    MorselRows rows_; // 当前正在输出的 morsel
+    size_t batch_pos_ = 0;
+    size_t row_pos_ = 0;
+
+    void scan_morsel(int start_page, int end_page, const std::function<void(const BatchSource &)> &consume) const {
+        RmScan scan(fh_, start_page, end_page);
+        SlotBuffer buf;
+        consume([&](TupleBatch &batch) {
+            batch.reset(len_);
+            fill_batch(scan, batch, buf);
+            return !batch.empty();
+        });
+    }
+
+public:
+    ParallelSeqScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
+                            Context *context)
+        : SeqScanExecutor(sm_manager, std::move(tab_name), std::move(conds), context) {
+        num_workers_ = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), PARALLEL_SCAN_MAX_WORKERS);
+    }
+
+    // 表的页面足够多时才值得并行扫描
+    static bool worth_parallel(RmFileHandle *fh) {
+        return fh->get_file_hdr().num_pages - RM_FIRST_RECORD_PAGE >= PARALLEL_SCAN_MIN_PAGES &&
+               std::thread::hardware_concurrency() > 1;
+    }
+
+    size_t num_workers() const { return num_workers_; }
+
+    /**
+     * @description: 工作线程不断领取 morsel 并调用 consume 处理，不保证顺序，所有 morsel 处理完以后返回。
+     * 用于每个工作线程把结果累积在自己的状态里的算子，worker 是工作线程的编号，morsel 是按页面顺序的编号
+     */
+    void for_each_morsel(
+        const std::function<void(size_t worker, size_t morsel, const BatchSource &next)> &consume) const {
+        int end_page = is_sub_query_empty_ ? RM_FIRST_RECORD_PAGE : fh_->get_file_hdr().num_pages;
+        size_t num_morsels = end_page > RM_FIRST_RECORD_PAGE
+                                 ? (end_page - RM_FIRST_RECORD_PAGE + PARALLEL_SCAN_MORSEL_PAGES - 1) /
+                                   PARALLEL_SCAN_MORSEL_PAGES
+                                 : 0;
+        std::atomic<size_t> next_morsel{0};
+        std::atomic<bool> failed{false};
+        run_workers(std::min(num_workers_, std::max<size_t>(1, num_morsels)), [&](size_t worker) {
+            try {
+                for (size_t morsel; !failed && (morsel = next_morsel++) < num_morsels;) {
+                    int start_page = RM_FIRST_RECORD_PAGE + static_cast<int>(morsel) * PARALLEL_SCAN_MORSEL_PAGES;
+                    scan_morsel(start_page, std::min(end_page, start_page + PARALLEL_SCAN_MORSEL_PAGES),
+                                [&](const BatchSource &next) { consume(worker, morsel, next); });
+                }
+            } catch (...) {
+                // 出错以后其他线程不再领取新的 morsel
+                failed = true;
+                throw;
+            }
+        });
+    }
+
+    /**
+     * @description: 启动工作线程，每个 morsel 调用一次 produce 生成一个结果，返回的队列按 morsel 顺序取回结果
+     * @param {function} produce 在工作线程中调用，参数为 morsel 的元组来源和这个 morsel 的结果
+     */
+    template <typename Result>
+    std::unique_ptr<MorselQueue<Result>> launch(std::function<void(const BatchSource &, Result &)> produce) const {
+        int end_page = is_sub_query_empty_ ? RM_FIRST_RECORD_PAGE : fh_->get_file_hdr().num_pages;
+        return std::make_unique<MorselQueue<Result>>(
+            RM_FIRST_RECORD_PAGE, end_page, num_workers_,
+            [this, produce = std::move(produce)](int start_page, int end_page, Result &out) {
+                scan_morsel(start_page, end_page, [&](const BatchSource &next) { produce(next, out); });
+            });
+    }
+
+    void beginBatch() override {
+        queue_ = nullptr;
+        rows_.clear();
+        batch_pos_ = row_pos_ = 0;
+        queue_ = launch<MorselRows>([](const BatchSource &next, MorselRows &out) {
+            for (out.emplace_back(); next(out.back()); out.emplace_back()) {
+            }
+            out.pop_back();
+        });
+    }
+
+    bool NextBatch(TupleBatch &batch) override {
+        batch.reset(len_);
+        while (!batch.full()) {
+            if (batch_pos_ == rows_.size()) {
+                if (queue_ == nullptr || !queue_->pop(rows_)) {
+                    queue_ = nullptr;
+                    break;
+                }
+                batch_pos_ = row_pos_ = 0;
+                continue;
+            }
+            auto &rows = rows_[batch_pos_];
+            // 整批交给上层，省掉一次拷贝
+            if (batch.empty() && row_pos_ == 0 && rows.capacity() == batch.capacity()) {
+                std::swap(batch, rows);
+                ++batch_pos_;
+                return true;
+            }
+            for (; row_pos_ < rows.size() && !batch.full(); ++row_pos_) {
+                batch.push_back(rows.get(row_pos_), rows.rid(row_pos_));
+            }
+            if (row_pos_ == rows.size()) {
+                ++batch_pos_;
+                row_pos_ = 0;
+            }
+        }
+        return !batch.empty();
+    }
+
+    std::string getType() { return "ParallelSeqScanExecutor"; }
+};
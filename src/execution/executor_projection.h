@@ -22,13 +22,45 @@ private:
     size_t len_; // 字段总长度
     std::vector<size_t> proj_idxs_; // 每个投影的字段在原先表所有字段的索引
     const std::vector<ColMeta> &prev_cols_;
+    TupleBatch prev_batch_; // 批量执行时儿子节点输出的一批元组
     bool is_agg_{false};
-    int limit_;
+    int limit_; // 最多输出的条数，-1 表示不限制
+    int offset_; // 开头跳过的条数
+    int remaining_; // 还能输出的条数
+    int skip_; // 还需要跳过的条数
+
+    // 按投影列拷贝一条儿子节点的元组
+    void project(const char *prev_record, char *proj_record) const {
+        for (std::size_t i = 0; i < proj_idxs_.size(); ++i) {
+            auto &prev_col = prev_cols_[proj_idxs_[i]];
+            memcpy(proj_record + proj_cols_[i].offset, prev_record + prev_col.offset, prev_col.len);
+        }
+    }
+
+    // 从儿子节点取一批元组投影到 batch 中，儿子节点没有元组时返回 false
+    bool fill(TupleBatch &batch) {
+        if (is_agg_) {
+            return prev_->NextBatch(batch);
+        }
+        batch.reset(len_);
+        // 投影一对一输出，儿子的一批不能比输出的一批大
+        if (prev_batch_.capacity() != batch.capacity()) {
+            prev_batch_ = TupleBatch(batch.capacity());
+        }
+        if (!prev_->NextBatch(prev_batch_)) {
+            return false;
+        }
+        for (size_t t = 0; t < prev_batch_.size(); ++t) {
+            project(prev_batch_.get(t), batch.emplace_back(prev_batch_.rid(t)));
+        }
+        return true;
+    }
 
 public:
     ProjectionExecutor(std::unique_ptr<AbstractExecutor> prev,
-                       const std::vector<TabCol> &proj_cols, int limit = -1): prev_(std::move(prev)),
-                                                                              prev_cols_(prev_->cols()), limit_(limit) {
+                       const std::vector<TabCol> &proj_cols, int limit = -1, int offset = 0)
+        : prev_(std::move(prev)), prev_cols_(prev_->cols()), limit_(limit), offset_(offset), remaining_(limit),
+          skip_(offset) {
         if (prev_->getType() == "AggregateExecutor") {
             is_agg_ = true;
             int offset = 0;
@@ -37,6 +69,7 @@ public:
                 proj_cols_.back().offset = offset;
                 offset += col_meta.len;
             }
+            len_ = offset;
             // 这里是引用不能拷贝，聚合调用 begin 后会自动调整 offset
             // proj_cols_ = prev_cols_;
         } else {
@@ -55,18 +88,27 @@ public:
         }
     }
 
-    void beginTuple() override { prev_->beginTuple(); }
+    void beginTuple() override {
+        remaining_ = limit_;
+        skip_ = offset_;
+        if (remaining_ == 0) {
+            return;
+        }
+        for (prev_->beginTuple(); skip_ > 0 && !prev_->is_end(); --skip_) {
+            prev_->nextTuple();
+        }
+    }
 
     void nextTuple() override {
         // limit 有效时，如果还需要输出记录的条数已经为 0 了，没必要再调用
-        if (limit_ == 0) {
+        if (remaining_ == 0) {
             return;
         }
         prev_->nextTuple();
     }
 
     std::unique_ptr<RmRecord> Next() override {
-        --limit_;
+        --remaining_;
         if (is_agg_) {
             return std::move(prev_->Next());
         }
@@ -74,21 +116,39 @@ public:
         auto &&prev_record = prev_->Next();
         // 要投影的记录
         auto &&proj_record = std::make_unique<RmRecord>(len_);
-        for (std::size_t i = 0; i < proj_idxs_.size(); ++i) {
-            // 需要投影的字段
-            auto &prev_col = prev_cols_[proj_idxs_[i]];
-            // 被投影到的字段
-            auto &proj_col = proj_cols_[i];
-            // 拷贝投影的字段数据
-            memcpy(proj_record->data + proj_col.offset, prev_record->data + prev_col.offset, prev_col.len);
-        }
+        project(prev_record->data, proj_record->data);
         return std::move(proj_record);
     }
 
+    void beginBatch() override {
+        remaining_ = limit_;
+        skip_ = offset_;
+        if (remaining_ != 0) {
+            prev_->beginBatch();
+        }
+    }
+
+    bool NextBatch(TupleBatch &batch) override {
+        batch.reset(len_);
+        // 输出够 limit 条以后直接结束，不再调用儿子节点
+        while (remaining_ != 0 && batch.empty() && fill(batch)) {
+            // offset 跳过最前面的元组
+            size_t skip = std::min(static_cast<size_t>(skip_), batch.size());
+            batch.drop_front(skip);
+            skip_ -= static_cast<int>(skip);
+        }
+        // limit 有效时只输出剩下的条数
+        if (remaining_ > 0) {
+            batch.truncate(remaining_);
+            remaining_ -= static_cast<int>(batch.size());
+        }
+        return !batch.empty();
+    }
+
     Rid &rid() override { return _abstract_rid; }
 
     bool is_end() const {
-        return limit_ == 0 || prev_->is_end();
+        return remaining_ == 0 || prev_->is_end();
     }
 
     // 需要实现
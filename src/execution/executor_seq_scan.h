@@ -16,15 +16,16 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "system/sm.h"
 #include "predicate_manager.h"
+#include "compiled_predicate.h"
 
 class SeqScanExecutor : public AbstractExecutor {
-private:
+protected:
     SmManager *sm_manager_;
     std::string tab_name_; // 表的名称
     std::vector<Condition> conds_; // scan的条件
     RmFileHandle *fh_; // 表的数据文件句柄
     // std::vector<ColMeta> cols_; // scan后生成的记录的字段
-    std::vector<std::vector<ColMeta>::iterator> cond_cols_; // 谓词需要读取的字段
+    CompiledPredicate pred_; // 编译好的扫描条件
     size_t len_; // scan后生成的每条记录的长度
     // std::vector<Condition> fed_conds_; // 同conds_，两个字段相同
     Rid rid_;
@@ -36,6 +37,42 @@ private:
     bool gap_mode_;
     TabMeta &tab_;
 
+    // 批量扫描时一个页面中候选记录的槽位地址、槽号和满足条件的下标
+    struct SlotBuffer {
+        std::vector<const char *> slots;
+        std::vector<int> slot_nos;
+        std::vector<uint32_t> sel;
+    };
+
+    SlotBuffer slot_buf_;
+
+    // 从 scan 的当前位置开始，每次取一个页面中的一段记录，在槽位上按列判断谓词，
+    // 只把满足条件的记录拷贝到 batch 中，直到 batch 满或者扫描结束
+    void fill_batch(RmScan &scan, TupleBatch &batch, SlotBuffer &buf) const {
+        if (buf.slots.size() < batch.capacity()) {
+            buf.slots.resize(batch.capacity());
+            buf.slot_nos.resize(batch.capacity());
+            buf.sel.resize(batch.capacity());
+        }
+        while (!scan.is_end() && !batch.full()) {
+            size_t n = scan.collect_page(batch.capacity() - batch.size(), buf.slots.data(), buf.slot_nos.data());
+            Rid rid{scan.rid().page_no, -1};
+            size_t cnt = pred_.filter(buf.slots.data(), n, buf.sel.data());
+            for (size_t i = 0; i < cnt; ++i) {
+                rid.slot_no = buf.slot_nos[buf.sel[i]];
+                batch.push_back(buf.slots[buf.sel[i]], rid);
+            }
+            scan.next();
+        }
+    }
+
+    // 谓词直接在 RmScan pin 住的页面上判断，只拷贝满足条件的记录，页面离开扫描后槽位就不能再访问
+    void load_record() {
+        rid_ = scan_->rid();
+        rm_record_ = std::make_unique<RmRecord>(static_cast<int>(len_));
+        memcpy(rm_record_->data, scan_->get_slot(), len_);
+    }
+
 public:
     SeqScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, Context *context,
                     bool gap_mode = false)
@@ -48,10 +85,12 @@ public:
         // fed_conds_ = conds_;
         is_sub_query_empty_ = false;
 
-        cond_cols_.reserve(conds_.size());
+        pred_ = CompiledPredicate(conds_, tab_.cols);
         for (auto &cond: conds_) {
-            // 存迭代器
-            cond_cols_.emplace_back(tab_.cols_map[cond.lhs_col.col_name]);
+            // 子查询结果为空，没有记录能满足条件，不用扫表
+            if (cond.is_sub_query && (cond.op == OP_IN ? cond.rhs_value_set->empty() : cond.rhs_value_list.empty())) {
+                is_sub_query_empty_ = true;
+            }
         }
 
         // S 锁
@@ -72,18 +111,16 @@ public:
     }
 
     void beginTuple() override {
+        rm_record_ = nullptr;
         scan_ = std::make_unique<RmScan>(fh_);
+        if (is_sub_query_empty_) {
+            return;
+        }
         for (; !scan_->is_end(); scan_->next()) {
-            rid_ = scan_->rid();
-            rm_record_ = fh_->get_record(rid_, context_);
-            // TODO 这里会跑太快
-            // rm_record_ = std::move(scan_->get_record());
-            if (cmp_conds(rm_record_.get(), conds_)) {
+            if (pred_.eval(scan_->get_slot())) {
+                load_record();
                 break;
             }
-            if (is_sub_query_empty_) {
-                return;
-            }
         }
     }
 
@@ -91,12 +128,10 @@ public:
         if (scan_->is_end()) {
             return;
         }
+        rm_record_ = nullptr;
         for (scan_->next(); !scan_->is_end(); scan_->next()) {
-            rid_ = scan_->rid();
-            rm_record_ = fh_->get_record(rid_, context_);
-            // TODO 这里会跑太快
-            // rm_record_ = std::move(scan_->get_record());
-            if (cmp_conds(rm_record_.get(), conds_)) {
+            if (pred_.eval(scan_->get_slot())) {
+                load_record();
                 break;
             }
         }
@@ -106,153 +141,24 @@ public:
         return std::move(rm_record_);
     }
 
-    Rid &rid() override { return rid_; }
-
-    bool is_end() const { return is_sub_query_empty_ || scan_->is_end(); }
-
-    const std::vector<ColMeta> &cols() const override { return tab_.cols; }
-
-    size_t tupleLen() const override { return len_; }
+    void beginBatch() override {
+        scan_ = std::make_unique<RmScan>(fh_);
+    }
 
-    static inline int compare(const char *a, const char *b, int col_len, ColType col_type) {
-        switch (col_type) {
-            case TYPE_INT: {
-                const int ai = *reinterpret_cast<const int *>(a);
-                const int bi = *reinterpret_cast<const int *>(b);
-                return (ai > bi) - (ai < bi);
-            }
-            case TYPE_FLOAT: {
-                const float af = *reinterpret_cast<const float *>(a);
-                const float bf = *reinterpret_cast<const float *>(b);
-                return (af > bf) - (af < bf);
-            }
-            case TYPE_STRING:
-                return memcmp(a, b, col_len);
-            default:
-                throw InternalError("Unexpected data type！");
+    bool NextBatch(TupleBatch &batch) override {
+        batch.reset(len_);
+        if (is_sub_query_empty_) {
+            return false;
         }
+        fill_batch(*scan_, batch, slot_buf_);
+        return !batch.empty();
     }
 
-    // 判断是否满足单个谓词条件
-    // 判断是否满足单个谓词条件
-    bool cmp_cond(int i, const RmRecord *rec, const Condition &cond) {
-        const auto &lhs_col_meta = cond_cols_[i];
-        const char *lhs_data = rec->data + lhs_col_meta->offset;
-        char *rhs_data;
-        ColType rhs_type;
-        // 全局record 防止作为临时变量离开作用域自动析构，char* 指针指向错误的地址
-        std::unique_ptr<RmRecord> record;
-        // 提取左值与右值的数据和类型
-        // 常值
-        if (cond.is_rhs_val) {
-            rhs_type = cond.rhs_val.type;
-            rhs_data = cond.rhs_val.raw->data;
-        } else if (cond.is_sub_query) {
-            // 查的是值列表
-            if (!cond.rhs_value_list.empty()) {
-                // in 谓词
-                if (cond.op == OP_IN) {
-                    // 前面已经强制转换和检查类型匹配过了，这里不需要
-                    for (auto &value: cond.rhs_value_list) {
-                        rhs_data = value.raw->data;
-                        if (compare(lhs_data, rhs_data, lhs_col_meta->len, value.type) == 0) {
-                            return true;
-                        }
-                    }
-                    return false;
-                }
-                // 比较谓词
-                assert(cond.rhs_value_list.size() == 1);
-                auto &value = cond.rhs_value_list[0];
-                int cmp = compare(lhs_data, value.raw->data, lhs_col_meta->len, value.type);
-                switch (cond.op) {
-                    case OP_EQ: return cmp == 0;
-                    case OP_NE: return cmp != 0;
-                    case OP_LT: return cmp < 0;
-                    case OP_GT: return cmp > 0;
-                    case OP_LE: return cmp <= 0;
-                    case OP_GE: return cmp >= 0;
-                    default:
-                        throw InternalError("Unexpected op type！");
-                }
-            }
-            // 查的是子算子，在算子生成阶段已经检查了合法性
-            cond.prev->beginTuple();
-
-            // where id <= (select count(*) from grade);
-            // where id <= (select id from grade where id = 1); // 返回单列单行
-            ColMeta rhs_col_meta;
-            if (cond.sub_query->agg_types[0] == AGG_COUNT && cond.sub_query->cols[0].tab_name.empty() && cond.sub_query
-                ->cols[0].col_name.empty()) {
-                rhs_type = TYPE_INT;
-            } else {
-                // ！子查询右边的列值类型应该由子算子决定
-                rhs_col_meta = cond.prev->cols()[0];
-                // where id > (select count(id) from grade);
-                if (cond.sub_query->agg_types[0] == AGG_COUNT) {
-                    rhs_type = TYPE_INT;
-                } else {
-                    rhs_type = rhs_col_meta.type;
-                }
-            }
-
-            // 处理 in 谓词，扫描算子直到找到一个完全相等的
-            if (cond.op == OP_IN) {
-                for (; !cond.prev->is_end(); cond.prev->nextTuple()) {
-                    record = cond.prev->Next();
-                    rhs_data = record->data;
-                    if (lhs_col_meta->type == TYPE_FLOAT && rhs_type == TYPE_INT) {
-                        rhs_type = TYPE_FLOAT;
-                        const float a = *reinterpret_cast<const int *>(rhs_data);
-                        memcpy(rhs_data, &a, sizeof(float));
-                    }
-                    if (compare(lhs_data, rhs_data, lhs_col_meta->len, rhs_type) == 0) {
-                        return true;
-                    }
-                }
-                return false;
-            }
-
-            // 聚合或列值只能有一行
-            record = cond.prev->Next();
-            rhs_data = record->data;
-            if (lhs_col_meta->type == TYPE_FLOAT && rhs_type == TYPE_INT) {
-                rhs_type = TYPE_FLOAT;
-                const float a = *reinterpret_cast<const int *>(rhs_data);
-                memcpy(rhs_data, &a, sizeof(float));
-            }
-        } else {
-            // 列值
-            assert(0);
-            // 没有 id1 = id2 的情况
-            // const auto &rhs_col_meta = get_col(rec_cols, cond.rhs_col);
-            // rhs_type = rhs_col_meta->type;
-            // rhs_data = rec->data + rhs_col_meta->offset;
-        }
+    Rid &rid() override { return rid_; }
 
-        if (lhs_col_meta->type != rhs_type) {
-            throw IncompatibleTypeError(coltype2str(lhs_col_meta->type), coltype2str(rhs_type));
-        }
+    bool is_end() const { return is_sub_query_empty_ || scan_->is_end(); }
 
-        int cmp = compare(lhs_data, rhs_data, lhs_col_meta->len, rhs_type);
-        switch (cond.op) {
-            case OP_EQ: return cmp == 0;
-            case OP_NE: return cmp != 0;
-            case OP_LT: return cmp < 0;
-            case OP_GT: return cmp > 0;
-            case OP_LE: return cmp <= 0;
-            case OP_GE: return cmp >= 0;
-            default:
-                throw InternalError("Unexpected op type！");
-        }
-    }
+    const std::vector<ColMeta> &cols() const override { return tab_.cols; }
 
-    bool cmp_conds(const RmRecord *rec, const std::vector<Condition> &conds) {
-        for (int i = 0; i < conds.size(); ++i) {
-            if (!cmp_cond(i, rec, conds[i])) {
-                return false;
-            }
-        }
-        return true;
-    }
+    size_t tupleLen() const override { return len_; }
 };
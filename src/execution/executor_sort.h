@@ -1,349 +1,458 @@
-#pragma once
-
-#include <queue>
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
 
-// #define SORT_EXTERNAL
-#define MAX_CHUNK_SIZE 5
+#pragma once
 
-class SortExecutor : public AbstractExecutor {
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <future>
+
+#include "execution_defs.h"
+#include "executor_abstract.h"
+#include "executor_parallel_seq_scan.h"
+#include "spill_manager.h"
+
+/**
+ * @description: 规范化排序键：把各个排序列依次编码成一个字节串，两个元组的先后顺序就是键的 memcmp 顺序。
+ * int 翻转符号位后按大端存放，float 按 IEEE 754 的位模式调整成无符号序后按大端存放，字符串原样拷贝，降序的列按位取反
+ */
+class SortKeyEncoder {
 private:
-    std::unique_ptr<AbstractExecutor> prev_;
-    ColMeta cols_; // 框架中只支持一个键排序，需要自行修改数据结构支持多个键排序
-    size_t tuple_num;
-    bool is_desc_;
-    std::vector<size_t> used_tuple;
-    std::unique_ptr<RmRecord> current_tuple_;
-    std::deque<std::unique_ptr<RmRecord> > records_;
-    size_t len_; // 字段总长度
-    // 题目要求排序结果写入 sorted_results.txt，字符串
-    std::fstream out_expected_file_;
-    // 排序结果实际读取文件，二进制
-    std::fstream outfile_;
-    // 实际二进制文件名
-    std::string filename_;
-    std::deque<std::string> temp_files_;
-    // 为每个 sort 算子实例分配一个 ID
-    size_t id_;
-    bool is_end_{false};
-
-    static std::size_t generateID() {
-        static size_t current_id = 0;
-        return ++current_id;
+    struct Key {
+        ColType type;
+        int offset;
+        int len;
+        bool is_desc;
+    };
+
+    std::vector<Key> keys_;
+    size_t len_{0};
+
+    static void store_be32(char *out, uint32_t bits) {
+        bits = __builtin_bswap32(bits);
+        memcpy(out, &bits, sizeof(bits));
     }
 
-    // 排序一部分元组并放入块（临时文件）中
-    void sortAndSaveChunk() {
-        std::sort(records_.begin(), records_.end(),
-                  [&](const std::unique_ptr<RmRecord> &l_rec, const std::unique_ptr<RmRecord> &r_rec) {
-                      auto &&lhs = l_rec->data + cols_.offset;
-                      auto &&rhs = r_rec->data + cols_.offset;
-                      return is_desc_
-                                 ? compare(lhs, rhs, cols_.len, cols_.type) > 0
-                                 : compare(lhs, rhs, cols_.len, cols_.type) < 0;
-                  });
-
-        std::string temp_filename = "sorted_chunk_" + std::to_string(temp_files_.size()) + ".tmp";
-        std::ofstream temp_file(temp_filename, std::ios::out | std::ios::binary);
-        for (const auto &record: records_) {
-            temp_file.write(record->data, record->size);
-        }
-        temp_file.close();
-        temp_files_.emplace_back(temp_filename);
-        records_.clear();
+public:
+    void add_key(const ColMeta &col, bool is_desc) {
+        keys_.push_back({col.type, col.offset, col.len, is_desc});
+        len_ += col.len;
     }
 
-    void mergeSortedChunks() {
-        auto compareRecords = [&](std::pair<std::unique_ptr<RmRecord>, std::ifstream *> &a,
-                                  std::pair<std::unique_ptr<RmRecord>, std::ifstream *> &b) {
-            auto &&lhs = a.first->data + cols_.offset;
-            auto &&rhs = b.first->data + cols_.offset;
-            return is_desc_
-                       ? compare(lhs, rhs, cols_.len, cols_.type) < 0
-                       : compare(lhs, rhs, cols_.len, cols_.type) > 0;
-        };
-
-        std::priority_queue<
-            std::pair<std::unique_ptr<RmRecord>, std::ifstream *>,
-            std::vector<std::pair<std::unique_ptr<RmRecord>, std::ifstream *> >,
-            decltype(compareRecords)> min_heap(compareRecords);
-
-        // 必须要支持多级归并排序，因为系统可以使用的文件描述符有限，超过使用限制会发生阻塞
-        // 排序阶段，已经完成了第几级排序
-        std::size_t level = 1;
-        // 每个阶段的临时文件
-        std::deque<std::string> level_temp_files;
-
-        // 一次处理100个排序好的文件，原来2000个，处理完一趟后剩下20个文件，然后再用一次就都处理完了
-        const std::size_t batch_size = 2; // 二路归并
-
-        // 最后归并为一个排好序的文件
-        while (temp_files_.size() > 1) {
-            std::size_t total_files = temp_files_.size();
-            std::size_t processed_files = 0;
-
-            while (processed_files < total_files) {
-                std::vector<std::ifstream> temp_file_streams;
-                temp_file_streams.reserve(batch_size);
-
-                for (size_t i = 0; i < batch_size && processed_files < total_files; ++i, ++processed_files) {
-                    const auto &filename = temp_files_[processed_files];
-                    temp_file_streams.emplace_back(filename, std::ios::in | std::ios::binary);
-                }
+    size_t len() const { return len_; }
 
-                for (auto &file_stream: temp_file_streams) {
-                    auto record = std::make_unique<RmRecord>(len_);
-                    file_stream.read(record->data, record->size);
-                    if (file_stream.gcount() > 0) {
-                        min_heap.emplace(std::move(record), &file_stream);
-                    }
+    void encode(const char *rec, char *out) const {
+        for (auto &key: keys_) {
+            const char *src = rec + key.offset;
+            switch (key.type) {
+                case TYPE_INT: {
+                    uint32_t bits;
+                    memcpy(&bits, src, sizeof(bits));
+                    store_be32(out, bits ^ 0x80000000u);
+                    break;
                 }
-
-                std::string temp_filename = "sorted_ID" + std::to_string(id_) + "_chunk_" + std::to_string(level) + "_"
-                                            + std::to_string(level_temp_files.size()) + ".tmp";
-                std::ofstream temp_file(temp_filename, std::ios::out | std::ios::binary);
-                level_temp_files.emplace_back(std::move(temp_filename));
-
-                // 放到第 level 阶段临时文件中
-                while (!min_heap.empty()) {
-                    auto &[record, file_stream] = min_heap.top();
-                    temp_file.write(record->data, record->size);
-                    auto new_record = std::make_unique<RmRecord>(len_);
-                    file_stream->read(new_record->data, new_record->size);
-                    if (file_stream->gcount() > 0) {
-                        min_heap.emplace(std::move(new_record), file_stream);
-                    } else {
-                        file_stream->close();
+                case TYPE_FLOAT: {
+                    float val;
+                    memcpy(&val, src, sizeof(val));
+                    // -0.0 和 0.0 相等，编码也要相同
+                    if (val == 0.0f) {
+                        val = 0.0f;
                     }
-                    min_heap.pop();
+                    uint32_t bits;
+                    memcpy(&bits, &val, sizeof(bits));
+                    store_be32(out, bits & 0x80000000u ? ~bits : bits | 0x80000000u);
+                    break;
+                }
+                default:
+                    memcpy(out, src, key.len);
+                    break;
+            }
+            if (key.is_desc) {
+                for (int i = 0; i < key.len; ++i) {
+                    out[i] = static_cast<char>(~out[i]);
                 }
-
-                temp_file.close();
             }
+            out += key.len;
+        }
+    }
+};
 
-            // 清除临时文件
-            for (auto &temp_file: temp_files_) {
-                unlink(temp_file.c_str());
+/* 多路归并若干有序段，用二叉堆选出键最小的条目，键相同时编号小的段在前 */
+class SortRunMerger {
+private:
+    size_t key_len_{0};
+    std::vector<std::unique_ptr<SpillReader> > readers_;
+    std::vector<size_t> heap_;
+
+    // 堆顶是键最小的段
+    bool after(size_t lhs, size_t rhs) const {
+        int cmp = memcmp(readers_[lhs]->peek(), readers_[rhs]->peek(), key_len_);
+        return cmp > 0 || (cmp == 0 && lhs > rhs);
+    }
+
+public:
+    void open(SpillContext *spill, const std::vector<std::string> &files, size_t entry_len, size_t key_len) {
+        key_len_ = key_len;
+        readers_.clear();
+        heap_.clear();
+        for (auto &file: files) {
+            readers_.push_back(std::make_unique<SpillReader>(spill, file, entry_len));
+            if (readers_.back()->peek() != nullptr) {
+                heap_.push_back(readers_.size() - 1);
             }
+        }
+        std::make_heap(heap_.begin(), heap_.end(), [this](size_t l, size_t r) { return after(l, r); });
+    }
+
+    // 键最小的条目，全部归并完时返回 nullptr
+    const char *peek() const { return heap_.empty() ? nullptr : readers_[heap_.front()]->peek(); }
 
-            temp_files_ = std::move(level_temp_files);
-            level_temp_files.clear();
-            ++level;
+    void next() {
+        auto cmp = [this](size_t l, size_t r) { return after(l, r); };
+        std::pop_heap(heap_.begin(), heap_.end(), cmp);
+        auto &reader = readers_[heap_.back()];
+        reader->next();
+        if (reader->peek() != nullptr) {
+            std::push_heap(heap_.begin(), heap_.end(), cmp);
+        } else {
+            heap_.pop_back();
         }
+    }
 
-        assert(temp_files_.size() == 1);
+    void close() {
+        readers_.clear();
+        heap_.clear();
+    }
+};
 
-        // 最终排序好的文件名
-        filename_ = std::move(temp_files_[0]);
-        temp_files_.clear();
+/**
+ * @description: 多列排序算子。每个元组在前面拼上规范化排序键组成条目，条目之间只用 memcmp 比较。
+ * 内存从查询的溢出预算中预留，输入放得下时直接在内存中排序（元组多时分段并行排序再归并）；
+ * 放不下时外部排序：预算用完就把攒下的一块交给后台线程排序并写成有序段，读取输入和排序写盘同时进行，
+ * 有序段太多时先分组并行归并，最后一轮归并在输出时进行，不再写盘。
+ * 有 limit 且放得进内存时只保留最前面的 limit_ 个元组（Top-N）
+ */
+class SortExecutor : public AbstractExecutor {
+private:
+    // 内存排序时对条目的引用，prefix 是键的前 8 个字节（按大端转成整数），大多数比较只看它
+    struct SortRef {
+        uint64_t prefix;
+        const char *entry;
+    };
 
-        outfile_.open(filename_, std::ios::in | std::ios::binary);
+    std::unique_ptr<AbstractExecutor> prev_;
+    SortKeyEncoder encoder_;
+    size_t len_; // 元组长度
+    size_t key_len_; // 规范化排序键长度
+    size_t entry_len_; // 条目长度：键 + 元组
+    std::shared_ptr<SpillContext> spill_;
+    MemoryReservation mem_; // rows_ 占用的内存
+    // 大于等于 0 时只输出排在最前面的 limit_ 个元组
+    int limit_{-1};
+    bool sorted_{false};
+    bool external_{false}; // 是否写了有序段文件
+
+    // 内存排序：条目连续存放在 rows_ 中，refs_ 是排好序的引用，pos_ 指向当前条目
+    std::vector<char> rows_;
+    std::vector<SortRef> refs_;
+    size_t pos_{0};
+
+    // 外部排序：有序段文件和最后一轮归并
+    std::vector<std::string> runs_;
+    SortRunMerger merger_;
 
-        // 以期望格式写入 sorted_results.txt
-        out_expected_file_.open("sorted_results.txt", std::ios::out | std::ios::app);
+    std::unique_ptr<RmRecord> current_tuple_;
+    bool is_end_{false};
 
-        // 打印表头
-        out_expected_file_ << "|";
-        for (auto &col_meta: prev_->cols()) {
-            out_expected_file_ << " " << col_meta.name << " |";
+    SortRef make_ref(const char *entry) const {
+        uint64_t prefix = 0;
+        memcpy(&prefix, entry, std::min<size_t>(key_len_, sizeof(prefix)));
+        return {__builtin_bswap64(prefix), entry};
+    }
+
+    bool ref_less(const SortRef &lhs, const SortRef &rhs) const {
+        if (lhs.prefix != rhs.prefix) {
+            return lhs.prefix < rhs.prefix;
         }
-        out_expected_file_ << "\n";
-
-        while (true) {
-            current_tuple_ = std::make_unique<RmRecord>(len_);
-            outfile_.read(current_tuple_->data, current_tuple_->size);
-            if (outfile_.gcount() > 0) {
-                // 打印记录
-                std::vector<std::string> columns;
-                columns.reserve(prev_->cols().size());
-
-                for (auto &col: prev_->cols()) {
-                    std::string col_str;
-                    char *rec_buf = current_tuple_->data + col.offset;
-                    if (col.type == TYPE_INT) {
-                        col_str = std::to_string(*(int *) rec_buf);
-                    } else if (col.type == TYPE_FLOAT) {
-                        col_str = std::to_string(*(float *) rec_buf);
-                    } else if (col.type == TYPE_STRING) {
-                        col_str = std::string((char *) rec_buf, col.len);
-                        col_str.resize(strlen(col_str.c_str()));
-                    }
-                    columns.emplace_back(col_str);
-                }
+        return key_len_ > sizeof(uint64_t) &&
+               memcmp(lhs.entry + sizeof(uint64_t), rhs.entry + sizeof(uint64_t), key_len_ - sizeof(uint64_t)) < 0;
+    }
 
-                // 打印记录
-                out_expected_file_ << "|";
-                for (auto &col: columns) {
-                    out_expected_file_ << " " << col << " |";
-                }
-                out_expected_file_ << "\n";
-            } else {
-                break;
-            }
+    std::vector<SortRef> make_refs(const std::vector<char> &rows) const {
+        std::vector<SortRef> refs;
+        refs.reserve(rows.size() / entry_len_);
+        for (size_t off = 0; off < rows.size(); off += entry_len_) {
+            refs.push_back(make_ref(rows.data() + off));
         }
+        return refs;
+    }
 
-        outfile_.close();
-        out_expected_file_.close();
+    // 元组多时切成几段并行排序，再两两并行归并
+    void sort_refs(std::vector<SortRef> &refs, size_t max_workers) const {
+        auto cmp = [this](const SortRef &l, const SortRef &r) { return ref_less(l, r); };
+        size_t pieces = refs.size() < SORT_PARALLEL_MIN_ROWS
+                            ? 1
+                            : std::min<size_t>(max_workers, std::max(1u, std::thread::hardware_concurrency()));
+        if (pieces <= 1) {
+            std::sort(refs.begin(), refs.end(), cmp);
+            return;
+        }
+        std::vector<size_t> bounds(pieces + 1);
+        for (size_t i = 0; i <= pieces; ++i) {
+            bounds[i] = refs.size() * i / pieces;
+        }
+        run_workers(pieces, [&](size_t i) { std::sort(refs.begin() + bounds[i], refs.begin() + bounds[i + 1], cmp); });
+        for (size_t width = 1; width < pieces; width *= 2) {
+            size_t pairs = (pieces + 2 * width - 1) / (2 * width);
+            run_workers(pairs, [&](size_t i) {
+                size_t lo = 2 * width * i, mid = std::min(lo + width, pieces), hi = std::min(lo + 2 * width, pieces);
+                std::inplace_merge(refs.begin() + bounds[lo], refs.begin() + bounds[mid], refs.begin() + bounds[hi], cmp);
+            });
+        }
     }
 
-public:
-    SortExecutor(std::unique_ptr<AbstractExecutor> prev, const TabCol &sel_cols, bool is_desc) {
-        prev_ = std::move(prev);
-        // cols_ = prev_->get_col_offset(sel_cols);
-        cols_ = *get_col(prev_->cols(), sel_cols);
-        is_desc_ = is_desc;
-        tuple_num = 0;
-        used_tuple.clear();
-        len_ = prev_->tupleLen();
-        id_ = generateID();
-        // filename_ = "sorted_results" + std::to_string(id_) + ".txt";
+    // 在后台线程中排序一块条目并写成有序段
+    void write_run(const std::vector<char> &rows, const std::string &file_name) const {
+        auto refs = make_refs(rows);
+        std::sort(refs.begin(), refs.end(), [this](const SortRef &l, const SortRef &r) { return ref_less(l, r); });
+        SpillWriter out(spill_.get(), file_name);
+        for (auto &ref: refs) {
+            out.append(ref.entry, entry_len_);
+        }
+        out.finish();
     }
 
-    void beginTuple() override {
-        records_.clear();
-        temp_files_.clear();
-        current_tuple_ = nullptr;
+    // 把一组有序段归并成一个
+    void merge_runs(const std::vector<std::string> &files, const std::string &file_name) const {
+        SortRunMerger merger;
+        merger.open(spill_.get(), files, entry_len_, key_len_);
+        SpillWriter out(spill_.get(), file_name);
+        for (const char *entry; (entry = merger.peek()) != nullptr; merger.next()) {
+            out.append(entry, entry_len_);
+        }
+        out.finish();
+    }
 
-#ifdef SORT_EXTERNAL
-        // struct stat st;
-        // 当前算子排序过了，已经存在排序结果文件
-        if (!filename_.empty()) {
-            // 可能是算子结束进来的，也有可能是到一部分重新开始了
-            if (!is_end_) {
-                outfile_.close();
+    // 有序段比 SORT_MERGE_FAN_IN 多时分组并行归并，直到一轮就能归并完
+    void reduce_runs() {
+        while (runs_.size() > SORT_MERGE_FAN_IN) {
+            size_t groups = (runs_.size() + SORT_MERGE_FAN_IN - 1) / SORT_MERGE_FAN_IN;
+            std::vector<std::string> merged(groups);
+            for (auto &file: merged) {
+                file = spill_->create_file("sort");
             }
+            std::atomic<size_t> next_group{0};
+            run_workers(std::min(groups, SORT_WORKERS), [&](size_t) {
+                for (size_t g; (g = next_group++) < groups;) {
+                    auto first = runs_.begin() + g * SORT_MERGE_FAN_IN;
+                    auto last = runs_.begin() + std::min(runs_.size(), (g + 1) * SORT_MERGE_FAN_IN);
+                    merge_runs(std::vector<std::string>(first, last), merged[g]);
+                }
+            });
+            remove_runs();
+            runs_ = std::move(merged);
+        }
+    }
 
-            // 记得一定要重置，否则读到文件尾后算子会一直保持结束状态
-            is_end_ = false;
+    void remove_runs() {
+        for (auto &file: runs_) {
+            spill_->remove_file(file);
+        }
+        runs_.clear();
+    }
 
-            outfile_.open(filename_, std::ios::in | std::ios::binary);
-            if (!outfile_.is_open()) {
-                std::stringstream s;
-                s << "Failed to open file: " << std::strerror(errno);
-                throw InternalError(s.str());
-            }
+    void append_entry(const char *rec) {
+        size_t off = rows_.size();
+        rows_.resize(off + entry_len_);
+        encoder_.encode(rec, rows_.data() + off);
+        memcpy(rows_.data() + off + key_len_, rec, len_);
+    }
 
-            // 缓存记录
-            do {
-                current_tuple_ = std::make_unique<RmRecord>(len_);
-                outfile_.read(current_tuple_->data, current_tuple_->size);
-                if (outfile_.gcount() == 0) {
-                    break;
-                }
-                records_.emplace_back(std::move(current_tuple_));
-            } while (records_.size() < MAX_CHUNK_SIZE);
+    // rows_ 和它的内存预留交给后台线程排序写盘
+    void spill_run(std::deque<std::future<void> > &pending) {
+        if (pending.size() >= SORT_WORKERS) {
+            pending.front().get();
+            pending.pop_front();
+        }
+        runs_.push_back(spill_->create_file("sort"));
+        pending.push_back(std::async(std::launch::async,
+                                     [this, rows = std::move(rows_), mem = std::move(mem_), file_name = runs_.back()] {
+                                         write_run(rows, file_name);
+                                     }));
+        rows_ = std::vector<char>();
+        mem_ = MemoryReservation(spill_);
+    }
 
-            if (!records_.empty()) {
-                current_tuple_ = std::move(records_.front());
-                records_.pop_front();
-            } else {
-                is_end_ = true;
-                current_tuple_ = nullptr;
-                outfile_.close();
-            }
+    // rows_ 放不下下一个条目时扩大内存预留，超出预算时先把攒下的条目写成有序段，
+    // 预算被后台的有序段占着时等它们写完，都释放以后仍然不够也至少留出一个条目的空间
+    void ensure_space(std::deque<std::future<void> > &pending) {
+        if (rows_.size() + entry_len_ <= mem_.size()) {
             return;
         }
+        size_t want = mem_.size() + std::max(SPILL_RESERVE_CHUNK, entry_len_);
+        if (mem_.try_resize(want)) {
+            return;
+        }
+        if (!rows_.empty()) {
+            spill_run(pending);
+            want = std::max(SPILL_RESERVE_CHUNK, entry_len_);
+        }
+        while (!mem_.try_resize(want) && !pending.empty()) {
+            pending.front().get();
+            pending.pop_front();
+        }
+        if (mem_.size() < want) {
+            mem_.resize(want);
+        }
+    }
 
-        is_end_ = false;
+    // 读入全部输入并排序，超过内存预算时生成有序段
+    void sort_input() {
+        std::deque<std::future<void> > pending; // 正在后台排序写盘的有序段
+        rows_.clear();
+        refs_.clear();
+        remove_runs();
+        TupleBatch batch;
+        for (prev_->beginBatch(); prev_->NextBatch(batch);) {
+            for (size_t i = 0; i < batch.size(); ++i) {
+                ensure_space(pending);
+                append_entry(batch.get(i));
+            }
+        }
+        external_ = !runs_.empty();
+        if (!external_) {
+            refs_ = make_refs(rows_);
+            sort_refs(refs_, SORT_WORKERS);
+            return;
+        }
+        if (!rows_.empty()) {
+            runs_.push_back(spill_->create_file("sort"));
+            write_run(rows_, runs_.back());
+        }
+        rows_ = std::vector<char>();
+        mem_.resize(0);
+        for (auto &run: pending) {
+            run.get();
+        }
+        reduce_runs();
+    }
 
-        // ios::in 需要文件存在，ios::out文件不存在则创建
-        // 两者同时存在且文件不存在时，会打开失败（文件不存在）
-        // outfile_.open(filename_, std::ios::out | std::ios::app);
-        // if (!outfile_.is_open()) {
-        //     std::stringstream s;
-        //     s << "Failed to open file: " << std::strerror(errno);
-        //     throw InternalError(s.str());
-        // }
-
-        // 内存中可能放不下，实现外部排序
-        for (prev_->beginTuple(); !prev_->is_end(); prev_->nextTuple()) {
-            records_.emplace_back(prev_->Next());
-            if (records_.size() >= MAX_CHUNK_SIZE) {
-                sortAndSaveChunk();
+    // Top-N：refs_ 是以排在最后的条目为堆顶的堆，新元组比堆顶靠前时替换掉堆顶，rows_ 最多 limit_ 个条目
+    void top_n() {
+        auto n = static_cast<size_t>(limit_);
+        auto cmp = [this](const SortRef &l, const SortRef &r) { return ref_less(l, r); };
+        std::vector<char> entry(entry_len_);
+        rows_.assign(n * entry_len_, 0);
+        refs_.clear();
+        external_ = false;
+        TupleBatch batch;
+        for (prev_->beginBatch(); prev_->NextBatch(batch);) {
+            for (size_t i = 0; i < batch.size() && n > 0; ++i) {
+                const char *rec = batch.get(i);
+                encoder_.encode(rec, entry.data());
+                memcpy(entry.data() + key_len_, rec, len_);
+                if (refs_.size() < n) {
+                    char *slot = rows_.data() + refs_.size() * entry_len_;
+                    memcpy(slot, entry.data(), entry_len_);
+                    refs_.push_back(make_ref(slot));
+                    std::push_heap(refs_.begin(), refs_.end(), cmp);
+                } else if (ref_less(make_ref(entry.data()), refs_.front())) {
+                    std::pop_heap(refs_.begin(), refs_.end(), cmp);
+                    char *slot = const_cast<char *>(refs_.back().entry);
+                    memcpy(slot, entry.data(), entry_len_);
+                    refs_.back() = make_ref(slot);
+                    std::push_heap(refs_.begin(), refs_.end(), cmp);
+                }
             }
         }
+        std::sort_heap(refs_.begin(), refs_.end(), cmp);
+    }
 
-        // 剩下未满最大值的记录们也写入磁盘
-        if (!records_.empty()) {
-            sortAndSaveChunk();
+    const char *current_entry() const {
+        if (external_) {
+            return merger_.peek();
         }
+        return pos_ < refs_.size() ? refs_[pos_].entry : nullptr;
+    }
 
-        // 空表
-        if (temp_files_.empty()) {
+    void advance() {
+        if (external_) {
+            merger_.next();
+        } else {
+            ++pos_;
+        }
+    }
+
+    // 把当前条目中的元组放到 current_tuple_ 中
+    void load_current() {
+        const char *entry = current_entry();
+        if (entry == nullptr) {
             is_end_ = true;
+            current_tuple_ = nullptr;
             return;
         }
+        is_end_ = false;
+        current_tuple_ = std::make_unique<RmRecord>(len_);
+        memcpy(current_tuple_->data, entry + key_len_, len_);
+    }
 
-        // 合并所有块
-        mergeSortedChunks();
+public:
+    SortExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<OrderCol> &order_cols,
+                 std::shared_ptr<SpillContext> spill, int limit = -1)
+        : spill_(std::move(spill)), mem_(spill_) {
+        prev_ = std::move(prev);
+        limit_ = limit;
+        for (auto &order: order_cols) {
+            encoder_.add_key(*get_col(prev_->cols(), order.col), order.is_desc);
+        }
+        len_ = prev_->tupleLen();
+        key_len_ = encoder_.len();
+        entry_len_ = key_len_ + len_;
+    }
 
-        // 读模式
-        outfile_.open(filename_, std::ios::in | std::ios::binary);
+    ~SortExecutor() override {
+        merger_.close();
+        remove_runs();
+    }
 
-        // 缓存记录
-        do {
-            current_tuple_ = std::make_unique<RmRecord>(len_);
-            outfile_.read(current_tuple_->data, current_tuple_->size);
-            if (outfile_.gcount() == 0) {
-                break;
+    // 排过一次后重新开始只需回到开头，外部排序重新打开最后一轮归并
+    void beginTuple() override {
+        if (!sorted_) {
+            if (limit_ >= 0 && mem_.try_resize(static_cast<size_t>(limit_) * entry_len_)) {
+                top_n();
+            } else {
+                sort_input();
             }
-            records_.emplace_back(std::move(current_tuple_));
-        } while (records_.size() < MAX_CHUNK_SIZE);
-
-        if (!records_.empty()) {
-            current_tuple_ = std::move(records_.front());
-            records_.pop_front();
-        } else {
-            is_end_ = true;
-            current_tuple_ = nullptr;
-            outfile_.close();
+            sorted_ = true;
         }
-#else
-        // 假设索引扫出来的记录数量比较少，直接在内存中排序
-        for (prev_->beginTuple(); !prev_->is_end(); prev_->nextTuple()) {
-            records_.emplace_back(prev_->Next());
+        pos_ = 0;
+        if (external_) {
+            merger_.open(spill_.get(), runs_, entry_len_, key_len_);
         }
-        if (records_.empty()) {
-            is_end_ = true;
-        } else {
-            std::sort(records_.begin(), records_.end(),
-                      [&](const std::unique_ptr<RmRecord> &l_rec, const std::unique_ptr<RmRecord> &r_rec) {
-                          auto &&lhs = l_rec->data + cols_.offset;
-                          auto &&rhs = r_rec->data + cols_.offset;
-                          return is_desc_
-                                     ? compare(lhs, rhs, cols_.len, cols_.type) > 0
-                                     : compare(lhs, rhs, cols_.len, cols_.type) < 0;
-                      });
-        }
-#endif
+        load_current();
     }
 
     void nextTuple() override {
-        if (!records_.empty()) {
-            current_tuple_ = std::move(records_.front());
-            records_.pop_front();
-            return;
-        }
-#ifdef SORT_EXTERNAL
-        do {
-            current_tuple_ = std::make_unique<RmRecord>(len_);
-            outfile_.read(current_tuple_->data, current_tuple_->size);
-            if (outfile_.gcount() == 0) {
-                break;
-            }
-            records_.emplace_back(std::move(current_tuple_));
-        } while (records_.size() < MAX_CHUNK_SIZE);
+        advance();
+        load_current();
+    }
 
-        if (!records_.empty()) {
-            current_tuple_ = std::move(records_.front());
-            records_.pop_front();
-        } else {
-            is_end_ = true;
-            current_tuple_ = nullptr;
-            outfile_.close();
+    bool NextBatch(TupleBatch &batch) override {
+        batch.reset(len_);
+        for (const char *entry; !batch.full() && (entry = current_entry()) != nullptr; advance()) {
+            batch.push_back(entry + key_len_);
         }
-#else
-        is_end_ = true;
-#endif
+        is_end_ = current_entry() == nullptr;
+        current_tuple_ = nullptr;
+        return !batch.empty();
     }
 
     std::unique_ptr<RmRecord> Next() override {
@@ -352,7 +461,7 @@ public:
 
     Rid &rid() override { return _abstract_rid; }
 
-    bool is_end() const { return is_end_; }
+    bool is_end() const override { return is_end_; }
 
     const std::vector<ColMeta> &cols() const override { return prev_->cols(); }
 
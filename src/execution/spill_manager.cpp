@@ -0,0 +1,221 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "execution/spill_manager.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include "errors.h"
+
+// 溢出文件所在子目录的前缀，后面是进程号
+static const std::string SPILL_PROC_DIR_PREFIX = "rmdb_";
+
+// 删除目录下的所有文件和目录本身，溢出目录中只有普通文件
+static void remove_dir(const std::string &dir) {
+    if (DIR *d = opendir(dir.c_str())) {
+        while (dirent *entry = readdir(d)) {
+            if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+                unlink((dir + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(d);
+    }
+    rmdir(dir.c_str());
+}
+
+static char *alloc_io_buffer(size_t size) {
+    void *buf = nullptr;
+    if (posix_memalign(&buf, PAGE_SIZE, size) != 0) {
+        throw std::bad_alloc();
+    }
+    return static_cast<char *>(buf);
+}
+
+/* ----------------------------------------------------------------- SpillContext */
+
+SpillContext::~SpillContext() {
+    for (auto &path: files_) {
+        unlink(path.c_str());
+    }
+}
+
+std::string SpillContext::create_file(const std::string &tag) {
+    std::string path = manager_->dir_ + "/q" + std::to_string(query_id_) + "_" + std::to_string(file_seq_++) + "_" +
+                       tag + ".tmp";
+    std::lock_guard<std::mutex> lock(latch_);
+    files_.insert(path);
+    ++manager_->files_created_;
+    return path;
+}
+
+void SpillContext::remove_file(const std::string &path) {
+    unlink(path.c_str());
+    std::lock_guard<std::mutex> lock(latch_);
+    files_.erase(path);
+}
+
+bool SpillContext::try_reserve(size_t bytes) {
+    size_t cur = reserved_.load();
+    do {
+        if (cur + bytes > budget_) {
+            return false;
+        }
+    } while (!reserved_.compare_exchange_weak(cur, cur + bytes));
+    return true;
+}
+
+void SpillContext::add_written(size_t bytes) {
+    bytes_written_ += bytes;
+    manager_->bytes_written_ += bytes;
+}
+
+void SpillContext::add_read(size_t bytes) { manager_->bytes_read_ += bytes; }
+
+/* ----------------------------------------------------------------- SpillManager */
+
+SpillManager::~SpillManager() {
+    if (!dir_.empty()) {
+        remove_dir(dir_);
+    }
+}
+
+void SpillManager::open(const std::string &dir) {
+    // 关闭数据库时会切换工作目录，统一使用绝对路径
+    std::string tmp_dir = dir;
+    if (tmp_dir.empty() || tmp_dir[0] != '/') {
+        char cwd[PATH_MAX];
+        if (getcwd(cwd, sizeof(cwd)) == nullptr) {
+            throw UnixError();
+        }
+        tmp_dir = std::string(cwd) + "/" + tmp_dir;
+    }
+    if (mkdir(tmp_dir.c_str(), S_IRWXU) != 0 && errno != EEXIST) {
+        throw UnixError();
+    }
+    // 进程号不存在（崩溃退出）或者被本进程复用的子目录都是遗留的
+    if (DIR *d = opendir(tmp_dir.c_str())) {
+        while (dirent *entry = readdir(d)) {
+            std::string name = entry->d_name;
+            if (name.compare(0, SPILL_PROC_DIR_PREFIX.size(), SPILL_PROC_DIR_PREFIX) != 0) {
+                continue;
+            }
+            pid_t pid = static_cast<pid_t>(atol(name.c_str() + SPILL_PROC_DIR_PREFIX.size()));
+            if (pid == getpid() || (kill(pid, 0) != 0 && errno == ESRCH)) {
+                remove_dir(tmp_dir + "/" + name);
+            }
+        }
+        closedir(d);
+    }
+    dir_ = tmp_dir + "/" + SPILL_PROC_DIR_PREFIX + std::to_string(getpid());
+    if (mkdir(dir_.c_str(), S_IRWXU) != 0) {
+        throw UnixError();
+    }
+}
+
+/* ----------------------------------------------------------------- SpillWriter */
+
+SpillWriter::SpillWriter(SpillContext *spill, const std::string &path) : spill_(spill) {
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd_ < 0) {
+        throw UnixError();
+    }
+    buf_.reset(alloc_io_buffer(SPILL_IO_BUFFER_SIZE));
+}
+
+SpillWriter::~SpillWriter() { ::close(fd_); }
+
+void SpillWriter::append(const char *data, size_t len) {
+    while (len > 0) {
+        size_t n = std::min(len, SPILL_IO_BUFFER_SIZE - used_);
+        memcpy(buf_.get() + used_, data, n);
+        used_ += n;
+        data += n;
+        len -= n;
+        if (used_ == SPILL_IO_BUFFER_SIZE) {
+            flush();
+        }
+    }
+}
+
+void SpillWriter::flush() {
+    for (size_t done = 0; done < used_;) {
+        ssize_t n = ::write(fd_, buf_.get() + done, used_ - done);
+        if (n < 0) {
+            throw UnixError();
+        }
+        done += n;
+    }
+    size_t start = offset_;
+    offset_ += used_;
+    spill_->add_written(used_);
+    used_ = 0;
+    // 写后落盘：开始回写刚写出的一块，等 SPILL_WRITE_BEHIND_BYTES 之前的一块写完后把它从页缓存中丢掉
+    sync_file_range(fd_, start, offset_ - start, SYNC_FILE_RANGE_WRITE);
+    if (start >= SPILL_WRITE_BEHIND_BYTES) {
+        off_t old = static_cast<off_t>(start - SPILL_WRITE_BEHIND_BYTES);
+        sync_file_range(fd_, old, offset_ - start,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        posix_fadvise(fd_, old, offset_ - start, POSIX_FADV_DONTNEED);
+    }
+}
+
+/* ----------------------------------------------------------------- SpillReader */
+
+SpillReader::SpillReader(SpillContext *spill, const std::string &path, size_t record_len)
+    : spill_(spill), record_len_(record_len) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw UnixError();
+    }
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    capacity_ = std::max<size_t>(1, SPILL_IO_BUFFER_SIZE / record_len_) * record_len_;
+    buf_.reset(alloc_io_buffer(capacity_));
+    refill();
+}
+
+SpillReader::~SpillReader() { ::close(fd_); }
+
+void SpillReader::refill() {
+    // 缓冲区中的数据已经用完，对应的页缓存不再需要
+    if (offset_ > 0) {
+        posix_fadvise(fd_, 0, static_cast<off_t>(offset_), POSIX_FADV_DONTNEED);
+    }
+    pos_ = end_ = 0;
+    while (end_ < capacity_) {
+        ssize_t n = ::read(fd_, buf_.get() + end_, capacity_ - end_);
+        if (n < 0) {
+            throw UnixError();
+        }
+        if (n == 0) {
+            break;
+        }
+        end_ += n;
+    }
+    offset_ += end_;
+    spill_->add_read(end_);
+}
+
+bool SpillReader::read(char *out) {
+    const char *record = peek();
+    if (record == nullptr) {
+        return false;
+    }
+    memcpy(out, record, record_len_);
+    next();
+    return true;
+}
@@ -0,0 +1,254 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include "common/config.h"
+
+class SpillManager;
+
+/**
+ * @description: 一个查询的溢出上下文，查询中所有可能溢出的算子共用一份内存预算，
+ * 创建的临时文件都登记在这里，查询结束（包括出错中止）时删除还没删掉的文件
+ */
+class SpillContext {
+private:
+    SpillManager *manager_;
+    size_t query_id_;
+    size_t budget_; // 查询的内存预算（字节）
+    std::atomic<size_t> reserved_{0}; // 已经预留的内存
+    std::atomic<size_t> file_seq_{0};
+    std::atomic<size_t> bytes_written_{0};
+    std::mutex latch_;
+    std::unordered_set<std::string> files_;
+
+public:
+    SpillContext(SpillManager *manager, size_t query_id, size_t budget)
+        : manager_(manager), query_id_(query_id), budget_(budget) {
+    }
+
+    SpillContext(const SpillContext &) = delete;
+
+    SpillContext &operator=(const SpillContext &) = delete;
+
+    ~SpillContext();
+
+    /**
+     * @description: 在临时目录中创建一个新的溢出文件名并登记，文件名在所有查询之间唯一
+     * @param {string} tag 用途，只用于文件名，方便排查
+     */
+    std::string create_file(const std::string &tag);
+
+    // 删除溢出文件并取消登记
+    void remove_file(const std::string &path);
+
+    // 预留 bytes 字节内存，超出查询预算时失败
+    bool try_reserve(size_t bytes);
+
+    // 不检查预算直接预留，用于必须保证进度的情况
+    void reserve(size_t bytes) { reserved_ += bytes; }
+
+    void release(size_t bytes) { reserved_ -= bytes; }
+
+    size_t reserved() const { return reserved_; }
+
+    size_t budget() const { return budget_; }
+
+    // 这个查询写出的字节数
+    size_t bytes_written() const { return bytes_written_; }
+
+    void add_written(size_t bytes);
+
+    void add_read(size_t bytes);
+};
+
+/**
+ * @description: 算子持有的一段内存预算，可以增减，析构时归还给查询
+ */
+class MemoryReservation {
+private:
+    std::shared_ptr<SpillContext> spill_;
+    size_t size_{0};
+
+public:
+    MemoryReservation() = default;
+
+    explicit MemoryReservation(std::shared_ptr<SpillContext> spill) : spill_(std::move(spill)) {
+    }
+
+    MemoryReservation(MemoryReservation &&other) noexcept : spill_(std::move(other.spill_)), size_(other.size_) {
+        other.size_ = 0;
+    }
+
+    MemoryReservation &operator=(MemoryReservation &&other) noexcept {
+        if (this != &other) {
+            resize(0);
+            spill_ = std::move(other.spill_);
+            size_ = other.size_;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    MemoryReservation(const MemoryReservation &) = delete;
+
+    MemoryReservation &operator=(const MemoryReservation &) = delete;
+
+    ~MemoryReservation() { resize(0); }
+
+    size_t size() const { return size_; }
+
+    // 调整到 bytes 字节，增加时超出查询预算则失败，缩小总是成功
+    bool try_resize(size_t bytes) {
+        if (bytes <= size_) {
+            resize(bytes);
+            return true;
+        }
+        // try_reserve 成功时已经计入查询的预留，不能再 resize 一次
+        if (!spill_->try_reserve(bytes - size_)) {
+            return false;
+        }
+        size_ = bytes;
+        return true;
+    }
+
+    // 不检查预算直接调整
+    void resize(size_t bytes) {
+        if (spill_ == nullptr) {
+            return;
+        }
+        if (bytes > size_) {
+            spill_->reserve(bytes - size_);
+        } else {
+            spill_->release(size_ - bytes);
+        }
+        size_ = bytes;
+    }
+};
+
+/**
+ * @description: 溢出文件管理器：所有查询的溢出文件都放在临时目录下本进程的子目录中，
+ * 启动时删除已经退出（包括崩溃）的进程留下的子目录，并统计溢出的文件数和字节数
+ */
+class SpillManager {
+private:
+    std::string dir_; // 本进程的溢出文件目录
+    size_t query_budget_;
+    std::atomic<size_t> next_query_id_{0};
+    std::atomic<size_t> files_created_{0};
+    std::atomic<size_t> bytes_written_{0};
+    std::atomic<size_t> bytes_read_{0};
+
+    friend class SpillContext;
+
+public:
+    explicit SpillManager(size_t query_budget = SPILL_QUERY_MEMORY_BUDGET) : query_budget_(query_budget) {
+    }
+
+    SpillManager(const SpillManager &) = delete;
+
+    SpillManager &operator=(const SpillManager &) = delete;
+
+    ~SpillManager();
+
+    /**
+     * @description: 使用 dir 作为临时目录，没有时创建，并清理已经不存在的进程留下的溢出文件
+     */
+    void open(const std::string &dir);
+
+    // 开始一个新的查询，返回的上下文由查询的各个算子共享
+    std::shared_ptr<SpillContext> begin_query() {
+        return std::make_shared<SpillContext>(this, ++next_query_id_, query_budget_);
+    }
+
+    const std::string &dir() const { return dir_; }
+
+    size_t files_created() const { return files_created_; }
+
+    size_t bytes_written() const { return bytes_written_; }
+
+    size_t bytes_read() const { return bytes_read_; }
+};
+
+/**
+ * @description: 带缓冲地顺序写溢出文件，缓冲区按页对齐，每次写出整块。
+ * 文件超过 SPILL_WRITE_BEHIND_BYTES 后，已经写出的部分落盘后从页缓存中丢掉，大量溢出不会挤掉其他文件的缓存
+ */
+class SpillWriter {
+private:
+    SpillContext *spill_;
+    int fd_;
+    std::unique_ptr<char, decltype(&free)> buf_{nullptr, &free};
+    size_t used_{0};
+    size_t offset_{0}; // 已经写到文件中的字节数
+
+    void flush();
+
+public:
+    SpillWriter(SpillContext *spill, const std::string &path);
+
+    SpillWriter(const SpillWriter &) = delete;
+
+    SpillWriter &operator=(const SpillWriter &) = delete;
+
+    ~SpillWriter();
+
+    void append(const char *data, size_t len);
+
+    // 写出缓冲区中剩下的数据，之后才能读取这个文件
+    void finish() { flush(); }
+};
+
+/**
+ * @description: 带缓冲地顺序读溢出文件中的定长记录，每次读入整数条记录，记录直接在缓冲区中访问。
+ * 读过的部分从页缓存中丢掉
+ */
+class SpillReader {
+private:
+    SpillContext *spill_;
+    int fd_;
+    size_t record_len_;
+    size_t capacity_;
+    std::unique_ptr<char, decltype(&free)> buf_{nullptr, &free};
+    size_t pos_{0};
+    size_t end_{0};
+    size_t offset_{0}; // 已经读入缓冲区的字节数
+
+    void refill();
+
+public:
+    SpillReader(SpillContext *spill, const std::string &path, size_t record_len);
+
+    SpillReader(const SpillReader &) = delete;
+
+    SpillReader &operator=(const SpillReader &) = delete;
+
+    ~SpillReader();
+
+    // 当前记录，读完时返回 nullptr
+    const char *peek() const { return pos_ + record_len_ <= end_ ? buf_.get() + pos_ : nullptr; }
+
+    void next() {
+        pos_ += record_len_;
+        if (pos_ + record_len_ > end_ && end_ == capacity_) {
+            refill();
+        }
+    }
+
+    // 把当前记录拷贝到 out 并前进，读完时返回 false
+    bool read(char *out);
+};
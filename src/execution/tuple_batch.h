@@ -0,0 +1,94 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "common/config.h"
+#include "defs.h"
+
+/* 批量执行时算子之间传递的一批定长元组，元组连续存放在一块缓冲区中，缓冲区在批次之间复用 */
+class TupleBatch {
+private:
+    size_t tuple_len_{0}; // 每个元组的长度
+    size_t capacity_; // 一批最多能放的元组个数
+    size_t size_{0}; // 当前的元组个数
+    std::vector<char> data_;
+    std::vector<Rid> rids_; // 每个元组对应的记录号，只有扫描算子会填
+
+public:
+    explicit TupleBatch(size_t capacity = TUPLE_BATCH_SIZE) : capacity_(capacity) {
+    }
+
+    /**
+     * @description: 清空并开始填充新的一批，缓冲区只会变大不会释放
+     * @param {size_t} tuple_len 这一批中每个元组的长度
+     */
+    void reset(size_t tuple_len) {
+        tuple_len_ = tuple_len;
+        size_ = 0;
+        if (data_.size() < tuple_len_ * capacity_) {
+            data_.resize(tuple_len_ * capacity_);
+        }
+        if (rids_.size() < capacity_) {
+            rids_.resize(capacity_);
+        }
+    }
+
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    bool full() const { return size_ == capacity_; }
+
+    size_t capacity() const { return capacity_; }
+
+    size_t tuple_len() const { return tuple_len_; }
+
+    // 在末尾追加一个元组，返回元组的地址由调用者直接写入
+    char *emplace_back(const Rid &rid = Rid{-1, -1}) {
+        rids_[size_] = rid;
+        return data_.data() + size_++ * tuple_len_;
+    }
+
+    void push_back(const char *tuple, const Rid &rid = Rid{-1, -1}) {
+        memcpy(emplace_back(rid), tuple, tuple_len_);
+    }
+
+    // 撤销最后一次追加，用于写入后才发现不满足谓词的元组
+    void pop_back() { --size_; }
+
+    // 只保留前 n 个元组
+    void truncate(size_t n) {
+        if (n < size_) {
+            size_ = n;
+        }
+    }
+
+    // 丢掉前 n 个元组，后面的元组前移
+    void drop_front(size_t n) {
+        if (n == 0) {
+            return;
+        }
+        n = std::min(n, size_);
+        memmove(data_.data(), data_.data() + n * tuple_len_, (size_ - n) * tuple_len_);
+        std::move(rids_.begin() + n, rids_.begin() + size_, rids_.begin());
+        size_ -= n;
+    }
+
+    char *get(size_t i) { return data_.data() + i * tuple_len_; }
+
+    const char *get(size_t i) const { return data_.data() + i * tuple_len_; }
+
+    const Rid &rid(size_t i) const { return rids_[i]; }
+};
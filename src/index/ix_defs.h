@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include "defs.h"
@@ -22,18 +23,18 @@ constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
+// 结点占用的字节数少于这个值时，删除后尝试和兄弟结点合并
+constexpr int IX_NODE_MERGE_BYTES = PAGE_SIZE / 4;
 
 class IxFileHdr {
 public:
     page_id_t first_free_page_no_; // 文件中第一个空闲的磁盘页面的页面号
-    int num_pages_; // 磁盘文件中页面的数量
-    page_id_t root_page_; // B+树根节点对应的页面号
+    std::atomic<int> num_pages_; // 磁盘文件中页面的数量，并发分裂时同时分配页面
+    std::atomic<page_id_t> root_page_; // B+树根节点对应的页面号，查找时不加锁读取，加锁后再检查
     int col_num_; // 索引包含的字段数量
     std::vector<ColType> col_types_; // 字段的类型
     std::vector<int> col_lens_; // 字段的长度
     int col_tot_len_; // 索引包含的字段的总长度
-    int btree_order_; // # children per page 每个结点最多可插入的键值对数量
-    int keys_size_; // keys_size = (btree_order + 1) * col_tot_len
     // first_leaf初始化之后没有进行修改，只不过是在测试文件中遍历叶子结点的时候用了
     page_id_t first_leaf_; // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_; // 尾叶节点对应的页号
@@ -44,16 +45,15 @@ public:
     }
 
     IxFileHdr(page_id_t first_free_page_no, int num_pages, page_id_t root_page, int col_num,
-              int col_tot_len, int btree_order, int keys_size, page_id_t first_leaf, page_id_t last_leaf)
+              int col_tot_len, page_id_t first_leaf, page_id_t last_leaf)
         : first_free_page_no_(first_free_page_no), num_pages_(num_pages), root_page_(root_page), col_num_(col_num),
-          col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf),
-          last_leaf_(last_leaf) {
+          col_tot_len_(col_tot_len), first_leaf_(first_leaf), last_leaf_(last_leaf) {
         tot_len_ = 0;
     }
 
     void update_tot_len() {
         tot_len_ = 0;
-        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
+        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 4;
         tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
     }
 
@@ -63,9 +63,11 @@ public:
         offset += sizeof(int);
         memcpy(dest + offset, &first_free_page_no_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
-        memcpy(dest + offset, &num_pages_, sizeof(int));
+        int num_pages = num_pages_;
+        memcpy(dest + offset, &num_pages, sizeof(int));
         offset += sizeof(int);
-        memcpy(dest + offset, &root_page_, sizeof(page_id_t));
+        page_id_t root_page = root_page_;
+        memcpy(dest + offset, &root_page, sizeof(page_id_t));
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &col_num_, sizeof(int));
         offset += sizeof(int);
@@ -79,10 +81,6 @@ public:
         }
         memcpy(dest + offset, &col_tot_len_, sizeof(int));
         offset += sizeof(int);
-        memcpy(dest + offset, &btree_order_, sizeof(int));
-        offset += sizeof(int);
-        memcpy(dest + offset, &keys_size_, sizeof(int));
-        offset += sizeof(int);
         memcpy(dest + offset, &first_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
@@ -117,10 +115,6 @@ public:
         }
         col_tot_len_ = *reinterpret_cast<const int *>(src + offset);
         offset += sizeof(int);
-        btree_order_ = *reinterpret_cast<const int *>(src + offset);
-        offset += sizeof(int);
-        keys_size_ = *reinterpret_cast<const int *>(src + offset);
-        offset += sizeof(int);
         first_leaf_ = *reinterpret_cast<const page_id_t *>(src + offset);
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t *>(src + offset);
@@ -131,14 +125,63 @@ public:
 
 class IxPageHdr {
 public:
-    page_id_t next_free_page_no; // unused
+    page_id_t next_free_page_no; // unused，与页面的lsn位于同一位置，不能使用
     page_id_t parent; // 父亲节点所在页面的叶号
     int num_key; // # current keys (always equals to #child - 1) 已插入的keys数量，key_idx∈[0,num_key)
     bool is_leaf; // 是否为叶节点
     page_id_t prev_leaf; // previous leaf node's page_no, effective only when is_leaf is true
     page_id_t next_leaf; // next leaf node's page_no, effective only when is_leaf is true
+    int prefix_len; // 叶子结点中所有key的公共前缀长度，前缀只存一份，放在页面的最末尾
+    int heap_size; // 页面末尾的key堆已经占用的字节数，包括前缀和删除key后留下的空洞
+    int key_bytes; // key堆中有效的字节数（前缀和各个key的后缀）
+};
+
+/**
+ * 结点中的一个键值对。页面中依次是 IxPageHdr、按key有序的槽数组和空闲空间，key的后缀从页面末尾向前存放。
+ * key都按 ix_encode_key 编码，完整的key是 结点前缀 + 后缀 + 补齐到 col_tot_len 的 0，后缀末尾的 0 不存储
+ */
+struct IxSlot {
+    uint16_t offset; // key的后缀在页面中的偏移
+    uint16_t len; // key的后缀的长度
+    Rid rid;
+};
+
+static_assert(PAGE_SIZE <= 65536, "IxSlot offsets are 16 bits");
+
+/* 索引页面日志中的一个修改，IX_OP_WRITE 之后紧跟写入的 len 个字节 */
+enum IxPageOpType : int {
+    IX_OP_WRITE = 0, // 把 len 个字节写到页面的 dst 处
+    IX_OP_MOVE // 把页面中 src 处的 len 个字节移动到 dst 处
+};
+
+struct IxPageOp {
+    IxPageOpType type;
+    int dst; // 页面内的偏移
+    int src; // 页面内的偏移，只用于 IX_OP_MOVE
+    int len;
 };
 
+/**
+ * @description: 在页面上依次重做索引页面日志中的修改
+ * @param {char*} page_data 页面数据
+ * @param {char*} ops 修改序列
+ * @param {size_t} size 修改序列的长度
+ */
+inline void ix_redo_page_ops(char *page_data, const char *ops, size_t size) {
+    size_t offset = 0;
+    while (offset < size) {
+        IxPageOp op;
+        memcpy(&op, ops + offset, sizeof(IxPageOp));
+        offset += sizeof(IxPageOp);
+        if (op.type == IX_OP_WRITE) {
+            memcpy(page_data + op.dst, ops + offset, op.len);
+            offset += op.len;
+        } else {
+            memmove(page_data + op.dst, page_data + op.src, op.len);
+        }
+    }
+}
+
 class Iid {
 public:
     int page_no;
@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #include "ix_index_handle.h"
 
 #include "ix_scan.h"
+#include "recovery/log_manager.h"
 
 void IxIndexHandle::release_all_index_latch_page(Transaction *transaction) {
     if (transaction != nullptr) {
@@ -23,36 +24,74 @@ void IxIndexHandle::release_all_index_latch_page(Transaction *transaction) {
     }
 }
 
-bool IxNodeHandle::isSafe(Operation operation) {
-    int min_size = 2;
-    if (!is_root_page()) {
-        min_size = get_min_size();
+void IxNodeHandle::log_page() {
+    if (page_ops_.empty()) {
+        return;
     }
+    IndexPageLogRecord log_record(index_handle_->index_name_, get_page_no(), page_ops_);
+    page->set_page_lsn(index_handle_->log_manager_->add_log_to_buffer(&log_record));
+    page_ops_.clear();
+}
+
+/**
+ * @brief 判断在以当前结点为根的子树中插入或删除key以后，当前结点的父结点是否一定不会被修改
+ * 插入时结点再插入一个键值对以后不会满（叶子结点还要求key以公共前缀开头，否则要重写结点），
+ * 删除时结点删除一个键值对以后既不会为空，也不会小到需要合并
+ */
+bool IxNodeHandle::isSafe(Operation operation, const char *key) {
+    if (operation == Operation::FIND) {
+        return true;
+    }
+    int limit = PAGE_SIZE - max_entry_size();
     if (operation == Operation::INSERT) {
-        return get_size() + 1 < get_max_size();
+        if (is_internal_page()) {
+            return used_bytes() + max_entry_size() <= limit;
+        }
+        return has_prefix(key) && used_bytes() + static_cast<int>(sizeof(IxSlot)) + suffix_len(key) <= limit;
     }
-    if (operation == Operation::DELETE) {
-        return get_size() > min_size;
+    if (is_root_page()) {
+        return get_size() > 2;
     }
-    // 其他操作
-    return true;
+    return get_size() > 1 && used_bytes() - max_entry_size() >= IX_NODE_MERGE_BYTES;
+}
+
+int IxNodeHandle::compare_suffix(const char *key, int key_len, int i) const {
+    int len = slots[i].len;
+    int cmp = memcmp(key, suffix(i), std::min(key_len, len));
+    if (cmp != 0) {
+        return cmp;
+    }
+    // 去掉末尾的 0 以后更长的key更大
+    return key_len < len ? -1 : (key_len > len ? 1 : 0);
+}
+
+int IxNodeHandle::compare_key(const char *key, int i) const {
+    int cmp = memcmp(key, prefix(), page_hdr->prefix_len);
+    if (cmp != 0) {
+        return cmp;
+    }
+    return compare_suffix(key + page_hdr->prefix_len, suffix_len(key), i);
 }
 
 /**
  * @brief 在当前node中查找第一个>=target的key_idx
+ * target先和公共前缀比较，不以前缀开头时直接得到结果，否则只在后缀上二分查找
  *
  * @return key_idx，范围为[0,num_key)，如果返回的key_idx=num_key，则表示target大于最后一个key
  * @note 返回key index（同时也是rid index），作为slot no
  */
 int IxNodeHandle::lower_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于等于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式，如顺序遍历、二分查找等；使用ix_compare()函数进行比较
+    int prefix_len = page_hdr->prefix_len;
+    int cmp = memcmp(target, prefix(), prefix_len);
+    if (cmp != 0) {
+        return cmp < 0 ? 0 : page_hdr->num_key;
+    }
+    const char *key = target + prefix_len;
+    int key_len = suffix_len(target);
     int l = 0, r = page_hdr->num_key;
     while (l < r) {
         int mid = (l + r) >> 1;
-        int cmp = Compare(target, get_key(mid));
-        if (cmp <= 0) {
+        if (compare_suffix(key, key_len, mid) <= 0) {
             r = mid;
         } else {
             l = mid + 1;
@@ -68,14 +107,17 @@ int IxNodeHandle::lower_bound(const char *target) const {
  * @note 注意此处的范围从1开始
  */
 int IxNodeHandle::upper_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式：顺序遍历、二分查找等；使用ix_compare()函数进行比较
+    int prefix_len = page_hdr->prefix_len;
+    int cmp = memcmp(target, prefix(), prefix_len);
+    if (cmp != 0) {
+        return cmp < 0 ? std::min(1, page_hdr->num_key) : page_hdr->num_key;
+    }
+    const char *key = target + prefix_len;
+    int key_len = suffix_len(target);
     int l = 1, r = page_hdr->num_key;
     while (l < r) {
         int mid = (l + r) >> 1;
-        int cmp = Compare(target, get_key(mid));
-        if (cmp < 0) {
+        if (compare_suffix(key, key_len, mid) < 0) {
             r = mid;
         } else {
             l = mid + 1;
@@ -94,13 +136,8 @@ int IxNodeHandle::upper_bound(const char *target) const {
  * @return 目标key是否存在
  */
 bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
-    // Todo:
-    // 1. 在叶子节点中获取目标key所在位置
-    // 2. 判断目标key是否存在
-    // 3. 如果存在，获取key对应的Rid，并赋值给传出参数value
-    // 提示：可以调用lower_bound()和get_rid()函数。
     int pos = lower_bound(key);
-    if (pos == page_hdr->num_key || Compare(key, get_key(pos))) {
+    if (pos == page_hdr->num_key || compare_key(key, pos) != 0) {
         return false;
     }
     *value = get_rid(pos);
@@ -113,56 +150,125 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
  * @return page_id_t 目标key所在的孩子节点（子树）的存储页面编号
  */
 page_id_t IxNodeHandle::internal_lookup(const char *key) {
-    // Todo:
-    // 1. 查找当前非叶子节点中目标key所在孩子节点（子树）的位置
-    // 2. 获取该孩子节点（子树）所在页面的编号
-    // 3. 返回页面编号
     return value_at(upper_bound(key) - 1);
 }
 
+void IxNodeHandle::get_key(int key_idx, char *out) const {
+    int prefix_len = page_hdr->prefix_len;
+    int len = slots[key_idx].len;
+    memcpy(out, prefix(), prefix_len);
+    memcpy(out + prefix_len, suffix(key_idx), len);
+    memset(out + prefix_len + len, 0, file_hdr->col_tot_len_ - prefix_len - len);
+}
+
+void IxNodeHandle::collect(int begin, int end, IxEntries *entries) const {
+    std::vector<char> key(file_hdr->col_tot_len_);
+    for (int i = begin; i < end; ++i) {
+        get_key(i, key.data());
+        entries->push_back(key.data(), *get_rid(i));
+    }
+}
+
+int IxNodeHandle::rebuild_bytes(const IxEntries &entries, int begin, int end) const {
+    int key_len = file_hdr->col_tot_len_;
+    int prefix_len = 0;
+    if (is_leaf_page() && begin < end) {
+        prefix_len = ix_common_prefix(entries.key(begin), entries.key(end - 1), key_len);
+    }
+    int bytes = sizeof(IxPageHdr) + (end - begin) * sizeof(IxSlot) + prefix_len;
+    for (int i = begin; i < end; ++i) {
+        bytes += ix_trimmed_len(entries.key(i) + prefix_len, key_len - prefix_len);
+    }
+    return bytes;
+}
+
 /**
- * @brief 在指定位置插入n个连续的键值对
- * 将key的前n位插入到原来keys中的pos位置；将rid的前n位插入到原来rids中的pos位置
+ * @brief 在一个临时页面中按新的前缀排好键值对和key堆，再写回结点，同时整理掉key堆中删除留下的空洞
+ * 只写页面头（跳过lsn）、槽数组和key堆实际占用的部分
+ */
+void IxNodeHandle::rebuild(const IxEntries &entries, int begin, int end) {
+    assert(rebuild_bytes(entries, begin, end) <= PAGE_SIZE);
+    int key_len = file_hdr->col_tot_len_;
+    int num_key = end - begin;
+    int prefix_len = 0;
+    if (is_leaf_page() && num_key > 0) {
+        prefix_len = ix_common_prefix(entries.key(begin), entries.key(end - 1), key_len);
+    }
+    char buf[PAGE_SIZE];
+    auto *new_hdr = reinterpret_cast<IxPageHdr *>(buf);
+    auto *new_slots = reinterpret_cast<IxSlot *>(buf + sizeof(IxPageHdr));
+    *new_hdr = *page_hdr;
+    if (num_key > 0) {
+        memcpy(buf + PAGE_SIZE - prefix_len, entries.key(begin), prefix_len);
+    }
+    int heap_size = prefix_len;
+    for (int i = 0; i < num_key; ++i) {
+        const char *key = entries.key(begin + i) + prefix_len;
+        int len = ix_trimmed_len(key, key_len - prefix_len);
+        heap_size += len;
+        memcpy(buf + PAGE_SIZE - heap_size, key, len);
+        new_slots[i] = {static_cast<uint16_t>(PAGE_SIZE - heap_size), static_cast<uint16_t>(len), entries.rid(begin + i)};
+    }
+    new_hdr->num_key = num_key;
+    new_hdr->prefix_len = prefix_len;
+    new_hdr->heap_size = heap_size;
+    new_hdr->key_bytes = heap_size;
+
+    write_bytes(page->get_data() + sizeof(page_id_t), buf + sizeof(page_id_t), sizeof(IxPageHdr) - sizeof(page_id_t));
+    write_bytes(reinterpret_cast<char *>(slots), reinterpret_cast<char *>(new_slots), num_key * sizeof(IxSlot));
+    write_bytes(page->get_data() + PAGE_SIZE - heap_size, buf + PAGE_SIZE - heap_size, heap_size);
+    log_page();
+}
+
+int IxNodeHandle::insert_bytes(int pos, const char *key) const {
+    if (has_prefix(key)) {
+        return used_bytes() + sizeof(IxSlot) + suffix_len(key);
+    }
+    // 公共前缀变短，所有的key都要重写
+    IxEntries entries(file_hdr->col_tot_len_);
+    collect(0, page_hdr->num_key, &entries);
+    entries.insert(pos, key, Rid{});
+    return rebuild_bytes(entries, 0, entries.size());
+}
+
+/**
+ * @brief 在指定位置插入单个键值对
+ * key以公共前缀开头并且空闲空间足够时，只移动槽数组并把后缀写到key堆的顶部；否则重写整个结点
  *
  * @param pos 要插入键值对的位置
- * @param (key, rid) 连续键值对的起始地址，也就是第一个键值对，可以通过(key, rid)来获取n个键值对
- * @param n 键值对数量
+ * @param (key, rid) 要插入的键值对，key是编码后的完整key
  * @note [0,pos)           [pos,num_key)
  *                            key_slot
  *                            /      \
  *                           /        \
- *       [0,pos)     [pos,pos+n)   [pos+n,num_key+n)
+ *       [0,pos)     [pos,pos+1)   [pos+1,num_key+1)
  *                      key           key_slot
  */
-void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n) {
-    // Todo:
-    // 1. 判断pos的合法性
-    // 2. 通过key获取n个连续键值对的key值，并把n个key值插入到pos位置
-    // 3. 通过rid获取n个连续键值对的rid值，并把n个rid值插入到pos位置
-    // 4. 更新当前节点的键数量
-    // 检查 pos 的合法性
-    if (pos < 0 || pos > page_hdr->num_key) {
+void IxNodeHandle::insert_pair(int pos, const char *key, const Rid &rid) {
+    int num_key = page_hdr->num_key;
+    if (pos < 0 || pos > num_key) {
         throw IndexEntryNotFoundError();
     }
-
-    // 获取当前键和 RID 的指针
-    auto &&cur_key = get_key(pos);
-    auto &&cur_rid = get_rid(pos);
-    auto &&num_keys = page_hdr->num_key;
-    auto &&cols_len = file_hdr->col_tot_len_;
-
-    // 腾出 (num_keys - pos) 个空间
-    if (pos < num_keys) {
-        memmove(cur_key + n * cols_len, cur_key, (num_keys - pos) * cols_len);
-        memmove(cur_rid + n, cur_rid, (num_keys - pos) * sizeof(Rid));
+    if (has_prefix(key)) {
+        int len = suffix_len(key);
+        int free_bytes = PAGE_SIZE - page_hdr->heap_size - static_cast<int>(sizeof(IxPageHdr) + (num_key + 1) * sizeof(IxSlot));
+        if (len <= free_bytes) {
+            auto *slot = reinterpret_cast<char *>(slots + pos);
+            move_bytes(slot + sizeof(IxSlot), slot, (num_key - pos) * sizeof(IxSlot));
+            int offset = PAGE_SIZE - page_hdr->heap_size - len;
+            write_bytes(page->get_data() + offset, key + page_hdr->prefix_len, len);
+            write_field(&slots[pos], IxSlot{static_cast<uint16_t>(offset), static_cast<uint16_t>(len), rid});
+            write_field(&page_hdr->num_key, num_key + 1);
+            write_field(&page_hdr->heap_size, page_hdr->heap_size + len);
+            write_field(&page_hdr->key_bytes, page_hdr->key_bytes + len);
+            log_page();
+            return;
+        }
     }
-
-    // 拷贝 n 个键值对
-    memcpy(cur_key, key, n * cols_len);
-    memcpy(cur_rid, rid, n * sizeof(Rid));
-
-    // 更新键数量
-    page_hdr->num_key += n;
+    IxEntries entries(file_hdr->col_tot_len_);
+    collect(0, num_key, &entries);
+    entries.insert(pos, key, rid);
+    rebuild(entries, 0, entries.size());
 }
 
 /**
@@ -173,13 +279,8 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
  * @return int 键值对数量 int 插入的位置
  */
 std::pair<int, int> IxNodeHandle::insert(const char *key, const Rid &value) {
-    // Todo:
-    // 1. 查找要插入的键值对应该插入到当前节点的哪个位置
-    // 2. 如果key重复则不插入
-    // 3. 如果key不重复则插入键值对
-    // 4. 返回完成插入操作之后的键值对数量
-    auto &&pos = lower_bound(key);
-    if (pos < page_hdr->num_key && Compare(key, get_key(pos)) == 0) {
+    int pos = lower_bound(key);
+    if (pos < page_hdr->num_key && compare_key(key, pos) == 0) {
         return {page_hdr->num_key, -1};
     }
     insert_pair(pos, key, value);
@@ -188,30 +289,27 @@ std::pair<int, int> IxNodeHandle::insert(const char *key, const Rid &value) {
 
 /**
  * @brief 用于在结点中的指定位置删除单个键值对
+ * key的后缀留在key堆中成为空洞，插入时空间不够再整理；结点删空时清空key堆
  *
  * @param pos 要删除键值对的位置
  */
 void IxNodeHandle::erase_pair(int pos) {
-    // Todo:
-    // 1. 删除该位置的key
-    // 2. 删除该位置的rid
-    // 3. 更新结点的键值对数量
-    if (pos < 0 || pos >= page_hdr->num_key) {
+    int num_key = page_hdr->num_key;
+    if (pos < 0 || pos >= num_key) {
         throw IndexEntryNotFoundError();
     }
-
-    // 获取当前键和 RID 的指针
-    auto &&cur_key = get_key(pos);
-    auto &&cur_rid = get_rid(pos);
-    auto &&num_keys = page_hdr->num_key;
-    auto &&cols_len = file_hdr->col_tot_len_;
-
-    // 腾出 1 个空间
-    memmove(cur_key, cur_key + cols_len, (num_keys - pos - 1) * cols_len);
-    memmove(cur_rid, cur_rid + 1, (num_keys - pos - 1) * sizeof(Rid));
-
-    // 更新键数量
-    --page_hdr->num_key;
+    int len = slots[pos].len;
+    auto *slot = reinterpret_cast<char *>(slots + pos);
+    move_bytes(slot, slot + sizeof(IxSlot), (num_key - pos - 1) * sizeof(IxSlot));
+    write_field(&page_hdr->num_key, num_key - 1);
+    if (num_key == 1) {
+        write_field(&page_hdr->prefix_len, 0);
+        write_field(&page_hdr->heap_size, 0);
+        write_field(&page_hdr->key_bytes, 0);
+    } else {
+        write_field(&page_hdr->key_bytes, page_hdr->key_bytes - len);
+    }
+    log_page();
 }
 
 /**
@@ -221,12 +319,8 @@ void IxNodeHandle::erase_pair(int pos) {
  * @return 完成删除操作后的键值对数量 / 移除位置
  */
 std::pair<int, int> IxNodeHandle::remove(const char *key) {
-    // Todo:
-    // 1. 查找要删除键值对的位置
-    // 2. 如果要删除的键值对存在，删除键值对
-    // 3. 返回完成删除操作后的键值对数量
-    auto &&pos = lower_bound(key);
-    if (pos < page_hdr->num_key && Compare(key, get_key(pos)) == 0) {
+    int pos = lower_bound(key);
+    if (pos < page_hdr->num_key && compare_key(key, pos) == 0) {
         erase_pair(pos);
     }
     return {page_hdr->num_key, pos};
@@ -242,71 +336,107 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
     delete []buf;
+    index_name_ = disk_manager_->get_file_name(fd);
+#ifdef ENABLE_LOGGING
+    log_manager_ = buffer_pool_manager_->get_log_manager();
+#endif
 
     // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
     // int now_page_no = disk_manager_->get_fd2pageno(fd);
     disk_manager_->set_fd2pageno(fd, file_hdr_->num_pages_);
 }
 
+/**
+ * @brief 获取根结点并加锁
+ * 根结点的页号是原子变量，不用锁保护；加锁以后如果根结点已经换了（分裂出新根或者根被合并），放开重新获取。
+ * 修改根结点页号的写操作一定持有旧根结点的写锁，所以加锁后检查通过时得到的就是当前的根结点
+ * @param write 是否加写锁
+ * @param leaf_write 根结点是叶子结点时是否加写锁
+ */
+std::shared_ptr<IxNodeHandle> IxIndexHandle::fetch_root(bool write, bool leaf_write) {
+    while (true) {
+        page_id_t root_page_no = file_hdr_->root_page_;
+        auto node = fetch_node(root_page_no);
+        // 页面一旦分配，是否是叶子结点就不再改变，不加锁读取是安全的
+        bool exclusive = write || (leaf_write && node->is_leaf_page());
+        if (exclusive) {
+            node->page->WLatch();
+        } else {
+            node->page->RLatch();
+        }
+        if (file_hdr_->root_page_ == root_page_no) {
+            return node;
+        }
+        if (exclusive) {
+            node->page->WUnlatch();
+        } else {
+            node->page->RUnlatch();
+        }
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+    }
+}
+
 /**
  * @brief 用于查找指定键所在的叶子结点
+ * 查找时一路加读锁；插入和删除时悲观地一路加写锁，子结点安全（不会修改父结点）时放开所有祖先结点的写锁，
+ * 没放开的祖先结点记录在事务的 index_latch_page_set 中
  * @param key 要查找的目标key值
  * @param operation 查找到目标键值对后要进行的操作类型
- * @param transaction 事务参数，如果不需要则默认传入nullptr
- * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
+ * @param transaction 事务参数，查找时可以传入nullptr
+ * @return 目标叶子结点
  * @note need to Unlatch and unpin the leaf node outside!
  * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
  */
-std::pair<std::shared_ptr<IxNodeHandle>, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
-                                                                             Transaction *transaction,
-                                                                             bool find_first) {
-    // Todo:
-    // 1. 获取根节点
-    // 2. 从根节点开始不断向下查找目标key
-    // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
-    // 因为根有可能被删除 获取根节点前先加根锁
-    root_latch_.lock();
-    bool is_root_locked = true;
-    auto &&node = fetch_node(file_hdr_->root_page_);
-    if (operation == Operation::FIND) {
-        // 读操作
-        node->page->RLatch();
-        root_latch_.unlock();
-        is_root_locked = false;
-    } else {
-        // 写操作
-        node->page->WLatch();
-        if (node->isSafe(operation)) {
-            root_latch_.unlock();
-            is_root_locked = false;
-        }
-    }
-
+std::shared_ptr<IxNodeHandle> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
+                                                            Transaction *transaction, bool find_first) {
+    bool write = operation != Operation::FIND;
+    auto node = fetch_root(write, write);
     while (!node->is_leaf_page()) {
         auto &&child_node = fetch_node(find_first ? node->value_at(0) : node->internal_lookup(key));
-        if (operation == Operation::FIND) {
+        if (!write) {
             child_node->page->RLatch();
             node->page->RUnlatch();
             buffer_pool_manager_->unpin_page(node->get_page_id(), false);
         } else {
             child_node->page->WLatch();
-            // !TODO 支持并发事务
             transaction->append_index_latch_page_set(node->page);
-            if (child_node->isSafe(operation)) {
-                if (is_root_locked) {
-                    root_latch_.unlock();
-                    is_root_locked = false;
-                }
+            if (child_node->isSafe(operation, key)) {
                 // 释放所有父节点写锁
                 release_all_index_latch_page(transaction);
             }
         }
         node = child_node;
     }
+    return node;
+}
 
-    return {node, is_root_locked};
+/**
+ * @brief 乐观地查找插入或删除key的叶子结点：内部结点只加读锁，只有叶子结点加写锁。
+ * 叶子结点不安全（需要分裂、合并或者修改父结点）时返回nullptr，由调用者改用find_leaf_page悲观地重新查找
+ * @return 加了写锁的叶子结点，或者nullptr
+ */
+std::shared_ptr<IxNodeHandle> IxIndexHandle::find_leaf_optimistic(const char *key, Operation operation) {
+    auto node = fetch_root(false, true);
+    while (!node->is_leaf_page()) {
+        auto &&child_node = fetch_node(node->internal_lookup(key));
+        if (child_node->is_leaf_page()) {
+            child_node->page->WLatch();
+        } else {
+            child_node->page->RLatch();
+        }
+        node->page->RUnlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        node = child_node;
+    }
+    if (node->isSafe(operation, key)) {
+        return node;
+    }
+    node->page->WUnlatch();
+    buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+    return nullptr;
 }
 
+
 /**
  * @brief 用于查找指定键在叶子结点中的对应的值result
  *
@@ -316,14 +446,11 @@ std::pair<std::shared_ptr<IxNodeHandle>, bool> IxIndexHandle::find_leaf_page(con
  * @return bool 返回目标键值对是否存在
  */
 bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
-    // Todo:
-    // 1. 获取目标key值所在的叶子结点
-    // 2. 在叶子节点中查找目标key值的位置，并读取key对应的rid
-    // 3. 把rid存入result参数中
-    // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
-    auto &&leaf_node = find_leaf_page(key, Operation::FIND, transaction, false).first;
+    std::vector<char> ekey(file_hdr_->col_tot_len_);
+    encode_key(key, ekey.data());
+    auto &&leaf_node = find_leaf_page(ekey.data(), Operation::FIND, transaction, false);
     Rid *rid;
-    if (leaf_node->leaf_lookup(key, &rid)) {
+    if (leaf_node->leaf_lookup(ekey.data(), &rid)) {
         leaf_node->page->RUnlatch();
         buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), false);
         result->emplace_back(*rid);
@@ -335,22 +462,40 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
 }
 
 /**
- * @brief  将传入的一个node拆分(Split)成两个结点，在node的右边生成一个新结点new node
+ * @brief 按占用的字节数把entries分成大小相近的两半
+ * @return 右半部分的第一个键值对，范围为[1,size)
+ */
+static int split_point_by_bytes(const IxEntries &entries, int key_len) {
+    int total = 0;
+    for (int i = 0; i < entries.size(); ++i) {
+        total += sizeof(IxSlot) + ix_trimmed_len(entries.key(i), key_len);
+    }
+    int bytes = 0;
+    for (int i = 0; i < entries.size(); ++i) {
+        bytes += sizeof(IxSlot) + ix_trimmed_len(entries.key(i), key_len);
+        if (bytes * 2 >= total) {
+            return std::max(1, std::min(i + 1, entries.size() - 1));
+        }
+    }
+    return entries.size() - 1;
+}
+
+/**
+ * @brief  将node拆分(Split)成两个结点，在node的右边生成一个新结点new node
+ * 叶子结点分裂时选最短的分隔key：右半部分第一个key到与左半部分最后一个key第一个不同的字节为止，后面补 0；
+ * 内部结点分裂时右半部分的第一个key上移到父结点，新结点中对应的位置清空
+ *
  * @param node 需要拆分的结点
+ * @param entries node的全部键值对，可以包含还没有写入node的键值对
+ * @param split_point 右半部分的第一个键值对
+ * @param[out] separator 插入父结点的分隔key，new node子树中的key都大于等于它，node子树中的key都小于它
  * @return 拆分得到的new_node
- * @note need to unpin the new node outside
- * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin
+ * @note 本函数执行完毕后，原node和new node都需要在函数外面进行unpin
  */
-std::shared_ptr<IxNodeHandle> IxIndexHandle::split(std::shared_ptr<IxNodeHandle> &node) {
-    // Todo:
-    // 1. 将原结点的键值对平均分配，右半部分分裂为新的右兄弟结点
-    //    需要初始化新节点的page_hdr内容
-    // 2. 如果新的右兄弟结点是叶子结点，更新新旧节点的prev_leaf和next_leaf指针
-    //    为新节点分配键值对，更新旧节点的键值对数记录
-    // 3. 如果新的右兄弟结点不是叶子结点，更新该结点的所有孩子结点的父节点信息(使用IxIndexHandle::maintain_child())
+std::shared_ptr<IxNodeHandle> IxIndexHandle::split(std::shared_ptr<IxNodeHandle> &node, IxEntries &entries,
+                                                   int split_point, char *separator) {
     auto new_sibling_node = create_node();
     new_sibling_node->page->WLatch();
-    auto &&split_point = node->get_min_size();
     if (node->is_leaf_page()) {
         // 更新左右叶子节点关系
         new_sibling_node->set_prev_leaf(node->get_page_no());
@@ -365,18 +510,25 @@ std::shared_ptr<IxNodeHandle> IxIndexHandle::split(std::shared_ptr<IxNodeHandle>
         buffer_pool_manager_->unpin_page(next_leaf->get_page_id(), true);
     }
     // 记得维护节点元信息
-    new_sibling_node->page_hdr->num_key = 0;
-    new_sibling_node->page_hdr->is_leaf = node->is_leaf_page();
-    new_sibling_node->page_hdr->parent = node->get_parent_page_no();
-    // 插入到右兄弟节点
-    new_sibling_node->insert_pairs(0, node->get_key(split_point), node->get_rid(split_point),
-                                   node->page_hdr->num_key - split_point);
-    // 这里直接设置 size，软移除
-    node->set_size(split_point);
+    new_sibling_node->set_is_leaf_page(node->is_leaf_page());
+    new_sibling_node->set_parent_page_no(node->get_parent_page_no());
+
+    int key_len = file_hdr_->col_tot_len_;
+    if (node->is_leaf_page()) {
+        const char *right_first = entries.key(split_point);
+        int diff = ix_common_prefix(entries.key(split_point - 1), right_first, key_len);
+        memcpy(separator, right_first, diff + 1);
+        memset(separator + diff + 1, 0, key_len - diff - 1);
+    } else {
+        memcpy(separator, entries.key(split_point), key_len);
+        memset(entries.key(split_point), 0, key_len);
+    }
+    new_sibling_node->rebuild(entries, split_point, entries.size());
+    node->rebuild(entries, 0, split_point);
 
     // ！如果是内部节点，还需要维护孩子节点关系
     if (new_sibling_node->is_internal_page()) {
-        for (int i = 0; i < new_sibling_node->page_hdr->num_key; ++i) {
+        for (int i = 0; i < new_sibling_node->get_size(); ++i) {
             maintain_child(new_sibling_node, i);
         }
     }
@@ -386,32 +538,26 @@ std::shared_ptr<IxNodeHandle> IxIndexHandle::split(std::shared_ptr<IxNodeHandle>
 /**
  * @brief Insert key & value pair into internal page after split
  * 拆分(Split)后，向上找到old_node的父结点
- * 将new_node的第一个key插入到父结点，其位置在 父结点指向old_node的孩子指针 之后
- * 如果插入后>=maxsize，则必须继续拆分父结点，然后在其父结点的父结点再插入，即需要递归
+ * 将分隔key插入到父结点，其位置在 父结点指向old_node的孩子指针 之后
+ * 如果插入后父结点满了，则必须继续拆分父结点，然后在其父结点的父结点再插入，即需要递归
  * 直到找到的old_node为根结点时，结束递归（此时将会新建一个根R，关键字为key，old_node和new_node为其孩子）
  *
  * @param (old_node, new_node) 原结点为old_node，old_node被分裂之后产生了新的右兄弟结点new_node
- * @param key 要插入parent的key
- * @note 一个结点插入了键值对之后需要分裂，分裂后左半部分的键值对保留在原结点，在参数中称为old_node，
- * 右半部分的键值对分裂为新的右兄弟节点，在参数中称为new_node（参考Split函数来理解old_node和new_node）
+ * @param key 要插入parent的分隔key
  * @note 本函数执行完毕后，new node和old node都需要在函数外面进行unpin
  */
 void IxIndexHandle::insert_into_parent(std::shared_ptr<IxNodeHandle> &old_node, const char *key,
                                        std::shared_ptr<IxNodeHandle> &new_node, Transaction *transaction) {
-    // Todo:
-    // 1. 分裂前的结点（原结点, old_node）是否为根结点，如果为根结点需要分配新的root
-    // 2. 获取原结点（old_node）的父亲结点
-    // 3. 获取key对应的rid，并将(key, rid)插入到父亲结点
-    // 4. 如果父亲结点仍需要继续分裂，则进行递归插入
-    // 提示：记得unpin page
     // 是否为根结点
     if (old_node->is_root_page()) {
         auto &&new_root = create_node();
-        new_root->page_hdr->parent = IX_NO_PAGE;
-        new_root->page_hdr->num_key = 0;
-        new_root->page_hdr->is_leaf = false;
-        new_root->page_hdr->prev_leaf = new_root->page_hdr->next_leaf = IX_NO_PAGE;
-        new_root->insert_pair(0, old_node->get_key(0), {old_node->get_page_no(), -1});
+        new_root->set_parent_page_no(IX_NO_PAGE);
+        new_root->set_is_leaf_page(false);
+        new_root->set_prev_leaf(IX_NO_PAGE);
+        new_root->set_next_leaf(IX_NO_PAGE);
+        // 内部结点的第一个key不参与查找
+        std::vector<char> first_key(file_hdr_->col_tot_len_, 0);
+        new_root->insert_pair(0, first_key.data(), {old_node->get_page_no(), -1});
         new_root->insert_pair(1, key, {new_node->get_page_no(), -1});
 
         // 维护父子关系
@@ -419,21 +565,24 @@ void IxIndexHandle::insert_into_parent(std::shared_ptr<IxNodeHandle> &old_node,
         new_node->set_parent_page_no(new_root->get_page_no());
 
         // 成为新的根节点
-        file_hdr_->root_page_ = new_root->get_page_no();
+        update_root_page_no(new_root->get_page_no());
 
-        // 维护完毕，释放根锁
-        root_latch_.unlock();
+        // 维护完毕，释放旧根结点以上的写锁
         buffer_pool_manager_->unpin_page(new_root->get_page_id(), true);
         release_all_index_latch_page(transaction);
     } else {
         // 获取原结点（old_node）的父亲结点
         auto &&parent_node = fetch_node(old_node->get_parent_page_no());
-        // 将新右兄弟节点头记录信息插入
+        // 将新右兄弟节点的分隔key插入
         parent_node->insert_pair(parent_node->find_child(old_node) + 1, key, {new_node->get_page_no(), -1});
         // 插入后满了
         if (parent_node->isFull()) {
-            auto &&new_sibling_node = split(parent_node);
-            insert_into_parent(parent_node, new_sibling_node->get_key(0), new_sibling_node, transaction);
+            IxEntries entries(file_hdr_->col_tot_len_);
+            parent_node->collect(0, parent_node->get_size(), &entries);
+            std::vector<char> separator(file_hdr_->col_tot_len_);
+            auto &&new_sibling_node = split(parent_node, entries, split_point_by_bytes(entries, file_hdr_->col_tot_len_),
+                                            separator.data());
+            insert_into_parent(parent_node, separator.data(), new_sibling_node, transaction);
             new_sibling_node->page->WUnlatch();
             buffer_pool_manager_->unpin_page(new_sibling_node->get_page_id(), true);
         }
@@ -444,13 +593,12 @@ void IxIndexHandle::insert_into_parent(std::shared_ptr<IxNodeHandle> &old_node,
 
 // 检查是否是 unique key，只有 insert 操作会调用
 bool IxIndexHandle::is_unique(const char *key, Rid &value, Transaction *transaction) {
+    std::vector<char> ekey(file_hdr_->col_tot_len_);
+    encode_key(key, ekey.data());
     // 操作应该为insert
-    auto &&[leaf_node, is_root_locked] = find_leaf_page(key, Operation::FIND, transaction, false);
-    if (is_root_locked) {
-        root_latch_.unlock();
-    }
-    int pos = leaf_node->lower_bound(key);
-    if (pos == leaf_node->page_hdr->num_key || Compare(key, leaf_node->get_key(pos))) {
+    auto &&leaf_node = find_leaf_page(ekey.data(), Operation::FIND, transaction, false);
+    int pos = leaf_node->lower_bound(ekey.data());
+    if (pos == leaf_node->get_size() || leaf_node->compare_key(ekey.data(), pos) != 0) {
         // 释放写锁
         leaf_node->page->RUnlatch();
         buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), false);
@@ -470,19 +618,22 @@ bool IxIndexHandle::is_unique(const char *key, Rid &value, Transaction *transact
  * @return page_id_t 插入到的叶结点的page_no
  */
 page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
-    // Todo:
-    // 1. 查找key值应该插入到哪个叶子节点
-    // 2. 在该叶子节点中插入键值对
-    // 3. 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
-    // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
-    auto &&[leaf_node, is_root_locked] = find_leaf_page(key, Operation::INSERT, transaction, false);
-    int old_size = leaf_node->get_size();
+    std::vector<char> ekey(file_hdr_->col_tot_len_);
+    encode_key(key, ekey.data());
+    // 大多数插入不会分裂，只锁叶子结点即可
+    if (auto leaf_node = find_leaf_optimistic(ekey.data(), Operation::INSERT)) {
+        int old_size = leaf_node->get_size();
+        bool inserted = leaf_node->insert(ekey.data(), value).first != old_size;
+        page_id_t page_no = inserted ? leaf_node->get_page_no() : IX_NO_PAGE;
+        leaf_node->page->WUnlatch();
+        buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), inserted);
+        return page_no;
+    }
+
+    auto &&leaf_node = find_leaf_page(ekey.data(), Operation::INSERT, transaction, false);
+    int pos = leaf_node->lower_bound(ekey.data());
     // key 重复
-    const auto &[new_size, pos] = leaf_node->insert(key, value);
-    if (new_size == old_size) {
-        if (is_root_locked) {
-            root_latch_.unlock();
-        }
+    if (pos < leaf_node->get_size() && leaf_node->compare_key(ekey.data(), pos) == 0) {
         // 处理事务
         release_all_index_latch_page(transaction);
         // 解锁和 unpin
@@ -491,39 +642,49 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
         return IX_NO_PAGE;
     }
 
-    // 优化，只有插入在第一个key位置时，才需要在父节点中向上更新node的第一个key
-    if (pos == 0) {
-        maintain_parent(leaf_node);
-    }
-
     page_id_t return_page_id = INVALID_PAGE_ID;
-    // 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
-    if (leaf_node->isFull()) {
-        auto &&new_sibling_node = split(leaf_node);
-        // 分裂完成后兄弟叶子节点关系已经维护好了
-        // 维护最右的叶子节点
-        if (leaf_node->get_page_no() == file_hdr_->last_leaf_) {
-            file_hdr_->last_leaf_ = new_sibling_node->get_page_no();
-        }
-        insert_into_parent(leaf_node, new_sibling_node->get_key(0), new_sibling_node, transaction);
-        leaf_node->page->WUnlatch();
-        // 如果分裂后插入的key在兄弟叶子节点
-        if (Compare(new_sibling_node->get_key(new_sibling_node->lower_bound(key)), key) == 0) {
-            return_page_id = new_sibling_node->get_page_no();
-        } else {
+    IxEntries entries(file_hdr_->col_tot_len_);
+    int split_point;
+    if (leaf_node->insert_bytes(pos, ekey.data()) <= PAGE_SIZE) {
+        leaf_node->insert_pair(pos, ekey.data(), value);
+        if (!leaf_node->isFull()) {
+            release_all_index_latch_page(transaction);
+            // 先解写锁 写锁不影响 pageId
+            leaf_node->page->WUnlatch();
+            // unpin 之后page可能会被替换 拷贝下页id
             return_page_id = leaf_node->get_page_no();
+            buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), true);
+            return return_page_id;
         }
-        new_sibling_node->page->WUnlatch();
-        buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), true);
-        buffer_pool_manager_->unpin_page(new_sibling_node->get_page_id(), true);
-        return return_page_id;
+        leaf_node->collect(0, leaf_node->get_size(), &entries);
+        split_point = split_point_by_bytes(entries, file_hdr_->col_tot_len_);
+    } else {
+        // key不以结点的公共前缀开头时前缀会变短，所有的key都变长，可能放不下。这时key只能比结点中所有的key都小或者都大，
+        // 把它单独分到一边，另一半的前缀不变，大小也不变
+        leaf_node->collect(0, leaf_node->get_size(), &entries);
+        entries.insert(pos, ekey.data(), value);
+        split_point = pos == 0 ? 1 : pos;
     }
 
-    // 先解写锁 写锁不影响 pageId
+    // 分裂结点，并把分隔key插入父节点
+    std::vector<char> separator(file_hdr_->col_tot_len_);
+    auto &&new_sibling_node = split(leaf_node, entries, split_point, separator.data());
+    // 分裂完成后兄弟叶子节点关系已经维护好了
+    // 维护最右的叶子节点
+    if (leaf_node->get_page_no() == file_hdr_->last_leaf_) {
+        update_last_leaf(new_sibling_node->get_page_no());
+    }
+    insert_into_parent(leaf_node, separator.data(), new_sibling_node, transaction);
     leaf_node->page->WUnlatch();
-    // unpin 之后page可能会被替换 拷贝下页id
-    return_page_id = leaf_node->get_page_no();
+    // 如果分裂后插入的key在兄弟叶子节点
+    if (memcmp(ekey.data(), separator.data(), file_hdr_->col_tot_len_) >= 0) {
+        return_page_id = new_sibling_node->get_page_no();
+    } else {
+        return_page_id = leaf_node->get_page_no();
+    }
+    new_sibling_node->page->WUnlatch();
     buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), true);
+    buffer_pool_manager_->unpin_page(new_sibling_node->get_page_id(), true);
     return return_page_id;
 }
 
@@ -533,19 +694,21 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
  * @param transaction 事务指针
  */
 bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
-    // Todo:
-    // 1. 获取该键值对所在的叶子结点
-    // 2. 在该叶子结点中删除键值对
-    // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
-    // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
-    auto &&[leaf_node, is_root_locked] = find_leaf_page(key, Operation::DELETE, transaction, false);
+    std::vector<char> ekey(file_hdr_->col_tot_len_);
+    encode_key(key, ekey.data());
+    // 删除后不需要合并时，只锁叶子结点即可
+    if (auto leaf_node = find_leaf_optimistic(ekey.data(), Operation::DELETE)) {
+        int old_size = leaf_node->get_size();
+        bool removed = leaf_node->remove(ekey.data()).first != old_size;
+        leaf_node->page->WUnlatch();
+        buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), removed);
+        return removed;
+    }
+
+    auto &&leaf_node = find_leaf_page(ekey.data(), Operation::DELETE, transaction, false);
     int old_size = leaf_node->get_size();
     // key 找不到
-    const auto &[new_size, pos] = leaf_node->remove(key);
-    if (new_size == old_size) {
-        if (is_root_locked) {
-            root_latch_.unlock();
-        }
+    if (leaf_node->remove(ekey.data()).first == old_size) {
         // 处理事务
         release_all_index_latch_page(transaction);
         // 解锁和 unpin
@@ -554,27 +717,13 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
         return false;
     }
 
-    // 优化，只有删除在第一个key位置时，才需要在父节点中向上更新node的第一个key
-    if (pos == 0) {
-        maintain_parent(leaf_node);
-    }
-
-    // 并且需要删除叶子结点，先不实现并发
-    bool is_delete = coalesce_or_redistribute(leaf_node, transaction, &is_root_locked);
-    if (is_root_locked) {
-        root_latch_.unlock();
-    }
+    // 父结点中的分隔key只是子树的下界，删除第一个key不需要向上修改
+    coalesce_or_remove(leaf_node, transaction);
     release_all_index_latch_page(transaction);
     leaf_node->page->WUnlatch();
     buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), true);
-    if (is_delete) {
-        // assert(buffer_pool_manager_->delete_page(leaf_node->get_page_id()));
-    }
     if (transaction != nullptr) {
-        // for (auto &page: *transaction->get_index_deleted_page_set()) {
-        // assert(page->get_pin_count() == 0);
-        // assert(buffer_pool_manager_->delete_page(page->get_page_id()));
-        // }
+        // 被删除的页面不会再分配
         transaction->get_index_deleted_page_set()->clear();
     }
     return true;
@@ -584,7 +733,7 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
  * @brief 用于当根结点被删除了一个键值对之后的处理
  * @param old_root_node 原根节点
  * @return bool 根结点是否需要被删除
- * @note size of root page can be less than min size and this method is only called within coalesce_or_redistribute()
+ * @note size of root page can be less than min size and this method is only called within coalesce_or_remove()
  */
 bool IxIndexHandle::adjust_root(std::shared_ptr<IxNodeHandle> &old_root_node) {
     // Todo:
@@ -595,20 +744,19 @@ bool IxIndexHandle::adjust_root(std::shared_ptr<IxNodeHandle> &old_root_node) {
     // 检查是否需要更新根结点
     if (old_root_node->is_leaf_page() && old_root_node->get_size() == 0) {
         // 叶结点且大小为0，更新根结点为初始值
-        file_hdr_->root_page_ = IX_INIT_ROOT_PAGE;
+        update_root_page_no(IX_INIT_ROOT_PAGE);
         return false;
     }
     if (old_root_node->is_internal_page() && old_root_node->get_size() == 1) {
         // 内部结点且大小为1，更新根结点为唯一子结点
-        file_hdr_->root_page_ = old_root_node->remove_and_return_only_child();
+        update_root_page_no(old_root_node->remove_and_return_only_child());
         // 获取新的根结点并更新其父结点信息
         auto new_root_node = fetch_node(file_hdr_->root_page_);
         new_root_node->set_parent_page_no(IX_NO_PAGE);
         buffer_pool_manager_->unpin_page(new_root_node->get_page_id(), true);
-        // 先不管删除
+        // 先不管删除，被删除的页面不会再分配，file_hdr_.num_pages 始终是已分配的页面数，
+        // 重新打开索引时从这里开始分配页号
         // buffer_pool_manager_->delete_page(old_root_node->get_page_id());
-        // 释放旧的根结点
-        release_node_handle(*old_root_node);
         return true;
     }
     // 不需要进行操作
@@ -616,177 +764,86 @@ bool IxIndexHandle::adjust_root(std::shared_ptr<IxNodeHandle> &old_root_node) {
 }
 
 /**
- * @brief 重新分配node和兄弟结点neighbor_node的键值对
- * Redistribute key & value pairs from one page to its sibling page. If index == 0, move sibling page's first key
- * & value pair into end of input "node", otherwise move sibling page's last key & value pair into head of input "node".
- *
- * @param neighbor_node sibling page of input "node"
- * @param node input from method coalesceOrRedistribute()
- * @param parent the parent of "node" and "neighbor_node"
+ * @brief 把node从B+树中摘除：叶子结点从叶子链表中删除，并删除父结点中指向它的键值对
  * @param index node在parent中的rid_idx
- * @note node是之前刚被删除过一个key的结点
- * index=0，则neighbor是node后继结点，表示：node(left)      neighbor(right)
- * index>0，则neighbor是node前驱结点，表示：neighbor(left)  node(right)
- * 注意更新parent结点的相关kv对
+ * @note 提示：如果是叶子结点且为最右叶子结点，需要更新file_hdr_.last_leaf
  */
-void IxIndexHandle::redistribute(std::shared_ptr<IxNodeHandle> &neighbor_node, std::shared_ptr<IxNodeHandle> &node,
-                                 std::shared_ptr<IxNodeHandle> &parent, int index) {
-    // Todo:
-    // 1. 通过index判断neighbor_node是否为node的前驱结点
-    // 2. 从neighbor_node中移动一个键值对到node结点中
-    // 3. 更新父节点中的相关信息，并且修改移动键值对对应孩子结点的父结点信息（maintain_child函数）
-    // 注意：neighbor_node的位置不同，需要移动的键值对不同，需要分类讨论
-    // 因为node节点被删除，缺一个，兄弟节点给出一个
-    // node(left) neighbor(right)
-    if (index == 0) {
-        node->insert_pair(node->get_size(), neighbor_node->get_key(0), neighbor_node->get_rid(0));
-        neighbor_node->erase_pair(0);
-        // 更新父节点 index + 1 对应为右兄弟节点的第一个 key
-        // 以满足小于 index + 1 的 key 指向 node，大于等于 index + 1 的 key 指向 neighbor
-        parent->set_key(index + 1, neighbor_node->get_key(0));
-        // maintain_parent(neighbor_node);
-        // 叶子节点才需要更新孩子节点的父节点信息
-        maintain_child(node, node->get_size() - 1);
-    } else {
-        // neighbor(left) node(right)
-        node->insert_pair(0, neighbor_node->get_last_key(), neighbor_node->get_last_rid());
-        neighbor_node->erase_pair(neighbor_node->get_size() - 1);
-        parent->set_key(index, node->get_key(0));
-        // maintain_parent(node);
-        // 叶子节点才需要更新孩子节点的父节点信息
-        maintain_child(node, 0);
-    }
-}
-
-/**
- * @brief 合并(Coalesce)函数是将node和其直接前驱进行合并，也就是和它左边的neighbor_node进行合并；
- * 假设node一定在右边。如果上层传入的index=0，说明node在左边，那么交换node和neighbor_node，保证node在右边；合并到左结点，实际上就是删除了右结点；
- * Move all the key & value pairs from one page to its sibling page, and notify buffer pool manager to delete this page.
- * Parent page must be adjusted to take info of deletion into account. Remember to deal with coalesce or redistribute
- * recursively if necessary.
- *
- * @param neighbor_node sibling page of input "node" (neighbor_node是node的前结点)
- * @param node input from method coalesceOrRedistribute() (node结点是需要被删除的)
- * @param parent parent page of input "node"
- * @param index node在parent中的rid_idx
- * @return true means parent node should be deleted, false means no deletion happend
- * @note Assume that *neighbor_node is the left sibling of *node (neighbor -> node)
- */
-bool IxIndexHandle::coalesce(std::shared_ptr<IxNodeHandle> *neighbor_node, std::shared_ptr<IxNodeHandle> *node,
-                             std::shared_ptr<IxNodeHandle> *parent, int index,
-                             Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 用index判断neighbor_node是否为node的前驱结点，若不是则交换两个结点，让neighbor_node作为左结点，node作为右结点
-    // 2. 把node结点的键值对移动到neighbor_node中，并更新node结点孩子结点的父节点信息（调用maintain_child函数）
-    // 3. 释放和删除node结点，并删除parent中node结点的信息，返回parent是否需要被删除
-    // 提示：如果是叶子结点且为最右叶子结点，需要更新file_hdr_.last_leaf
-    // 判断neighbor_node是否为node的前驱结点
-    if (index == 0) {
-        // 非前驱，交换
-        std::swap(neighbor_node, node);
-        ++index;
-    }
-    // neighbor(left) node(right)
-    auto &node_ = *node;
-    auto &neighbor_node_ = *neighbor_node;
-    auto &&prev_size = neighbor_node_->get_size();
-    neighbor_node_->insert_pairs(prev_size, node_->keys, node_->rids, node_->get_size());
-
-    // 非叶子节点才需要维护node结点孩子结点的父节点信息
-    if (node_->is_internal_page()) {
-        for (int pos = prev_size; pos < neighbor_node_->get_size(); ++pos) {
-            maintain_child(neighbor_node_, pos);
-        }
-    } else {
-        // 是叶子节点，维护叶子兄弟节点前后关系
-        erase_leaf(node_);
-        if (node_->get_page_no() == file_hdr_->last_leaf_) {
-            // 如果是叶子结点且为最右叶子结点，需要更新file_hdr_.last_leaf
-            file_hdr_->last_leaf_ = neighbor_node_->get_page_no();
+void IxIndexHandle::remove_node(std::shared_ptr<IxNodeHandle> &node, std::shared_ptr<IxNodeHandle> &parent, int index,
+                                Transaction *transaction) {
+    if (node->is_leaf_page()) {
+        if (node->get_page_no() == file_hdr_->last_leaf_) {
+            update_last_leaf(node->get_prev_leaf());
         }
+        erase_leaf(node);
     }
-
-    // 释放和删除node结点
-    transaction->append_index_deleted_page((*node_).page);
-    release_node_handle(*node_);
-    // 并删除parent中node结点的信息
-    (*parent)->erase_pair(index);
-    return coalesce_or_redistribute(*parent, transaction, root_is_latched);
+    if (transaction != nullptr) {
+        transaction->append_index_deleted_page(node->page);
+    }
+    parent->erase_pair(index);
 }
 
 /**
- * @brief 用于处理合并和重分配的逻辑，用于删除键值对后调用
+ * @brief 用于处理合并和删除结点的逻辑，用于删除键值对后调用
+ * 结点占用的字节数过少时，和兄弟结点（优先选取前驱结点）合并成左边的结点，合并后放不下就保持不变；
+ * 结点删空且没能合并时直接从父结点中删除，第一个叶子结点除外，叶子链表总是从它开始。
+ * key是变长的，兄弟结点之间不重新分配键值对：重新分配会换一个可能更长的分隔key，父结点可能因此需要分裂
  *
  * @param node 执行完删除操作的结点
  * @param transaction 事务指针
- * @param root_is_latched 传出参数：根节点是否上锁，用于并发操作
- * @return 是否需要删除结点
- * @note User needs to first find the sibling of input page.
- * If sibling's size + input page's size >= 2 * page's minsize, then redistribute.
- * Otherwise, merge(Coalesce).
+ * @return 是否从B+树中删除了结点
  */
-bool IxIndexHandle::coalesce_or_redistribute(std::shared_ptr<IxNodeHandle> &node, Transaction *transaction,
-                                             bool *root_is_latched) {
-    // Todo:
-    // 1. 判断node结点是否为根节点
-    //    1.1 如果是根节点，需要调用AdjustRoot() 函数来进行处理，返回根节点是否需要被删除
-    //    1.2 如果不是根节点，并且不需要执行合并或重分配操作，则直接返回false，否则执行2
-    // 2. 获取node结点的父亲结点
-    // 3. 寻找node结点的兄弟结点（优先选取前驱结点）
-    // 4. 如果node结点和兄弟结点的键值对数量之和，能够支撑两个B+树结点（即node.size+neighbor.size >=
-    // NodeMinSize*2)，则只需要重新分配键值对（调用Redistribute函数）
-    // 5. 如果不满足上述条件，则需要合并两个结点，将右边的结点合并到左边的结点（调用Coalesce函数）
+bool IxIndexHandle::coalesce_or_remove(std::shared_ptr<IxNodeHandle> &node, Transaction *transaction) {
     if (node->is_root_page()) {
-        // 1.1 如果是根节点，需要调用AdjustRoot() 函数来进行处理，返回根节点是否需要被删除
         bool is_delete = adjust_root(node);
-        if (*root_is_latched) {
-            root_latch_.unlock();
-            *root_is_latched = false;
-        }
-        // !TODO 完善并发事务
         release_all_index_latch_page(transaction);
         return is_delete;
     }
-
-    // 如果不是根节点，并且不需要执行合并或重分配操作，大于等于半满，不需要合并或重分配
-    if (node->get_size() >= node->get_min_size()) {
+    if (node->get_size() > 0 && !node->is_underfull()) {
         release_all_index_latch_page(transaction);
         return false;
     }
 
     auto &&parent_node = fetch_node(node->get_parent_page_no());
-    auto &&index = parent_node->find_child(node);
-    // 有父节点必然有兄弟节点，优先选择左兄弟节点
-    auto &&neighbor_node = fetch_node(parent_node->value_at(index == 0 ? 1 : index - 1));
-    neighbor_node->page->WLatch();
-
-    // 如果node结点和兄弟结点的键值对数量之和，能够支撑两个B+树结点，只需重分配
-    if (node->get_size() + neighbor_node->get_size() >= node->get_min_size() << 1) {
-        // 可以提前释放根锁了
-        if (*root_is_latched) {
-            root_latch_.unlock();
-            *root_is_latched = false;
+    int index = parent_node->find_child(node);
+    bool removed = false;
+    if (parent_node->get_size() > 1) {
+        auto &&neighbor_node = fetch_node(parent_node->value_at(index == 0 ? 1 : index - 1));
+        neighbor_node->page->WLatch();
+        // 合并到左边的结点，删除右边的结点
+        auto &left = index == 0 ? node : neighbor_node;
+        auto &right = index == 0 ? neighbor_node : node;
+        int right_index = index == 0 ? 1 : index;
+        IxEntries entries(file_hdr_->col_tot_len_);
+        left->collect(0, left->get_size(), &entries);
+        int left_size = entries.size();
+        right->collect(0, right->get_size(), &entries);
+        if (right->is_internal_page() && right->get_size() > 0) {
+            // 右边结点的第一个key不参与查找，合并后换成父结点中的分隔key
+            parent_node->get_key(right_index, entries.key(left_size));
+        }
+        if (left->rebuild_bytes(entries, 0, entries.size()) <= PAGE_SIZE - left->max_entry_size()) {
+            left->rebuild(entries, 0, entries.size());
+            for (int i = left_size; i < entries.size(); ++i) {
+                maintain_child(left, i);
+            }
+            remove_node(right, parent_node, right_index, transaction);
+            removed = true;
         }
-        redistribute(neighbor_node, node, parent_node, index);
-        release_all_index_latch_page(transaction);
-        buffer_pool_manager_->unpin_page(parent_node->get_page_id(), true);
         neighbor_node->page->WUnlatch();
         buffer_pool_manager_->unpin_page(neighbor_node->get_page_id(), true);
-        return false;
     }
-
-    // 对指针取地址，用于交换两个指针指向的内容
-    if (coalesce(&neighbor_node, &node, &parent_node, index, transaction, root_is_latched)) {
-        // 要删除父节点
-        if (transaction != nullptr) {
-            transaction->append_index_deleted_page(parent_node->page);
-        }
+    if (!removed && node->get_size() == 0 && node->get_page_no() != file_hdr_->first_leaf_) {
+        remove_node(node, parent_node, index, transaction);
+        removed = true;
     }
 
+    if (removed) {
+        coalesce_or_remove(parent_node, transaction);
+    } else {
+        release_all_index_latch_page(transaction);
+    }
     buffer_pool_manager_->unpin_page(parent_node->get_page_id(), true);
-    neighbor_node->page->WUnlatch();
-    buffer_pool_manager_->unpin_page(neighbor_node->get_page_id(), true);
-    return true;
+    return removed;
 }
 
 /**
@@ -820,8 +877,10 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  * 可用*(int *)key转换回去
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
-    auto &&leaf_node = find_leaf_page(key, Operation::FIND, nullptr, false).first;
-    auto &&pos = leaf_node->lower_bound(key);
+    std::vector<char> ekey(file_hdr_->col_tot_len_);
+    encode_key(key, ekey.data());
+    auto &&leaf_node = find_leaf_page(ekey.data(), Operation::FIND, nullptr, false);
+    auto &&pos = leaf_node->lower_bound(ekey.data());
     Iid iid{};
     if (pos == leaf_node->get_size()) {
         if (leaf_node->get_page_no() == file_hdr_->last_leaf_) {
@@ -846,11 +905,13 @@ Iid IxIndexHandle::lower_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
-    auto &&leaf_node = find_leaf_page(key, Operation::FIND, nullptr, false).first;
-    auto &&pos = leaf_node->upper_bound(key);
+    std::vector<char> ekey(file_hdr_->col_tot_len_);
+    encode_key(key, ekey.data());
+    auto &&leaf_node = find_leaf_page(ekey.data(), Operation::FIND, nullptr, false);
+    auto &&pos = leaf_node->upper_bound(ekey.data());
     Iid iid{};
     // 如果第一个比他大的在第 0 个 key
-    if (pos == 1 && Compare(key, leaf_node->get_key(0)) < 0) {
+    if (pos == 1 && leaf_node->compare_key(ekey.data(), 0) < 0) {
         --pos;
     }
     if (pos == leaf_node->get_size()) {
@@ -886,12 +947,19 @@ Iid IxIndexHandle::leaf_end() const {
 
 /**
  * @brief 指向第一个叶子的第一个结点
- * 用处在于可以作为IxScan的第一个
+ * 用处在于可以作为IxScan的第一个。第一个叶子结点删空以后仍然保留，这时从下一个叶子开始
  *
  * @return Iid
  */
 Iid IxIndexHandle::leaf_begin() const {
     Iid iid = {.page_no = file_hdr_->first_leaf_, .slot_no = 0};
+    auto node = fetch_node(iid.page_no);
+    node->page->RLatch();
+    if (node->get_size() == 0 && iid.page_no != file_hdr_->last_leaf_) {
+        iid.page_no = node->get_next_leaf();
+    }
+    node->page->RUnlatch();
+    buffer_pool_manager_->unpin_page(node->get_page_id(), false);
     return iid;
 }
 
@@ -904,7 +972,7 @@ Iid IxIndexHandle::leaf_begin() const {
  */
 std::shared_ptr<IxNodeHandle> IxIndexHandle::fetch_node(int page_no) const {
     auto *page = buffer_pool_manager_->fetch_page({fd_, page_no});
-    return std::make_shared<IxNodeHandle>(file_hdr_, page);
+    return std::make_shared<IxNodeHandle>(file_hdr_, page, log_manager_ != nullptr ? this : nullptr);
 }
 
 /**
@@ -922,30 +990,7 @@ std::shared_ptr<IxNodeHandle> IxIndexHandle::create_node() {
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
     // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
     auto *page = buffer_pool_manager_->new_page(&new_page_id);
-    return std::make_shared<IxNodeHandle>(file_hdr_, page);
-}
-
-/**
- * @brief 从node开始更新其父节点的第一个key，一直向上更新直到根节点
- *
- * @param node
- */
-void IxIndexHandle::maintain_parent(std::shared_ptr<IxNodeHandle> &node) {
-    auto curr = node;
-    while (curr->get_parent_page_no() != IX_NO_PAGE) {
-        // Load its parent
-        auto parent = fetch_node(curr->get_parent_page_no());
-        int rank = parent->find_child(curr);
-        char *parent_key = parent->get_key(rank);
-        char *child_first_key = curr->get_key(0);
-        if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
-            break;
-        }
-        memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_); // 修改了parent node
-        curr = parent;
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
-    }
+    return std::make_shared<IxNodeHandle>(file_hdr_, page, log_manager_ != nullptr ? this : nullptr);
 }
 
 /**
@@ -966,12 +1011,14 @@ void IxIndexHandle::erase_leaf(std::shared_ptr<IxNodeHandle> &leaf) {
 }
 
 /**
- * @brief 删除node时，更新file_hdr_.num_pages
- *
- * @param node
+ * @brief 文件头只在检查点和关闭索引时写回，根结点和最右叶子结点改变后写日志，redo 时恢复到最新值
  */
-void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
-    --file_hdr_->num_pages_;
+void IxIndexHandle::log_file_hdr() {
+    if (log_manager_ == nullptr) {
+        return;
+    }
+    IndexHeaderLogRecord log_record(index_name_, file_hdr_->root_page_, file_hdr_->last_leaf_);
+    log_manager_->add_log_to_buffer(&log_record);
 }
 
 /**
@@ -986,159 +1033,29 @@ void IxIndexHandle::maintain_child(std::shared_ptr<IxNodeHandle> &node, int chil
         buffer_pool_manager_->unpin_page(child->get_page_id(), true);
     }
 }
-
 RmRecord IxIndexHandle::get_key(const Iid &iid) const {
     auto node = fetch_node(iid.page_no);
     if (iid.slot_no >= node->get_size()) {
         buffer_pool_manager_->unpin_page(node->get_page_id(), false);
         throw IndexEntryNotFoundError();
     }
-    RmRecord record(node->get_key(iid.slot_no), file_hdr_->col_tot_len_);
+    std::vector<char> ekey(file_hdr_->col_tot_len_);
+    node->get_key(iid.slot_no, ekey.data());
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+    RmRecord record(file_hdr_->col_tot_len_);
+    ix_decode_key(ekey.data(), record.data, file_hdr_->col_types_, file_hdr_->col_lens_);
     return record;
 }
 
-void IxIndexHandle::create_upper_parent_nodes(char *key, Rid *rid, int first_parent_page_no, int sum) {
-    // 初始化第一个父亲节点
-    int pos = 0;
-
-    auto node = create_node();
-    node->page_hdr->is_leaf = false;
-    char *node_key = node->get_key(0);
-    Rid *node_rid = node->get_rid(0);
-    int tot_len = file_hdr_->col_tot_len_;
-
-    int block = 0;
-    // 计算叶子结点的个数和每块应装入的元组条数
-    // max_size * 0.7 大小 尽可能避免分裂重组
-    int expected_leaf_num = static_cast<int>((file_hdr_->btree_order_ + 1) * 0.9);
-    int blocks = sum / expected_leaf_num + (sum % expected_leaf_num ? 1 : 0);
-    // 调整块数量，确保每个叶子节点半满
-    if (blocks > 1 && (file_hdr_->btree_order_ + 1) / 2 > sum / blocks) {
-        // assert(0);
-        --blocks;
-    }
-
-    // 实际每个叶子上的元组数量
-    int actual_leaf_num = sum / blocks;
-    // 多出来的元组
-    int remaining_leaf_num = sum % blocks;
-
-    int upper_expected_parent_num = static_cast<int>((file_hdr_->btree_order_ + 1) * 0.9);
-    int upper_blocks = blocks / upper_expected_parent_num + (blocks % upper_expected_parent_num ? 1 : 0);
-    // 调整块数量，确保每个叶子节点半满
-    if (upper_blocks > 1 && (file_hdr_->btree_order_ + 1) / 2 > blocks / upper_blocks) {
-        --upper_blocks;
-    }
-
-    // 实际每个父亲节点上的元组数量
-    int actual_upper_parent_num = blocks / upper_blocks;
-    // 多出来的元组
-    int remaining_upper_parent_num = blocks % upper_blocks;
-
-    // 第一个父亲节点页号
-    int parent_page_no = first_parent_page_no + blocks;
-
-    // 只能构成一个节点，即为根节点
-    if (blocks == 1) {
-        node->set_parent_page_no(INVALID_PAGE_ID);
-        file_hdr_->root_page_ = node->get_page_no();
-    } else {
-        // 否则叶子节点指向父亲节点
-        node->set_parent_page_no(parent_page_no);
-    }
-
-    // 设置叶子节点大小
-    node->set_size(actual_leaf_num);
-
-    // 对于父亲节点，孩子节点数量
-    int child_pos = 0;
-
-    // 把每个索引块的第一个元组拷贝，用于父亲节点生成
-    char *key_temp = nullptr;
-    char *key_temp_head = nullptr;
-    Rid *rid_temp = nullptr;
-    Rid *rid_temp_head = nullptr;
-
-    // 只有有父亲节点才需要
-    if (blocks > 1) {
-        key_temp = new char[blocks * tot_len];
-        key_temp_head = key_temp;
-        rid_temp = new Rid[blocks];
-        rid_temp_head = rid_temp;
-    }
-
-    auto *src_key = key;
-    auto *src_rid = rid;
-
-    for (int i = 0; i < sum; i++) {
-        if (pos == actual_leaf_num) {
-            pos = 0;
-            // unpin
-            buffer_pool_manager_->unpin_page(node->get_page_id(), true);
-            // 建立新节点
-            node = create_node();
-            node->page_hdr->is_leaf = false;
-
-            node_key = node->get_key(0);
-            node_rid = node->get_rid(0);
-
-            // 一样的操作
-            if (++block + remaining_leaf_num == blocks) {
-                ++actual_leaf_num;
-            }
-
-            // 设置大小
-            node->set_size(actual_leaf_num);
-
-            // 对于父亲节点，孩子节点数量 + 1
-            if (++child_pos >= actual_upper_parent_num) {
-                // 孩子节点数量设置为 0
-                child_pos = 0;
-                // 父亲节点 + 1
-                // 注意这里的2和起始节点页号有关，parent_page_no - blocks - first_parent_page_no 才是实际父节点块数
-                if (++parent_page_no - blocks - first_parent_page_no == upper_blocks - remaining_upper_parent_num) {
-                    ++actual_upper_parent_num;
-                }
-            }
-            // 指向父亲节点
-            node->set_parent_page_no(parent_page_no);
-        }
-
-        // 注意如果一个叶子节点放满了，跳到下一个叶子头也得拷贝
-        if (pos == 0 && blocks > 1) {
-            // 将每个索引块的第一个元组拷贝一份到临时数组中
-            memcpy(key_temp_head, src_key, tot_len);
-            Rid rid{.page_no = node->get_page_no(), .slot_no = -1};
-            memcpy(rid_temp_head, &rid, sizeof(Rid));
-            key_temp_head += tot_len;
-            // 加一个 rid
-            ++rid_temp_head;
-        }
-
-        // 初始化键值对
-        memcpy(node_key, src_key, tot_len);
-        memcpy(node_rid, src_rid, sizeof(Rid));
-        src_key += tot_len;
-        node_key += tot_len;
-        ++src_rid;
-        ++node_rid;
-        ++pos;
-    }
-
-    delete []key;
-    delete []rid;
-
-    // 没有到根节点，继续递归
-    if (blocks > 1) {
-        buffer_pool_manager_->unpin_page(node->get_page_id(), true);
-        create_upper_parent_nodes(key_temp, rid_temp, first_parent_page_no + blocks, blocks);
-    } else {
-        file_hdr_->root_page_ = node->get_page_no();
-        buffer_pool_manager_->unpin_page(node->get_page_id(), true);
-    }
+// 结点中第i个key的第一列，只用于画图
+static int first_col_at(const IxIndexHandle *ih, IxNodeHandle *node, int i) {
+    std::vector<char> ekey(ih->file_hdr_->col_tot_len_), key(ih->file_hdr_->col_tot_len_);
+    node->get_key(i, ekey.data());
+    ix_decode_key(ekey.data(), key.data(), ih->file_hdr_->col_types_, ih->file_hdr_->col_lens_);
+    return *reinterpret_cast<int *>(key.data());
 }
 
+
 void ToGraph(const IxIndexHandle *ih, IxNodeHandle *node, BufferPoolManager *bpm, std::ofstream &out) {
     std::string leaf_prefix("LEAF_");
     std::string internal_prefix("INT_");
@@ -1153,10 +1070,10 @@ void ToGraph(const IxIndexHandle *ih, IxNodeHandle *node, BufferPoolManager *bpm
         // Print data
         out << "<TR><TD COLSPAN=\"" << leaf->get_size() << "\">page_no=" << leaf->get_page_no() << "</TD></TR>\n";
         out << "<TR><TD COLSPAN=\"" << leaf->get_size() << "\">"
-                << "max_size=" << leaf->get_max_size() << ",min_size=" << leaf->get_min_size() << "</TD></TR>\n";
+                << "used_bytes=" << leaf->used_bytes() << "</TD></TR>\n";
         out << "<TR>";
         for (int i = 0; i < leaf->get_size(); i++) {
-            out << "<TD>" << *reinterpret_cast<int *>(leaf->get_key(i)) << "</TD>\n";
+            out << "<TD>" << first_col_at(ih, leaf, i) << "</TD>\n";
         }
         out << "</TR>";
         // Print table end
@@ -1185,11 +1102,11 @@ void ToGraph(const IxIndexHandle *ih, IxNodeHandle *node, BufferPoolManager *bpm
         // Print data
         out << "<TR><TD COLSPAN=\"" << inner->get_size() << "\">page_no=" << inner->get_page_no() << "</TD></TR>\n";
         out << "<TR><TD COLSPAN=\"" << inner->get_size() << "\">"
-                << "max_size=" << inner->get_max_size() << ",min_size=" << inner->get_min_size() << "</TD></TR>\n";
+                << "used_bytes=" << inner->used_bytes() << "</TD></TR>\n";
         out << "<TR>";
         for (int i = 0; i < inner->get_size(); i++) {
             out << "<TD PORT=\"p" << inner->value_at(i) << "\">";
-            out << inner->key_at(i);
+            out << first_col_at(ih, inner, i);
             // if (inner->KeyAt(i) != 0) {  // 原判断条件是if (i > 0)
             //     out << inner->KeyAt(i);
             // } else {
@@ -20,37 +20,118 @@ enum class Operation { FIND = 0, INSERT, DELETE }; // 三种操作：查找、
 
 static const bool binary_search = false;
 
-inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
-    switch (type) {
-        case TYPE_INT: {
-            int ia = *(int *) a;
-            int ib = *(int *) b;
-            return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
-        }
-        case TYPE_FLOAT: {
-            float fa = *(float *) a;
-            float fb = *(float *) b;
-            return (fa < fb) ? -1 : ((fa > fb) ? 1 : 0);
+/**
+ * @description: 把索引键编码成可以直接用 memcmp 比较先后的字节串，长度不变。
+ * int 翻转符号位后按大端存放，float 按 IEEE 754 的位模式调整成无符号序后按大端存放（-0.0 和 0.0 编码相同），字符串原样拷贝
+ */
+inline void ix_encode_key(const char *key, char *out, const std::vector<ColType> &col_types,
+                          const std::vector<int> &col_lens) {
+    for (size_t i = 0; i < col_types.size(); ++i) {
+        uint32_t bits;
+        switch (col_types[i]) {
+            case TYPE_INT:
+                memcpy(&bits, key, sizeof(bits));
+                bits = __builtin_bswap32(bits ^ 0x80000000u);
+                memcpy(out, &bits, sizeof(bits));
+                break;
+            case TYPE_FLOAT: {
+                float val;
+                memcpy(&val, key, sizeof(val));
+                if (val == 0.0f) {
+                    val = 0.0f;
+                }
+                memcpy(&bits, &val, sizeof(bits));
+                bits = __builtin_bswap32(bits & 0x80000000u ? ~bits : bits | 0x80000000u);
+                memcpy(out, &bits, sizeof(bits));
+                break;
+            }
+            default:
+                memcpy(out, key, col_lens[i]);
+                break;
         }
-        case TYPE_STRING:
-            return memcmp(a, b, col_len);
-        default:
-            throw InternalError("Unexpected data type");
+        key += col_lens[i];
+        out += col_lens[i];
     }
 }
 
-inline int ix_compare(const char *a, const char *b, const std::vector<ColType> &col_types,
-                      const std::vector<int> &col_lens) {
-    int offset = 0;
+// ix_encode_key 的逆变换
+inline void ix_decode_key(const char *key, char *out, const std::vector<ColType> &col_types,
+                          const std::vector<int> &col_lens) {
     for (size_t i = 0; i < col_types.size(); ++i) {
-        int res = ix_compare(a + offset, b + offset, col_types[i], col_lens[i]);
-        if (res != 0) return res;
-        offset += col_lens[i];
+        uint32_t bits;
+        switch (col_types[i]) {
+            case TYPE_INT:
+                memcpy(&bits, key, sizeof(bits));
+                bits = __builtin_bswap32(bits) ^ 0x80000000u;
+                memcpy(out, &bits, sizeof(bits));
+                break;
+            case TYPE_FLOAT:
+                memcpy(&bits, key, sizeof(bits));
+                bits = __builtin_bswap32(bits);
+                bits = bits & 0x80000000u ? bits ^ 0x80000000u : ~bits;
+                memcpy(out, &bits, sizeof(bits));
+                break;
+            default:
+                memcpy(out, key, col_lens[i]);
+                break;
+        }
+        key += col_lens[i];
+        out += col_lens[i];
     }
-    return 0;
 }
 
-/* 管理B+树中的每个节点 */
+// 去掉末尾的 0 以后的长度
+inline int ix_trimmed_len(const char *key, int len) {
+    while (len > 0 && key[len - 1] == 0) {
+        --len;
+    }
+    return len;
+}
+
+// 两个key的公共前缀长度
+inline int ix_common_prefix(const char *a, const char *b, int len) {
+    int i = 0;
+    while (i < len && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+/* 重建结点时使用的键值对序列，key都是编码后的完整key */
+class IxEntries {
+    int key_len_;
+    std::string keys_;
+    std::vector<Rid> rids_;
+
+public:
+    explicit IxEntries(int key_len) : key_len_(key_len) {}
+
+    int size() const { return static_cast<int>(rids_.size()); }
+
+    const char *key(int i) const { return keys_.data() + i * key_len_; }
+
+    char *key(int i) { return &keys_[i * key_len_]; }
+
+    const Rid &rid(int i) const { return rids_[i]; }
+
+    void push_back(const char *key, const Rid &rid) {
+        keys_.append(key, key_len_);
+        rids_.push_back(rid);
+    }
+
+    void insert(int pos, const char *key, const Rid &rid) {
+        keys_.insert(pos * key_len_, key, key_len_);
+        rids_.insert(rids_.begin() + pos, rid);
+    }
+};
+
+class IxIndexHandle;
+
+/**
+ * 管理B+树中的每个节点。结点中的key是变长的：叶子结点只存一份所有key的公共前缀，每个key只存去掉前缀和末尾的 0 以后的部分；
+ * 内部结点不压缩前缀，其中的key是分隔key，第 0 个key不参与查找，为空。
+ * 结点按占用的字节数而不是key的个数判断是否需要分裂或合并
+ */
 class IxNodeHandle {
     friend class IxIndexHandle;
     friend class IxScan;
@@ -59,29 +140,79 @@ private:
     const IxFileHdr *file_hdr; // 节点所在文件的头部信息
     Page *page; // 存储节点的页面
     IxPageHdr *page_hdr; // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
-    char *keys; // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
-    Rid *rids; // page->data的第三部分，指针指向首地址
+    IxSlot *slots; // page->data的第二部分，按key有序的槽数组
+    const IxIndexHandle *index_handle_ = nullptr; // 结点所属的B+树，不为空时修改结点需要写日志
+    std::string page_ops_; // 结点的本次修改中还没有写入日志的页面操作
+
+    /**
+     * @description: 写入页面中从dst开始的len个字节，并记录到页面操作中
+     */
+    void write_bytes(char *dst, const char *src, int len) {
+        memcpy(dst, src, len);
+        if (index_handle_ != nullptr && len > 0) {
+            IxPageOp op{IX_OP_WRITE, static_cast<int>(dst - page->get_data()), 0, len};
+            page_ops_.append(reinterpret_cast<const char *>(&op), sizeof(IxPageOp));
+            page_ops_.append(dst, len);
+        }
+    }
+
+    /**
+     * @description: 在页面内移动len个字节，并记录到页面操作中
+     */
+    void move_bytes(char *dst, const char *src, int len) {
+        memmove(dst, src, len);
+        if (index_handle_ != nullptr && len > 0) {
+            IxPageOp op{IX_OP_MOVE, static_cast<int>(dst - page->get_data()), static_cast<int>(src - page->get_data()), len};
+            page_ops_.append(reinterpret_cast<const char *>(&op), sizeof(IxPageOp));
+        }
+    }
+
+    template<typename T>
+    void write_field(T *field, const T &value) {
+        write_bytes(reinterpret_cast<char *>(field), reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    // 把记录下来的页面操作写入日志，并更新页面的lsn
+    void log_page();
+
+    // 结点的公共前缀，放在页面的最末尾
+    const char *prefix() const { return page->get_data() + PAGE_SIZE - page_hdr->prefix_len; }
+
+    // 第i个key去掉前缀以后存储的部分
+    const char *suffix(int i) const { return page->get_data() + slots[i].offset; }
+
+    // 以结点前缀开头的key去掉前缀以后需要存储的长度
+    int suffix_len(const char *key) const {
+        return ix_trimmed_len(key + page_hdr->prefix_len, file_hdr->col_tot_len_ - page_hdr->prefix_len);
+    }
+
+    // 比较以结点前缀开头的key和第i个key，key_len是key去掉末尾的 0 以后的长度
+    int compare_suffix(const char *key, int key_len, int i) const;
+
+    // 一个键值对最多占用的字节数
+    int max_entry_size() const { return sizeof(IxSlot) + file_hdr->col_tot_len_; }
+
+    // 用entries中[begin, end)的键值对重写整个结点，叶子结点重新计算公共前缀
+    void rebuild(const IxEntries &entries, int begin, int end);
 
 public:
     IxNodeHandle() = default;
 
-    IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
+    IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_, const IxIndexHandle *index_handle = nullptr)
+        : file_hdr(file_hdr_), page(page_), index_handle_(index_handle) {
         page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
-        keys = page->get_data() + sizeof(IxPageHdr);
-        rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
+        slots = reinterpret_cast<IxSlot *>(page->get_data() + sizeof(IxPageHdr));
     }
 
-    inline bool isSafe(Operation operation);
+    // 在这个结点的子树中插入或删除 key 以后，是否一定不会修改这个结点的父结点
+    bool isSafe(Operation operation, const char *key);
 
     inline int get_size() { return page_hdr->num_key; }
 
-    inline void set_size(int size) { page_hdr->num_key = size; }
-
-    int get_max_size() { return file_hdr->btree_order_ + 1; }
-
-    int get_min_size() { return get_max_size() / 2; }
-
-    int key_at(int i) { return *(int *) get_key(i); }
+    // 结点占用的字节数
+    inline int used_bytes() const {
+        return sizeof(IxPageHdr) + page_hdr->num_key * sizeof(IxSlot) + page_hdr->key_bytes;
+    }
 
     /* 得到第i个孩子结点的page_no */
     page_id_t value_at(int i) { return get_rid(i)->page_no; }
@@ -96,55 +227,73 @@ public:
 
     inline page_id_t get_parent_page_no() { return page_hdr->parent; }
 
-    inline bool is_leaf_page() { return page_hdr->is_leaf; }
+    inline bool is_leaf_page() const { return page_hdr->is_leaf; }
 
-    inline bool is_internal_page() { return !page_hdr->is_leaf; }
+    inline bool is_internal_page() const { return !page_hdr->is_leaf; }
 
     inline bool is_root_page() { return get_parent_page_no() == IX_NO_PAGE; }
 
-    inline void set_next_leaf(page_id_t page_no) { page_hdr->next_leaf = page_no; }
-
-    inline void set_prev_leaf(page_id_t page_no) { page_hdr->prev_leaf = page_no; }
+    inline void set_next_leaf(page_id_t page_no) {
+        write_field(&page_hdr->next_leaf, page_no);
+        log_page();
+    }
 
-    inline void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
+    inline void set_prev_leaf(page_id_t page_no) {
+        write_field(&page_hdr->prev_leaf, page_no);
+        log_page();
+    }
 
-    inline void set_is_leaf_page(bool val) { page_hdr->is_leaf = val; }
+    inline void set_parent_page_no(page_id_t parent) {
+        write_field(&page_hdr->parent, parent);
+        log_page();
+    }
 
-    inline char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
+    inline void set_is_leaf_page(bool val) {
+        write_field(&page_hdr->is_leaf, val);
+        log_page();
+    }
 
-    inline Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
+    // 把第key_idx个key的完整编码写到out中，out的长度为col_tot_len
+    void get_key(int key_idx, char *out) const;
 
-    inline char *get_last_key() { return get_key(get_size() - 1); }
+    inline Rid *get_rid(int rid_idx) const { return &slots[rid_idx].rid; }
 
     inline Rid *get_last_rid() { return get_rid(get_size() - 1); }
 
-    void set_key(int key_idx, const char *key) {
-        memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_);
+    // key是否以结点的公共前缀开头，不是的话插入key需要重写结点
+    bool has_prefix(const char *key) const {
+        return memcmp(key, prefix(), page_hdr->prefix_len) == 0;
     }
 
-    void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
+    // 比较key和第i个key
+    int compare_key(const char *key, int i) const;
 
     int lower_bound(const char *target) const;
 
     int upper_bound(const char *target) const;
 
-    void insert_pairs(int pos, const char *key, const Rid *rid, int n);
-
     page_id_t internal_lookup(const char *key);
 
     bool leaf_lookup(const char *key, Rid **value);
 
-    std::pair<int, int> insert(const char *key, const Rid &value);
+    // 在pos处插入key以后结点占用的字节数
+    int insert_bytes(int pos, const char *key) const;
 
-    // 用于在结点中的指定位置插入单个键值对
-    void insert_pair(int pos, const char *key, const Rid &rid) { insert_pairs(pos, key, &rid, 1); }
+    // 在指定位置插入单个键值对，调用前要保证 insert_bytes 不超过页面大小
+    void insert_pair(int pos, const char *key, const Rid &rid);
 
-    void insert_pair(int pos, const char *key, const Rid *rid) { insert_pairs(pos, key, rid, 1); }
+    std::pair<int, int> insert(const char *key, const Rid &value);
 
     void erase_pair(int pos);
 
     std::pair<int, int> remove(const char *key);
 
+    // 把[begin, end)中的键值对按完整的key追加到entries中
+    void collect(int begin, int end, IxEntries *entries) const;
+
+    // 用entries中[begin, end)的键值对重写结点以后占用的字节数
+    int rebuild_bytes(const IxEntries &entries, int begin, int end) const;
+
     /**
      * @brief used in internal node to remove the last key in root node, and return the last child
      *
@@ -176,12 +325,14 @@ public:
         return rid_idx;
     }
 
-    inline int Compare(const char *a, const char *b) const {
-        return ix_compare(a, b, file_hdr->col_types_, file_hdr->col_lens_);
+    // 超过这个大小就要分裂，保证再插入一个任意的键值对也放得下
+    inline bool isFull() {
+        return used_bytes() > PAGE_SIZE - max_entry_size();
     }
 
-    inline bool isFull() {
-        return page_hdr->num_key == get_max_size();
+    // 删除后占用的字节数过少，需要尝试和兄弟结点合并
+    inline bool is_underfull() {
+        return used_bytes() < IX_NODE_MERGE_BYTES;
     }
 };
 
@@ -189,6 +340,7 @@ public:
 class IxIndexHandle {
     friend class IxScan;
     friend class IxManager;
+    friend class IxNodeHandle;
 
 public:
     int fd_; // 存储B+树的文件
@@ -198,7 +350,8 @@ private:
     DiskManager *disk_manager_;
     BufferPoolManager *buffer_pool_manager_;
     // IxFileHdr *file_hdr_; // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
-    std::mutex root_latch_;
+    LogManager *log_manager_ = nullptr; // 不为空时结点和文件头的修改都要写日志
+    std::string index_name_; // 索引文件名，日志中用它找到索引
 
     // class Context {
     // public:
@@ -222,6 +375,10 @@ private:
 
     void release_all_index_latch_page(Transaction *);
 
+    std::shared_ptr<IxNodeHandle> fetch_root(bool write, bool leaf_write);
+
+    std::shared_ptr<IxNodeHandle> find_leaf_optimistic(const char *key, Operation operation);
+
 public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
 
@@ -238,8 +395,6 @@ public:
     // for get/create node
     std::shared_ptr<IxNodeHandle> fetch_node(int page_no) const;
 
-    void create_upper_parent_nodes(char *key, Rid *rid, int first_parent_page_no, int sum);
-
     // for safe look empty table
     bool is_empty();
 
@@ -249,9 +404,9 @@ public:
     // for search
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
-    std::pair<std::shared_ptr<IxNodeHandle>, bool> find_leaf_page(const char *key, Operation operation,
-                                                                  Transaction *transaction,
-                                                                  bool find_first = false);
+    // key是编码后的key，其他接口的key都是上层传入的原始key
+    std::shared_ptr<IxNodeHandle> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
+                                                 bool find_first = false);
 
     // check unique
     bool is_unique(const char *key, Rid &value, Transaction *transaction);
@@ -259,7 +414,8 @@ public:
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
 
-    std::shared_ptr<IxNodeHandle> split(std::shared_ptr<IxNodeHandle> &node);
+    std::shared_ptr<IxNodeHandle> split(std::shared_ptr<IxNodeHandle> &node, IxEntries &entries, int split_point,
+                                        char *separator);
 
     void insert_into_parent(std::shared_ptr<IxNodeHandle> &old_node, const char *key,
                             std::shared_ptr<IxNodeHandle> &new_node, Transaction *transaction);
@@ -267,17 +423,12 @@ public:
     // for delete
     bool delete_entry(const char *key, Transaction *transaction);
 
-    bool coalesce_or_redistribute(std::shared_ptr<IxNodeHandle> &node, Transaction *transaction = nullptr,
-                                  bool *root_is_latched = nullptr);
+    bool coalesce_or_remove(std::shared_ptr<IxNodeHandle> &node, Transaction *transaction = nullptr);
 
     bool adjust_root(std::shared_ptr<IxNodeHandle> &old_root_node);
 
-    void redistribute(std::shared_ptr<IxNodeHandle> &neighbor_node, std::shared_ptr<IxNodeHandle> &node,
-                      std::shared_ptr<IxNodeHandle> &parent, int index);
-
-    bool coalesce(std::shared_ptr<IxNodeHandle> *neighbor_node, std::shared_ptr<IxNodeHandle> *node,
-                  std::shared_ptr<IxNodeHandle> *parent, int index,
-                  Transaction *transaction, bool *root_is_latched);
+    void remove_node(std::shared_ptr<IxNodeHandle> &node, std::shared_ptr<IxNodeHandle> &parent, int index,
+                     Transaction *transaction);
 
     Iid lower_bound(const char *key);
 
@@ -292,20 +443,27 @@ public:
 
 private:
     // 辅助函数
-    void update_root_page_no(page_id_t root) { file_hdr_->root_page_ = root; }
+    void update_root_page_no(page_id_t root) {
+        file_hdr_->root_page_ = root;
+        log_file_hdr();
+    }
+
+    void update_last_leaf(page_id_t last_leaf) {
+        file_hdr_->last_leaf_ = last_leaf;
+        log_file_hdr();
+    }
+
+    void log_file_hdr();
 
     // std::shared_ptr<IxNodeHandle> create_node();
 
     // for maintain data structure
-    void maintain_parent(std::shared_ptr<IxNodeHandle> &node);
-
     void erase_leaf(std::shared_ptr<IxNodeHandle> &leaf);
 
-    void release_node_handle(IxNodeHandle &node);
-
     void maintain_child(std::shared_ptr<IxNodeHandle> &node, int child_idx);
 
-    inline int Compare(const char *a, const char *b) const {
-        return ix_compare(a, b, file_hdr_->col_types_, file_hdr_->col_lens_);
+    // 把上层传入的key编码成结点中存储的形式
+    inline void encode_key(const char *key, char *out) const {
+        ix_encode_key(key, out, file_hdr_->col_types_, file_hdr_->col_lens_);
     }
 };
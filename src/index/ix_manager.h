@@ -68,10 +68,7 @@ public:
         // Open index file
         int fd = disk_manager_->open_file(ix_name);
 
-        // Create file header and write to file
-        // Theoretically we have: |page_hdr| + (|attr| + |rid|) * n <= PAGE_SIZE
-        // but we reserve one slot for convenient inserting and deleting, i.e.
-        // |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE
+        // 结点按字节数存放变长的key，key的总长度只用来限制单个键值对的大小
         int col_tot_len = 0;
         int col_num = index_cols.size();
         for (auto &col: index_cols) {
@@ -80,15 +77,10 @@ public:
         if (col_tot_len > IX_MAX_COL_LEN) {
             throw InvalidColLengthError(col_tot_len);
         }
-        // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
-        // 即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
-        int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
-        assert(btree_order > 2);
 
         // Create file header and write to file
         IxFileHdr *fhdr = new IxFileHdr(IX_NO_PAGE, IX_INIT_NUM_PAGES, IX_INIT_ROOT_PAGE,
-                                        col_num, col_tot_len, btree_order, (btree_order + 1) * col_tot_len,
-                                        IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE);
+                                        col_num, col_tot_len, IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE);
         for (int i = 0; i < col_num; ++i) {
             fhdr->col_types_.emplace_back(index_cols[i].type);
             fhdr->col_lens_.emplace_back(index_cols[i].len);
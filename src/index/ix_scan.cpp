@@ -34,8 +34,12 @@ void IxScan::next() {
     // bpm_->unpin_page(node->page->get_page_id(), false);
 }
 
+// 当前结点已经被扫描持有读锁，直接从结点读取，不再重新 fetch
 Rid IxScan::rid() const {
-    return ih_->get_rid(iid_);
+    if (iid_.slot_no >= cur_node_handle_->get_size()) {
+        throw IndexEntryNotFoundError();
+    }
+    return *cur_node_handle_->get_rid(iid_.slot_no);
 }
 
 // Iid IxScan::prev_iid() {
@@ -86,5 +90,16 @@ Rid IxScan::prev_rid(const Iid &iid) {
 }
 
 RmRecord IxScan::get_key() {
-    return ih_->get_key(iid_);
+    RmRecord record(ih_->file_hdr_->col_tot_len_);
+    get_key(record.data);
+    return record;
+}
+
+void IxScan::get_key(char *out) const {
+    if (iid_.slot_no >= cur_node_handle_->get_size()) {
+        throw IndexEntryNotFoundError();
+    }
+    std::vector<char> ekey(ih_->file_hdr_->col_tot_len_);
+    cur_node_handle_->get_key(iid_.slot_no, ekey.data());
+    ix_decode_key(ekey.data(), out, ih_->file_hdr_->col_types_, ih_->file_hdr_->col_lens_);
 }
@@ -54,4 +54,7 @@ public:
     Rid prev_rid(const Iid &iid);
 
     RmRecord get_key();
+
+    // 把当前位置的key解码到 out 中，out 的长度为索引各列的总长度
+    void get_key(char *out) const;
 };
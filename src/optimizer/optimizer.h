@@ -48,6 +48,10 @@ public:
             // desc table;
             return std::make_shared<OtherPlan>(T_DescTable, std::move(x->tab_name));
         }
+        if (auto x = std::dynamic_pointer_cast<ast::AnalyzeTable>(query->parse)) {
+            // analyze [table];
+            return std::make_shared<OtherPlan>(T_Analyze, std::move(x->tab_name));
+        }
         if (auto x = std::dynamic_pointer_cast<ast::TxnBegin>(query->parse)) {
             // begin;
             return std::make_shared<OtherPlan>(T_Transaction_begin, std::string());
@@ -26,6 +26,7 @@ typedef enum PlanTag {
     T_ShowTable,
     T_ShowIndex,
     T_DescTable,
+    T_Analyze,
     T_CreateTable,
     T_DropTable,
     T_CreateIndex,
@@ -43,6 +44,7 @@ typedef enum PlanTag {
     T_IndexScan,
     T_NestLoop,
     T_SortMerge, // sort merge join
+    T_HashJoin,
     T_Sort,
     T_Projection,
     T_Aggregate,
@@ -82,6 +84,14 @@ public:
     std::vector<std::string> index_col_names_;
     // 顺序扫还是逆序
     bool asc_;
+    // 最多输出的元组数，-1 表示不限制。索引扫描输出够了就提前结束，顺序扫描有 limit 时不并行扫描
+    int limit_{-1};
+    // 索引包含查询用到的这张表的所有列，索引扫描直接用索引中的key构造元组，不回表
+    bool index_only_{false};
+    // 位图扫描：先收集索引范围内的 rid，按页号排序后每个堆页面只读一次
+    bool bitmap_{false};
+    // 位图扫描时再和这些索引上的扫描结果求交集，只回表同时满足各个索引条件的记录
+    std::vector<std::vector<std::string> > and_index_col_names_;
 };
 
 class JoinPlan : public Plan {
@@ -105,17 +115,20 @@ public:
     std::vector<Condition> conds_;
     // future TODO: 后续可以支持的连接类型
     JoinType type;
+    // hash join 时是否在左儿子上建哈希表（较小的一侧）
+    bool build_left_{false};
 };
 
 class ProjectionPlan : public Plan {
 public:
     ProjectionPlan(PlanTag tag, std::shared_ptr<Plan> subplan, std::vector<TabCol> sel_cols,
-                   std::vector<std::string> alias, int limit = -1) {
+                   std::vector<std::string> alias, int limit = -1, int offset = 0) {
         Plan::tag = tag;
         subplan_ = std::move(subplan);
         sel_cols_ = std::move(sel_cols);
         alias_ = std::move(alias);
         limit_ = limit;
+        offset_ = offset;
     }
 
     ~ProjectionPlan() {
@@ -125,23 +138,24 @@ public:
     std::vector<TabCol> sel_cols_;
     std::vector<std::string> alias_;
     int limit_;
+    int offset_;
 };
 
 class SortPlan : public Plan {
 public:
-    SortPlan(PlanTag tag, std::shared_ptr<Plan> subplan, TabCol sel_col, bool is_desc) {
+    SortPlan(PlanTag tag, std::shared_ptr<Plan> subplan, std::vector<OrderCol> order_cols) {
         Plan::tag = tag;
         subplan_ = std::move(subplan);
-        sel_col_ = std::move(sel_col);
-        is_desc_ = is_desc;
+        order_cols_ = std::move(order_cols);
     }
 
     ~SortPlan() {
     }
 
     std::shared_ptr<Plan> subplan_;
-    TabCol sel_col_;
-    bool is_desc_;
+    std::vector<OrderCol> order_cols_; // 排序列，按优先级排列
+    // 大于等于 0 时只需要排在最前面的 limit_ 个元组（Top-N）
+    int limit_{-1};
 };
 
 class AggregatePlan : public Plan {
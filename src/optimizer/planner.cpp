@@ -37,16 +37,31 @@ bool Planner::get_index_cols(std::string &tab_name, std::vector<Condition> &curr
     repelicate_conds_map.reserve(2);
     index_col_names.reserve(tab.indexes.begin()->second.cols.size());
 
+    // 不参与选索引的条件，最后原样接在 fed_conds 后面，由谓词判断
+    std::vector<std::size_t> other_conds;
+    std::size_t num_eligible = 0; // 能用于索引的条件个数
+
     for (std::size_t i = 0; i < curr_conds.size(); ++i) {
+        // 索引只能处理和常量比较的条件，IN 列表、子查询和不等于留给谓词判断
+        if (!curr_conds[i].is_rhs_val || curr_conds[i].is_sub_query || curr_conds[i].op == OP_NE) {
+            other_conds.emplace_back(i);
+            continue;
+        }
+        ++num_eligible;
         auto &col_name = curr_conds[i].lhs_col.col_name;
         if (index_set.count(col_name) == 0) {
             index_set.emplace(col_name);
             conds_map.emplace(col_name, i);
-        } else {
-            repelicate_conds_map.emplace(col_name, i);
+        } else if (!repelicate_conds_map.emplace(col_name, i).second) {
+            // 同一列上的第三个及以后的条件
+            other_conds.emplace_back(i);
         }
     }
 
+    if (index_set.empty()) {
+        return false;
+    }
+
     size_t max_len = 0, max_equals = 0, cur_len = 0, cur_equals = 0;
     for (auto &[index_name, index]: tab.indexes) {
         std::ignore = index_name;
@@ -64,14 +79,14 @@ bool Planner::get_index_cols(std::string &tab_name, std::vector<Condition> &curr
         // 如果有 where a = 1, b = 1, c > 1;
         // index(a, b, c), index(a, b, c, d);
         // 应该匹配最合适的，避免索引查询中带来的额外拷贝开销
-        if (cur_len > max_len && cur_len < curr_conds.size()) {
+        if (cur_len > max_len && cur_len < num_eligible) {
             // 匹配最长的
             max_len = cur_len;
             index_col_names.clear();
             for (size_t i = 0; i < index.cols.size(); ++i) {
                 index_col_names.emplace_back(index.cols[i].second.name);
             }
-        } else if (cur_len == curr_conds.size()) {
+        } else if (cur_len == num_eligible) {
             max_len = cur_len;
             // 最长前缀相等选择等号多的
             if (index_col_names.empty()) {
@@ -134,6 +149,11 @@ bool Planner::get_index_cols(std::string &tab_name, std::vector<Condition> &curr
         fed_conds.emplace_back(std::move(curr_conds[repelicate_conds_map[index_name]]));
     }
 
+    // 连接不能用于索引的
+    for (auto idx: other_conds) {
+        fed_conds.emplace_back(std::move(curr_conds[idx]));
+    }
+
     curr_conds = std::move(fed_conds);
 
     // 检查正确与否
@@ -177,6 +197,17 @@ Planner::pop_conds(std::vector<Condition> &conds, const std::string &tab_names,
     return solved_conds;
 }
 
+/**
+ * @description: 为单表 update/delete 条件中的子查询生成计划，算子生成时会先执行子查询并缓存结果
+ */
+void Planner::generate_sub_query_plans(std::vector<Condition> &conds, Context *context) {
+    for (auto &cond: conds) {
+        if (cond.is_sub_query && cond.sub_query != nullptr) {
+            cond.sub_query_plan = generate_select_plan(cond.sub_query, context);
+        }
+    }
+}
+
 int push_conds(Condition *cond, std::shared_ptr<Plan> &plan) {
     if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
         if (x->tab_name_.compare(cond->lhs_col.tab_name) == 0) {
@@ -267,16 +298,328 @@ std::shared_ptr<Plan> Planner::physical_optimization(std::shared_ptr<Query> &que
     return plan;
 }
 
+/**
+ * @description: 判断连接条件能否作为 hash join 的连接键：两侧列的等值比较，且类型和长度相同
+ */
+bool Planner::can_hash_join(const Condition &cond) {
+    if (!enable_hash_join || cond.op != OP_EQ || cond.is_rhs_val || cond.is_sub_query) {
+        return false;
+    }
+    auto lhs = sm_manager_->db_.get_table(cond.lhs_col.tab_name).get_col(cond.lhs_col.col_name);
+    auto rhs = sm_manager_->db_.get_table(cond.rhs_col.tab_name).get_col(cond.rhs_col.col_name);
+    return lhs->type == rhs->type && lhs->len == rhs->len;
+}
+
+/**
+ * @description: 表的行数，有统计信息时取 ANALYZE 时的行数，否则按数据文件的页数和每页的记录数估计
+ */
+double Planner::base_rows(const std::string &tab_name) {
+    if (auto *tab_stats = sm_manager_->stats_.get_table(tab_name)) {
+        return static_cast<double>(tab_stats->rows);
+    }
+    auto &file_hdr = sm_manager_->fhs_.at(tab_name)->get_file_hdr();
+    return static_cast<double>(file_hdr.num_pages) * file_hdr.num_records_per_page;
+}
+
+static double value_key(const Value &val) {
+    switch (val.type) {
+        case TYPE_INT:
+            return val.int_val;
+        case TYPE_FLOAT:
+            return val.float_val;
+        default:
+            return stats_key(TYPE_STRING, val.str_val.data(), static_cast<int>(val.str_val.size()));
+    }
+}
+
+/**
+ * @description: 估计单表谓词的选择率。有统计信息时用不同值个数和直方图估计，否则等值取 1/10、其他取 1/3
+ */
+double Planner::cond_selectivity(const Condition &cond) {
+    auto *tab_stats = sm_manager_->stats_.get_table(cond.lhs_col.tab_name);
+    auto *col = tab_stats != nullptr ? tab_stats->get_col(cond.lhs_col.col_name) : nullptr;
+    double eq = col != nullptr && col->ndv > 0 ? 1.0 / col->ndv : 0.1;
+    if (cond.op == OP_IN) {
+        return cond.rhs_value_list.empty() ? 1.0 / 3 : std::min(1.0, eq * cond.rhs_value_list.size());
+    }
+    if (!cond.is_rhs_val || col == nullptr) {
+        switch (cond.op) {
+            case OP_EQ: return eq;
+            case OP_NE: return 1 - eq;
+            default: return 1.0 / 3;
+        }
+    }
+    double key = value_key(cond.rhs_val);
+    double below = col->fraction_below(key);
+    switch (cond.op) {
+        case OP_EQ: return key < col->min_val || key > col->max_val ? 0 : eq;
+        case OP_NE: return 1 - eq;
+        case OP_LT: return below;
+        case OP_LE: return std::min(1.0, below + eq);
+        case OP_GT: return std::max(0.0, 1 - below - eq);
+        case OP_GE: return 1 - below;
+        default: return 1.0 / 3;
+    }
+}
+
+/**
+ * @description: 估计连接条件的选择率，等值连接取 1 / max(两侧不同值个数)，没有统计信息时把列当作键
+ */
+double Planner::join_selectivity(const Condition &cond) {
+    if (cond.op != OP_EQ) {
+        return 1.0 / 3;
+    }
+    auto ndv = [&](const TabCol &tab_col) {
+        auto *tab_stats = sm_manager_->stats_.get_table(tab_col.tab_name);
+        auto *col = tab_stats != nullptr ? tab_stats->get_col(tab_col.col_name) : nullptr;
+        return col != nullptr ? static_cast<double>(col->ndv) : base_rows(tab_col.tab_name);
+    };
+    return 1.0 / std::max({ndv(cond.lhs_col), ndv(cond.rhs_col), 1.0});
+}
+
+/**
+ * @description: 估计算子输出的行数
+ */
+double Planner::estimate_rows(const std::shared_ptr<Plan> &plan) {
+    double rows = 0;
+    if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
+        rows = base_rows(x->tab_name_);
+        for (auto &cond: x->conds_) {
+            if (cond.is_rhs_val || cond.is_sub_query) {
+                rows *= cond_selectivity(cond);
+            } else if (cond.rhs_col.tab_name == x->tab_name_) {
+                rows /= 3;
+            }
+        }
+    } else if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+        rows = estimate_rows(x->left_) * estimate_rows(x->right_);
+        for (auto &cond: x->conds_) {
+            rows *= join_selectivity(cond);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
+        rows = estimate_rows(x->subplan_);
+    }
+    return std::max(rows, 1.0);
+}
+
+/**
+ * @description: 估计算子输出的数据量（字节），用于选择 hash join 的 build 侧
+ */
+double Planner::estimate_size(const std::shared_ptr<Plan> &plan) {
+    std::function<double(const std::shared_ptr<Plan> &)> width = [&](const std::shared_ptr<Plan> &node) -> double {
+        if (auto x = std::dynamic_pointer_cast<ScanPlan>(node)) {
+            return static_cast<double>(x->len_);
+        }
+        if (auto x = std::dynamic_pointer_cast<JoinPlan>(node)) {
+            return width(x->left_) + width(x->right_);
+        }
+        if (auto x = std::dynamic_pointer_cast<SortPlan>(node)) {
+            return width(x->subplan_);
+        }
+        return 0;
+    };
+    return estimate_rows(plan) * width(plan);
+}
+
+/**
+ * @description: 估计索引列上的条件命中的行数比例。只有足够有选择性才走索引，否则回表的随机读不如直接顺序扫描；
+ * 没有统计信息时返回 0，总是走索引
+ */
+double Planner::index_selectivity(const std::string &tab_name, const std::vector<Condition> &conds,
+                                  const std::vector<std::string> &index_col_names) {
+    if (sm_manager_->stats_.get_table(tab_name) == nullptr) {
+        return 0;
+    }
+    double selectivity = 1;
+    for (auto &cond: conds) {
+        if (cond.is_rhs_val && std::find(index_col_names.begin(), index_col_names.end(), cond.lhs_col.col_name) !=
+            index_col_names.end()) {
+            selectivity *= cond_selectivity(cond);
+        }
+    }
+    return selectivity;
+}
+
+/**
+ * @description: 单个索引不够有选择性时，选出若干个列互不重叠的索引，扫描结果按 rid 求交集后再回表。
+ * 按估计的选择性从高到低加入，选择性太低的索引不参与
+ * @param {double*} selectivity 传入单个索引的选择性，选中时更新为交集的估计选择性
+ * @return 参与求交集的各个索引的列，第一个选择性最高，为空表示不比单个索引好
+ */
+std::vector<std::vector<std::string> > Planner::choose_and_indexes(const std::string &tab_name,
+                                                                    const std::vector<Condition> &conds,
+                                                                    double *selectivity) {
+    TabMeta &tab = sm_manager_->db_.get_table(tab_name);
+    if (sm_manager_->stats_.get_table(tab_name) == nullptr || tab.indexes.size() < 2) {
+        return {};
+    }
+    // 可以作为索引扫描范围的条件所在的列
+    std::unordered_set<std::string> cond_cols;
+    for (auto &cond: conds) {
+        if (cond.is_rhs_val && !cond.is_sub_query && cond.op != OP_NE && cond.op != OP_IN) {
+            cond_cols.emplace(cond.lhs_col.col_name);
+        }
+    }
+    std::vector<std::pair<double, std::vector<std::string> > > candidates;
+    for (auto &[index_name, index]: tab.indexes) {
+        std::ignore = index_name;
+        if (cond_cols.count(index.cols[0].second.name) == 0) {
+            continue;
+        }
+        std::vector<std::string> cols;
+        for (auto &[_, col]: index.cols) {
+            std::ignore = _;
+            cols.emplace_back(col.name);
+        }
+        double sel = index_selectivity(tab_name, conds, cols);
+        if (sel <= INDEX_AND_MAX_SELECTIVITY) {
+            candidates.emplace_back(sel, std::move(cols));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    // 同一列上的条件只算一次，和已选索引有相同条件列的索引不再加入
+    std::vector<std::vector<std::string> > chosen;
+    std::unordered_set<std::string> used;
+    double combined = 1;
+    for (auto &[sel, cols]: candidates) {
+        if (std::any_of(cols.begin(), cols.end(),
+                        [&](const std::string &col) { return cond_cols.count(col) && used.count(col); })) {
+            continue;
+        }
+        used.insert(cols.begin(), cols.end());
+        combined *= sel;
+        chosen.emplace_back(std::move(cols));
+    }
+    if (chosen.size() < 2 || combined > INDEX_SCAN_MAX_SELECTIVITY || combined >= *selectivity) {
+        return {};
+    }
+    *selectivity = combined;
+    return chosen;
+}
+
+/**
+ * @description: 查询中用到的所有列：投影和聚合列、where 条件、group by、having 和 order by 的列
+ */
+static std::vector<TabCol> used_columns(const Query &query) {
+    std::vector<TabCol> used;
+    for (auto &col: query.cols) {
+        // count(*) 不引用任何列
+        if (!col.col_name.empty()) {
+            used.push_back(col);
+        }
+    }
+    for (auto *conds: {&query.conds, &query.havings}) {
+        for (auto &cond: *conds) {
+            used.push_back(cond.lhs_col);
+            if (!cond.is_rhs_val && !cond.is_sub_query) {
+                used.push_back(cond.rhs_col);
+            }
+        }
+    }
+    used.insert(used.end(), query.group_bys.begin(), query.group_bys.end());
+    for (auto &order: query.sort_bys) {
+        used.push_back(order.col);
+    }
+    return used;
+}
+
+/**
+ * @description: 索引是否覆盖查询用到的 tab_name 表的所有列，覆盖时索引扫描不需要回表
+ */
+bool Planner::index_covers(const std::string &tab_name, const std::vector<std::string> &index_col_names,
+                           const std::vector<TabCol> &used_cols) {
+    return std::all_of(used_cols.begin(), used_cols.end(), [&](const TabCol &col) {
+        return col.tab_name != tab_name ||
+               std::find(index_col_names.begin(), index_col_names.end(), col.col_name) != index_col_names.end();
+    });
+}
+
+/**
+ * @description: 贪心地确定连接顺序：每次选择使中间结果最小的连接条件，优先把一张新表连接到已经连接的表上，
+ * 两侧都已经连接的条件紧跟在后面，作为连接上的过滤条件。make_one_rel 按返回的顺序逐个处理连接条件
+ */
+std::vector<Condition> Planner::order_join_conds(std::vector<Condition> conds,
+                                                 const std::vector<std::shared_ptr<Plan> > &scans) {
+    std::unordered_map<std::string, double> rows;
+    for (auto &scan: scans) {
+        rows.emplace(std::dynamic_pointer_cast<ScanPlan>(scan)->tab_name_, estimate_rows(scan));
+    }
+    std::vector<Condition> ordered;
+    ordered.reserve(conds.size());
+    std::unordered_set<std::string> joined;
+    double cur_rows = 0;
+    while (!conds.empty()) {
+        size_t best = conds.size();
+        double best_rows = 0;
+        bool best_connects = false;
+        for (size_t i = 0; i < conds.size(); ++i) {
+            auto &lhs_tab = conds[i].lhs_col.tab_name;
+            auto &rhs_tab = conds[i].rhs_col.tab_name;
+            bool connects = joined.count(lhs_tab) > 0 || joined.count(rhs_tab) > 0;
+            double est = connects
+                             ? cur_rows * rows[joined.count(lhs_tab) > 0 ? rhs_tab : lhs_tab]
+                             : rows[lhs_tab] * rows[rhs_tab];
+            est *= join_selectivity(conds[i]);
+            if (best == conds.size() || (connects && !best_connects) ||
+                (connects == best_connects && est < best_rows)) {
+                best = i;
+                best_rows = est;
+                best_connects = connects;
+            }
+        }
+        cur_rows = best_connects || joined.empty() ? best_rows : cur_rows * best_rows;
+        joined.emplace(conds[best].lhs_col.tab_name);
+        joined.emplace(conds[best].rhs_col.tab_name);
+        ordered.emplace_back(std::move(conds[best]));
+        conds.erase(conds.begin() + static_cast<long>(best));
+
+        for (auto it = conds.begin(); it != conds.end();) {
+            if (joined.count(it->lhs_col.tab_name) > 0 && joined.count(it->rhs_col.tab_name) > 0) {
+                cur_rows *= join_selectivity(*it);
+                ordered.emplace_back(std::move(*it));
+                it = conds.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    return ordered;
+}
+
+std::shared_ptr<Plan> Planner::make_hash_join(std::shared_ptr<Plan> left, std::shared_ptr<Plan> right,
+                                              std::vector<Condition> conds) {
+    bool build_left = estimate_size(left) < estimate_size(right);
+    auto join = std::make_shared<JoinPlan>(T_HashJoin, std::move(left), std::move(right), std::move(conds));
+    join->build_left_ = build_left;
+    return join;
+}
+
 std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> &query, Context *context) {
     auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
     std::vector<std::string> tables = std::move(query->tables);
     // // Scan table , 生成表算子列表tab_nodes
     std::vector<std::shared_ptr<Plan> > table_scan_executors(tables.size());
+    // 在条件被按表拆开之前收集查询用到的列，用来判断索引能不能覆盖查询
+    auto used_cols = used_columns(*query);
     for (size_t i = 0; i < tables.size(); i++) {
         auto curr_conds = pop_conds(query->conds, tables[i], context);
         // int index_no = get_indexNo(tables[i], curr_conds);
         std::vector<std::string> index_col_names;
         bool index_exist = get_index_cols(tables[i], curr_conds, index_col_names);
+        // 覆盖索引不回表，没有随机读，条件的选择性不高也比顺序扫描整张表好
+        bool index_only = index_exist && index_covers(tables[i], index_col_names, used_cols);
+        double selectivity = index_exist ? index_selectivity(tables[i], curr_conds, index_col_names) : 1;
+        // 单个索引不够有选择性时，尝试多个索引的 rid 交集
+        std::vector<std::vector<std::string> > and_indexes;
+        if (!index_only && selectivity > BITMAP_SCAN_MIN_SELECTIVITY) {
+            and_indexes = choose_and_indexes(tables[i], curr_conds, &selectivity);
+        }
+        if (!and_indexes.empty()) {
+            index_exist = true;
+            index_col_names = std::move(and_indexes[0]);
+            and_indexes.erase(and_indexes.begin());
+        }
+        index_exist = index_exist && (index_only || selectivity <= INDEX_SCAN_MAX_SELECTIVITY);
         if (index_exist == false) {
             // 该表没有索引
             index_col_names.clear();
@@ -289,29 +632,41 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> &query, Conte
             // 如果有索引，且是 min，max 聚合直接优化成 orderby + limit，就不用走聚合算子了
             // select min(no_o_id)/max(no_o_id) as min_o_id from new_orders where no_d_id=:d_id and no_w_id=:w_id;
             // select no_o_id as min_o_id from new_orders where no_d_id=:d_id and no_w_id=:w_id order by no_o_id limit 1;
-            if (curr_conds.size() <= index_col_names.size() && query->agg_types.size() == 1) {
+            // 聚合只输出一行，用户写的 limit 0 仍然不输出
+            // 下面两种情况依赖索引的顺序输出，不能改成按 rid 顺序回表的位图扫描，多个索引求交集时也不做
+            bool keep_order = false;
+            if (and_indexes.empty() && curr_conds.size() <= index_col_names.size() &&
+                query->agg_types.size() == 1) {
                 if (query->agg_types[0] == AGG_MIN) {
                     query->asc = true;
-                    query->limit = 1;
+                    query->limit = query->limit == 0 ? 0 : 1;
                     query->agg_types[0] = AGG_COL;
+                    keep_order = true;
                 } else if (query->agg_types[0] == AGG_MAX) {
                     query->asc = false;
-                    query->limit = 1;
+                    query->limit = query->limit == 0 ? 0 : 1;
                     query->agg_types[0] = AGG_COL;
+                    keep_order = true;
                 }
             }
-            if (x->has_sort) {
+            // 索引扫描只支持正向输出，降序还是要排序
+            if (and_indexes.empty() && x->has_sort && query->sort_bys.size() == 1 && !query->sort_bys[0].is_desc) {
                 for (auto &cond: curr_conds) {
-                    if (cond.lhs_col == query->sort_bys || cond.rhs_col == query->sort_bys) {
+                    if (cond.lhs_col == query->sort_bys[0].col || cond.rhs_col == query->sort_bys[0].col) {
                         x->has_sort = false;
+                        keep_order = true;
                         break;
                     }
                 }
             }
-            table_scan_executors[i] =
-                    std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, std::move(tables[i]), std::move(curr_conds),
-                                               std::move(index_col_names),
-                                               query->asc);
+            auto scan = std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, std::move(tables[i]),
+                                                   std::move(curr_conds), std::move(index_col_names), query->asc);
+            scan->index_only_ = index_only;
+            // 命中的行较多时按 key 的顺序回表会在堆文件里来回随机读，改为按页号顺序回表
+            scan->bitmap_ = !index_only && ((!keep_order && selectivity > BITMAP_SCAN_MIN_SELECTIVITY) ||
+                                            !and_indexes.empty());
+            scan->and_index_col_names_ = std::move(and_indexes);
+            table_scan_executors[i] = std::move(scan);
         }
     }
     // TODO 这里先假设子查询不需要 join
@@ -321,6 +676,14 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> &query, Conte
     }
     // 获取where条件
     auto conds = std::move(query->conds);
+    // 所有表都有统计信息时，按估计的中间结果大小重排连接顺序，否则按条件书写的顺序连接
+    if (tables.size() > 2 && std::all_of(table_scan_executors.begin(), table_scan_executors.end(),
+                                         [&](const std::shared_ptr<Plan> &scan) {
+                                             auto &tab_name = std::dynamic_pointer_cast<ScanPlan>(scan)->tab_name_;
+                                             return sm_manager_->stats_.get_table(tab_name) != nullptr;
+                                         })) {
+        conds = order_join_conds(std::move(conds), table_scan_executors);
+    }
     std::shared_ptr<Plan> table_join_executors;
 
     int scantbl[tables.size()];
@@ -339,15 +702,18 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> &query, Conte
             std::vector<Condition> join_conds{*it};
             left = pop_scan(scantbl, it->lhs_col.tab_name, joined_tables, table_scan_executors);
             right = pop_scan(scantbl, it->rhs_col.tab_name, joined_tables, table_scan_executors);
+            // 等值连接走 hash join，不需要把扫描改成索引扫描或者给两侧加 sort 来保证有序
+            bool hash_join = can_hash_join(join_conds[0]);
             // 检查左连接条件上是否有索引
             auto left_plan = std::dynamic_pointer_cast<ScanPlan>(left);
             std::vector<std::string> index_col_names;
             // TODO 这里是优化成index
-            if (left_plan->tag != T_IndexScan) {
+            if (!hash_join && left_plan->tag != T_IndexScan) {
                 bool index_exist = get_index_cols(it->lhs_col.tab_name, join_conds, index_col_names);
                 if (index_exist) {
                     left_plan->tag = T_IndexScan;
                     left_plan->conds_.emplace(left_plan->conds_.begin(), join_conds[0]);
+                    left_plan->index_only_ = index_covers(left_plan->tab_name_, index_col_names, used_cols);
                     left_plan->index_col_names_ = std::move(index_col_names);
                 }
                 index_col_names.clear();
@@ -358,48 +724,52 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> &query, Conte
             auto right_conds = join_conds;
             std::swap(right_conds[0].lhs_col, right_conds[0].rhs_col);
             auto right_plan = std::dynamic_pointer_cast<ScanPlan>(right);
-            if (right_plan->tag != T_IndexScan) {
+            if (!hash_join && right_plan->tag != T_IndexScan) {
                 bool index_exist = get_index_cols(it->rhs_col.tab_name, right_conds, index_col_names);
                 if (index_exist) {
                     right_plan->tag = T_IndexScan;
                     right_plan->conds_.emplace(right_plan->conds_.begin(), std::move(right_conds[0]));
+                    right_plan->index_only_ = index_covers(right_plan->tab_name_, index_col_names, used_cols);
                     right_plan->index_col_names_ = std::move(index_col_names);
                 }
                 index_col_names.clear();
             }
 
             // TODO 优化 sort 转索引
-            if (x->has_sort) {
+            // 只有单列排序才能借助连接列的顺序
+            if (!hash_join && x->has_sort && query->sort_bys.size() == 1) {
+                auto &sort_col = query->sort_bys[0].col;
+                bool sort_desc = query->sort_bys[0].is_desc;
                 if (left->tag != T_IndexScan && right->tag == T_IndexScan) {
                     // 为左列生成 sort
-                    if (join_conds[0].lhs_col == query->sort_bys || join_conds[0].rhs_col == query->sort_bys) {
+                    if (join_conds[0].lhs_col == sort_col || join_conds[0].rhs_col == sort_col) {
                         // TODO 检查排序列是否就是连接列，检查排序列上是否有索引
-                        left = std::make_shared<SortPlan>(T_Sort, std::move(left), it->lhs_col,
-                                                          x->order->orderby_dir == ast::OrderBy_DESC);
+                        left = std::make_shared<SortPlan>(T_Sort, std::move(left),
+                                                          std::vector<OrderCol>{{it->lhs_col, sort_desc}});
                         // 不用再生成 sort 算子来排序了
                         x->has_sort = false;
                     }
                 } else if (left->tag == T_IndexScan && right->tag != T_IndexScan) {
                     // 为右列生成 sort
-                    if (join_conds[0].lhs_col == query->sort_bys || join_conds[0].rhs_col == query->sort_bys) {
+                    if (join_conds[0].lhs_col == sort_col || join_conds[0].rhs_col == sort_col) {
                         // TODO 检查排序列是否就是连接列，检查排序列上是否有索引
-                        right = std::make_shared<SortPlan>(T_Sort, std::move(right), it->rhs_col,
-                                                           x->order->orderby_dir == ast::OrderBy_DESC);
+                        right = std::make_shared<SortPlan>(T_Sort, std::move(right),
+                                                           std::vector<OrderCol>{{it->rhs_col, sort_desc}});
                         // 不用再生成 sort 算子来排序了
                         x->has_sort = false;
                     }
                 } else if (left->tag != T_IndexScan && right->tag != T_IndexScan) {
-                    if (join_conds[0].lhs_col == query->sort_bys || join_conds[0].rhs_col == query->sort_bys) {
+                    if (join_conds[0].lhs_col == sort_col || join_conds[0].rhs_col == sort_col) {
                         // TODO 检查排序列是否就是连接列，检查排序列上是否有索引
-                        left = std::make_shared<SortPlan>(T_Sort, std::move(left), it->lhs_col,
-                                                          x->order->orderby_dir == ast::OrderBy_DESC);
-                        right = std::make_shared<SortPlan>(T_Sort, std::move(right), it->rhs_col,
-                                                           x->order->orderby_dir == ast::OrderBy_DESC);
+                        left = std::make_shared<SortPlan>(T_Sort, std::move(left),
+                                                          std::vector<OrderCol>{{it->lhs_col, sort_desc}});
+                        right = std::make_shared<SortPlan>(T_Sort, std::move(right),
+                                                           std::vector<OrderCol>{{it->rhs_col, sort_desc}});
                         // 不用再生成 sort 算子来排序了
                         x->has_sort = false;
                     }
                 } else if (left->tag == T_IndexScan && right->tag == T_IndexScan) {
-                    if (join_conds[0].lhs_col == query->sort_bys || join_conds[0].rhs_col == query->sort_bys) {
+                    if (join_conds[0].lhs_col == sort_col || join_conds[0].rhs_col == sort_col) {
                         x->has_sort = false;
                     }
                 }
@@ -407,7 +777,9 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> &query, Conte
 
             // 建立join
             // 判断使用哪种join方式
-            if (enable_nestedloop_join && enable_sortmerge_join) {
+            if (hash_join) {
+                table_join_executors = make_hash_join(std::move(left), std::move(right), std::move(join_conds));
+            } else if (enable_nestedloop_join && enable_sortmerge_join) {
                 // 默认nested loop join
                 table_join_executors = std::make_shared<JoinPlan>(T_NestLoop, std::move(left), std::move(right),
                                                                   std::move(join_conds));
@@ -456,10 +828,17 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> &query, Conte
 
             if (left_need_to_join_executors != nullptr && right_need_to_join_executors != nullptr) {
                 std::vector<Condition> join_conds{std::move(*it)};
-                std::shared_ptr<Plan> temp_join_executors = std::make_shared<JoinPlan>(T_NestLoop,
-                    std::move(left_need_to_join_executors),
-                    std::move(right_need_to_join_executors),
-                    join_conds);
+                std::shared_ptr<Plan> temp_join_executors;
+                if (can_hash_join(join_conds[0])) {
+                    temp_join_executors = make_hash_join(std::move(left_need_to_join_executors),
+                                                         std::move(right_need_to_join_executors),
+                                                         std::move(join_conds));
+                } else {
+                    temp_join_executors = std::make_shared<JoinPlan>(T_NestLoop,
+                                                                     std::move(left_need_to_join_executors),
+                                                                     std::move(right_need_to_join_executors),
+                                                                     join_conds);
+                }
                 table_join_executors = std::make_shared<JoinPlan>(T_NestLoop, std::move(temp_join_executors),
                                                                   std::move(table_join_executors),
                                                                   std::vector<Condition>());
@@ -473,8 +852,14 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> &query, Conte
                     left_need_to_join_executors = std::move(right_need_to_join_executors);
                 }
                 std::vector<Condition> join_conds{std::move(*it)};
-                table_join_executors = std::make_shared<JoinPlan>(T_NestLoop, std::move(left_need_to_join_executors),
-                                                                  std::move(table_join_executors), join_conds);
+                if (can_hash_join(join_conds[0])) {
+                    table_join_executors = make_hash_join(std::move(left_need_to_join_executors),
+                                                          std::move(table_join_executors), std::move(join_conds));
+                } else {
+                    table_join_executors = std::make_shared<JoinPlan>(T_NestLoop,
+                                                                      std::move(left_need_to_join_executors),
+                                                                      std::move(table_join_executors), join_conds);
+                }
             } else {
                 push_conds(std::move(&(*it)), table_join_executors);
             }
@@ -515,8 +900,7 @@ std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> &query,
     //         sel_col = {.tab_name = col.tab_name, .col_name = col.name};
     //     }
     // }
-    return std::make_shared<SortPlan>(T_Sort, std::move(plan), std::move(query->sort_bys),
-                                      x->order->orderby_dir == ast::OrderBy_DESC);
+    return std::make_shared<SortPlan>(T_Sort, std::move(plan), std::move(query->sort_bys));
 }
 
 std::shared_ptr<Plan> Planner::generate_select_plan(std::shared_ptr<Query> &query, Context *context) {
@@ -545,9 +929,21 @@ std::shared_ptr<Plan> Planner::generate_select_plan(std::shared_ptr<Query> &quer
                                                       std::move(query->havings));
     }
 
+    // limit 下推：没有聚合时，排序只需要保留前 limit + offset 个元组，
+    // 单表扫描（索引扫描的顺序已经满足 order by）输出这么多元组后就可以结束
+    if (!is_agg && query->limit >= 0) {
+        int keep = query->limit + query->offset;
+        if (auto sort = std::dynamic_pointer_cast<SortPlan>(plannerRoot)) {
+            sort->limit_ = keep;
+        } else if (auto scan = std::dynamic_pointer_cast<ScanPlan>(plannerRoot)) {
+            scan->limit_ = keep;
+        }
+    }
+
     // TODO 待会处理别名
     return std::make_shared<ProjectionPlan>(T_Projection, std::move(plannerRoot),
-                                            std::move(sel_cols), std::move(query->alias), query->limit);
+                                            std::move(sel_cols), std::move(query->alias), query->limit,
+                                            query->offset);
 }
 
 // 生成DDL语句和DML语句的查询执行计划
@@ -597,6 +993,7 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> &query, Context
         // delete;
         // 生成表扫描方式
         std::shared_ptr<Plan> table_scan_executors;
+        generate_sub_query_plans(query->conds, context);
         // 只有一张表，不需要进行物理优化了
         // int index_no = get_indexNo(x->tab_name, query->conds);
         std::vector<std::string> index_col_names;
@@ -621,6 +1018,7 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> &query, Context
         // update;
         // 生成表扫描方式
         std::shared_ptr<Plan> table_scan_executors;
+        generate_sub_query_plans(query->conds, context);
         // 只有一张表，不需要进行物理优化了
         // int index_no = get_indexNo(x->tab_name, query->conds);
         std::vector<std::string> index_col_names;
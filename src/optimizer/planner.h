@@ -36,6 +36,8 @@ private:
 
     bool enable_nestedloop_join = false;
     bool enable_sortmerge_join = true;
+    // 等值连接优先使用 hash join
+    bool enable_hash_join = true;
 
 public:
     Planner(SmManager *sm_manager) : sm_manager_(sm_manager) {
@@ -47,6 +49,8 @@ public:
 
     void set_enable_sortmerge_join(bool set_val) { enable_sortmerge_join = set_val; }
 
+    void set_enable_hash_join(bool set_val) { enable_hash_join = set_val; }
+
     void set_enable_output_file(bool set_val) { enable_output_file = set_val; }
 
     // 是否把输入写入 output.txt 文件中，默认开启
@@ -59,6 +63,34 @@ private:
 
     std::shared_ptr<Plan> make_one_rel(std::shared_ptr<Query> &query, Context *context);
 
+    bool can_hash_join(const Condition &cond);
+
+    double base_rows(const std::string &tab_name);
+
+    double cond_selectivity(const Condition &cond);
+
+    double join_selectivity(const Condition &cond);
+
+    double estimate_rows(const std::shared_ptr<Plan> &plan);
+
+    double estimate_size(const std::shared_ptr<Plan> &plan);
+
+    double index_selectivity(const std::string &tab_name, const std::vector<Condition> &conds,
+                             const std::vector<std::string> &index_col_names);
+
+    std::vector<std::vector<std::string> > choose_and_indexes(const std::string &tab_name,
+                                                              const std::vector<Condition> &conds,
+                                                              double *selectivity);
+
+    static bool index_covers(const std::string &tab_name, const std::vector<std::string> &index_col_names,
+                             const std::vector<TabCol> &used_cols);
+
+    std::vector<Condition> order_join_conds(std::vector<Condition> conds,
+                                            const std::vector<std::shared_ptr<Plan> > &scans);
+
+    std::shared_ptr<Plan> make_hash_join(std::shared_ptr<Plan> left, std::shared_ptr<Plan> right,
+                                         std::vector<Condition> conds);
+
     static std::shared_ptr<Plan> generate_sort_plan(std::shared_ptr<Query> &query, std::shared_ptr<Plan> &plan);
 
     std::shared_ptr<Plan> generate_select_plan(std::shared_ptr<Query> &query, Context *context);
@@ -68,6 +100,8 @@ private:
 
     std::vector<Condition> pop_conds(std::vector<Condition> &conds, const std::string &tab_names, Context *context);
 
+    void generate_sub_query_plans(std::vector<Condition> &conds, Context *context);
+
     bool get_index_cols(std::string &tab_name, std::vector<Condition> &curr_conds,
                         std::vector<std::string> &index_col_names);
 
@@ -43,7 +43,7 @@ namespace ast {
     };
 
     enum SetKnobType {
-        EnableNestLoop, EnableSortMerge, EnableOutputFile
+        EnableNestLoop, EnableSortMerge, EnableOutputFile, EnableHashJoin
     };
 
     // Base class for tree nodes
@@ -64,6 +64,16 @@ namespace ast {
         }
     };
 
+    // analyze [table]; 收集统计信息，表名为空时收集所有表
+    struct AnalyzeTable : public TreeNode {
+        std::string tab_name;
+
+        AnalyzeTable() = default;
+
+        explicit AnalyzeTable(std::string &tab_name_) : tab_name(std::move(tab_name_)) {
+        }
+    };
+
     struct TxnBegin : public TreeNode {
     };
 
@@ -232,6 +242,15 @@ namespace ast {
         }
     };
 
+    // LIMIT count [OFFSET offset]，也支持 LIMIT offset, count
+    struct Limit : public TreeNode {
+        int count;
+        int offset;
+
+        Limit(int count_, int offset_) : count(count_), offset(offset_) {
+        }
+    };
+
     struct LoadStmt : public TreeNode {
         std::string file_name;
         std::string table_name;
@@ -309,20 +328,25 @@ namespace ast {
         std::vector<std::shared_ptr<HavingExpr> > havings;
 
         bool has_sort;
-        std::shared_ptr<OrderBy> order;
+        // ORDER BY 的各列，按优先级排列
+        std::vector<std::shared_ptr<OrderBy> > orders;
+        // 没有 LIMIT 时为 nullptr
+        std::shared_ptr<Limit> limit;
 
         SelectStmt(std::vector<std::shared_ptr<BoundExpr> > &select_list_,
                    std::vector<std::string> &tabs_,
                    std::vector<std::shared_ptr<BinaryExpr> > &conds_,
                    std::vector<std::shared_ptr<Col> > &group_bys_,
                    std::vector<std::shared_ptr<HavingExpr> > &havings_,
-                   std::shared_ptr<OrderBy> &order_) : select_list(std::move(select_list_)),
-                                                       tabs(std::move(tabs_)),
-                                                       conds(std::move(conds_)),
-                                                       group_bys(std::move(group_bys_)),
-                                                       havings(std::move(havings_)),
-                                                       order(std::move(order_)) {
-            has_sort = (bool) order;
+                   std::vector<std::shared_ptr<OrderBy> > &orders_,
+                   std::shared_ptr<Limit> &limit_) : select_list(std::move(select_list_)),
+                                                     tabs(std::move(tabs_)),
+                                                     conds(std::move(conds_)),
+                                                     group_bys(std::move(group_bys_)),
+                                                     havings(std::move(havings_)),
+                                                     orders(std::move(orders_)),
+                                                     limit(std::move(limit_)) {
+            has_sort = !orders.empty();
         }
     };
 
@@ -376,6 +400,9 @@ namespace ast {
         std::vector<std::shared_ptr<BinaryExpr> > sv_conds;
 
         std::shared_ptr<OrderBy> sv_orderby;
+        std::vector<std::shared_ptr<OrderBy> > sv_orderbys;
+
+        std::shared_ptr<Limit> sv_limit;
 
         SetKnobType sv_setKnobType;
     };
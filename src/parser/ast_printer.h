@@ -78,7 +78,8 @@ namespace ast {
             static std::map<SetKnobType, std::string> m{
                 {EnableNestLoop, "EnableNestLoop"},
                 {EnableSortMerge, "EnableSortMerge"},
-                {EnableOutputFile, "EnableOutputFile"}
+                {EnableOutputFile, "EnableOutputFile"},
+                {EnableHashJoin, "EnableHashJoin"}
             };
             return m.at(type);
         }
@@ -109,6 +110,9 @@ namespace ast {
             } else if (auto x = std::dynamic_pointer_cast<ShowIndexs>(node)) {
                 std::cout << "SHOW_INDEXS\n";
                 print_val(x->tab_name, offset);
+            } else if (auto x = std::dynamic_pointer_cast<AnalyzeTable>(node)) {
+                std::cout << "ANALYZE\n";
+                print_val(x->tab_name, offset);
             } else if (auto x = std::dynamic_pointer_cast<CreateTable>(node)) {
                 std::cout << "CREATE_TABLE\n";
                 print_val(x->tab_name, offset);
@@ -1336,6 +1336,18 @@ case 61:
 YY_RULE_SETUP
 #line 123 "lex.l"
 {
+    if (strcasecmp(yytext, "ANALYZE") == 0) {
+        return ANALYZE;
+    }
+    if (strcasecmp(yytext, "LIMIT") == 0) {
+        return LIMIT;
+    }
+    if (strcasecmp(yytext, "OFFSET") == 0) {
+        return OFFSET;
+    }
+    if (strcasecmp(yytext, "ENABLE_HASHJOIN") == 0) {
+        return ENABLE_HASHJOIN;
+    }
     yylval->sv_str = yytext;
     return IDENTIFIER;
 }
@@ -1343,7 +1355,7 @@ YY_RULE_SETUP
 /* literals */
 case 62:
 YY_RULE_SETUP
-#line 128 "lex.l"
+#line 140 "lex.l"
 {
     yylval->sv_int = atoi(yytext);
     return VALUE_INT;
@@ -1351,7 +1363,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 63:
 YY_RULE_SETUP
-#line 132 "lex.l"
+#line 144 "lex.l"
 {
     yylval->sv_float = atof(yytext);
     return VALUE_FLOAT;
@@ -1360,7 +1372,7 @@ YY_RULE_SETUP
 case 64:
 /* rule 64 can match eol */
 YY_RULE_SETUP
-#line 136 "lex.l"
+#line 148 "lex.l"
 {
     yylval->sv_str = std::string(yytext + 1, strlen(yytext) - 2);
     return VALUE_STRING;
@@ -1368,7 +1380,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 65:
 YY_RULE_SETUP
-#line 140 "lex.l"
+#line 152 "lex.l"
 {
     yylval->sv_str = yytext;
     return FILE_PATH;
@@ -1377,18 +1389,18 @@ YY_RULE_SETUP
 /* EOF */
 case YY_STATE_EOF(INITIAL):
 case YY_STATE_EOF(STATE_COMMENT):
-#line 145 "lex.l"
+#line 157 "lex.l"
 { return T_EOF; }
 	YY_BREAK
 /* unexpected char */
 case 66:
 YY_RULE_SETUP
-#line 147 "lex.l"
+#line 159 "lex.l"
 { std::cerr << "Lexer Error: unexpected character " << yytext[0] << std::endl; }
 	YY_BREAK
 case 67:
 YY_RULE_SETUP
-#line 148 "lex.l"
+#line 160 "lex.l"
 ECHO;
 	YY_BREAK
 #line 1395 "lex.yy.cpp"
@@ -2544,6 +2556,6 @@ void yyfree (void * ptr , yyscan_t yyscanner)
 
 #define YYTABLES_NAME "yytables"
 
-#line 148 "lex.l"
+#line 160 "lex.l"
 
 
@@ -1,8 +1,8 @@
-/* A Bison parser, made by GNU Bison 3.5.1.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2020 Free Software Foundation,
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
    Inc.
 
    This program is free software: you can redistribute it and/or modify
@@ -16,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -34,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -41,14 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Undocumented macros, especially those whose name start with YY_,
-   are private implementation details.  Do not rely on them.  */
-
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.5.1"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -66,7 +67,7 @@
 
 
 /* First part of user prologue.  */
-#line 1 "yacc.y"
+#line 1 "/root/repo/src/parser/yacc.y"
 
 #include "ast.h"
 #include "yacc.tab.hpp"
@@ -81,7 +82,7 @@ void yyerror(YYLTYPE *locp, void *yyscanner, const char* s) {
 
 using namespace ast;
 
-#line 85 "yacc.tab.cpp"
+#line 86 "/root/repo/src/parser/yacc.tab.cpp"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -104,112 +105,126 @@ using namespace ast;
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 1
-#endif
-
-/* Use api.header.include to #include this header
-   instead of duplicating it here.  */
-#ifndef YY_YY_YACC_TAB_HPP_INCLUDED
-# define YY_YY_YACC_TAB_HPP_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int yydebug;
-#endif
-
-/* Token type.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    SHOW = 258,
-    TABLES = 259,
-    CREATE = 260,
-    TABLE = 261,
-    DROP = 262,
-    DESC = 263,
-    INSERT = 264,
-    INTO = 265,
-    VALUES = 266,
-    DELETE = 267,
-    FROM = 268,
-    ASC = 269,
-    ORDER = 270,
-    BY = 271,
-    WHERE = 272,
-    UPDATE = 273,
-    SET = 274,
-    SELECT = 275,
-    INT = 276,
-    CHAR = 277,
-    FLOAT = 278,
-    DATETIME = 279,
-    INDEX = 280,
-    AND = 281,
-    JOIN = 282,
-    EXIT = 283,
-    HELP = 284,
-    TXN_BEGIN = 285,
-    TXN_COMMIT = 286,
-    TXN_ABORT = 287,
-    TXN_ROLLBACK = 288,
-    ORDER_BY = 289,
-    ENABLE_NESTLOOP = 290,
-    ENABLE_SORTMERGE = 291,
-    COUNT = 292,
-    MAX = 293,
-    MIN = 294,
-    SUM = 295,
-    AS = 296,
-    GROUP = 297,
-    HAVING = 298,
-    IN = 299,
-    STATIC_CHECKPOINT = 300,
-    LOAD = 301,
-    OUTPUT_FILE = 302,
-    ON = 303,
-    OFF = 304,
-    LEQ = 305,
-    NEQ = 306,
-    GEQ = 307,
-    T_EOF = 308,
-    FILE_PATH = 309,
-    IDENTIFIER = 310,
-    VALUE_STRING = 311,
-    VALUE_INT = 312,
-    VALUE_FLOAT = 313,
-    VALUE_BOOL = 314
-  };
-#endif
-
-/* Value type.  */
-
-/* Location type.  */
-#if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
-typedef struct YYLTYPE YYLTYPE;
-struct YYLTYPE
+#include "yacc.tab.hpp"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
-  int first_line;
-  int first_column;
-  int last_line;
-  int last_column;
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_SHOW = 3,                       /* SHOW  */
+  YYSYMBOL_TABLES = 4,                     /* TABLES  */
+  YYSYMBOL_CREATE = 5,                     /* CREATE  */
+  YYSYMBOL_TABLE = 6,                      /* TABLE  */
+  YYSYMBOL_DROP = 7,                       /* DROP  */
+  YYSYMBOL_DESC = 8,                       /* DESC  */
+  YYSYMBOL_INSERT = 9,                     /* INSERT  */
+  YYSYMBOL_INTO = 10,                      /* INTO  */
+  YYSYMBOL_VALUES = 11,                    /* VALUES  */
+  YYSYMBOL_DELETE = 12,                    /* DELETE  */
+  YYSYMBOL_FROM = 13,                      /* FROM  */
+  YYSYMBOL_ASC = 14,                       /* ASC  */
+  YYSYMBOL_ORDER = 15,                     /* ORDER  */
+  YYSYMBOL_BY = 16,                        /* BY  */
+  YYSYMBOL_WHERE = 17,                     /* WHERE  */
+  YYSYMBOL_UPDATE = 18,                    /* UPDATE  */
+  YYSYMBOL_SET = 19,                       /* SET  */
+  YYSYMBOL_SELECT = 20,                    /* SELECT  */
+  YYSYMBOL_INT = 21,                       /* INT  */
+  YYSYMBOL_CHAR = 22,                      /* CHAR  */
+  YYSYMBOL_FLOAT = 23,                     /* FLOAT  */
+  YYSYMBOL_DATETIME = 24,                  /* DATETIME  */
+  YYSYMBOL_INDEX = 25,                     /* INDEX  */
+  YYSYMBOL_AND = 26,                       /* AND  */
+  YYSYMBOL_JOIN = 27,                      /* JOIN  */
+  YYSYMBOL_EXIT = 28,                      /* EXIT  */
+  YYSYMBOL_HELP = 29,                      /* HELP  */
+  YYSYMBOL_TXN_BEGIN = 30,                 /* TXN_BEGIN  */
+  YYSYMBOL_TXN_COMMIT = 31,                /* TXN_COMMIT  */
+  YYSYMBOL_TXN_ABORT = 32,                 /* TXN_ABORT  */
+  YYSYMBOL_TXN_ROLLBACK = 33,              /* TXN_ROLLBACK  */
+  YYSYMBOL_ORDER_BY = 34,                  /* ORDER_BY  */
+  YYSYMBOL_ENABLE_NESTLOOP = 35,           /* ENABLE_NESTLOOP  */
+  YYSYMBOL_ENABLE_SORTMERGE = 36,          /* ENABLE_SORTMERGE  */
+  YYSYMBOL_COUNT = 37,                     /* COUNT  */
+  YYSYMBOL_MAX = 38,                       /* MAX  */
+  YYSYMBOL_MIN = 39,                       /* MIN  */
+  YYSYMBOL_SUM = 40,                       /* SUM  */
+  YYSYMBOL_AS = 41,                        /* AS  */
+  YYSYMBOL_GROUP = 42,                     /* GROUP  */
+  YYSYMBOL_HAVING = 43,                    /* HAVING  */
+  YYSYMBOL_IN = 44,                        /* IN  */
+  YYSYMBOL_STATIC_CHECKPOINT = 45,         /* STATIC_CHECKPOINT  */
+  YYSYMBOL_LOAD = 46,                      /* LOAD  */
+  YYSYMBOL_OUTPUT_FILE = 47,               /* OUTPUT_FILE  */
+  YYSYMBOL_ON = 48,                        /* ON  */
+  YYSYMBOL_OFF = 49,                       /* OFF  */
+  YYSYMBOL_ANALYZE = 50,                   /* ANALYZE  */
+  YYSYMBOL_LIMIT = 51,                     /* LIMIT  */
+  YYSYMBOL_OFFSET = 52,                    /* OFFSET  */
+  YYSYMBOL_ENABLE_HASHJOIN = 53,           /* ENABLE_HASHJOIN  */
+  YYSYMBOL_LEQ = 54,                       /* LEQ  */
+  YYSYMBOL_NEQ = 55,                       /* NEQ  */
+  YYSYMBOL_GEQ = 56,                       /* GEQ  */
+  YYSYMBOL_T_EOF = 57,                     /* T_EOF  */
+  YYSYMBOL_FILE_PATH = 58,                 /* FILE_PATH  */
+  YYSYMBOL_IDENTIFIER = 59,                /* IDENTIFIER  */
+  YYSYMBOL_VALUE_STRING = 60,              /* VALUE_STRING  */
+  YYSYMBOL_VALUE_INT = 61,                 /* VALUE_INT  */
+  YYSYMBOL_VALUE_FLOAT = 62,               /* VALUE_FLOAT  */
+  YYSYMBOL_VALUE_BOOL = 63,                /* VALUE_BOOL  */
+  YYSYMBOL_64_ = 64,                       /* ';'  */
+  YYSYMBOL_65_ = 65,                       /* '='  */
+  YYSYMBOL_66_ = 66,                       /* '('  */
+  YYSYMBOL_67_ = 67,                       /* ')'  */
+  YYSYMBOL_68_ = 68,                       /* ','  */
+  YYSYMBOL_69_ = 69,                       /* '.'  */
+  YYSYMBOL_70_ = 70,                       /* '<'  */
+  YYSYMBOL_71_ = 71,                       /* '>'  */
+  YYSYMBOL_72_ = 72,                       /* '*'  */
+  YYSYMBOL_YYACCEPT = 73,                  /* $accept  */
+  YYSYMBOL_start = 74,                     /* start  */
+  YYSYMBOL_stmt = 75,                      /* stmt  */
+  YYSYMBOL_txnStmt = 76,                   /* txnStmt  */
+  YYSYMBOL_dbStmt = 77,                    /* dbStmt  */
+  YYSYMBOL_setStmt = 78,                   /* setStmt  */
+  YYSYMBOL_ddl = 79,                       /* ddl  */
+  YYSYMBOL_dml = 80,                       /* dml  */
+  YYSYMBOL_fieldList = 81,                 /* fieldList  */
+  YYSYMBOL_colNameList = 82,               /* colNameList  */
+  YYSYMBOL_field = 83,                     /* field  */
+  YYSYMBOL_type = 84,                      /* type  */
+  YYSYMBOL_valueList = 85,                 /* valueList  */
+  YYSYMBOL_value = 86,                     /* value  */
+  YYSYMBOL_condition = 87,                 /* condition  */
+  YYSYMBOL_optWhereClause = 88,            /* optWhereClause  */
+  YYSYMBOL_whereClause = 89,               /* whereClause  */
+  YYSYMBOL_col = 90,                       /* col  */
+  YYSYMBOL_colList = 91,                   /* colList  */
+  YYSYMBOL_op = 92,                        /* op  */
+  YYSYMBOL_expr = 93,                      /* expr  */
+  YYSYMBOL_setClauses = 94,                /* setClauses  */
+  YYSYMBOL_setClause = 95,                 /* setClause  */
+  YYSYMBOL_asClause = 96,                  /* asClause  */
+  YYSYMBOL_select_item = 97,               /* select_item  */
+  YYSYMBOL_select_list = 98,               /* select_list  */
+  YYSYMBOL_tableList = 99,                 /* tableList  */
+  YYSYMBOL_opt_order_clause = 100,         /* opt_order_clause  */
+  YYSYMBOL_order_clause = 101,             /* order_clause  */
+  YYSYMBOL_order_item = 102,               /* order_item  */
+  YYSYMBOL_opt_limit_clause = 103,         /* opt_limit_clause  */
+  YYSYMBOL_opt_asc_desc = 104,             /* opt_asc_desc  */
+  YYSYMBOL_group_by_clause = 105,          /* group_by_clause  */
+  YYSYMBOL_having_clause = 106,            /* having_clause  */
+  YYSYMBOL_having_clauses = 107,           /* having_clauses  */
+  YYSYMBOL_set_knob_type = 108,            /* set_knob_type  */
+  YYSYMBOL_tbName = 109,                   /* tbName  */
+  YYSYMBOL_colName = 110,                  /* colName  */
+  YYSYMBOL_alias = 111                     /* alias  */
 };
-# define YYLTYPE_IS_DECLARED 1
-# define YYLTYPE_IS_TRIVIAL 1
-#endif
-
-
-
-int yyparse (void *yyscanner);
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-#endif /* !YY_YY_YACC_TAB_HPP_INCLUDED  */
 
 
 
@@ -250,6 +265,18 @@ typedef int_least16_t yytype_int16;
 typedef short yytype_int16;
 #endif
 
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
 #if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
 typedef __UINT_LEAST8_TYPE__ yytype_uint8;
 #elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
@@ -309,6 +336,7 @@ typedef int yytype_uint16;
 
 #define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
 
+
 /* Stored state numbers (used for stacks). */
 typedef yytype_uint8 yy_state_t;
 
@@ -327,6 +355,7 @@ typedef int yy_state_fast_t;
 # endif
 #endif
 
+
 #ifndef YY_ATTRIBUTE_PURE
 # if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
 #  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
@@ -345,17 +374,23 @@ typedef int yy_state_fast_t;
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && ! defined __ICC && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                            \
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
     _Pragma ("GCC diagnostic push")                                     \
     _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
 # define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
@@ -384,7 +419,7 @@ typedef int yy_state_fast_t;
 
 #define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if 1
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -449,8 +484,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* 1 */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -516,27 +550,29 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  53
+#define YYFINAL  56
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   217
+#define YYLAST   225
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  69
+#define YYNTOKENS  73
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  37
+#define YYNNTS  39
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  102
+#define YYNRULES  111
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  207
+#define YYNSTATES  221
 
-#define YYUNDEFTOK  2
-#define YYMAXUTOK   314
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   318
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex, with out-of-bounds checking.  */
-#define YYTRANSLATE(YYX)                                                \
-  (0 <= (YYX) && (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex.  */
@@ -546,9 +582,9 @@ static const yytype_int8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      62,    63,    68,     2,    64,     2,    65,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,    60,
-      66,    61,    67,     2,     2,     2,     2,     2,     2,     2,
+      66,    67,    72,     2,    68,     2,    69,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,    64,
+      70,    65,    71,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -573,273 +609,285 @@ static const yytype_int8 yytranslate[] =
       25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
       35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
       45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
-      55,    56,    57,    58,    59
+      55,    56,    57,    58,    59,    60,    61,    62,    63
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,    65,    65,    70,    75,    80,    85,    90,    98,    99,
-     100,   101,   102,   106,   110,   114,   118,   125,   129,   136,
-     143,   147,   151,   155,   159,   163,   170,   174,   178,   182,
-     186,   193,   197,   204,   208,   215,   222,   226,   230,   234,
-     241,   245,   252,   256,   260,   264,   271,   275,   283,   286,
-     293,   297,   304,   308,   315,   319,   326,   330,   334,   338,
-     342,   346,   350,   357,   361,   365,   372,   376,   383,   387,
-     394,   399,   405,   409,   413,   417,   421,   425,   432,   436,
-     440,   447,   451,   455,   462,   467,   473,   480,   484,   489,
-     495,   500,   506,   510,   515,   521,   526,   532,   536,   540,
-     546,   548,   550
+       0,    67,    67,    72,    77,    82,    87,    92,   100,   101,
+     102,   103,   104,   108,   112,   116,   120,   127,   131,   135,
+     139,   146,   153,   157,   161,   165,   169,   173,   180,   184,
+     188,   192,   196,   203,   207,   214,   218,   225,   232,   236,
+     240,   244,   251,   255,   262,   266,   270,   274,   281,   285,
+     293,   296,   303,   307,   314,   318,   325,   329,   336,   340,
+     344,   348,   352,   356,   360,   367,   371,   375,   382,   386,
+     393,   397,   404,   409,   415,   419,   423,   427,   431,   435,
+     442,   446,   450,   457,   461,   465,   472,   477,   483,   487,
+     494,   501,   505,   509,   514,   520,   524,   529,   535,   540,
+     546,   550,   555,   561,   566,   572,   576,   580,   584,   590,
+     592,   594
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 1
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if 1
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "SHOW", "TABLES", "CREATE", "TABLE",
-  "DROP", "DESC", "INSERT", "INTO", "VALUES", "DELETE", "FROM", "ASC",
-  "ORDER", "BY", "WHERE", "UPDATE", "SET", "SELECT", "INT", "CHAR",
-  "FLOAT", "DATETIME", "INDEX", "AND", "JOIN", "EXIT", "HELP", "TXN_BEGIN",
-  "TXN_COMMIT", "TXN_ABORT", "TXN_ROLLBACK", "ORDER_BY", "ENABLE_NESTLOOP",
-  "ENABLE_SORTMERGE", "COUNT", "MAX", "MIN", "SUM", "AS", "GROUP",
-  "HAVING", "IN", "STATIC_CHECKPOINT", "LOAD", "OUTPUT_FILE", "ON", "OFF",
-  "LEQ", "NEQ", "GEQ", "T_EOF", "FILE_PATH", "IDENTIFIER", "VALUE_STRING",
-  "VALUE_INT", "VALUE_FLOAT", "VALUE_BOOL", "';'", "'='", "'('", "')'",
-  "','", "'.'", "'<'", "'>'", "'*'", "$accept", "start", "stmt", "txnStmt",
-  "dbStmt", "setStmt", "ddl", "dml", "fieldList", "colNameList", "field",
-  "type", "valueList", "value", "condition", "optWhereClause",
-  "whereClause", "col", "colList", "op", "expr", "setClauses", "setClause",
-  "asClause", "select_item", "select_list", "tableList",
-  "opt_order_clause", "order_clause", "opt_asc_desc", "group_by_clause",
+  "\"end of file\"", "error", "\"invalid token\"", "SHOW", "TABLES",
+  "CREATE", "TABLE", "DROP", "DESC", "INSERT", "INTO", "VALUES", "DELETE",
+  "FROM", "ASC", "ORDER", "BY", "WHERE", "UPDATE", "SET", "SELECT", "INT",
+  "CHAR", "FLOAT", "DATETIME", "INDEX", "AND", "JOIN", "EXIT", "HELP",
+  "TXN_BEGIN", "TXN_COMMIT", "TXN_ABORT", "TXN_ROLLBACK", "ORDER_BY",
+  "ENABLE_NESTLOOP", "ENABLE_SORTMERGE", "COUNT", "MAX", "MIN", "SUM",
+  "AS", "GROUP", "HAVING", "IN", "STATIC_CHECKPOINT", "LOAD",
+  "OUTPUT_FILE", "ON", "OFF", "ANALYZE", "LIMIT", "OFFSET",
+  "ENABLE_HASHJOIN", "LEQ", "NEQ", "GEQ", "T_EOF", "FILE_PATH",
+  "IDENTIFIER", "VALUE_STRING", "VALUE_INT", "VALUE_FLOAT", "VALUE_BOOL",
+  "';'", "'='", "'('", "')'", "','", "'.'", "'<'", "'>'", "'*'", "$accept",
+  "start", "stmt", "txnStmt", "dbStmt", "setStmt", "ddl", "dml",
+  "fieldList", "colNameList", "field", "type", "valueList", "value",
+  "condition", "optWhereClause", "whereClause", "col", "colList", "op",
+  "expr", "setClauses", "setClause", "asClause", "select_item",
+  "select_list", "tableList", "opt_order_clause", "order_clause",
+  "order_item", "opt_limit_clause", "opt_asc_desc", "group_by_clause",
   "having_clause", "having_clauses", "set_knob_type", "tbName", "colName",
   "alias", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_int16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-     295,   296,   297,   298,   299,   300,   301,   302,   303,   304,
-     305,   306,   307,   308,   309,   310,   311,   312,   313,   314,
-      59,    61,    40,    41,    44,    46,    60,    62,    42
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF (-166)
+#define YYPACT_NINF (-156)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF (-101)
+#define YYTABLE_NINF (-110)
 
 #define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-     122,    11,    48,    12,   -39,    10,     9,   -39,    75,    41,
-    -166,  -166,  -166,  -166,  -166,  -166,    -6,  -166,    53,     3,
-    -166,  -166,  -166,  -166,  -166,  -166,    61,   -39,   -39,  -166,
-     -39,   -39,  -166,  -166,   -39,   -39,    57,  -166,  -166,  -166,
-      -9,    20,    23,    30,    32,    35,  -166,    67,  -166,    -3,
-      63,  -166,   111,  -166,  -166,   -39,    70,    71,  -166,    86,
-     138,   144,   107,  -166,  -166,   105,   -13,   110,   110,   110,
-     112,  -166,   -39,    49,   107,   -39,  -166,   107,   107,   107,
-     104,   110,  -166,  -166,    -8,  -166,   113,  -166,   119,   120,
-     121,   123,   124,  -166,  -166,     8,  -166,  -166,  -166,  -166,
-       6,  -166,    22,    27,  -166,    34,    80,  -166,   162,    51,
-     107,  -166,    88,    67,    67,    67,    67,    67,   -39,   -39,
-     147,  -166,   107,  -166,   128,  -166,  -166,  -166,  -166,   107,
-    -166,  -166,  -166,  -166,  -166,    42,  -166,   110,  -166,  -166,
-    -166,  -166,  -166,  -166,  -166,   101,  -166,  -166,    80,  -166,
-    -166,  -166,  -166,  -166,  -166,  -166,   175,   149,  -166,   136,
-    -166,  -166,    80,  -166,     1,  -166,  -166,  -166,  -166,   110,
-      49,   179,   132,  -166,    41,    56,  -166,   133,    51,   170,
-     182,  -166,  -166,    -2,  -166,   110,   114,    49,   110,   -39,
-    -166,   180,  -166,    51,    33,  -166,     8,   114,  -166,  -166,
-    -166,   147,  -166,   149,   179,   139,  -166
+      81,    12,    11,    17,     4,    54,    59,     4,    97,    57,
+    -156,  -156,  -156,  -156,  -156,  -156,    50,     4,  -156,    70,
+      23,  -156,  -156,  -156,  -156,  -156,  -156,   115,     4,     4,
+    -156,     4,     4,  -156,  -156,     4,     4,   135,  -156,  -156,
+    -156,  -156,    -8,    89,   105,   106,   108,    94,  -156,   123,
+    -156,    -3,   109,  -156,   165,  -156,  -156,  -156,     4,   110,
+     111,  -156,   113,   169,   164,   124,  -156,  -156,   119,   -13,
+     125,   125,   125,   126,  -156,     4,    10,   124,     4,  -156,
+     124,   124,   124,   120,   125,  -156,  -156,     5,  -156,   122,
+    -156,   121,   127,   128,   129,   130,  -156,  -156,    -6,  -156,
+    -156,  -156,  -156,   -53,  -156,    98,   -16,  -156,     9,    74,
+    -156,   163,    86,   124,  -156,    43,   123,   123,   123,   123,
+     123,     4,     4,   149,  -156,   124,  -156,   132,  -156,  -156,
+    -156,  -156,   124,  -156,  -156,  -156,  -156,  -156,    24,  -156,
+     125,  -156,  -156,  -156,  -156,  -156,  -156,  -156,    99,  -156,
+    -156,    74,  -156,  -156,  -156,  -156,  -156,  -156,  -156,   176,
+     150,  -156,   138,  -156,  -156,    74,  -156,    19,  -156,  -156,
+    -156,  -156,   125,    10,   185,   134,  -156,    57,    85,  -156,
+     136,    86,   177,   186,   154,  -156,    -1,  -156,   125,   107,
+      10,   125,   145,  -156,     4,  -156,   187,  -156,    86,    47,
+     140,  -156,   -23,    -6,   107,  -156,  -156,  -156,   125,   148,
+     151,   149,  -156,  -156,  -156,  -156,   150,   185,   154,   143,
+    -156
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
        0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       6,     5,    13,    14,    15,    16,     0,     7,     0,     0,
-      11,     8,    12,     9,    10,    17,     0,     0,     0,    21,
-       0,     0,   100,    23,     0,     0,     0,    97,    98,    99,
-       0,     0,     0,     0,     0,   101,    78,    71,    79,     0,
-       0,    53,     0,     1,     2,     0,     0,     0,    22,     0,
-       0,    48,     0,     4,     3,     0,     0,     0,     0,     0,
-       0,    72,     0,     0,     0,     0,    18,     0,     0,     0,
-       0,     0,    28,   101,    48,    66,     0,    19,     0,     0,
-       0,     0,     0,   102,    70,    48,    81,    80,    52,    26,
-       0,    31,     0,     0,    33,     0,     0,    50,    49,     0,
-       0,    29,     0,    71,    71,    71,    71,    71,     0,     0,
-      91,    20,     0,    36,     0,    38,    39,    35,    24,     0,
-      25,    44,    42,    43,    45,     0,    40,     0,    62,    60,
-      59,    61,    56,    57,    58,     0,    67,    68,     0,    73,
-      74,    75,    76,    77,    83,    82,     0,    96,    32,     0,
-      34,    27,     0,    51,     0,    63,    64,    46,    69,     0,
-      94,    85,     0,    41,     0,     0,    54,    90,     0,    95,
-       0,    30,    37,     0,    47,     0,     0,     0,     0,     0,
-      55,     0,    92,     0,    89,    84,    48,     0,    88,    87,
-      86,    91,    93,    96,    85,     0,    65
+       6,     5,    13,    14,    15,    16,     0,    19,     7,     0,
+       0,    11,     8,    12,     9,    10,    17,     0,     0,     0,
+      23,     0,     0,   109,    25,     0,     0,     0,   105,   106,
+     108,   107,     0,     0,     0,     0,     0,   110,    80,    73,
+      81,     0,     0,    55,     0,    20,     1,     2,     0,     0,
+       0,    24,     0,     0,    50,     0,     4,     3,     0,     0,
+       0,     0,     0,     0,    74,     0,     0,     0,     0,    18,
+       0,     0,     0,     0,     0,    30,   110,    50,    68,     0,
+      21,     0,     0,     0,     0,     0,   111,    72,    50,    83,
+      82,    54,    28,     0,    33,     0,     0,    35,     0,     0,
+      52,    51,     0,     0,    31,     0,    73,    73,    73,    73,
+      73,     0,     0,    99,    22,     0,    38,     0,    40,    41,
+      37,    26,     0,    27,    46,    44,    45,    47,     0,    42,
+       0,    64,    62,    61,    63,    58,    59,    60,     0,    69,
+      70,     0,    75,    76,    77,    78,    79,    85,    84,     0,
+     104,    34,     0,    36,    29,     0,    53,     0,    65,    66,
+      48,    71,     0,   102,    87,     0,    43,     0,     0,    56,
+      98,     0,   103,     0,    94,    39,     0,    49,     0,     0,
+       0,     0,     0,    32,     0,    57,     0,   100,     0,    97,
+      86,    88,    91,    50,     0,    96,    95,    90,     0,     0,
+       0,    99,   101,    89,    92,    93,   104,    87,    94,     0,
+      67
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-    -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,   125,
-      77,  -166,    37,   -98,    66,   -83,  -166,   -62,  -166,  -165,
-    -148,  -166,    95,    64,   -71,    36,    17,     4,  -166,  -166,
-      13,  -166,    14,  -166,    -4,   -45,  -166
+    -156,  -156,  -156,  -156,  -156,  -156,  -156,  -156,  -156,   131,
+      90,  -156,    44,  -107,    76,   -78,  -156,   -65,  -156,  -155,
+    -151,  -156,   101,    29,   -75,    40,    25,     1,  -156,    13,
+       2,  -156,    14,  -156,     6,  -156,    -4,   -47,  -156
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int16 yydefgoto[] =
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
 {
-      -1,    18,    19,    20,    21,    22,    23,    24,   100,   103,
-     101,   127,   135,   165,   107,    82,   108,    47,   177,   145,
-     167,    84,    85,    71,    48,    49,    95,   181,   195,   200,
-     157,   179,   171,    40,    50,    51,    94
+       0,    19,    20,    21,    22,    23,    24,    25,   103,   106,
+     104,   130,   138,   168,   110,    85,   111,    49,   180,   148,
+     170,    87,    88,    74,    50,    51,    98,   184,   200,   201,
+     193,   207,   160,   182,   174,    42,    52,    53,    97
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
-      33,   111,    97,    36,    89,    90,    91,    92,   136,    81,
-      72,   189,   120,   186,   147,    25,    32,    86,    30,   109,
-      34,   174,    35,    56,    57,    81,    58,    59,   197,    98,
-      60,    61,   102,   104,   104,   118,    26,    31,   192,    63,
-      64,   198,    45,   123,   124,   125,   126,   199,    52,   202,
-     168,    76,    65,    53,    27,    88,   110,   131,   132,   133,
-     134,    73,    73,    54,   173,    86,   136,   148,    96,   121,
-     122,    99,   119,    28,    55,   109,    62,   102,    41,    42,
-      43,    44,    66,   166,   160,    67,    41,    42,    43,    44,
-     128,   129,    68,    29,    69,   138,    45,   130,   129,   178,
-    -100,   139,   140,   141,    45,   161,   162,   176,    70,    46,
-      37,    38,   142,   201,   154,   155,   193,   143,   144,   184,
-     162,    75,    39,   190,   166,     1,   194,     2,    74,     3,
-       4,     5,    77,    78,     6,   166,   131,   132,   133,   134,
-       7,     8,     9,    83,   131,   132,   133,   134,    79,    80,
-      10,    11,    12,    13,    14,    15,    45,   131,   132,   133,
-     134,    81,    83,   164,    87,    45,   106,    93,    16,    45,
-     131,   132,   133,   134,   112,    17,   191,   149,   150,   151,
-     152,   153,   113,   114,   115,    96,   116,   117,   137,   156,
-     159,   169,   170,   172,   180,   182,   187,   185,   188,   158,
-     174,   175,   206,   163,   105,   146,   196,     0,   205,     0,
-     183,     0,     0,     0,   203,     0,     0,   204
+      34,   100,   139,    37,    92,    93,    94,    95,   150,   114,
+      75,    84,   194,    55,   124,   125,    26,    28,    89,   112,
+     123,   121,    84,    31,    59,    60,   189,    61,    62,   209,
+     101,    63,    64,   105,   107,   107,    29,    27,   197,   177,
+      66,    67,    32,   204,   171,   210,    47,    43,    44,    45,
+      46,   131,   132,   212,    79,   205,    30,    68,   176,    91,
+     139,   206,   122,    33,    35,    76,    89,    76,   151,    47,
+      56,    99,    36,   113,   102,   112,   133,   132,   105,   134,
+     135,   136,   137,   169,     1,   163,     2,    57,     3,     4,
+       5,   164,   165,     6,    43,    44,    45,    46,   181,     7,
+       8,     9,    86,   134,   135,   136,   137,   179,    54,    10,
+      11,    12,    13,    14,    15,   198,    47,   157,   158,   126,
+     127,   128,   129,   195,   169,   211,   199,    16,    58,    48,
+     141,    17,    38,    39,   134,   135,   136,   137,    18,   169,
+     142,   143,   144,   199,    40,   152,   153,   154,   155,   156,
+      41,   145,   187,   165,    65,    69,   146,   147,    47,   134,
+     135,   136,   137,  -109,    73,   167,    47,   134,   135,   136,
+     137,    70,    71,   196,    72,    78,    80,    81,    77,    82,
+      83,    84,    90,    86,    47,    96,   109,   115,   116,   140,
+      99,   159,   172,   173,   117,   118,   119,   120,   162,   175,
+     183,   185,   191,   190,   188,   192,   202,   177,   208,   214,
+     220,   178,   215,   108,   149,   161,   166,   186,   218,   203,
+     219,   213,   217,     0,     0,   216
 };
 
 static const yytype_int16 yycheck[] =
 {
-       4,    84,    73,     7,    66,    67,    68,    69,   106,    17,
-      13,    13,    95,   178,   112,     4,    55,    62,     6,    81,
-      10,    20,    13,    27,    28,    17,    30,    31,   193,    74,
-      34,    35,    77,    78,    79,    27,    25,    25,   186,    48,
-      49,     8,    55,    21,    22,    23,    24,    14,    54,   197,
-     148,    55,    61,     0,     6,    68,    64,    56,    57,    58,
-      59,    64,    64,    60,   162,   110,   164,   112,    72,    63,
-      64,    75,    64,    25,    13,   137,    19,   122,    37,    38,
-      39,    40,    62,   145,   129,    62,    37,    38,    39,    40,
-      63,    64,    62,    45,    62,    44,    55,    63,    64,   170,
-      65,    50,    51,    52,    55,    63,    64,   169,    41,    68,
-      35,    36,    61,   196,   118,   119,   187,    66,    67,    63,
-      64,    10,    47,   185,   186,     3,   188,     5,    65,     7,
-       8,     9,    62,    62,    12,   197,    56,    57,    58,    59,
-      18,    19,    20,    55,    56,    57,    58,    59,    62,    11,
-      28,    29,    30,    31,    32,    33,    55,    56,    57,    58,
-      59,    17,    55,    62,    59,    55,    62,    55,    46,    55,
-      56,    57,    58,    59,    61,    53,    62,   113,   114,   115,
-     116,   117,    63,    63,    63,   189,    63,    63,    26,    42,
-      62,    16,    43,    57,    15,    63,    26,    64,    16,   122,
-      20,   164,    63,   137,    79,   110,   189,    -1,   204,    -1,
-     174,    -1,    -1,    -1,   201,    -1,    -1,   203
+       4,    76,   109,     7,    69,    70,    71,    72,   115,    87,
+      13,    17,    13,    17,    67,    68,     4,     6,    65,    84,
+      98,    27,    17,     6,    28,    29,   181,    31,    32,    52,
+      77,    35,    36,    80,    81,    82,    25,    25,   189,    20,
+      48,    49,    25,   198,   151,    68,    59,    37,    38,    39,
+      40,    67,    68,   204,    58,     8,    45,    65,   165,    72,
+     167,    14,    68,    59,    10,    68,   113,    68,   115,    59,
+       0,    75,    13,    68,    78,   140,    67,    68,   125,    60,
+      61,    62,    63,   148,     3,   132,     5,    64,     7,     8,
+       9,    67,    68,    12,    37,    38,    39,    40,   173,    18,
+      19,    20,    59,    60,    61,    62,    63,   172,    58,    28,
+      29,    30,    31,    32,    33,   190,    59,   121,   122,    21,
+      22,    23,    24,   188,   189,   203,   191,    46,    13,    72,
+      44,    50,    35,    36,    60,    61,    62,    63,    57,   204,
+      54,    55,    56,   208,    47,   116,   117,   118,   119,   120,
+      53,    65,    67,    68,    19,    66,    70,    71,    59,    60,
+      61,    62,    63,    69,    41,    66,    59,    60,    61,    62,
+      63,    66,    66,    66,    66,    10,    66,    66,    69,    66,
+      11,    17,    63,    59,    59,    59,    66,    65,    67,    26,
+     194,    42,    16,    43,    67,    67,    67,    67,    66,    61,
+      15,    67,    16,    26,    68,    51,    61,    20,    68,    61,
+      67,   167,    61,    82,   113,   125,   140,   177,   217,   194,
+     218,   208,   216,    -1,    -1,   211
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
        0,     3,     5,     7,     8,     9,    12,    18,    19,    20,
-      28,    29,    30,    31,    32,    33,    46,    53,    70,    71,
-      72,    73,    74,    75,    76,     4,    25,     6,    25,    45,
-       6,    25,    55,   103,    10,    13,   103,    35,    36,    47,
-     102,    37,    38,    39,    40,    55,    68,    86,    93,    94,
-     103,   104,    54,     0,    60,    13,   103,   103,   103,   103,
-     103,   103,    19,    48,    49,    61,    62,    62,    62,    62,
-      41,    92,    13,    64,    65,    10,   103,    62,    62,    62,
-      11,    17,    84,    55,    90,    91,   104,    59,    68,    86,
-      86,    86,    86,    55,   105,    95,   103,    93,   104,   103,
-      77,    79,   104,    78,   104,    78,    62,    83,    85,    86,
-      64,    84,    61,    63,    63,    63,    63,    63,    27,    64,
-      84,    63,    64,    21,    22,    23,    24,    80,    63,    64,
-      63,    56,    57,    58,    59,    81,    82,    26,    44,    50,
-      51,    52,    61,    66,    67,    88,    91,    82,   104,    92,
-      92,    92,    92,    92,   103,   103,    42,    99,    79,    62,
-     104,    63,    64,    83,    62,    82,    86,    89,    82,    16,
-      43,   101,    57,    82,    20,    81,    86,    87,    93,   100,
-      15,    96,    63,    94,    63,    64,    88,    26,    16,    13,
-      86,    62,    89,    93,    86,    97,    95,    88,     8,    14,
-      98,    84,    89,    99,   101,    96,    63
+      28,    29,    30,    31,    32,    33,    46,    50,    57,    74,
+      75,    76,    77,    78,    79,    80,     4,    25,     6,    25,
+      45,     6,    25,    59,   109,    10,    13,   109,    35,    36,
+      47,    53,   108,    37,    38,    39,    40,    59,    72,    90,
+      97,    98,   109,   110,    58,   109,     0,    64,    13,   109,
+     109,   109,   109,   109,   109,    19,    48,    49,    65,    66,
+      66,    66,    66,    41,    96,    13,    68,    69,    10,   109,
+      66,    66,    66,    11,    17,    88,    59,    94,    95,   110,
+      63,    72,    90,    90,    90,    90,    59,   111,    99,   109,
+      97,   110,   109,    81,    83,   110,    82,   110,    82,    66,
+      87,    89,    90,    68,    88,    65,    67,    67,    67,    67,
+      67,    27,    68,    88,    67,    68,    21,    22,    23,    24,
+      84,    67,    68,    67,    60,    61,    62,    63,    85,    86,
+      26,    44,    54,    55,    56,    65,    70,    71,    92,    95,
+      86,   110,    96,    96,    96,    96,    96,   109,   109,    42,
+     105,    83,    66,   110,    67,    68,    87,    66,    86,    90,
+      93,    86,    16,    43,   107,    61,    86,    20,    85,    90,
+      91,    97,   106,    15,   100,    67,    98,    67,    68,    92,
+      26,    16,    51,   103,    13,    90,    66,    93,    97,    90,
+     101,   102,    61,    99,    92,     8,    14,   104,    68,    52,
+      68,    88,    93,   102,    61,    61,   105,   107,   100,   103,
+      67
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
-       0,    69,    70,    70,    70,    70,    70,    70,    71,    71,
-      71,    71,    71,    72,    72,    72,    72,    73,    73,    74,
-      75,    75,    75,    75,    75,    75,    76,    76,    76,    76,
-      76,    77,    77,    78,    78,    79,    80,    80,    80,    80,
-      81,    81,    82,    82,    82,    82,    83,    83,    84,    84,
-      85,    85,    86,    86,    87,    87,    88,    88,    88,    88,
-      88,    88,    88,    89,    89,    89,    90,    90,    91,    91,
-      92,    92,    93,    93,    93,    93,    93,    93,    94,    94,
-      94,    95,    95,    95,    96,    96,    97,    98,    98,    98,
-      99,    99,   100,   100,   100,   101,   101,   102,   102,   102,
-     103,   104,   105
+       0,    73,    74,    74,    74,    74,    74,    74,    75,    75,
+      75,    75,    75,    76,    76,    76,    76,    77,    77,    77,
+      77,    78,    79,    79,    79,    79,    79,    79,    80,    80,
+      80,    80,    80,    81,    81,    82,    82,    83,    84,    84,
+      84,    84,    85,    85,    86,    86,    86,    86,    87,    87,
+      88,    88,    89,    89,    90,    90,    91,    91,    92,    92,
+      92,    92,    92,    92,    92,    93,    93,    93,    94,    94,
+      95,    95,    96,    96,    97,    97,    97,    97,    97,    97,
+      98,    98,    98,    99,    99,    99,   100,   100,   101,   101,
+     102,   103,   103,   103,   103,   104,   104,   104,   105,   105,
+     106,   106,   106,   107,   107,   108,   108,   108,   108,   109,
+     110,   111
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
        0,     2,     2,     3,     3,     1,     1,     1,     1,     1,
-       1,     1,     1,     1,     1,     1,     1,     2,     4,     4,
-       6,     2,     3,     2,     6,     6,     4,     7,     4,     5,
-       8,     1,     3,     1,     3,     2,     1,     4,     1,     1,
-       1,     3,     1,     1,     1,     1,     3,     5,     0,     2,
-       1,     3,     3,     1,     1,     3,     1,     1,     1,     1,
-       1,     1,     1,     1,     1,    10,     1,     3,     3,     4,
-       2,     0,     2,     5,     5,     5,     5,     5,     1,     1,
-       3,     1,     3,     3,     3,     0,     2,     1,     1,     0,
-       3,     0,     3,     5,     0,     2,     0,     1,     1,     1,
-       1,     1,     1
+       1,     1,     1,     1,     1,     1,     1,     2,     4,     1,
+       2,     4,     6,     2,     3,     2,     6,     6,     4,     7,
+       4,     5,     9,     1,     3,     1,     3,     2,     1,     4,
+       1,     1,     1,     3,     1,     1,     1,     1,     3,     5,
+       0,     2,     1,     3,     3,     1,     1,     3,     1,     1,
+       1,     1,     1,     1,     1,     1,     1,    11,     1,     3,
+       3,     4,     2,     0,     2,     5,     5,     5,     5,     5,
+       1,     1,     3,     1,     3,     3,     3,     0,     1,     3,
+       2,     2,     4,     4,     0,     1,     1,     0,     3,     0,
+       3,     5,     0,     2,     0,     1,     1,     1,     1,     1,
+       1,     1
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
@@ -861,10 +909,9 @@ static const yytype_int8 yyr2[] =
       }                                                           \
   while (0)
 
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 /* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
    If N is 0, then set CURRENT to the empty location which ends
@@ -908,12 +955,19 @@ do {                                            \
 } while (0)
 
 
-/* YY_LOCATION_PRINT -- Print the location on the stream.
+/* YYLOCATION_PRINT -- Print the location on the stream.
    This macro was not mandated originally: define only if we know
    we won't break user code: when these are the locations we know.  */
 
-#ifndef YY_LOCATION_PRINT
-# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
 
 /* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
 
@@ -941,24 +995,32 @@ yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
         res += YYFPRINTF (yyo, "-%d", end_col);
     }
   return res;
- }
+}
 
-#  define YY_LOCATION_PRINT(File, Loc)          \
-  yy_location_print_ (File, &(Loc))
+#   define YYLOCATION_PRINT  yy_location_print_
 
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
 
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value, Location, yyscanner); \
+                  Kind, Value, Location, yyscanner); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
@@ -969,20 +1031,17 @@ do {                                                                      \
 `-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, void *yyscanner)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, void *yyscanner)
 {
   FILE *yyoutput = yyo;
-  YYUSE (yyoutput);
-  YYUSE (yylocationp);
-  YYUSE (yyscanner);
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  YY_USE (yyscanner);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyo, yytoknum[yytype], *yyvaluep);
-# endif
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
@@ -992,14 +1051,15 @@ yy_symbol_value_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, YY
 `---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, void *yyscanner)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, void *yyscanner)
 {
   YYFPRINTF (yyo, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  YY_LOCATION_PRINT (yyo, *yylocationp);
+  YYLOCATION_PRINT (yyo, yylocationp);
   YYFPRINTF (yyo, ": ");
-  yy_symbol_value_print (yyo, yytype, yyvaluep, yylocationp, yyscanner);
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp, yyscanner);
   YYFPRINTF (yyo, ")");
 }
 
@@ -1032,7 +1092,8 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule, void *yyscanner)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule, void *yyscanner)
 {
   int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
@@ -1044,9 +1105,9 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule,
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[+yyssp[yyi + 1 - yynrhs]],
-                       &yyvsp[(yyi + 1) - (yynrhs)]
-                       , &(yylsp[(yyi + 1) - (yynrhs)])                       , yyscanner);
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]), yyscanner);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -1061,8 +1122,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -1085,12 +1146,61 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
+/* Context of a parse error.  */
+typedef struct
+{
+  yy_state_t *yyssp;
+  yysymbol_kind_t yytoken;
+  YYLTYPE *yylloc;
+} yypcontext_t;
+
+/* Put in YYARG at most YYARGN of the expected tokens given the
+   current YYCTX, and return the number of tokens stored in YYARG.  If
+   YYARG is null, return the number of expected tokens (guaranteed to
+   be less than YYNTOKENS).  Return YYENOMEM on memory exhaustion.
+   Return 0 if there are more than YYARGN expected tokens, yet fill
+   YYARG up to YYARGN. */
+static int
+yypcontext_expected_tokens (const yypcontext_t *yyctx,
+                            yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  int yyn = yypact[+*yyctx->yyssp];
+  if (!yypact_value_is_default (yyn))
+    {
+      /* Start YYX at -YYN if negative to avoid negative indexes in
+         YYCHECK.  In other words, skip the first -YYN actions for
+         this state because they are default actions.  */
+      int yyxbegin = yyn < 0 ? -yyn : 0;
+      /* Stay within bounds of both yycheck and yytname.  */
+      int yychecklim = YYLAST - yyn + 1;
+      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
+      int yyx;
+      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
+        if (yycheck[yyx + yyn] == yyx && yyx != YYSYMBOL_YYerror
+            && !yytable_value_is_error (yytable[yyx + yyn]))
+          {
+            if (!yyarg)
+              ++yycount;
+            else if (yycount == yyargn)
+              return 0;
+            else
+              yyarg[yycount++] = YY_CAST (yysymbol_kind_t, yyx);
+          }
+    }
+  if (yyarg && yycount == 0 && 0 < yyargn)
+    yyarg[0] = YYSYMBOL_YYEMPTY;
+  return yycount;
+}
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
-#  else
+
+
+
+#ifndef yystrlen
+# if defined __GLIBC__ && defined _STRING_H
+#  define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
+# else
 /* Return the length of YYSTR.  */
 static YYPTRDIFF_T
 yystrlen (const char *yystr)
@@ -1100,13 +1210,13 @@ yystrlen (const char *yystr)
     continue;
   return yylen;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
+#ifndef yystpcpy
+# if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
+#  define yystpcpy stpcpy
+# else
 /* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
    YYDEST.  */
 static char *
@@ -1120,10 +1230,10 @@ yystpcpy (char *yydest, const char *yysrc)
 
   return yyd - 1;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yytnamerr
+#ifndef yytnamerr
 /* Copy to YYRES the contents of YYSTR after stripping away unnecessary
    quotes and backslashes, so that it's suitable for yyerror.  The
    heuristic is that double-quoting is unnecessary unless the string
@@ -1138,7 +1248,6 @@ yytnamerr (char *yyres, const char *yystr)
     {
       YYPTRDIFF_T yyn = 0;
       char const *yyp = yystr;
-
       for (;;)
         switch (*++yyp)
           {
@@ -1172,31 +1281,15 @@ yytnamerr (char *yyres, const char *yystr)
   else
     return yystrlen (yystr);
 }
-# endif
+#endif
 
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
 
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
 static int
-yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
-                yy_state_t *yyssp, int yytoken)
+yy_syntax_error_arguments (const yypcontext_t *yyctx,
+                           yysymbol_kind_t yyarg[], int yyargn)
 {
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat: reported tokens (one for the "unexpected",
-     one per "expected"). */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
   /* Actual size of YYARG. */
   int yycount = 0;
-  /* Cumulated lengths of YYARG.  */
-  YYPTRDIFF_T yysize = 0;
-
   /* There are many possibilities here to consider:
      - If this state is a consistent state with a default action, then
        the only way this function was invoked is if the default action
@@ -1220,52 +1313,54 @@ yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
        one exception: it will still contain any token that will not be
        accepted due to an error action in a later state.
   */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[+*yyssp];
-      YYPTRDIFF_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-      yysize = yysize0;
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYPTRDIFF_T yysize1
-                    = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
-                    yysize = yysize1;
-                  else
-                    return 2;
-                }
-              }
-        }
+  if (yyctx->yytoken != YYSYMBOL_YYEMPTY)
+    {
+      int yyn;
+      if (yyarg)
+        yyarg[yycount] = yyctx->yytoken;
+      ++yycount;
+      yyn = yypcontext_expected_tokens (yyctx,
+                                        yyarg ? yyarg + 1 : yyarg, yyargn - 1);
+      if (yyn == YYENOMEM)
+        return YYENOMEM;
+      else
+        yycount += yyn;
     }
+  return yycount;
+}
+
+/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
+   about the unexpected token YYTOKEN for the state stack whose top is
+   YYSSP.
+
+   Return 0 if *YYMSG was successfully written.  Return -1 if *YYMSG is
+   not large enough to hold the message.  In that case, also set
+   *YYMSG_ALLOC to the required number of bytes.  Return YYENOMEM if the
+   required number of bytes is too large to store.  */
+static int
+yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
+                const yypcontext_t *yyctx)
+{
+  enum { YYARGS_MAX = 5 };
+  /* Internationalized format string. */
+  const char *yyformat = YY_NULLPTR;
+  /* Arguments of yyformat: reported tokens (one for the "unexpected",
+     one per "expected"). */
+  yysymbol_kind_t yyarg[YYARGS_MAX];
+  /* Cumulated lengths of YYARG.  */
+  YYPTRDIFF_T yysize = 0;
+
+  /* Actual size of YYARG. */
+  int yycount = yy_syntax_error_arguments (yyctx, yyarg, YYARGS_MAX);
+  if (yycount == YYENOMEM)
+    return YYENOMEM;
 
   switch (yycount)
     {
-# define YYCASE_(N, S)                      \
+#define YYCASE_(N, S)                       \
       case N:                               \
         yyformat = S;                       \
-      break
+        break
     default: /* Avoid compiler warnings. */
       YYCASE_(0, YY_("syntax error"));
       YYCASE_(1, YY_("syntax error, unexpected %s"));
@@ -1273,17 +1368,23 @@ yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
       YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
       YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
       YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
+#undef YYCASE_
     }
 
+  /* Compute error message size.  Don't count the "%s"s, but reserve
+     room for the terminator.  */
+  yysize = yystrlen (yyformat) - 2 * yycount + 1;
   {
-    /* Don't count the "%s"s in the final size, but reserve room for
-       the terminator.  */
-    YYPTRDIFF_T yysize1 = yysize + (yystrlen (yyformat) - 2 * yycount) + 1;
-    if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
-      yysize = yysize1;
-    else
-      return 2;
+    int yyi;
+    for (yyi = 0; yyi < yycount; ++yyi)
+      {
+        YYPTRDIFF_T yysize1
+          = yysize + yytnamerr (YY_NULLPTR, yytname[yyarg[yyi]]);
+        if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
+          yysize = yysize1;
+        else
+          return YYENOMEM;
+      }
   }
 
   if (*yymsg_alloc < yysize)
@@ -1292,7 +1393,7 @@ yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
       if (! (yysize <= *yymsg_alloc
              && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
         *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
+      return -1;
     }
 
   /* Avoid sprintf, as that infringes on the user's name space.
@@ -1304,7 +1405,7 @@ yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
     while ((*yyp = *yyformat) != '\0')
       if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
         {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
+          yyp += yytnamerr (yyp, yytname[yyarg[yyi++]]);
           yyformat += 2;
         }
       else
@@ -1315,30 +1416,33 @@ yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
   }
   return 0;
 }
-#endif /* YYERROR_VERBOSE */
+
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, void *yyscanner)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, void *yyscanner)
 {
-  YYUSE (yyvaluep);
-  YYUSE (yylocationp);
-  YYUSE (yyscanner);
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
+  YY_USE (yyscanner);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1346,7 +1450,7 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocatio
 int
 yyparse (void *yyscanner)
 {
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 
@@ -1365,55 +1469,50 @@ static YYLTYPE yyloc_default
 YYLTYPE yylloc = yyloc_default;
 
     /* Number of syntax errors so far.  */
-    int yynerrs;
+    int yynerrs = 0;
 
-    yy_state_fast_t yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
-       'yyls': related to locations.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
     yy_state_t yyssa[YYINITDEPTH];
-    yy_state_t *yyss;
-    yy_state_t *yyssp;
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    /* The semantic value stack.  */
+    /* The semantic value stack: array, bottom, top.  */
     YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
-    /* The location stack.  */
+    /* The location stack: array, bottom, top.  */
     YYLTYPE yylsa[YYINITDEPTH];
-    YYLTYPE *yyls;
-    YYLTYPE *yylsp;
-
-    /* The locations where the error started and ended.  */
-    YYLTYPE yyerror_range[3];
-
-    YYPTRDIFF_T yystacksize;
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
   YYLTYPE yyloc;
 
-#if YYERROR_VERBOSE
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
   /* Buffer for error messages, and its allocated size.  */
   char yymsgbuf[128];
   char *yymsg = yymsgbuf;
   YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
-#endif
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
@@ -1421,17 +1520,10 @@ YYLTYPE yylloc = yyloc_default;
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yylsp = yyls = yylsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   yylsp[0] = yylloc;
   goto yysetstate;
 
@@ -1454,10 +1546,11 @@ yysetstate:
   YY_IGNORE_USELESS_CAST_BEGIN
   *yyssp = YY_CAST (yy_state_t, yystate);
   YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
 #if !defined yyoverflow && !defined YYSTACK_RELOCATE
-    goto yyexhaustedlab;
+    YYNOMEM;
 #else
     {
       /* Get the current used size of the three stacks, in elements.  */
@@ -1488,7 +1581,7 @@ yysetstate:
 # else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
@@ -1499,11 +1592,11 @@ yysetstate:
           YY_CAST (union yyalloc *,
                    YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
         YYSTACK_RELOCATE (yyls_alloc, yyls);
-# undef YYSTACK_RELOCATE
+#  undef YYSTACK_RELOCATE
         if (yyss1 != yyssa)
           YYSTACK_FREE (yyss1);
       }
@@ -1523,6 +1616,7 @@ yysetstate:
     }
 #endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
+
   if (yystate == YYFINAL)
     YYACCEPT;
 
@@ -1543,18 +1637,30 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex (&yylval, &yylloc, yyscanner);
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1626,758 +1732,830 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-  case 2:
-#line 66 "yacc.y"
+  case 2: /* start: stmt ';'  */
+#line 68 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = std::move((yyvsp[-1].sv_node));
         YYACCEPT;
     }
-#line 1636 "yacc.tab.cpp"
+#line 1742 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 3:
-#line 71 "yacc.y"
+  case 3: /* start: SET set_knob_type OFF  */
+#line 73 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = std::make_shared<SetStmt>((yyvsp[-1].sv_setKnobType), false);
         YYACCEPT;
     }
-#line 1645 "yacc.tab.cpp"
+#line 1751 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 4:
-#line 76 "yacc.y"
+  case 4: /* start: SET set_knob_type ON  */
+#line 78 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = std::make_shared<SetStmt>((yyvsp[-1].sv_setKnobType), true);
         YYACCEPT;
     }
-#line 1654 "yacc.tab.cpp"
+#line 1760 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 5:
-#line 81 "yacc.y"
+  case 5: /* start: HELP  */
+#line 83 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = std::make_shared<Help>();
         YYACCEPT;
     }
-#line 1663 "yacc.tab.cpp"
+#line 1769 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 6:
-#line 86 "yacc.y"
+  case 6: /* start: EXIT  */
+#line 88 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = nullptr;
         YYACCEPT;
     }
-#line 1672 "yacc.tab.cpp"
+#line 1778 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 7:
-#line 91 "yacc.y"
+  case 7: /* start: T_EOF  */
+#line 93 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = nullptr;
         YYACCEPT;
     }
-#line 1681 "yacc.tab.cpp"
+#line 1787 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 13:
-#line 107 "yacc.y"
+  case 13: /* txnStmt: TXN_BEGIN  */
+#line 109 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnBegin>();
     }
-#line 1689 "yacc.tab.cpp"
+#line 1795 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 14:
-#line 111 "yacc.y"
+  case 14: /* txnStmt: TXN_COMMIT  */
+#line 113 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnCommit>();
     }
-#line 1697 "yacc.tab.cpp"
+#line 1803 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 15:
-#line 115 "yacc.y"
+  case 15: /* txnStmt: TXN_ABORT  */
+#line 117 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnAbort>();
     }
-#line 1705 "yacc.tab.cpp"
+#line 1811 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 16:
-#line 119 "yacc.y"
+  case 16: /* txnStmt: TXN_ROLLBACK  */
+#line 121 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnRollback>();
     }
-#line 1713 "yacc.tab.cpp"
+#line 1819 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 17:
-#line 126 "yacc.y"
+  case 17: /* dbStmt: SHOW TABLES  */
+#line 128 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<ShowTables>();
     }
-#line 1721 "yacc.tab.cpp"
+#line 1827 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 18:
-#line 130 "yacc.y"
+  case 18: /* dbStmt: SHOW INDEX FROM tbName  */
+#line 132 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<ShowIndexs>((yyvsp[0].sv_str));
     }
-#line 1729 "yacc.tab.cpp"
+#line 1835 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 19: /* dbStmt: ANALYZE  */
+#line 136 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_node) = std::make_shared<AnalyzeTable>();
+    }
+#line 1843 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 19:
-#line 137 "yacc.y"
+  case 20: /* dbStmt: ANALYZE tbName  */
+#line 140 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_node) = std::make_shared<AnalyzeTable>((yyvsp[0].sv_str));
+    }
+#line 1851 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 21: /* setStmt: SET set_knob_type '=' VALUE_BOOL  */
+#line 147 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<SetStmt>((yyvsp[-2].sv_setKnobType), (yyvsp[0].sv_bool));
     }
-#line 1737 "yacc.tab.cpp"
+#line 1859 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 20:
-#line 144 "yacc.y"
+  case 22: /* ddl: CREATE TABLE tbName '(' fieldList ')'  */
+#line 154 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<CreateTable>((yyvsp[-3].sv_str), (yyvsp[-1].sv_fields));
     }
-#line 1745 "yacc.tab.cpp"
+#line 1867 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 21:
-#line 148 "yacc.y"
+  case 23: /* ddl: CREATE STATIC_CHECKPOINT  */
+#line 158 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<CreateStaticCheckpoint>();
     }
-#line 1753 "yacc.tab.cpp"
+#line 1875 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 22:
-#line 152 "yacc.y"
+  case 24: /* ddl: DROP TABLE tbName  */
+#line 162 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DropTable>((yyvsp[0].sv_str));
     }
-#line 1761 "yacc.tab.cpp"
+#line 1883 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 23:
-#line 156 "yacc.y"
+  case 25: /* ddl: DESC tbName  */
+#line 166 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DescTable>((yyvsp[0].sv_str));
     }
-#line 1769 "yacc.tab.cpp"
+#line 1891 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 24:
-#line 160 "yacc.y"
+  case 26: /* ddl: CREATE INDEX tbName '(' colNameList ')'  */
+#line 170 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<CreateIndex>((yyvsp[-3].sv_str), (yyvsp[-1].sv_strs));
     }
-#line 1777 "yacc.tab.cpp"
+#line 1899 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 25:
-#line 164 "yacc.y"
+  case 27: /* ddl: DROP INDEX tbName '(' colNameList ')'  */
+#line 174 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DropIndex>((yyvsp[-3].sv_str), (yyvsp[-1].sv_strs));
     }
-#line 1785 "yacc.tab.cpp"
+#line 1907 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 26:
-#line 171 "yacc.y"
+  case 28: /* dml: LOAD FILE_PATH INTO tbName  */
+#line 181 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<LoadStmt>((yyvsp[-2].sv_str), (yyvsp[0].sv_str));
     }
-#line 1793 "yacc.tab.cpp"
+#line 1915 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 27:
-#line 175 "yacc.y"
+  case 29: /* dml: INSERT INTO tbName VALUES '(' valueList ')'  */
+#line 185 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<InsertStmt>((yyvsp[-4].sv_str), (yyvsp[-1].sv_vals));
     }
-#line 1801 "yacc.tab.cpp"
+#line 1923 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 28:
-#line 179 "yacc.y"
+  case 30: /* dml: DELETE FROM tbName optWhereClause  */
+#line 189 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DeleteStmt>((yyvsp[-1].sv_str), (yyvsp[0].sv_conds));
     }
-#line 1809 "yacc.tab.cpp"
+#line 1931 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 29:
-#line 183 "yacc.y"
+  case 31: /* dml: UPDATE tbName SET setClauses optWhereClause  */
+#line 193 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<UpdateStmt>((yyvsp[-3].sv_str), (yyvsp[-1].sv_set_clauses), (yyvsp[0].sv_conds));
     }
-#line 1817 "yacc.tab.cpp"
+#line 1939 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 30:
-#line 187 "yacc.y"
+  case 32: /* dml: SELECT select_list FROM tableList optWhereClause group_by_clause having_clauses opt_order_clause opt_limit_clause  */
+#line 197 "/root/repo/src/parser/yacc.y"
     {
-        (yyval.sv_node) = std::static_pointer_cast<Expr>(std::make_shared<SelectStmt>((yyvsp[-6].sv_bounds), (yyvsp[-4].sv_strs), (yyvsp[-3].sv_conds), (yyvsp[-2].sv_cols), (yyvsp[-1].sv_havings), (yyvsp[0].sv_orderby)));
+        (yyval.sv_node) = std::static_pointer_cast<Expr>(std::make_shared<SelectStmt>((yyvsp[-7].sv_bounds), (yyvsp[-5].sv_strs), (yyvsp[-4].sv_conds), (yyvsp[-3].sv_cols), (yyvsp[-2].sv_havings), (yyvsp[-1].sv_orderbys), (yyvsp[0].sv_limit)));
     }
-#line 1825 "yacc.tab.cpp"
+#line 1947 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 31:
-#line 194 "yacc.y"
+  case 33: /* fieldList: field  */
+#line 204 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_fields).emplace_back(std::move((yyvsp[0].sv_field)));
     }
-#line 1833 "yacc.tab.cpp"
+#line 1955 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 32:
-#line 198 "yacc.y"
+  case 34: /* fieldList: fieldList ',' field  */
+#line 208 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_fields).emplace_back(std::move((yyvsp[0].sv_field)));
     }
-#line 1841 "yacc.tab.cpp"
+#line 1963 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 33:
-#line 205 "yacc.y"
+  case 35: /* colNameList: colName  */
+#line 215 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs).emplace_back(std::move((yyvsp[0].sv_str)));
     }
-#line 1849 "yacc.tab.cpp"
+#line 1971 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 34:
-#line 209 "yacc.y"
+  case 36: /* colNameList: colNameList ',' colName  */
+#line 219 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs).emplace_back(std::move((yyvsp[0].sv_str)));
     }
-#line 1857 "yacc.tab.cpp"
+#line 1979 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 35:
-#line 216 "yacc.y"
+  case 37: /* field: colName type  */
+#line 226 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_field) = std::make_shared<ColDef>((yyvsp[-1].sv_str), (yyvsp[0].sv_type_len));
     }
-#line 1865 "yacc.tab.cpp"
+#line 1987 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 36:
-#line 223 "yacc.y"
+  case 38: /* type: INT  */
+#line 233 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_INT, sizeof(int));
     }
-#line 1873 "yacc.tab.cpp"
+#line 1995 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 37:
-#line 227 "yacc.y"
+  case 39: /* type: CHAR '(' VALUE_INT ')'  */
+#line 237 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_STRING, (yyvsp[-1].sv_int));
     }
-#line 1881 "yacc.tab.cpp"
+#line 2003 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 38:
-#line 231 "yacc.y"
+  case 40: /* type: FLOAT  */
+#line 241 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_FLOAT, sizeof(float));
     }
-#line 1889 "yacc.tab.cpp"
+#line 2011 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 39:
-#line 235 "yacc.y"
+  case 41: /* type: DATETIME  */
+#line 245 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_STRING, 19);
     }
-#line 1897 "yacc.tab.cpp"
+#line 2019 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 40:
-#line 242 "yacc.y"
+  case 42: /* valueList: value  */
+#line 252 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_vals).emplace_back(std::move((yyvsp[0].sv_val)));
     }
-#line 1905 "yacc.tab.cpp"
+#line 2027 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 41:
-#line 246 "yacc.y"
+  case 43: /* valueList: valueList ',' value  */
+#line 256 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_vals).emplace_back(std::move((yyvsp[0].sv_val)));
     }
-#line 1913 "yacc.tab.cpp"
+#line 2035 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 42:
-#line 253 "yacc.y"
+  case 44: /* value: VALUE_INT  */
+#line 263 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<IntLit>((yyvsp[0].sv_int));
     }
-#line 1921 "yacc.tab.cpp"
+#line 2043 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 43:
-#line 257 "yacc.y"
+  case 45: /* value: VALUE_FLOAT  */
+#line 267 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<FloatLit>((yyvsp[0].sv_float));
     }
-#line 1929 "yacc.tab.cpp"
+#line 2051 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 44:
-#line 261 "yacc.y"
+  case 46: /* value: VALUE_STRING  */
+#line 271 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<StringLit>((yyvsp[0].sv_str));
     }
-#line 1937 "yacc.tab.cpp"
+#line 2059 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 45:
-#line 265 "yacc.y"
+  case 47: /* value: VALUE_BOOL  */
+#line 275 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<BoolLit>((yyvsp[0].sv_bool));
     }
-#line 1945 "yacc.tab.cpp"
+#line 2067 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 46:
-#line 272 "yacc.y"
+  case 48: /* condition: col op expr  */
+#line 282 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cond) = std::make_shared<BinaryExpr>((yyvsp[-2].sv_col), (yyvsp[-1].sv_comp_op), (yyvsp[0].sv_expr));
     }
-#line 1953 "yacc.tab.cpp"
+#line 2075 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 47:
-#line 276 "yacc.y"
+  case 49: /* condition: col op '(' valueList ')'  */
+#line 286 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cond) = std::make_shared<BinaryExpr>((yyvsp[-4].sv_col), (yyvsp[-3].sv_comp_op), (yyvsp[-1].sv_vals));
     }
-#line 1961 "yacc.tab.cpp"
+#line 2083 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 48:
-#line 283 "yacc.y"
+  case 50: /* optWhereClause: %empty  */
+#line 293 "/root/repo/src/parser/yacc.y"
     {
         /* ignore */
     }
-#line 1969 "yacc.tab.cpp"
+#line 2091 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 49:
-#line 287 "yacc.y"
+  case 51: /* optWhereClause: WHERE whereClause  */
+#line 297 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_conds) = std::move((yyvsp[0].sv_conds));
     }
-#line 1977 "yacc.tab.cpp"
+#line 2099 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 50:
-#line 294 "yacc.y"
+  case 52: /* whereClause: condition  */
+#line 304 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_conds).emplace_back(std::move((yyvsp[0].sv_cond)));
     }
-#line 1985 "yacc.tab.cpp"
+#line 2107 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 51:
-#line 298 "yacc.y"
+  case 53: /* whereClause: whereClause AND condition  */
+#line 308 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_conds).emplace_back(std::move((yyvsp[0].sv_cond)));
     }
-#line 1993 "yacc.tab.cpp"
+#line 2115 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 52:
-#line 305 "yacc.y"
+  case 54: /* col: tbName '.' colName  */
+#line 315 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_col) = std::make_shared<Col>(std::move((yyvsp[-2].sv_str)), std::move((yyvsp[0].sv_str)));
     }
-#line 2001 "yacc.tab.cpp"
+#line 2123 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 53:
-#line 309 "yacc.y"
+  case 55: /* col: colName  */
+#line 319 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_col) = std::make_shared<Col>("", std::move((yyvsp[0].sv_str)));
     }
-#line 2009 "yacc.tab.cpp"
+#line 2131 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 54:
-#line 316 "yacc.y"
+  case 56: /* colList: col  */
+#line 326 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cols).emplace_back(std::move((yyvsp[0].sv_col)));
     }
-#line 2017 "yacc.tab.cpp"
+#line 2139 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 55:
-#line 320 "yacc.y"
+  case 57: /* colList: colList ',' col  */
+#line 330 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cols).emplace_back(std::move((yyvsp[0].sv_col)));
     }
-#line 2025 "yacc.tab.cpp"
+#line 2147 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 56:
-#line 327 "yacc.y"
+  case 58: /* op: '='  */
+#line 337 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_EQ;
     }
-#line 2033 "yacc.tab.cpp"
+#line 2155 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 57:
-#line 331 "yacc.y"
+  case 59: /* op: '<'  */
+#line 341 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_LT;
     }
-#line 2041 "yacc.tab.cpp"
+#line 2163 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 58:
-#line 335 "yacc.y"
+  case 60: /* op: '>'  */
+#line 345 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_GT;
     }
-#line 2049 "yacc.tab.cpp"
+#line 2171 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 59:
-#line 339 "yacc.y"
+  case 61: /* op: NEQ  */
+#line 349 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_NE;
     }
-#line 2057 "yacc.tab.cpp"
+#line 2179 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 60:
-#line 343 "yacc.y"
+  case 62: /* op: LEQ  */
+#line 353 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_LE;
     }
-#line 2065 "yacc.tab.cpp"
+#line 2187 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 61:
-#line 347 "yacc.y"
+  case 63: /* op: GEQ  */
+#line 357 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_GE;
     }
-#line 2073 "yacc.tab.cpp"
+#line 2195 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 62:
-#line 351 "yacc.y"
+  case 64: /* op: IN  */
+#line 361 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_IN;
     }
-#line 2081 "yacc.tab.cpp"
+#line 2203 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 63:
-#line 358 "yacc.y"
+  case 65: /* expr: value  */
+#line 368 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_expr) = std::static_pointer_cast<Expr>((yyvsp[0].sv_val));
     }
-#line 2089 "yacc.tab.cpp"
+#line 2211 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 64:
-#line 362 "yacc.y"
+  case 66: /* expr: col  */
+#line 372 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_expr) = std::static_pointer_cast<Expr>((yyvsp[0].sv_col));
     }
-#line 2097 "yacc.tab.cpp"
+#line 2219 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 65:
-#line 366 "yacc.y"
+  case 67: /* expr: '(' SELECT select_list FROM tableList optWhereClause group_by_clause having_clauses opt_order_clause opt_limit_clause ')'  */
+#line 376 "/root/repo/src/parser/yacc.y"
     {
-        (yyval.sv_expr) = std::make_shared<SelectStmt>((yyvsp[-7].sv_bounds), (yyvsp[-5].sv_strs), (yyvsp[-4].sv_conds), (yyvsp[-3].sv_cols), (yyvsp[-2].sv_havings), (yyvsp[-1].sv_orderby));
+        (yyval.sv_expr) = std::make_shared<SelectStmt>((yyvsp[-8].sv_bounds), (yyvsp[-6].sv_strs), (yyvsp[-5].sv_conds), (yyvsp[-4].sv_cols), (yyvsp[-3].sv_havings), (yyvsp[-2].sv_orderbys), (yyvsp[-1].sv_limit));
     }
-#line 2105 "yacc.tab.cpp"
+#line 2227 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 66:
-#line 373 "yacc.y"
+  case 68: /* setClauses: setClause  */
+#line 383 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_set_clauses).emplace_back(std::move((yyvsp[0].sv_set_clause)));
     }
-#line 2113 "yacc.tab.cpp"
+#line 2235 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 67:
-#line 377 "yacc.y"
+  case 69: /* setClauses: setClauses ',' setClause  */
+#line 387 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_set_clauses).emplace_back(std::move((yyvsp[0].sv_set_clause)));
     }
-#line 2121 "yacc.tab.cpp"
+#line 2243 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 68:
-#line 384 "yacc.y"
+  case 70: /* setClause: colName '=' value  */
+#line 394 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_set_clause) = std::make_shared<SetClause>((yyvsp[-2].sv_str), (yyvsp[0].sv_val));
     }
-#line 2129 "yacc.tab.cpp"
+#line 2251 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 69:
-#line 388 "yacc.y"
+  case 71: /* setClause: colName '=' colName value  */
+#line 398 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_set_clause) = std::make_shared<SetClause>((yyvsp[-3].sv_str), (yyvsp[0].sv_val), true);
     }
-#line 2137 "yacc.tab.cpp"
+#line 2259 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 70:
-#line 395 "yacc.y"
+  case 72: /* asClause: AS alias  */
+#line 405 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_str) = std::move((yyvsp[0].sv_str));
     }
-#line 2145 "yacc.tab.cpp"
+#line 2267 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 71:
-#line 399 "yacc.y"
+  case 73: /* asClause: %empty  */
+#line 409 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_str) = "";
     }
-#line 2153 "yacc.tab.cpp"
+#line 2275 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 72:
-#line 406 "yacc.y"
+  case 74: /* select_item: col asClause  */
+#line 416 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_bound) = std::make_shared<BoundExpr>(std::move((yyvsp[-1].sv_col)), AGG_COL, std::move((yyvsp[0].sv_str)));
     }
-#line 2161 "yacc.tab.cpp"
+#line 2283 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 73:
-#line 410 "yacc.y"
+  case 75: /* select_item: COUNT '(' '*' ')' asClause  */
+#line 420 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_bound) = std::make_shared<BoundExpr>(std::make_shared<Col>("", ""), AGG_COUNT, std::move((yyvsp[0].sv_str)));
     }
-#line 2169 "yacc.tab.cpp"
+#line 2291 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 74:
-#line 414 "yacc.y"
+  case 76: /* select_item: COUNT '(' col ')' asClause  */
+#line 424 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_bound) = std::make_shared<BoundExpr>(std::move((yyvsp[-2].sv_col)), AGG_COUNT, std::move((yyvsp[0].sv_str)));
     }
-#line 2177 "yacc.tab.cpp"
+#line 2299 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 75:
-#line 418 "yacc.y"
+  case 77: /* select_item: MAX '(' col ')' asClause  */
+#line 428 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_bound) = std::make_shared<BoundExpr>(std::move((yyvsp[-2].sv_col)), AGG_MAX, std::move((yyvsp[0].sv_str)));
     }
-#line 2185 "yacc.tab.cpp"
+#line 2307 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 76:
-#line 422 "yacc.y"
+  case 78: /* select_item: MIN '(' col ')' asClause  */
+#line 432 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_bound) = std::make_shared<BoundExpr>(std::move((yyvsp[-2].sv_col)), AGG_MIN, std::move((yyvsp[0].sv_str)));
     }
-#line 2193 "yacc.tab.cpp"
+#line 2315 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 77:
-#line 426 "yacc.y"
+  case 79: /* select_item: SUM '(' col ')' asClause  */
+#line 436 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_bound) = std::make_shared<BoundExpr>(std::move((yyvsp[-2].sv_col)), AGG_SUM, std::move((yyvsp[0].sv_str)));
     }
-#line 2201 "yacc.tab.cpp"
+#line 2323 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 78:
-#line 433 "yacc.y"
+  case 80: /* select_list: '*'  */
+#line 443 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_bounds) = {};
     }
-#line 2209 "yacc.tab.cpp"
+#line 2331 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 79:
-#line 437 "yacc.y"
+  case 81: /* select_list: select_item  */
+#line 447 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_bounds).emplace_back(std::move((yyvsp[0].sv_bound)));
     }
-#line 2217 "yacc.tab.cpp"
+#line 2339 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 80:
-#line 441 "yacc.y"
+  case 82: /* select_list: select_list ',' select_item  */
+#line 451 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_bounds).emplace_back(std::move((yyvsp[0].sv_bound)));
     }
-#line 2225 "yacc.tab.cpp"
+#line 2347 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 81:
-#line 448 "yacc.y"
+  case 83: /* tableList: tbName  */
+#line 458 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs).emplace_back(std::move((yyvsp[0].sv_str)));
     }
-#line 2233 "yacc.tab.cpp"
+#line 2355 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 82:
-#line 452 "yacc.y"
+  case 84: /* tableList: tableList ',' tbName  */
+#line 462 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs).emplace_back(std::move((yyvsp[0].sv_str)));
     }
-#line 2241 "yacc.tab.cpp"
+#line 2363 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 83:
-#line 456 "yacc.y"
+  case 85: /* tableList: tableList JOIN tbName  */
+#line 466 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs).emplace_back(std::move((yyvsp[0].sv_str)));
     }
-#line 2249 "yacc.tab.cpp"
+#line 2371 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 84:
-#line 463 "yacc.y"
+  case 86: /* opt_order_clause: ORDER BY order_clause  */
+#line 473 "/root/repo/src/parser/yacc.y"
     { 
-        (yyval.sv_orderby) = std::move((yyvsp[0].sv_orderby));
+        (yyval.sv_orderbys) = std::move((yyvsp[0].sv_orderbys));
     }
-#line 2257 "yacc.tab.cpp"
+#line 2379 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 85:
-#line 467 "yacc.y"
+  case 87: /* opt_order_clause: %empty  */
+#line 477 "/root/repo/src/parser/yacc.y"
     {
         /* ignore */
     }
-#line 2265 "yacc.tab.cpp"
+#line 2387 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 86:
-#line 474 "yacc.y"
+  case 88: /* order_clause: order_item  */
+#line 484 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_orderbys) = std::vector<std::shared_ptr<OrderBy>>{(yyvsp[0].sv_orderby)};
+    }
+#line 2395 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 89: /* order_clause: order_clause ',' order_item  */
+#line 488 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_orderbys).emplace_back(std::move((yyvsp[0].sv_orderby)));
+    }
+#line 2403 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 90: /* order_item: col opt_asc_desc  */
+#line 495 "/root/repo/src/parser/yacc.y"
     { 
         (yyval.sv_orderby) = std::make_shared<OrderBy>((yyvsp[-1].sv_col), (yyvsp[0].sv_orderby_dir));
     }
-#line 2273 "yacc.tab.cpp"
+#line 2411 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 91: /* opt_limit_clause: LIMIT VALUE_INT  */
+#line 502 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_limit) = std::make_shared<Limit>((yyvsp[0].sv_int), 0);
+    }
+#line 2419 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 87:
-#line 481 "yacc.y"
+  case 92: /* opt_limit_clause: LIMIT VALUE_INT OFFSET VALUE_INT  */
+#line 506 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_limit) = std::make_shared<Limit>((yyvsp[-2].sv_int), (yyvsp[0].sv_int));
+    }
+#line 2427 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 93: /* opt_limit_clause: LIMIT VALUE_INT ',' VALUE_INT  */
+#line 510 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_limit) = std::make_shared<Limit>((yyvsp[0].sv_int), (yyvsp[-2].sv_int));
+    }
+#line 2435 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 94: /* opt_limit_clause: %empty  */
+#line 514 "/root/repo/src/parser/yacc.y"
+    {
+        /* ignore */
+    }
+#line 2443 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 95: /* opt_asc_desc: ASC  */
+#line 521 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_orderby_dir) = OrderBy_ASC;
     }
-#line 2281 "yacc.tab.cpp"
+#line 2451 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 88:
-#line 485 "yacc.y"
+  case 96: /* opt_asc_desc: DESC  */
+#line 525 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_orderby_dir) = OrderBy_DESC;
     }
-#line 2289 "yacc.tab.cpp"
+#line 2459 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 89:
-#line 489 "yacc.y"
+  case 97: /* opt_asc_desc: %empty  */
+#line 529 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_orderby_dir) = OrderBy_DEFAULT;
     }
-#line 2297 "yacc.tab.cpp"
+#line 2467 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 90:
-#line 496 "yacc.y"
+  case 98: /* group_by_clause: GROUP BY colList  */
+#line 536 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cols) = std::move((yyvsp[0].sv_cols));
     }
-#line 2305 "yacc.tab.cpp"
+#line 2475 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 91:
-#line 500 "yacc.y"
+  case 99: /* group_by_clause: %empty  */
+#line 540 "/root/repo/src/parser/yacc.y"
     {
         /* ignore */
     }
-#line 2313 "yacc.tab.cpp"
+#line 2483 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 92:
-#line 507 "yacc.y"
+  case 100: /* having_clause: select_item op expr  */
+#line 547 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_havings).emplace_back(std::make_shared<HavingExpr>((yyvsp[-2].sv_bound), (yyvsp[-1].sv_comp_op), (yyvsp[0].sv_expr)));
     }
-#line 2321 "yacc.tab.cpp"
+#line 2491 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 93:
-#line 511 "yacc.y"
+  case 101: /* having_clause: having_clause AND select_item op expr  */
+#line 551 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_havings).emplace_back(std::make_shared<HavingExpr>((yyvsp[-2].sv_bound), (yyvsp[-1].sv_comp_op), (yyvsp[0].sv_expr)));
     }
-#line 2329 "yacc.tab.cpp"
+#line 2499 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 94:
-#line 515 "yacc.y"
+  case 102: /* having_clause: %empty  */
+#line 555 "/root/repo/src/parser/yacc.y"
     {
         /* ignore */
     }
-#line 2337 "yacc.tab.cpp"
+#line 2507 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 95:
-#line 522 "yacc.y"
+  case 103: /* having_clauses: HAVING having_clause  */
+#line 562 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_havings) = std::move((yyvsp[0].sv_havings));
     }
-#line 2345 "yacc.tab.cpp"
+#line 2515 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 96:
-#line 526 "yacc.y"
+  case 104: /* having_clauses: %empty  */
+#line 566 "/root/repo/src/parser/yacc.y"
     {
         /* ignore */
     }
-#line 2353 "yacc.tab.cpp"
+#line 2523 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 97:
-#line 533 "yacc.y"
+  case 105: /* set_knob_type: ENABLE_NESTLOOP  */
+#line 573 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_setKnobType) = EnableNestLoop;
     }
-#line 2361 "yacc.tab.cpp"
+#line 2531 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 98:
-#line 537 "yacc.y"
+  case 106: /* set_knob_type: ENABLE_SORTMERGE  */
+#line 577 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_setKnobType) = EnableSortMerge;
     }
-#line 2369 "yacc.tab.cpp"
+#line 2539 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 107: /* set_knob_type: ENABLE_HASHJOIN  */
+#line 581 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_setKnobType) = EnableHashJoin;
+    }
+#line 2547 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 99:
-#line 541 "yacc.y"
+  case 108: /* set_knob_type: OUTPUT_FILE  */
+#line 585 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_setKnobType) = EnableOutputFile;
     }
-#line 2377 "yacc.tab.cpp"
+#line 2555 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
 
-#line 2381 "yacc.tab.cpp"
+#line 2559 "/root/repo/src/parser/yacc.tab.cpp"
 
       default: break;
     }
@@ -2392,11 +2570,10 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
   *++yylsp = yyloc;
@@ -2421,50 +2598,45 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (&yylloc, yyscanner, YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
       {
+        yypcontext_t yyctx
+          = {yyssp, yytoken, &yylloc};
         char const *yymsgp = YY_("syntax error");
         int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
+        yysyntax_error_status = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
         if (yysyntax_error_status == 0)
           yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
+        else if (yysyntax_error_status == -1)
           {
             if (yymsg != yymsgbuf)
               YYSTACK_FREE (yymsg);
-            yymsg = YY_CAST (char *, YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
-            if (!yymsg)
+            yymsg = YY_CAST (char *,
+                             YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
+            if (yymsg)
               {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
+                yysyntax_error_status
+                  = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+                yymsgp = yymsg;
               }
             else
               {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
+                yymsg = yymsgbuf;
+                yymsg_alloc = sizeof yymsgbuf;
+                yysyntax_error_status = YYENOMEM;
               }
           }
         yyerror (&yylloc, yyscanner, yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
+        if (yysyntax_error_status == YYENOMEM)
+          YYNOMEM;
       }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
   yyerror_range[1] = yylloc;
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -2497,6 +2669,7 @@ yyerrorlab:
      label yyerrorlab therefore never appears in user code.  */
   if (0)
     YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -2513,13 +2686,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -2533,7 +2707,7 @@ yyerrlab1:
 
       yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp, yylsp, yyscanner);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp, yyscanner);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -2544,13 +2718,11 @@ yyerrlab1:
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
   yyerror_range[2] = yylloc;
-  /* Using YYLLOC is tempting, but would change the location of
-     the lookahead.  YYLOC is available though.  */
-  YYLLOC_DEFAULT (yyloc, yyerror_range, 2);
-  *++yylsp = yyloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2561,7 +2733,7 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
 /*-----------------------------------.
@@ -2569,24 +2741,22 @@ yyacceptlab:
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (&yylloc, yyscanner, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
 
-/*-----------------------------------------------------.
-| yyreturn -- parsing is finished, return the result.  |
-`-----------------------------------------------------*/
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -2602,18 +2772,17 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[+*yyssp], yyvsp, yylsp, yyscanner);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp, yyscanner);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
   if (yymsg != yymsgbuf)
     YYSTACK_FREE (yymsg);
-#endif
   return yyresult;
 }
-#line 551 "yacc.y"
+
+#line 595 "/root/repo/src/parser/yacc.y"
 
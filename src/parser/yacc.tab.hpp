@@ -1,8 +1,8 @@
-/* A Bison parser, made by GNU Bison 3.5.1.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2020 Free Software Foundation,
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
    Inc.
 
    This program is free software: you can redistribute it and/or modify
@@ -16,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -31,11 +31,12 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
-/* Undocumented macros, especially those whose name start with YY_,
-   are private implementation details.  Do not rely on them.  */
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
 
-#ifndef YY_YY_YACC_TAB_HPP_INCLUDED
-# define YY_YY_YACC_TAB_HPP_INCLUDED
+#ifndef YY_YY_ROOT_REPO_SRC_PARSER_YACC_TAB_HPP_INCLUDED
+# define YY_YY_ROOT_REPO_SRC_PARSER_YACC_TAB_HPP_INCLUDED
 /* Debug traces.  */
 #ifndef YYDEBUG
 # define YYDEBUG 0
@@ -44,69 +45,78 @@
 extern int yydebug;
 #endif
 
-/* Token type.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
   enum yytokentype
   {
-    SHOW = 258,
-    TABLES = 259,
-    CREATE = 260,
-    TABLE = 261,
-    DROP = 262,
-    DESC = 263,
-    INSERT = 264,
-    INTO = 265,
-    VALUES = 266,
-    DELETE = 267,
-    FROM = 268,
-    ASC = 269,
-    ORDER = 270,
-    BY = 271,
-    WHERE = 272,
-    UPDATE = 273,
-    SET = 274,
-    SELECT = 275,
-    INT = 276,
-    CHAR = 277,
-    FLOAT = 278,
-    DATETIME = 279,
-    INDEX = 280,
-    AND = 281,
-    JOIN = 282,
-    EXIT = 283,
-    HELP = 284,
-    TXN_BEGIN = 285,
-    TXN_COMMIT = 286,
-    TXN_ABORT = 287,
-    TXN_ROLLBACK = 288,
-    ORDER_BY = 289,
-    ENABLE_NESTLOOP = 290,
-    ENABLE_SORTMERGE = 291,
-    COUNT = 292,
-    MAX = 293,
-    MIN = 294,
-    SUM = 295,
-    AS = 296,
-    GROUP = 297,
-    HAVING = 298,
-    IN = 299,
-    STATIC_CHECKPOINT = 300,
-    LOAD = 301,
-    OUTPUT_FILE = 302,
-    ON = 303,
-    OFF = 304,
-    LEQ = 305,
-    NEQ = 306,
-    GEQ = 307,
-    T_EOF = 308,
-    FILE_PATH = 309,
-    IDENTIFIER = 310,
-    VALUE_STRING = 311,
-    VALUE_INT = 312,
-    VALUE_FLOAT = 313,
-    VALUE_BOOL = 314
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    SHOW = 258,                    /* SHOW  */
+    TABLES = 259,                  /* TABLES  */
+    CREATE = 260,                  /* CREATE  */
+    TABLE = 261,                   /* TABLE  */
+    DROP = 262,                    /* DROP  */
+    DESC = 263,                    /* DESC  */
+    INSERT = 264,                  /* INSERT  */
+    INTO = 265,                    /* INTO  */
+    VALUES = 266,                  /* VALUES  */
+    DELETE = 267,                  /* DELETE  */
+    FROM = 268,                    /* FROM  */
+    ASC = 269,                     /* ASC  */
+    ORDER = 270,                   /* ORDER  */
+    BY = 271,                      /* BY  */
+    WHERE = 272,                   /* WHERE  */
+    UPDATE = 273,                  /* UPDATE  */
+    SET = 274,                     /* SET  */
+    SELECT = 275,                  /* SELECT  */
+    INT = 276,                     /* INT  */
+    CHAR = 277,                    /* CHAR  */
+    FLOAT = 278,                   /* FLOAT  */
+    DATETIME = 279,                /* DATETIME  */
+    INDEX = 280,                   /* INDEX  */
+    AND = 281,                     /* AND  */
+    JOIN = 282,                    /* JOIN  */
+    EXIT = 283,                    /* EXIT  */
+    HELP = 284,                    /* HELP  */
+    TXN_BEGIN = 285,               /* TXN_BEGIN  */
+    TXN_COMMIT = 286,              /* TXN_COMMIT  */
+    TXN_ABORT = 287,               /* TXN_ABORT  */
+    TXN_ROLLBACK = 288,            /* TXN_ROLLBACK  */
+    ORDER_BY = 289,                /* ORDER_BY  */
+    ENABLE_NESTLOOP = 290,         /* ENABLE_NESTLOOP  */
+    ENABLE_SORTMERGE = 291,        /* ENABLE_SORTMERGE  */
+    COUNT = 292,                   /* COUNT  */
+    MAX = 293,                     /* MAX  */
+    MIN = 294,                     /* MIN  */
+    SUM = 295,                     /* SUM  */
+    AS = 296,                      /* AS  */
+    GROUP = 297,                   /* GROUP  */
+    HAVING = 298,                  /* HAVING  */
+    IN = 299,                      /* IN  */
+    STATIC_CHECKPOINT = 300,       /* STATIC_CHECKPOINT  */
+    LOAD = 301,                    /* LOAD  */
+    OUTPUT_FILE = 302,             /* OUTPUT_FILE  */
+    ON = 303,                      /* ON  */
+    OFF = 304,                     /* OFF  */
+    ANALYZE = 305,                 /* ANALYZE  */
+    LIMIT = 306,                   /* LIMIT  */
+    OFFSET = 307,                  /* OFFSET  */
+    ENABLE_HASHJOIN = 308,         /* ENABLE_HASHJOIN  */
+    LEQ = 309,                     /* LEQ  */
+    NEQ = 310,                     /* NEQ  */
+    GEQ = 311,                     /* GEQ  */
+    T_EOF = 312,                   /* T_EOF  */
+    FILE_PATH = 313,               /* FILE_PATH  */
+    IDENTIFIER = 314,              /* IDENTIFIER  */
+    VALUE_STRING = 315,            /* VALUE_STRING  */
+    VALUE_INT = 316,               /* VALUE_INT  */
+    VALUE_FLOAT = 317,             /* VALUE_FLOAT  */
+    VALUE_BOOL = 318               /* VALUE_BOOL  */
   };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
 
 /* Value type.  */
@@ -127,6 +137,8 @@ struct YYLTYPE
 
 
 
+
 int yyparse (void *yyscanner);
 
-#endif /* !YY_YY_YACC_TAB_HPP_INCLUDED  */
+
+#endif /* !YY_YY_ROOT_REPO_SRC_PARSER_YACC_TAB_HPP_INCLUDED  */
@@ -25,7 +25,7 @@ using namespace ast;
 // keywords
 %token SHOW TABLES CREATE TABLE DROP DESC INSERT INTO VALUES DELETE FROM ASC ORDER BY
 WHERE UPDATE SET SELECT INT CHAR FLOAT DATETIME INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY ENABLE_NESTLOOP ENABLE_SORTMERGE
-COUNT MAX MIN SUM AS GROUP HAVING IN STATIC_CHECKPOINT LOAD OUTPUT_FILE ON OFF
+COUNT MAX MIN SUM AS GROUP HAVING IN STATIC_CHECKPOINT LOAD OUTPUT_FILE ON OFF ANALYZE LIMIT OFFSET ENABLE_HASHJOIN
 
 // non-keywords
 %token LEQ NEQ GEQ T_EOF
@@ -56,8 +56,10 @@ COUNT MAX MIN SUM AS GROUP HAVING IN STATIC_CHECKPOINT LOAD OUTPUT_FILE ON OFF
 %type <sv_set_clauses> setClauses
 %type <sv_cond> condition
 %type <sv_conds> whereClause optWhereClause
-%type <sv_orderby>  order_clause opt_order_clause
+%type <sv_orderby>  order_item
+%type <sv_orderbys> order_clause opt_order_clause
 %type <sv_orderby_dir> opt_asc_desc
+%type <sv_limit> opt_limit_clause
 %type <sv_setKnobType> set_knob_type
 
 %%
@@ -130,6 +132,14 @@ dbStmt:
     {
         $$ = std::make_shared<ShowIndexs>($4);
     }
+    |   ANALYZE
+    {
+        $$ = std::make_shared<AnalyzeTable>();
+    }
+    |   ANALYZE tbName
+    {
+        $$ = std::make_shared<AnalyzeTable>($2);
+    }
     ;
 
 setStmt:
@@ -183,9 +193,9 @@ dml:
     {
         $$ = std::make_shared<UpdateStmt>($2, $4, $5);
     }
-    |   SELECT select_list FROM tableList optWhereClause group_by_clause having_clauses opt_order_clause
+    |   SELECT select_list FROM tableList optWhereClause group_by_clause having_clauses opt_order_clause opt_limit_clause
     {
-        $$ = std::static_pointer_cast<Expr>(std::make_shared<SelectStmt>($2, $4, $5, $6, $7, $8));
+        $$ = std::static_pointer_cast<Expr>(std::make_shared<SelectStmt>($2, $4, $5, $6, $7, $8, $9));
     }
     ;
 
@@ -362,9 +372,9 @@ expr:
     {
         $$ = std::static_pointer_cast<Expr>($1);
     }
-    |   '(' SELECT select_list FROM tableList optWhereClause group_by_clause having_clauses opt_order_clause ')'
+    |   '(' SELECT select_list FROM tableList optWhereClause group_by_clause having_clauses opt_order_clause opt_limit_clause ')'
     {
-        $$ = std::make_shared<SelectStmt>($3, $5, $6, $7, $8, $9);
+        $$ = std::make_shared<SelectStmt>($3, $5, $6, $7, $8, $9, $10);
     }
     ;
 
@@ -470,12 +480,42 @@ opt_order_clause:
     ;
 
 order_clause:
+        order_item
+    {
+        $$ = std::vector<std::shared_ptr<OrderBy>>{$1};
+    }
+    |   order_clause ',' order_item
+    {
+        $$.emplace_back(std::move($3));
+    }
+    ;
+
+order_item:
         col opt_asc_desc
     { 
         $$ = std::make_shared<OrderBy>($1, $2);
     }
     ;
 
+opt_limit_clause:
+        LIMIT VALUE_INT
+    {
+        $$ = std::make_shared<Limit>($2, 0);
+    }
+    |   LIMIT VALUE_INT OFFSET VALUE_INT
+    {
+        $$ = std::make_shared<Limit>($2, $4);
+    }
+    |   LIMIT VALUE_INT ',' VALUE_INT
+    {
+        $$ = std::make_shared<Limit>($4, $2);
+    }
+    |   /* epsilon */
+    {
+        /* ignore */
+    }
+    ;
+
 opt_asc_desc:
         ASC
     {
@@ -537,6 +577,10 @@ set_knob_type:
     {
         $$ = EnableSortMerge;
     }
+    |   ENABLE_HASHJOIN
+    {
+        $$ = EnableHashJoin;
+    }
     |   OUTPUT_FILE
     {
         $$ = EnableOutputFile;
@@ -17,14 +17,17 @@ See the Mulan PSL v2 for more details. */
 #include "execution/executor_abstract.h"
 #include "execution/executor_nestedloop_join.h"
 #include "execution/executor_sortmerge_join.h"
+#include "execution/executor_hash_join.h"
 #include "execution/executor_projection.h"
 #include "execution/executor_seq_scan.h"
+#include "execution/executor_parallel_seq_scan.h"
 #include "execution/executor_aggregate.h"
 #include "execution/executor_index_scan.h"
 #include "execution/executor_update.h"
 #include "execution/executor_insert.h"
 #include "execution/executor_delete.h"
 #include "execution/executor_sort.h"
+#include "execution/spill_manager.h"
 #include "common/common.h"
 
 typedef enum portalTag {
@@ -52,9 +55,11 @@ struct PortalStmt {
 class Portal {
 private:
     SmManager *sm_manager_;
+    SpillManager *spill_manager_;
 
 public:
-    explicit Portal(SmManager *sm_manager) : sm_manager_(sm_manager) {
+    Portal(SmManager *sm_manager, SpillManager *spill_manager)
+        : sm_manager_(sm_manager), spill_manager_(spill_manager) {
     }
 
     ~Portal() = default;
@@ -79,6 +84,8 @@ public:
                                                 std::unique_ptr<AbstractExecutor>(), plan);
         }
         if (auto x = std::dynamic_pointer_cast<DMLPlan>(plan)) {
+            // 一条语句的算子共用一个溢出上下文，上一条语句留下的溢出文件在这里被清理
+            context->spill_ = spill_manager_->begin_query();
             switch (x->tag) {
                 case T_select: {
                     std::shared_ptr<ProjectionPlan> p = std::dynamic_pointer_cast<ProjectionPlan>(x->subplan_);
@@ -95,8 +102,11 @@ public:
                 case T_Update: {
                     std::unique_ptr<AbstractExecutor> scan = convert_plan_executor(x->subplan_, context, true);
                     std::vector<Rid> rids;
-                    for (scan->beginTuple(); !scan->is_end(); scan->nextTuple()) {
-                        rids.emplace_back(scan->rid());
+                    TupleBatch batch;
+                    for (scan->beginBatch(); scan->NextBatch(batch);) {
+                        for (size_t i = 0; i < batch.size(); ++i) {
+                            rids.emplace_back(batch.rid(i));
+                        }
                     }
                     // TODO update 算子优化，如果更新值不涉及索引键，则不需要维护索引
                     bool is_set_index_key = true;
@@ -123,8 +133,11 @@ public:
                 case T_Delete: {
                     std::unique_ptr<AbstractExecutor> scan = convert_plan_executor(x->subplan_, context, true);
                     std::vector<Rid> rids;
-                    for (scan->beginTuple(); !scan->is_end(); scan->nextTuple()) {
-                        rids.emplace_back(scan->rid());
+                    TupleBatch batch;
+                    for (scan->beginBatch(); scan->NextBatch(batch);) {
+                        for (size_t i = 0; i < batch.size(); ++i) {
+                            rids.emplace_back(batch.rid(i));
+                        }
                     }
                     std::unique_ptr<AbstractExecutor> root =
                             std::make_unique<DeleteExecutor>(sm_manager_, std::move(x->tab_name_),
@@ -176,50 +189,46 @@ public:
     static void drop() {
     }
 
+    // parallel 为 false 时不用并行扫描，被反复重新扫描的算子（比如嵌套循环连接的子算子）每次都要重新启动工作线程
     std::unique_ptr<AbstractExecutor> convert_plan_executor(const std::shared_ptr<Plan> &plan, Context *context,
-                                                            bool gap_mode = false) {
+                                                            bool gap_mode = false, bool parallel = true) {
         if (auto x = std::dynamic_pointer_cast<ProjectionPlan>(plan)) {
-            return std::make_unique<ProjectionExecutor>(convert_plan_executor(x->subplan_, context),
-                                                        std::move(x->sel_cols_), x->limit_);
+            return std::make_unique<ProjectionExecutor>(convert_plan_executor(x->subplan_, context, false, parallel),
+                                                        std::move(x->sel_cols_), x->limit_, x->offset_);
         }
         if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
-            // TODO 为每个子查询生成算子
-            // for (auto &cond: x->conds_) {
-            //     if (cond.is_sub_query && cond.sub_query_plan != nullptr) {
-            //         assert(0);
-            //         cond.prev = convert_plan_executor(cond.sub_query_plan, context);
-            //         // 在算子执行之前就处理异常情况，否则会错误输出表头
-            //         // 子查询为空抛错处理
-            //         cond.prev->beginTuple();
-            //         if (cond.prev->is_end()) {
-            //             throw InternalError("Empty sub query!");
-            //         }
-            //         // 比较运算符的子查询，只能有一个元素
-            //         if (cond.op != OP_IN) {
-            //             cond.prev->nextTuple();
-            //             if (!cond.prev->is_end()) {
-            //                 throw InternalError("Subquery returns more than 1 row!");
-            //             }
-            //         }
-            //     }
-            // }
+            // 非相关子查询在这里执行一次，扫描算子只读缓存的结果
+            for (auto &cond: x->conds_) {
+                if (cond.is_sub_query && cond.sub_query_plan != nullptr) {
+                    materialize_sub_query(cond, context);
+                }
+            }
+            // 增删改的扫描要加互斥间隙锁并按 rid 修改，只有查询使用并行扫描；有 limit 时只需要开头的少量元组，也不并行
+            if (x->tag == T_SeqScan && !gap_mode && parallel && x->limit_ < 0 &&
+                ParallelSeqScanExecutor::worth_parallel(sm_manager_->fhs_.at(x->tab_name_).get())) {
+                return std::make_unique<ParallelSeqScanExecutor>(sm_manager_, std::move(x->tab_name_),
+                                                                 std::move(x->conds_), context);
+            }
             if (x->tag == T_SeqScan) {
                 return std::make_unique<SeqScanExecutor>(sm_manager_, std::move(x->tab_name_), std::move(x->conds_),
                                                          context, gap_mode);
             }
             return std::make_unique<IndexScanExecutor>(sm_manager_, std::move(x->tab_name_), std::move(x->conds_),
                                                        std::move(x->index_col_names_),
-                                                       context, gap_mode, x->asc_);
+                                                       context, gap_mode, x->asc_, x->limit_, x->index_only_,
+                                                       x->bitmap_, std::move(x->and_index_col_names_));
         }
         if (auto x = std::dynamic_pointer_cast<AggregatePlan>(plan)) {
-            return std::make_unique<AggregateExecutor>(convert_plan_executor(x->subplan_, context),
+            return std::make_unique<AggregateExecutor>(convert_plan_executor(x->subplan_, context, false, parallel),
                                                        std::move(x->sel_cols_),
                                                        std::move(x->agg_types_),
                                                        std::move(x->group_bys_), std::move(x->havings_), context);
         }
         if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
-            std::unique_ptr<AbstractExecutor> left = convert_plan_executor(x->left_, context);
-            std::unique_ptr<AbstractExecutor> right = convert_plan_executor(x->right_, context);
+            // 哈希连接的两个子算子都只扫描一次
+            bool child_parallel = parallel && x->tag == T_HashJoin;
+            std::unique_ptr<AbstractExecutor> left = convert_plan_executor(x->left_, context, false, child_parallel);
+            std::unique_ptr<AbstractExecutor> right = convert_plan_executor(x->right_, context, false, child_parallel);
 
             // 使用 lambda 表达式并行化 left 和 right 执行器的创建
             // auto left_future = std::async(std::launch::async, [&] {
@@ -238,13 +247,68 @@ public:
                     std::move(left),
                     std::move(right), std::move(x->conds_));
             }
+            if (x->tag == T_HashJoin) {
+                return std::make_unique<HashJoinExecutor>(std::move(left), std::move(right), std::move(x->conds_),
+                                                          x->build_left_, context->spill_);
+            }
             return std::make_unique<SortMergeJoinExecutor>(std::move(left),
                                                            std::move(right), std::move(x->conds_));
         }
         if (auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
-            return std::make_unique<SortExecutor>(convert_plan_executor(x->subplan_, context),
-                                                  std::move(x->sel_col_), x->is_desc_);
+            return std::make_unique<SortExecutor>(convert_plan_executor(x->subplan_, context, false, parallel),
+                                                  std::move(x->order_cols_), context->spill_, x->limit_);
         }
         return nullptr;
     }
+
+    /**
+     * @description: 执行条件中的子查询并把结果缓存在条件里。IN 子查询的结果放进哈希集合，
+     * 比较运算符的标量子查询只保留一个值，值都按左列的类型和长度转换好
+     */
+    void materialize_sub_query(Condition &cond, Context *context) {
+        auto prev = convert_plan_executor(cond.sub_query_plan, context);
+        auto &lhs_col = *sm_manager_->db_.get_table(cond.lhs_col.tab_name).get_col(cond.lhs_col.col_name);
+        // 结果类型由子算子的输出列决定，聚合算子已经把 count 的输出列改成了 int
+        ColType rhs_type = prev->cols()[0].type;
+        int rhs_len = prev->cols()[0].len;
+
+        cond.rhs_value_list.clear();
+        TupleBatch batch;
+        for (prev->beginBatch(); prev->NextBatch(batch);) {
+            for (size_t i = 0; i < batch.size(); ++i) {
+                const char *record = batch.get(i);
+                Value value;
+                if (rhs_type == TYPE_INT) {
+                    int int_val = *reinterpret_cast<const int *>(record);
+                    if (lhs_col.type == TYPE_FLOAT) {
+                        value.set_float(static_cast<float>(int_val));
+                    } else {
+                        value.set_int(int_val);
+                    }
+                } else if (rhs_type == TYPE_FLOAT) {
+                    value.set_float(*reinterpret_cast<const float *>(record));
+                } else {
+                    value.set_str(std::string(record, strnlen(record, rhs_len)));
+                    if (value.str_val.size() > static_cast<size_t>(lhs_col.len)) {
+                        // 比左列还长的字符串不可能和左列相等，比较时只看左列长度
+                        if (cond.op == OP_IN) {
+                            continue;
+                        }
+                        value.str_val.resize(lhs_col.len);
+                    }
+                }
+                if (value.type != lhs_col.type) {
+                    throw IncompatibleTypeError(coltype2str(lhs_col.type), coltype2str(value.type));
+                }
+                value.init_raw(lhs_col.len);
+                cond.rhs_value_list.emplace_back(std::move(value));
+                if (cond.op != OP_IN && cond.rhs_value_list.size() > 1) {
+                    throw InternalError("Subquery returns more than 1 row!");
+                }
+            }
+        }
+        if (cond.op == OP_IN) {
+            cond.build_value_set();
+        }
+    }
 };
@@ -13,6 +13,10 @@ See the Mulan PSL v2 for more details. */
 #include <cinttypes>
 #include <cstring>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 static constexpr int BITMAP_WIDTH = 8;
 static constexpr unsigned BITMAP_HIGHEST_BIT = 0x80u; // 128 (2^7)
 
@@ -32,7 +36,7 @@ public:
     static bool is_set(const char *bm, int pos) { return (bm[get_bucket(pos)] & get_bit(pos)) != 0; }
 
     /**
-     * @brief 找下一个为0 or 1的位
+     * @brief 找下一个为0 or 1的位，一次比较 64 位，编译器支持 AVX2 时先按 256 位跳过全 0 或全 1 的区域
      * @param bit false表示要找下一个为0的位，true表示要找下一个为1的位
      * @param bm 要找的起始地址为bm
      * @param max_n 要找的从起始地址开始的偏移为[curr+1,max_n)
@@ -40,23 +44,132 @@ public:
      * @return 找到了就返回偏移位置，没找到就返回max_n
      */
     static int next_bit(bool bit, const char *bm, int max_n, int curr) {
-        for (int i = curr + 1; i < max_n; i++) {
-            if (is_set(bm, i) == bit) {
-                return i;
+        int pos = curr + 1;
+        if (pos >= max_n) {
+            return max_n;
+        }
+        const uint64_t flip = bit ? 0 : ~0ull;
+        // 第一个字从 pos 所在的字节开始读，去掉 pos 之前的位
+        int base = pos & ~(BITMAP_WIDTH - 1);
+        uint64_t word = (load_word(bm, base, max_n) ^ flip) & (~0ull >> (pos - base));
+        while (true) {
+            word &= tail_mask(base, max_n);
+            if (word != 0) {
+                return base + __builtin_clzll(word);
+            }
+            base += WORD_BITS;
+            if (base >= max_n) {
+                return max_n;
+            }
+#ifdef __AVX2__
+            base = skip_chunks(bit, bm, max_n, base);
+            if (base >= max_n) {
+                return max_n;
             }
+#endif
+            word = load_word(bm, base, max_n) ^ flip;
         }
-        return max_n;
     }
 
     // 找第一个为0 or 1的位
     static int first_bit(bool bit, const char *bm, int max_n) { return next_bit(bit, bm, max_n, -1); }
 
+    /**
+     * @brief 把 (curr, max_n) 中为 1 的位的偏移按顺序写到 out 中，最多写 max_out 个
+     * @return 写入的个数
+     */
+    static int collect_set_bits(const char *bm, int max_n, int curr, int *out, int max_out) {
+        int n = 0;
+        int pos = curr + 1;
+        if (pos >= max_n || max_out <= 0) {
+            return n;
+        }
+        int base = pos & ~(BITMAP_WIDTH - 1);
+        uint64_t word = load_word(bm, base, max_n) & (~0ull >> (pos - base));
+        while (true) {
+            word &= tail_mask(base, max_n);
+            while (word != 0) {
+                int lz = __builtin_clzll(word);
+                out[n] = base + lz;
+                if (++n == max_out) {
+                    return n;
+                }
+                word &= ~(HIGHEST_WORD_BIT >> lz);
+            }
+            base += WORD_BITS;
+            if (base >= max_n) {
+                return n;
+            }
+            word = load_word(bm, base, max_n);
+        }
+    }
+
+    // [0, max_n) 中为 1 的位的个数
+    static int count(const char *bm, int max_n) {
+        int cnt = 0;
+        for (int base = 0; base < max_n; base += WORD_BITS) {
+            cnt += __builtin_popcountll(load_word(bm, base, max_n) & tail_mask(base, max_n));
+        }
+        return cnt;
+    }
+
+    // [0, n) 位全部置 1
+    static void set_prefix(char *bm, int n) {
+        memset(bm, 0xff, n / BITMAP_WIDTH);
+        if (n % BITMAP_WIDTH != 0) {
+            bm[n / BITMAP_WIDTH] |= static_cast<char>(~(0xffu >> (n % BITMAP_WIDTH)));
+        }
+    }
+
     // for example:
     // rid_.slot_no = Bitmap::next_bit(true, page_handle.bitmap, file_handle_->file_hdr_.num_records_per_page,
     // rid_.slot_no); int slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
 
 private:
+    static constexpr int WORD_BITS = 64;
+    static constexpr uint64_t HIGHEST_WORD_BIT = 1ull << 63;
+
     static int get_bucket(int pos) { return pos / BITMAP_WIDTH; }
 
+    /**
+     * @brief 从第 base 位（必须是字节边界）开始读 64 位，第 base 位在最高位，和字节内的位序一致。
+     * 不会读 max_n 所在字节之后的内存，读不满的部分补 0
+     */
+    static uint64_t load_word(const char *bm, int base, int max_n) {
+        int bytes = (max_n - base + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        uint64_t word = 0;
+        if (bytes >= static_cast<int>(sizeof(uint64_t))) {
+            memcpy(&word, bm + base / BITMAP_WIDTH, sizeof(uint64_t));
+        } else {
+            memcpy(&word, bm + base / BITMAP_WIDTH, bytes);
+        }
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        return word;
+    }
+
+    // 从 base 开始的字中属于 [base, max_n) 的位
+    static uint64_t tail_mask(int base, int max_n) {
+        int valid = max_n - base;
+        return valid >= WORD_BITS ? ~0ull : ~(~0ull >> valid);
+    }
+
+#ifdef __AVX2__
+    // 从 base（64 位对齐）开始按 256 位跳过没有要找的位的区域，返回第一个可能有要找的位的块的起点
+    static int skip_chunks(bool bit, const char *bm, int max_n, int base) {
+        constexpr int CHUNK_BITS = 256;
+        while (base + CHUNK_BITS <= max_n) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bm + base / BITMAP_WIDTH));
+            bool skip = bit ? _mm256_testz_si256(chunk, chunk) : _mm256_testc_si256(chunk, _mm256_set1_epi8(-1));
+            if (!skip) {
+                break;
+            }
+            base += CHUNK_BITS;
+        }
+        return base;
+    }
+#endif
+
     static char get_bit(int pos) { return BITMAP_HIGHEST_BIT >> static_cast<char>(pos % BITMAP_WIDTH); }
 };
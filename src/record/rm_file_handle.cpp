@@ -35,6 +35,21 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid &rid, Context *cont
     return record;
 }
 
+/**
+ * @description: 把指定位置的记录拷贝到调用者提供的缓冲区中，批量执行时缓冲区在元组之间复用，不用为每条记录分配内存
+ * @param {Rid&} rid 记录所在的位置
+ * @param {char*} buf 长度至少为 record_size 的缓冲区
+ */
+void RmFileHandle::read_record(const Rid &rid, char *buf) const {
+    auto page_handle = fetch_page_handle(rid.page_no);
+    if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    memcpy(buf, page_handle.get_slot(rid.slot_no), file_hdr_.record_size);
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+}
+
 /**
  * @description: 在当前表中插入一条记录，不指定插入位置
  * @param {char*} buf 要插入的记录的数据
@@ -52,7 +67,6 @@ Rid RmFileHandle::insert_record(char *buf, Context *context) {
     // TODO 这里实际上是以一个页面放一个记录，太占用空间了！
     auto page_handle = create_page_handle();
     page_handle.page->WLatch();
-    // TODO 算法优化
     auto slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
 
     // 行级 X 锁
@@ -101,23 +115,59 @@ void RmFileHandle::insert_record(const Rid &rid, char *buf) {
 }
 
 /** 为 load 载入数据 免检查 直接找到插入位置
- * @description: 在当前表中的指定位置插入一条记录
- * @param {Rid&} rid 要插入记录的位置
- * @param {char*} buf 要插入记录的数据
+ * @description: 把一页记录作为新页面追加到表文件末尾。页面不经过缓冲池，在内存中攒满一批后
+ * 通过 I/O 后端一次提交，load 结束时需要调用 finish_load 写入最后一批
+ * @param {int&} page_no 新页面的页号，必须是文件的下一个页号
+ * @param {char*&} data 页面中的记录
+ * @param {int} nums_record 记录个数
+ * @param {int} page_size 记录的总字节数
  */
 void RmFileHandle::load_record(int &page_no, char *&data, int nums_record, int page_size) {
-    PageId page_id{fd_, page_no};
-    auto page_handle = RmPageHandle{&file_hdr_, buffer_pool_manager_->new_page(&page_id)};
-    assert(page_id.page_no == page_no);
-    memcpy(page_handle.slots, data, page_size);
-    for (int i = 0; i < nums_record; ++i) {
-        Bitmap::set(page_handle.bitmap, i);
-    }
-    page_handle.page_hdr->num_records += nums_record;
-    page_handle.page_hdr->next_free_page_no = INVALID_PAGE_ID;
+    page_id_t allocated = disk_manager_->allocate_page(fd_);
+    assert(allocated == page_no);
+    std::ignore = allocated;
+    if (load_pages_.empty()) {
+        load_start_page_no_ = page_no;
+    }
+    size_t offset = load_pages_.size();
+    // resize 把新页面清零，和缓冲池中的新页面一样
+    load_pages_.resize(offset + PAGE_SIZE);
+    char *page = load_pages_.data() + offset;
+    lsn_t lsn = INVALID_LSN;
+    memcpy(page + Page::OFFSET_LSN, &lsn, sizeof(lsn_t));
+    auto *page_hdr = reinterpret_cast<RmPageHdr *>(page + Page::OFFSET_PAGE_HDR);
+    char *bitmap = page + Page::OFFSET_PAGE_HDR + sizeof(RmPageHdr);
+    memcpy(bitmap + file_hdr_.bitmap_size, data, page_size);
+    Bitmap::set_prefix(bitmap, nums_record);
+    page_hdr->num_records = nums_record;
+    page_hdr->next_free_page_no = INVALID_PAGE_ID;
     ++file_hdr_.num_pages;
-    // file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
-    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+    if (load_pages_.size() >= static_cast<size_t>(LOAD_WRITE_BATCH_PAGES) * PAGE_SIZE) {
+        finish_load();
+    }
+}
+
+/**
+ * @description: 把 load_record 攒下的页面一次提交给 I/O 后端写入文件，每个页面一个写请求
+ */
+void RmFileHandle::finish_load() {
+    size_t num_pages = load_pages_.size() / PAGE_SIZE;
+    if (num_pages == 0) {
+        return;
+    }
+    std::vector<IoRequest> requests;
+    requests.reserve(num_pages);
+    for (size_t i = 0; i < num_pages; ++i) {
+        requests.push_back(IoRequest::write(fd_, load_pages_.data() + i * PAGE_SIZE, PAGE_SIZE,
+                                            static_cast<off_t>(load_start_page_no_ + i) * PAGE_SIZE));
+    }
+    disk_manager_->submit_io(requests.data(), requests.size());
+    load_pages_.clear();
+    for (auto &request: requests) {
+        if (request.result != PAGE_SIZE) {
+            throw InternalError("RmFileHandle::finish_load: Write Error");
+        }
+    }
 }
 
 /**
@@ -250,3 +300,61 @@ void RmFileHandle::release_page_handle(RmPageHandle &page_handle) {
     page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
     file_hdr_.first_free_page_no = page_handle.page->get_page_id().page_no;
 }
+
+/**
+ * @description: redo 插入日志，把记录写到页面中指定的slot，只修改页面本身
+ * @param {RmPageHandle&} page_handle 记录所在的页面，由调用者pin住
+ * @param {int} slot_no 记录所在的slot
+ * @param {char*} buf 记录的数据
+ */
+void RmFileHandle::redo_insert_record(RmPageHandle &page_handle, int slot_no, const char *buf) const {
+    if (!Bitmap::is_set(page_handle.bitmap, slot_no)) {
+        Bitmap::set(page_handle.bitmap, slot_no);
+        ++page_handle.page_hdr->num_records;
+    }
+    memcpy(page_handle.get_slot(slot_no), buf, file_hdr_.record_size);
+}
+
+/**
+ * @description: redo 删除日志，只修改页面本身，slot上没有记录时跳过
+ * @param {RmPageHandle&} page_handle 记录所在的页面，由调用者pin住
+ * @param {int} slot_no 记录所在的slot
+ */
+void RmFileHandle::redo_delete_record(RmPageHandle &page_handle, int slot_no) const {
+    if (Bitmap::is_set(page_handle.bitmap, slot_no)) {
+        Bitmap::reset(page_handle.bitmap, slot_no);
+        --page_handle.page_hdr->num_records;
+    }
+}
+
+/**
+ * @description: redo 更新日志，slot上没有记录时跳过
+ * @param {RmPageHandle&} page_handle 记录所在的页面，由调用者pin住
+ * @param {int} slot_no 记录所在的slot
+ * @param {char*} buf 新记录的数据
+ */
+void RmFileHandle::redo_update_record(RmPageHandle &page_handle, int slot_no, const char *buf) const {
+    if (Bitmap::is_set(page_handle.bitmap, slot_no)) {
+        memcpy(page_handle.get_slot(slot_no), buf, file_hdr_.record_size);
+    }
+}
+
+/**
+ * @description: 按页面中的记录个数重建空闲页面链表，链表按页号从小到大连接所有未满的页面。
+ *              redo 工作线程不维护空闲页面链表，所有工作线程结束后对重做过的表调用
+ */
+void RmFileHandle::rebuild_free_page_list() {
+    std::lock_guard lock(latch_);
+    page_id_t next_free_page_no = RM_NO_PAGE;
+    for (page_id_t page_no = file_hdr_.num_pages - 1; page_no >= RM_FIRST_RECORD_PAGE; --page_no) {
+        auto page_handle = fetch_page_handle(page_no);
+        bool is_dirty = false;
+        if (page_handle.page_hdr->num_records < file_hdr_.num_records_per_page) {
+            is_dirty = page_handle.page_hdr->next_free_page_no != next_free_page_no;
+            page_handle.page_hdr->next_free_page_no = next_free_page_no;
+            next_free_page_no = page_no;
+        }
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), is_dirty);
+    }
+    file_hdr_.first_free_page_no = next_free_page_no;
+}
@@ -55,6 +55,8 @@ private:
     int fd_; // 打开文件后产生的文件句柄
     RmFileHdr file_hdr_; // 文件头，维护当前表文件的元数据
     std::mutex latch_;
+    std::vector<char> load_pages_; // load_record 攒下的页面，满 LOAD_WRITE_BATCH_PAGES 页后一批写入
+    page_id_t load_start_page_no_ = INVALID_PAGE_ID; // load_pages_ 中第一个页面的页号
 
 public:
     RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
@@ -79,8 +81,12 @@ public:
 
     std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
 
+    void read_record(const Rid &rid, char *buf) const;
+
     void load_record(int &page_no, char *&data, int nums_record, int page_size);
 
+    void finish_load();
+
     void set_first_free_page_no(page_id_t page_no) { file_hdr_.first_free_page_no = page_no; }
 
     Rid insert_record(char *buf, Context *context);
@@ -95,6 +101,16 @@ public:
 
     RmPageHandle fetch_page_handle(int page_no) const;
 
+    /* 以下函数供故障恢复时的 redo 工作线程使用，只修改给定的页面，不读写文件头中的页面个数和空闲页面链表，
+     * 不同页面可以在多个线程中并行重做。redo 结束后调用 rebuild_free_page_list 重建空闲页面链表 */
+    void redo_insert_record(RmPageHandle &page_handle, int slot_no, const char *buf) const;
+
+    void redo_delete_record(RmPageHandle &page_handle, int slot_no) const;
+
+    void redo_update_record(RmPageHandle &page_handle, int slot_no, const char *buf) const;
+
+    void rebuild_free_page_list();
+
 private:
     RmPageHandle create_page_handle();
 
@@ -15,11 +15,18 @@ See the Mulan PSL v2 for more details. */
  * @brief 初始化file_handle和rid
  * @param file_handle
  */
-RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
+RmScan::RmScan(const RmFileHandle *file_handle) : RmScan(file_handle, RM_FIRST_RECORD_PAGE, -1) {}
+
+/**
+ * @brief 只扫描 [first_page, end_page) 范围内的页面，并行扫描时每个 morsel 用一个 RmScan
+ * @param end_page 为 -1 时扫描到文件末尾，扫描过程中追加的页面也会被扫描到
+ */
+RmScan::RmScan(const RmFileHandle *file_handle, int first_page, int end_page)
+    : file_handle_(file_handle), end_page_(end_page) {
     // Todo:
     // 初始化file_handle和rid（指向第一个存放了记录的位置）
-    rid_ = {RM_FIRST_RECORD_PAGE, -1};
-    if (rid_.page_no < file_handle_->file_hdr_.num_pages) {
+    rid_ = {first_page, -1};
+    if (rid_.page_no < (end_page_ < 0 ? file_handle_->file_hdr_.num_pages : end_page_)) {
         cur_page_handle_ = file_handle_->fetch_page_handle(rid_.page_no);
         // 这里设置-1，Bit::next_bit即是0，直接设置为0，会少判断0
         next();
@@ -28,6 +35,15 @@ RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
     rid_.page_no = RM_NO_PAGE;
 }
 
+/**
+ * @brief 没扫完就销毁时，当前页面还 pin 着，需要 unpin
+ */
+RmScan::~RmScan() {
+    if (!is_end()) {
+        file_handle_->buffer_pool_manager_->unpin_page(cur_page_handle_.page->get_page_id(), false);
+    }
+}
+
 /**
  * @brief 找到文件中下一个存放了记录的位置
  */
@@ -42,7 +58,7 @@ void RmScan::next() {
         }
         // 一定要 unpin，否则多次 scan 以后所有页面都会无法替换！
         file_handle_->buffer_pool_manager_->unpin_page(cur_page_handle_.page->get_page_id(), false);
-        if (++rid_.page_no >= file_handle_->file_hdr_.num_pages) {
+        if (++rid_.page_no >= (end_page_ < 0 ? file_handle_->file_hdr_.num_pages : end_page_)) {
             break;
         }
         cur_page_handle_ = file_handle_->fetch_page_handle(rid_.page_no);
@@ -83,3 +99,31 @@ std::unique_ptr<RmRecord> RmScan::get_record() {
     return std::make_unique<RmRecord>(cur_page_handle_.get_slot(rid_.slot_no), file_handle_->file_hdr_.record_size,
                                       true);
 }
+
+/**
+ * @brief 当前记录在 pin 住的页面中的地址，不拷贝也不访问缓冲池，只在调用 next() 之前有效
+ */
+const char *RmScan::get_slot() const {
+    return cur_page_handle_.get_slot(rid_.slot_no);
+}
+
+/**
+ * @brief 从当前记录开始，收集当前页面中最多 max 条记录的槽位地址和槽号。
+ * 扫描停在最后一条收集到的记录上，页面仍然 pin 着，调用者用完这些槽位后再调用 next()
+ * @return 收集到的记录条数，扫描已经结束时为 0
+ */
+size_t RmScan::collect_page(size_t max, const char **slots, int *slot_nos) {
+    size_t n = 0;
+    if (is_end() || max == 0) {
+        return n;
+    }
+    // 当前记录之后的槽号按字从 bitmap 中批量取出
+    slot_nos[0] = rid_.slot_no;
+    n = 1 + Bitmap::collect_set_bits(cur_page_handle_.bitmap, file_handle_->file_hdr_.num_records_per_page,
+                                     rid_.slot_no, slot_nos + 1, static_cast<int>(max - 1));
+    for (size_t i = 0; i < n; ++i) {
+        slots[i] = cur_page_handle_.get_slot(slot_nos[i]);
+    }
+    rid_.slot_no = slot_nos[n - 1];
+    return n;
+}
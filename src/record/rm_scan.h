@@ -20,10 +20,19 @@ private:
     const RmFileHandle *file_handle_;
     RmPageHandle cur_page_handle_;
     Rid rid_;
+    int end_page_;  // 扫描到这个页面之前结束，-1 表示扫描到文件末尾
 
 public:
     RmScan(const RmFileHandle *file_handle);
 
+    RmScan(const RmFileHandle *file_handle, int first_page, int end_page);
+
+    RmScan(const RmScan &) = delete;
+
+    RmScan &operator=(const RmScan &) = delete;
+
+    ~RmScan() override;
+
     void next() override;
 
     bool is_end() const override;
@@ -31,4 +40,8 @@ public:
     Rid rid() const override;
 
     std::unique_ptr<RmRecord> get_record();
+
+    const char *get_slot() const;
+
+    size_t collect_page(size_t max, const char **slots, int *slot_nos);
 };
@@ -10,33 +10,240 @@ See the Mulan PSL v2 for more details. */
 
 #include <cstring>
 #include "log_manager.h"
+#include "errors.h"
 
 /**
- * @description: 添加日志记录到日志缓冲区中，并返回日志记录号
+ * @description: 添加日志记录到日志缓冲区中，并返回日志记录号。
+ *               通过一次 fetch_add 预留lsn和缓冲区空间后各自序列化，多个线程可以并行写入同一个缓冲区
  * @param {LogRecord*} log_record 要写入缓冲区的日志记录
  * @return {lsn_t} 返回该日志的日志记录号
  */
 lsn_t LogManager::add_log_to_buffer(LogRecord *log_record) {
-    latch_.lock();
-    if (log_buffer_.is_full(log_record->log_tot_len_)) {
-        flush_log_to_disk();
+    uint32_t size = log_record->log_tot_len_;
+    if (size > LOG_BUFFER_SIZE) {
+        throw InternalError("LogManager::add_log_to_buffer: log record is larger than log buffer");
     }
-    log_record->lsn_ = global_lsn_++;
-    log_record->serialize(log_buffer_.buffer_ + log_buffer_.offset_);
-    log_buffer_.offset_ += log_record->log_tot_len_;
-    latch_.unlock();
-    return log_record->lsn_;
+    while (true) {
+        uint64_t word = reserve_.fetch_add((1ULL << RESERVE_LSN_SHIFT) | size);
+        uint32_t seq = reserve_seq(word);
+        uint32_t offset = reserve_offset(word);
+        if (offset + size <= LOG_BUFFER_SIZE) {
+            auto &buffer = get_buffer(seq);
+            log_record->lsn_ = reserve_lsn(word);
+            log_record->serialize(buffer.buffer_ + offset);
+            buffer.written_.fetch_add(size, std::memory_order_release);
+            return log_record->lsn_;
+        }
+        // 预留失败，第一个越过缓冲区末尾的线程负责封存当前缓冲区，其他线程等待切换到下一个缓冲区后重试
+        if (offset <= LOG_BUFFER_SIZE) {
+            seal_full_buffer(seq, offset);
+        } else {
+            wait_for_switch(seq);
+        }
+    }
+}
+
+/**
+ * @description: 封存写满的缓冲区并切换到下一个缓冲区，下一个缓冲区还没写盘时等待后台线程
+ * @param {uint32_t} seq 写满的缓冲区序号
+ * @param {uint32_t} offset 缓冲区的有效长度，即第一个预留失败的记录的偏移
+ */
+void LogManager::seal_full_buffer(uint32_t seq, uint32_t offset) {
+    auto &buffer = get_buffer(seq);
+    auto &next = get_buffer(seq + 1);
+    std::unique_lock lk(latch_);
+    cv_.notify_one();
+    buffer_cv_.wait(lk, [&] { return !next.is_sealed_.load(std::memory_order_acquire); });
+
+    // 偏移已经越界，后台线程不会再封存这个缓冲区，只有当前线程会修改序号
+    uint64_t word = reserve_.load();
+    while (!reserve_.compare_exchange_weak(word, pack_reserve(reserve_lsn(word), seq + 1, 0))) {
+    }
+    buffer.offset_ = offset;
+    buffer.end_lsn_ = reserve_lsn(word);
+    buffer.is_sealed_.store(true, std::memory_order_release);
+    buffer_cv_.notify_all();
+    cv_.notify_one();
+}
+
+/**
+ * @description: 等待序号为seq的缓冲区被封存，切换到下一个缓冲区
+ */
+void LogManager::wait_for_switch(uint32_t seq) {
+    std::unique_lock lk(latch_);
+    buffer_cv_.wait(lk, [&] { return reserve_seq(reserve_.load()) != seq; });
+}
+
+/**
+ * @description: 设置下一个分配的lsn，只在恢复时、没有其他线程写日志时调用
+ */
+void LogManager::set_global_lsn(lsn_t global_lsn) {
+    uint64_t word = reserve_.load();
+    reserve_.store(pack_reserve(global_lsn, reserve_seq(word), reserve_offset(word)));
+}
+
+/**
+ * @description: 重置日志位置索引，lsn及之后的日志从日志文件的offset处开始。恢复完成或日志文件被清空后调用
+ * @param {lsn_t} lsn 下一条日志的lsn
+ * @param {off_t} offset 日志文件当前的大小
+ */
+void LogManager::set_log_offset(lsn_t lsn, off_t offset) {
+    std::lock_guard lock(latch_);
+    log_offsets_.clear();
+    log_offsets_.emplace_back(lsn, offset);
+}
+
+/**
+ * @description: 查找lsn所在缓冲区在日志文件中的起始位置，lsn不小于它的日志都在这个位置之后。lsn需已落盘
+ * @return {off_t} 日志文件中的偏移，lsn早于索引中最早的位置时返回最早的位置
+ * @param {lsn_t} lsn 日志号
+ */
+off_t LogManager::get_log_offset(lsn_t lsn) {
+    std::lock_guard lock(latch_);
+    if (log_offsets_.empty()) {
+        return 0;
+    }
+    auto it = std::upper_bound(log_offsets_.begin(), log_offsets_.end(), lsn,
+                               [](lsn_t lsn, const std::pair<lsn_t, off_t> &entry) { return lsn < entry.first; });
+    if (it == log_offsets_.begin()) {
+        return it->second;
+    }
+    return std::prev(it)->second;
 }
 
 /**
- * @description: 把日志缓冲区的内容刷到磁盘中，由于目前只设置了一个缓冲区，因此需要阻塞其他日志操作
+ * @description: 日志文件中offset之前的部分被截断后，删除不再需要的位置索引
+ * @param {off_t} offset 截断的位置
+ */
+void LogManager::truncate_log_offsets(off_t offset) {
+    std::lock_guard lock(latch_);
+    while (log_offsets_.size() > 1 && log_offsets_[1].second <= offset) {
+        log_offsets_.pop_front();
+    }
+}
+
+/**
+ * @description: 把日志缓冲区的内容刷到磁盘中，返回时之前写入的日志都已经持久化
  */
 void LogManager::flush_log_to_disk() {
-    // std::lock_guard lock(latch_);
-    if (log_buffer_.offset_ == 0) {
+    wait_for_flush(reserve_lsn(reserve_.load()) - 1);
+}
+
+/**
+ * @description: 等待lsn及之前的日志全部落盘，用于事务提交。等待期间到达的其他提交会和它合并成一次刷盘
+ * @param {lsn_t} lsn 需要持久化的日志号
+ */
+void LogManager::wait_for_flush(lsn_t lsn) {
+    std::unique_lock lk(latch_);
+    if (lsn <= persist_lsn_) {
         return;
     }
-    disk_manager_->write_log(log_buffer_.buffer_, log_buffer_.offset_);
-    log_buffer_.offset_ = 0;
-    persist_lsn_ = global_lsn_ - 1;
+    flush_lsn_ = std::max(flush_lsn_, lsn);
+    // 这一组的第一个提交唤醒刷盘线程开始计时，凑满一组时让它立即刷盘
+    if (++group_size_ == 1 || group_size_ >= group_commit_max_batch_) {
+        cv_.notify_one();
+    }
+    flushed_cv_.wait(lk, [&] { return persist_lsn_ >= lsn; });
+}
+
+/**
+ * @description: 后台刷盘线程。有提交在等待且存在并发提交时，最多等待group_commit_max_wait_让更多提交加入同一组，
+ *               然后一次写入并fdatasync；有写满的缓冲区时立即写盘；其他情况每隔log_flush_interval_刷一次盘
+ */
+void LogManager::background_flush() {
+    std::unique_lock lk(latch_);
+    while (true) {
+        cv_.wait_for(lk, log_flush_interval_, [this] {
+            return !run_background_thread_ || flush_lsn_ > persist_lsn_ ||
+                   get_buffer(flush_seq_).is_sealed_.load(std::memory_order_acquire);
+        });
+        // 上一组只有一个提交时说明没有并发提交，等待只会增加延迟
+        if (run_background_thread_ && flush_lsn_ > persist_lsn_ && last_group_size_ > 1 &&
+            group_size_ < group_commit_max_batch_ && group_commit_max_wait_.count() > 0) {
+            cv_.wait_for(lk, group_commit_max_wait_, [this] {
+                return !run_background_thread_ || group_size_ >= group_commit_max_batch_;
+            });
+        }
+        if (group_size_ > 0) {
+            last_group_size_ = group_size_;
+        }
+        group_size_ = 0;
+        bool stop = !run_background_thread_;
+        // 写盘时不持有latch_，提交事务可以继续加入下一组
+        lk.unlock();
+        flush_buffers();
+        lk.lock();
+        if (stop) {
+            break;
+        }
+    }
+}
+
+/**
+ * @description: 封存当前正在写入的缓冲区，由后台线程调用
+ * @return {bool} 缓冲区为空时返回false，此时之前的日志都已经持久化
+ */
+bool LogManager::seal_current_buffer() {
+    auto &buffer = get_buffer(flush_seq_);
+    uint64_t word = reserve_.load();
+    while (true) {
+        if (reserve_seq(word) != (flush_seq_ & RESERVE_SEQ_MASK) || reserve_offset(word) > LOG_BUFFER_SIZE) {
+            // 缓冲区已写满，由预留失败的写入线程封存
+            std::unique_lock lk(latch_);
+            buffer_cv_.wait(lk, [&] { return buffer.is_sealed_.load(std::memory_order_acquire); });
+            return true;
+        }
+        if (reserve_offset(word) == 0) {
+            std::lock_guard lock(latch_);
+            persist_lsn_ = std::max(persist_lsn_.load(), reserve_lsn(word) - 1);
+            flushed_cv_.notify_all();
+            return false;
+        }
+        // 之前的缓冲区都已写盘，下一个缓冲区一定是空闲的
+        if (reserve_.compare_exchange_weak(word, pack_reserve(reserve_lsn(word), flush_seq_ + 1, 0))) {
+            std::lock_guard lock(latch_);
+            buffer.offset_ = reserve_offset(word);
+            buffer.end_lsn_ = reserve_lsn(word);
+            buffer.is_sealed_.store(true, std::memory_order_release);
+            buffer_cv_.notify_all();
+            return true;
+        }
+    }
+}
+
+/**
+ * @description: 按顺序把所有已封存的缓冲区以及当前缓冲区写入日志文件并fdatasync，然后唤醒等待落盘的提交事务。
+ *               写盘期间写入线程继续填充下一个缓冲区
+ */
+void LogManager::flush_buffers() {
+    while (true) {
+        auto &buffer = get_buffer(flush_seq_);
+        bool is_current = !buffer.is_sealed_.load(std::memory_order_acquire);
+        if (is_current && !seal_current_buffer()) {
+            return;
+        }
+        // 等待预留了空间的线程完成序列化
+        while (buffer.written_.load(std::memory_order_acquire) != buffer.offset_) {
+            std::this_thread::yield();
+        }
+        off_t file_offset = disk_manager_->get_log_size();
+        disk_manager_->write_log(buffer.buffer_, buffer.offset_);
+        disk_manager_->sync_log();
+        {
+            std::lock_guard lock(latch_);
+            lsn_t first_lsn = persist_lsn_ + 1;
+            if (log_offsets_.empty() || log_offsets_.back().first < first_lsn) {
+                log_offsets_.emplace_back(first_lsn, file_offset);
+            }
+            persist_lsn_ = buffer.end_lsn_ - 1;
+            buffer.written_.store(0, std::memory_order_relaxed);
+            buffer.is_sealed_.store(false, std::memory_order_release);
+            ++flush_seq_;
+            flushed_cv_.notify_all();
+            buffer_cv_.notify_all();
+        }
+        if (is_current) {
+            return;
+        }
+    }
 }
@@ -10,10 +10,13 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <algorithm>
+#include <deque>
 #include <mutex>
 #include <vector>
 #include <iostream>
 #include <thread>
+#include <condition_variable>
 
 #include "log_defs.h"
 #include "common/config.h"
@@ -27,7 +30,11 @@ enum LogType: int {
     BEGIN,
     COMMIT,
     ABORT,
-    STATIC_CHECKPOINT
+    STATIC_CHECKPOINT,
+    BEGIN_CHECKPOINT,
+    END_CHECKPOINT,
+    INDEX_PAGE,
+    INDEX_HEADER
 };
 
 static std::string LogTypeStr[] = {
@@ -37,7 +44,11 @@ static std::string LogTypeStr[] = {
     "BEGIN",
     "COMMIT",
     "ABORT",
-    "STATIC_CHECKPOINT"
+    "STATIC_CHECKPOINT",
+    "BEGIN_CHECKPOINT",
+    "END_CHECKPOINT",
+    "INDEX_PAGE",
+    "INDEX_HEADER"
 };
 
 class LogRecord {
@@ -110,6 +121,161 @@ public:
     }
 };
 
+/**
+ * 模糊检查点开始的日志记录，写入后记录活跃事务表和脏页表，期间事务可以继续执行
+*/
+class BeginCheckpointLogRecord : public LogRecord {
+public:
+    BeginCheckpointLogRecord() {
+        log_type_ = BEGIN_CHECKPOINT;
+        lsn_ = INVALID_LSN;
+        log_tot_len_ = LOG_HEADER_SIZE;
+        log_tid_ = INVALID_TXN_ID;
+        prev_lsn_ = INVALID_LSN;
+    }
+
+    void serialize(char *dest) const override {
+        LogRecord::serialize(dest);
+    }
+
+    void deserialize(const char *src) override {
+        LogRecord::deserialize(src);
+    }
+
+    void format_print() override {
+        std::cout << "log type in son_function: " << LogTypeStr[log_type_] << "\n";
+        LogRecord::format_print();
+    }
+};
+
+/* 检查点时的活跃事务 */
+struct CheckpointTxnEntry {
+    txn_id_t txn_id;
+    lsn_t begin_lsn; // 事务 begin 日志的lsn，undo 需要从这里开始的日志
+    lsn_t last_lsn; // 事务最后一条日志的lsn
+};
+
+/* 检查点时的脏页，rec_lsn 之前的修改都已经在磁盘上 */
+struct CheckpointPageEntry {
+    std::string file_name;
+    page_id_t page_no;
+    lsn_t rec_lsn;
+};
+
+/**
+ * 模糊检查点结束的日志记录，携带检查点开始时的活跃事务表（ATT）和脏页表（DPT）
+*/
+class EndCheckpointLogRecord : public LogRecord {
+public:
+    EndCheckpointLogRecord() {
+        log_type_ = END_CHECKPOINT;
+        lsn_ = INVALID_LSN;
+        log_tot_len_ = LOG_HEADER_SIZE + sizeof(lsn_t) + sizeof(txn_id_t) + 2 * sizeof(uint32_t);
+        log_tid_ = INVALID_TXN_ID;
+        prev_lsn_ = INVALID_LSN;
+        begin_lsn_ = INVALID_LSN;
+        next_txn_id_ = INVALID_TXN_ID;
+    }
+
+    /**
+     * @param {lsn_t} begin_lsn 对应的检查点开始日志
+     * @param {txn_id_t} next_txn_id 检查点时下一个分配的事务ID
+     * @param {vector<CheckpointTxnEntry>} att 活跃事务表
+     * @param {vector<CheckpointPageEntry>} dpt 脏页表，超过日志缓冲区大小时只保留 rec_lsn 最小的部分
+     */
+    EndCheckpointLogRecord(lsn_t begin_lsn, txn_id_t next_txn_id, std::vector<CheckpointTxnEntry> att,
+                           std::vector<CheckpointPageEntry> dpt) : EndCheckpointLogRecord() {
+        begin_lsn_ = begin_lsn;
+        next_txn_id_ = next_txn_id;
+        att_ = std::move(att);
+        dpt_ = std::move(dpt);
+        log_tot_len_ += att_.size() * sizeof(CheckpointTxnEntry);
+        std::sort(dpt_.begin(), dpt_.end(), [](auto &a, auto &b) { return a.rec_lsn < b.rec_lsn; });
+        size_t num_pages = 0;
+        for (auto &entry: dpt_) {
+            uint32_t entry_len = page_entry_size(entry);
+            if (log_tot_len_ + entry_len > LOG_BUFFER_SIZE) {
+                break;
+            }
+            log_tot_len_ += entry_len;
+            ++num_pages;
+        }
+        dpt_.resize(num_pages);
+    }
+
+    void serialize(char *dest) const override {
+        LogRecord::serialize(dest);
+        int offset = OFFSET_LOG_DATA;
+        memcpy(dest + offset, &begin_lsn_, sizeof(lsn_t));
+        offset += sizeof(lsn_t);
+        memcpy(dest + offset, &next_txn_id_, sizeof(txn_id_t));
+        offset += sizeof(txn_id_t);
+        uint32_t num_txns = att_.size();
+        memcpy(dest + offset, &num_txns, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        memcpy(dest + offset, att_.data(), num_txns * sizeof(CheckpointTxnEntry));
+        offset += num_txns * sizeof(CheckpointTxnEntry);
+        uint32_t num_pages = dpt_.size();
+        memcpy(dest + offset, &num_pages, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        for (auto &entry: dpt_) {
+            uint32_t name_len = entry.file_name.size();
+            memcpy(dest + offset, &name_len, sizeof(uint32_t));
+            offset += sizeof(uint32_t);
+            memcpy(dest + offset, entry.file_name.data(), name_len);
+            offset += name_len;
+            memcpy(dest + offset, &entry.page_no, sizeof(page_id_t));
+            offset += sizeof(page_id_t);
+            memcpy(dest + offset, &entry.rec_lsn, sizeof(lsn_t));
+            offset += sizeof(lsn_t);
+        }
+    }
+
+    void deserialize(const char *src) override {
+        LogRecord::deserialize(src);
+        int offset = OFFSET_LOG_DATA;
+        begin_lsn_ = *reinterpret_cast<const lsn_t *>(src + offset);
+        offset += sizeof(lsn_t);
+        next_txn_id_ = *reinterpret_cast<const txn_id_t *>(src + offset);
+        offset += sizeof(txn_id_t);
+        uint32_t num_txns = *reinterpret_cast<const uint32_t *>(src + offset);
+        offset += sizeof(uint32_t);
+        att_.resize(num_txns);
+        memcpy(att_.data(), src + offset, num_txns * sizeof(CheckpointTxnEntry));
+        offset += num_txns * sizeof(CheckpointTxnEntry);
+        uint32_t num_pages = *reinterpret_cast<const uint32_t *>(src + offset);
+        offset += sizeof(uint32_t);
+        dpt_.resize(num_pages);
+        for (auto &entry: dpt_) {
+            uint32_t name_len = *reinterpret_cast<const uint32_t *>(src + offset);
+            offset += sizeof(uint32_t);
+            entry.file_name.assign(src + offset, name_len);
+            offset += name_len;
+            entry.page_no = *reinterpret_cast<const page_id_t *>(src + offset);
+            offset += sizeof(page_id_t);
+            entry.rec_lsn = *reinterpret_cast<const lsn_t *>(src + offset);
+            offset += sizeof(lsn_t);
+        }
+    }
+
+    void format_print() override {
+        std::cout << "log type in son_function: " << LogTypeStr[log_type_] << "\n";
+        LogRecord::format_print();
+        printf("begin lsn: %d, next txn id: %d, active txns: %zu, dirty pages: %zu\n", begin_lsn_, next_txn_id_,
+               att_.size(), dpt_.size());
+    }
+
+    lsn_t begin_lsn_; // 对应的检查点开始日志
+    txn_id_t next_txn_id_; // 检查点时下一个分配的事务ID
+    std::vector<CheckpointTxnEntry> att_; // 活跃事务表
+    std::vector<CheckpointPageEntry> dpt_; // 脏页表
+
+private:
+    static uint32_t page_entry_size(const CheckpointPageEntry &entry) {
+        return sizeof(uint32_t) + entry.file_name.size() + sizeof(page_id_t) + sizeof(lsn_t);
+    }
+};
+
 class BeginLogRecord : public LogRecord {
 public:
     BeginLogRecord() {
@@ -450,8 +616,148 @@ public:
     size_t table_name_size_; // 表名称的大小
 };
 
-/* 日志缓冲区，只有一个buffer，因此需要阻塞地去把日志写入缓冲区中 */
+/**
+ * 索引页面的物理逻辑日志：B+树结点的一次修改在页面内做的若干字节写入和移动，只用于 redo。
+ * 索引的回滚由数据日志的 undo 逻辑地完成，因此不属于任何事务，也不加入事务的日志链
+*/
+class IndexPageLogRecord : public LogRecord {
+public:
+    IndexPageLogRecord() {
+        log_type_ = INDEX_PAGE;
+        lsn_ = INVALID_LSN;
+        log_tot_len_ = LOG_HEADER_SIZE + sizeof(page_id_t) + 2 * sizeof(uint32_t);
+        log_tid_ = INVALID_TXN_ID;
+        prev_lsn_ = INVALID_LSN;
+        page_no_ = INVALID_PAGE_ID;
+    }
+
+    /**
+     * @param {string&} index_name 索引文件名
+     * @param {page_id_t} page_no 修改的页面
+     * @param {string&} page_ops 页面内的修改，格式见 IxPageOp
+     */
+    IndexPageLogRecord(const std::string &index_name, page_id_t page_no, const std::string &page_ops)
+        : IndexPageLogRecord() {
+        index_name_ = index_name;
+        page_no_ = page_no;
+        page_ops_ = page_ops;
+        log_tot_len_ += index_name_.size() + page_ops_.size();
+    }
+
+    void serialize(char *dest) const override {
+        LogRecord::serialize(dest);
+        int offset = OFFSET_LOG_DATA;
+        memcpy(dest + offset, &page_no_, sizeof(page_id_t));
+        offset += sizeof(page_id_t);
+        uint32_t name_len = index_name_.size();
+        memcpy(dest + offset, &name_len, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        memcpy(dest + offset, index_name_.data(), name_len);
+        offset += name_len;
+        uint32_t ops_len = page_ops_.size();
+        memcpy(dest + offset, &ops_len, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        memcpy(dest + offset, page_ops_.data(), ops_len);
+    }
+
+    void deserialize(const char *src) override {
+        LogRecord::deserialize(src);
+        int offset = OFFSET_LOG_DATA;
+        page_no_ = *reinterpret_cast<const page_id_t *>(src + offset);
+        offset += sizeof(page_id_t);
+        uint32_t name_len = *reinterpret_cast<const uint32_t *>(src + offset);
+        offset += sizeof(uint32_t);
+        index_name_.assign(src + offset, name_len);
+        offset += name_len;
+        uint32_t ops_len = *reinterpret_cast<const uint32_t *>(src + offset);
+        offset += sizeof(uint32_t);
+        page_ops_.assign(src + offset, ops_len);
+    }
+
+    /**
+     * @description: 不反序列化整条日志，直接取出修改的页面和索引文件名，用于 redo 分发
+     */
+    static void parse_page(const char *src, page_id_t *page_no, std::string *index_name) {
+        int offset = OFFSET_LOG_DATA;
+        *page_no = *reinterpret_cast<const page_id_t *>(src + offset);
+        offset += sizeof(page_id_t);
+        uint32_t name_len = *reinterpret_cast<const uint32_t *>(src + offset);
+        offset += sizeof(uint32_t);
+        index_name->assign(src + offset, name_len);
+    }
+
+    void format_print() override {
+        std::cout << "log type in son_function: " << LogTypeStr[log_type_] << "\n";
+        LogRecord::format_print();
+        printf("index: %s, page_no: %d, ops size: %zu\n", index_name_.c_str(), page_no_, page_ops_.size());
+    }
+
+    std::string index_name_; // 索引文件名
+    page_id_t page_no_; // 修改的页面
+    std::string page_ops_; // 页面内的修改
+};
+
+/**
+ * 索引文件头的日志：根结点或最右叶子结点改变后记录它们的新值。文件头只在检查点和关闭时写回，
+ * redo 时按日志顺序覆盖内存中的文件头，结果与崩溃前一致
+*/
+class IndexHeaderLogRecord : public LogRecord {
+public:
+    IndexHeaderLogRecord() {
+        log_type_ = INDEX_HEADER;
+        lsn_ = INVALID_LSN;
+        log_tot_len_ = LOG_HEADER_SIZE + 2 * sizeof(page_id_t) + sizeof(uint32_t);
+        log_tid_ = INVALID_TXN_ID;
+        prev_lsn_ = INVALID_LSN;
+        root_page_ = last_leaf_ = INVALID_PAGE_ID;
+    }
+
+    IndexHeaderLogRecord(const std::string &index_name, page_id_t root_page, page_id_t last_leaf)
+        : IndexHeaderLogRecord() {
+        index_name_ = index_name;
+        root_page_ = root_page;
+        last_leaf_ = last_leaf;
+        log_tot_len_ += index_name_.size();
+    }
 
+    void serialize(char *dest) const override {
+        LogRecord::serialize(dest);
+        int offset = OFFSET_LOG_DATA;
+        memcpy(dest + offset, &root_page_, sizeof(page_id_t));
+        offset += sizeof(page_id_t);
+        memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
+        offset += sizeof(page_id_t);
+        uint32_t name_len = index_name_.size();
+        memcpy(dest + offset, &name_len, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        memcpy(dest + offset, index_name_.data(), name_len);
+    }
+
+    void deserialize(const char *src) override {
+        LogRecord::deserialize(src);
+        int offset = OFFSET_LOG_DATA;
+        root_page_ = *reinterpret_cast<const page_id_t *>(src + offset);
+        offset += sizeof(page_id_t);
+        last_leaf_ = *reinterpret_cast<const page_id_t *>(src + offset);
+        offset += sizeof(page_id_t);
+        uint32_t name_len = *reinterpret_cast<const uint32_t *>(src + offset);
+        offset += sizeof(uint32_t);
+        index_name_.assign(src + offset, name_len);
+    }
+
+    void format_print() override {
+        std::cout << "log type in son_function: " << LogTypeStr[log_type_] << "\n";
+        LogRecord::format_print();
+        printf("index: %s, root page: %d, last leaf: %d\n", index_name_.c_str(), root_page_, last_leaf_);
+    }
+
+    std::string index_name_; // 索引文件名
+    page_id_t root_page_; // 根结点
+    page_id_t last_leaf_; // 最右叶子结点
+};
+
+/* 日志缓冲区。LogManager 轮流使用 LOG_BUFFER_NUM 个缓冲区：写入线程通过原子操作在当前缓冲区中预留空间并各自序列化，
+ * 缓冲区写满或需要刷盘时被封存，后台线程把封存的缓冲区写入磁盘，同时写入线程继续填充下一个缓冲区 */
 class LogBuffer {
 public:
     LogBuffer() {
@@ -466,10 +772,17 @@ public:
     }
 
     char buffer_[LOG_BUFFER_SIZE + 1];
-    uint32_t offset_; // 写入 log 的 offset
+    uint32_t offset_; // 写入 log 的 offset，对于 LogManager 的缓冲区是封存时的有效长度
+    std::atomic<uint32_t> written_{0}; // 已经序列化完成的字节数，等于 offset_ 时缓冲区可以写盘
+    lsn_t end_lsn_{INVALID_LSN}; // 封存时的下一个lsn，缓冲区写盘后之前的日志都已持久化
+    std::atomic<bool> is_sealed_{false}; // 已封存、等待写盘
 };
 
-/* 日志管理器，负责把日志写入日志缓冲区，以及把日志缓冲区中的内容写入磁盘中 */
+/* 日志管理器，负责把日志写入日志缓冲区，以及把日志缓冲区中的内容写入磁盘中。
+ * 写入日志不需要加锁：reserve_ 把下一个lsn、当前缓冲区序号和缓冲区内偏移打包在一个64位整数中，
+ * 一次 fetch_add 同时分配lsn和缓冲区空间，因此日志在文件中的顺序与lsn顺序一致。
+ * 刷盘由后台线程完成：提交的事务调用 wait_for_flush 等待自己的 commit 日志落盘，
+ * 后台线程把一段时间内到达的多个提交合并成一次 write + fdatasync（group commit） */
 class LogManager {
 public:
     explicit LogManager(DiskManager *disk_manager) : disk_manager_(disk_manager), run_background_thread_(true),
@@ -491,30 +804,79 @@ public:
 
     void flush_log_to_disk();
 
-    inline LogBuffer *get_log_buffer() { return &log_buffer_; }
-    inline lsn_t get_persist_lsn() const { return persist_lsn_; }
-    inline void set_global_lsn(lsn_t global_lsn) { global_lsn_.store(global_lsn); }
-    inline void set_persist_lsn(lsn_t persist_lsn) { persist_lsn_ = persist_lsn; }
+    void wait_for_flush(lsn_t lsn);
+
+    /**
+     * @description: 设置 group commit 的参数
+     * @param {int} max_batch 一组最多包含的提交数，达到后立即刷盘，为 1 时每个提交单独刷盘
+     * @param {microseconds} max_wait 第一个提交到达后最多等待多久再刷盘
+     */
+    void set_group_commit(int max_batch, std::chrono::microseconds max_wait) {
+        std::lock_guard lock(latch_);
+        group_commit_max_batch_ = std::max(max_batch, 1);
+        group_commit_max_wait_ = max_wait;
+    }
+
+    inline lsn_t get_persist_lsn() const { return persist_lsn_.load(); }
+    // 下一条日志将分配的lsn
+    inline lsn_t get_next_lsn() const { return reserve_lsn(reserve_.load()); }
+    void set_global_lsn(lsn_t global_lsn);
+
+    void set_log_offset(lsn_t lsn, off_t offset);
+
+    off_t get_log_offset(lsn_t lsn);
+
+    void truncate_log_offsets(off_t offset);
+    inline void set_persist_lsn(lsn_t persist_lsn) { persist_lsn_.store(persist_lsn); }
 
 private:
-    void background_flush() {
-        std::unique_lock lk(latch_);
-        while (run_background_thread_) {
-            if (cv_.wait_for(lk, log_flush_interval_, [this] { return !run_background_thread_; })) {
-                break;
-            }
-            flush_log_to_disk();
-        }
+    // reserve_ 的布局：高32位为下一个lsn，低32位中高4位为缓冲区序号，低28位为缓冲区内偏移
+    static constexpr int RESERVE_LSN_SHIFT = 32;
+    static constexpr int RESERVE_SEQ_SHIFT = 28;
+    static constexpr uint64_t RESERVE_SEQ_MASK = 0xf;
+    static constexpr uint64_t RESERVE_OFFSET_MASK = (1ULL << RESERVE_SEQ_SHIFT) - 1;
+    static_assert(LOG_BUFFER_NUM >= 2 && (RESERVE_SEQ_MASK + 1) % LOG_BUFFER_NUM == 0);
+    static_assert(2ULL * LOG_BUFFER_SIZE < RESERVE_OFFSET_MASK);
+
+    static uint64_t pack_reserve(lsn_t lsn, uint32_t seq, uint32_t offset) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(lsn)) << RESERVE_LSN_SHIFT) |
+               ((seq & RESERVE_SEQ_MASK) << RESERVE_SEQ_SHIFT) | offset;
     }
+    static lsn_t reserve_lsn(uint64_t word) { return static_cast<lsn_t>(word >> RESERVE_LSN_SHIFT); }
+    static uint32_t reserve_seq(uint64_t word) { return (word >> RESERVE_SEQ_SHIFT) & RESERVE_SEQ_MASK; }
+    static uint32_t reserve_offset(uint64_t word) { return word & RESERVE_OFFSET_MASK; }
+
+    LogBuffer &get_buffer(uint32_t seq) { return log_buffers_[seq % LOG_BUFFER_NUM]; }
+
+    void seal_full_buffer(uint32_t seq, uint32_t offset);
+
+    void wait_for_switch(uint32_t seq);
+
+    void background_flush();
+
+    void flush_buffers();
+
+    bool seal_current_buffer();
 
-    std::condition_variable cv_;
+    std::condition_variable cv_; // 唤醒后台刷盘线程
+    std::condition_variable flushed_cv_; // 唤醒等待日志落盘的提交事务
+    std::condition_variable buffer_cv_; // 缓冲区被封存、切换或写盘完成
     std::thread background_thread_;
     bool run_background_thread_{};
     std::chrono::seconds log_flush_interval_{};
 
-    std::atomic<lsn_t> global_lsn_{0}; // 全局lsn，递增，用于为每条记录分发lsn
-    std::mutex latch_; // 用于对log_buffer_的互斥访问
-    LogBuffer log_buffer_; // 日志缓冲区
-    lsn_t persist_lsn_{}; // 记录已经持久化到磁盘中的最后一条日志的日志号
+    int group_commit_max_batch_{GROUP_COMMIT_MAX_BATCH};
+    std::chrono::microseconds group_commit_max_wait_{GROUP_COMMIT_MAX_WAIT_US};
+    int group_size_{0}; // 当前这一组中等待落盘的提交数
+    int last_group_size_{0}; // 上一组的提交数
+    lsn_t flush_lsn_{INVALID_LSN}; // 提交事务请求落盘的最大lsn
+
+    std::atomic<uint64_t> reserve_{0}; // 下一个lsn、当前缓冲区序号和偏移，用于为每条记录分发lsn和空间
+    std::mutex latch_; // 保护刷盘相关的状态和条件变量，写入日志时不需要持有
+    LogBuffer log_buffers_[LOG_BUFFER_NUM]; // 日志缓冲区，轮流写入和刷盘
+    uint32_t flush_seq_{0}; // 下一个要写盘的缓冲区序号，只由后台线程修改
+    // 每个写盘的缓冲区中第一个lsn及其在日志文件中的偏移，lsn不小于first的日志都在offset之后，用于检查点定位日志
+    std::deque<std::pair<lsn_t, off_t>> log_offsets_;
+    std::atomic<lsn_t> persist_lsn_{INVALID_LSN}; // 记录已经持久化到磁盘中的最后一条日志的日志号
     DiskManager *disk_manager_;
 };
@@ -10,7 +10,12 @@ See the Mulan PSL v2 for more details. */
 
 #include "log_recovery.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fstream>
 #include <queue>
+#include <unordered_set>
 #include "transaction/transaction_manager.h"
 
 /**
@@ -20,271 +25,499 @@ void RecoveryManager::analyze() {
     // 逻辑递增，txn_id 和 lsn 都要恢复到 crash 前的状态
     lsn_t max_lsn = INVALID_LSN;
     txn_id_t max_txn_id = INVALID_TXN_ID;
-    std::size_t log_offset = 0;
+    off_t log_offset = 0;
     // 这里返回的read_bytes <= LOG_BUFFER_SIZE
-    size_t read_bytes;
+    int read_bytes;
+
+    // 有检查点时从检查点记录的位置开始分析，redo 从检查点开始和脏页表中最小的 rec_lsn 开始，
+    // 更早的日志只用来找到活跃事务回滚需要的日志
+    EndCheckpointLogRecord checkpoint;
+    redo_start_lsn_ = INVALID_LSN;
+    if (read_checkpoint(&checkpoint, &log_offset)) {
+        redo_start_lsn_ = checkpoint.begin_lsn_;
+        for (auto &entry: checkpoint.dpt_) {
+            redo_start_lsn_ = std::min(redo_start_lsn_, entry.rec_lsn);
+        }
+        max_lsn = checkpoint.lsn_;
+        max_txn_id = checkpoint.next_txn_id_ - 1;
+        last_checkpoint_lsn_ = checkpoint.begin_lsn_;
+    }
+    redo_offset_ = log_offset;
+    // 分析过程中已经结束的事务，合并检查点的活跃事务表时跳过
+    std::unordered_set<txn_id_t> finished_txns;
+    // 未结束事务的每条日志在 log 文件中的 offset，事务结束后丢弃，日志很大时只保留 undo 需要的部分
+    std::unordered_map<txn_id_t, std::vector<std::pair<lsn_t, off_t>>> txn_logs;
 
     while ((read_bytes = disk_manager_->read_log(buffer_.buffer_, LOG_BUFFER_SIZE, log_offset)) > 0) {
         while (buffer_.offset_ + LOG_HEADER_SIZE <= read_bytes) {
-            // 获取日志长度
-            auto &log_size = *reinterpret_cast<const uint32_t *>(
-                buffer_.buffer_ + buffer_.offset_ + OFFSET_LOG_TOT_LEN);
-            // 日志完整内容需要从下次 read 中获取
-            if (log_size > read_bytes - buffer_.offset_) {
+            LogRecord log;
+            log.deserialize(buffer_.buffer_ + buffer_.offset_);
+            // 日志完整内容需要从下次 read 中获取；长度不合法说明是没有写完的日志尾部
+            if (log.log_tot_len_ < LOG_HEADER_SIZE || log.log_tot_len_ > static_cast<uint32_t>(read_bytes - buffer_.offset_)) {
                 break;
             }
-
-            auto &log_type = *reinterpret_cast<const LogType *>(buffer_.buffer_ + buffer_.offset_ + OFFSET_LOG_TYPE);
-            switch (log_type) {
-                case BEGIN: {
-                    auto *log = new BeginLogRecord;
-                    log->deserialize(buffer_.buffer_ + buffer_.offset_);
-                    active_txn_.emplace(log->log_tid_, log->lsn_);
-                    // 在 log 文件中的 offset
-                    lsn_mapping_.emplace(log->lsn_, log_offset + buffer_.offset_);
-                    buffer_.offset_ += log->log_tot_len_;
-
-                    // 找到 txn 和 lsn 最后的状态
-                    max_lsn = std::max(max_lsn, log->lsn_);
-                    max_txn_id = std::max(max_txn_id, log->log_tid_);
-
-                    delete log;
+            off_t offset = log_offset + buffer_.offset_;
+            buffer_.offset_ += log.log_tot_len_;
+            max_lsn = std::max(max_lsn, log.lsn_);
+
+            switch (log.log_type_) {
+                case BEGIN:
+                    active_txn_.emplace(log.log_tid_, log.lsn_);
+                    txn_logs[log.log_tid_].emplace_back(log.lsn_, offset);
                     break;
-                }
-                case COMMIT: {
-                    auto *log = new CommitLogRecord;
-                    log->deserialize(buffer_.buffer_ + buffer_.offset_);
+                case COMMIT:
+                case ABORT:
                     // 提交了则持久化到磁盘中了，不需要恢复
-                    active_txn_.erase(log->log_tid_);
-                    // 在 log 文件中的 offset
-                    lsn_mapping_.emplace(log->lsn_, log_offset + buffer_.offset_);
-                    buffer_.offset_ += log->log_tot_len_;
-                    // 找到 txn 和 lsn 最后的状态
-                    max_lsn = std::max(max_lsn, log->lsn_);
-                    max_txn_id = std::max(max_txn_id, log->log_tid_);
-
-                    delete log;
-                    break;
-                }
-                case ABORT: {
-                    auto *log = new AbortLogRecord;
-                    log->deserialize(buffer_.buffer_ + buffer_.offset_);
-                    active_txn_.erase(log->log_tid_);
-                    // 在 log 文件中的 offset
-                    lsn_mapping_.emplace(log->lsn_, log_offset + buffer_.offset_);
-                    buffer_.offset_ += log->log_tot_len_;
-                    // 找到 txn 和 lsn 最后的状态
-                    max_lsn = std::max(max_lsn, log->lsn_);
-                    max_txn_id = std::max(max_txn_id, log->log_tid_);
-
-                    delete log;
-                    break;
-                }
-                case INSERT: {
-                    auto *log = new InsertLogRecord;
-                    log->deserialize(buffer_.buffer_ + buffer_.offset_);
-                    // emplace 如果存在会插入失败，用下标插入
-                    active_txn_[log->log_tid_] = log->lsn_;
-                    // 在 log 文件中的 offset
-                    lsn_mapping_.emplace(log->lsn_, log_offset + buffer_.offset_);
-
-                    auto fh = sm_manager_->fhs_.at(log->table_name_).get();
-                    // 如果新建页面一次都没有落盘，可能会不存在
-                    try {
-                        fh->fetch_page_handle(log->rid_.page_no);
-                    } catch (RMDBError &e) {
-                        // throw InternalError(e.what());
-                        fh->create_new_page_handle();
-                    }
-                    auto &&rm_page_handle = fh->fetch_page_handle(log->rid_.page_no);
-                    // 判断需要 redo
-                    if (rm_page_handle.page->get_page_lsn() < log->lsn_) {
-                        dirty_page_table_.emplace_back(log->lsn_);
-                        rm_page_handle.page->set_page_lsn(log->lsn_);
-                    }
-                    buffer_pool_manager_->unpin_page(rm_page_handle.page->get_page_id(), true);
-                    buffer_pool_manager_->unpin_page(rm_page_handle.page->get_page_id(), true);
-
-                    buffer_.offset_ += log->log_tot_len_;
-
-                    // 找到 txn 和 lsn 最后的状态
-                    max_lsn = std::max(max_lsn, log->lsn_);
-                    max_txn_id = std::max(max_txn_id, log->log_tid_);
-
-                    delete log;
-                    break;
-                }
-                case DELETE: {
-                    auto *log = new DeleteLogRecord;
-                    log->deserialize(buffer_.buffer_ + buffer_.offset_);
-                    // emplace 如果存在会插入失败，用下标插入
-                    active_txn_[log->log_tid_] = log->lsn_;
-                    // 在 log 文件中的 offset
-                    lsn_mapping_.emplace(log->lsn_, log_offset + buffer_.offset_);
-
-                    auto fh = sm_manager_->fhs_.at(log->table_name_).get();
-                    // 如果新建页面一次都没有落盘，可能会不存在
-                    try {
-                        fh->fetch_page_handle(log->rid_.page_no);
-                    } catch (RMDBError &e) {
-                        // throw InternalError(e.what());
-                        fh->create_new_page_handle();
-                    }
-                    auto &&rm_page_handle = fh->fetch_page_handle(log->rid_.page_no);
-                    // 判断需要 redo
-                    if (rm_page_handle.page->get_page_lsn() < log->lsn_) {
-                        dirty_page_table_.emplace_back(log->lsn_);
-                        rm_page_handle.page->set_page_lsn(log->lsn_);
-                    }
-                    buffer_pool_manager_->unpin_page(rm_page_handle.page->get_page_id(), true);
-                    buffer_pool_manager_->unpin_page(rm_page_handle.page->get_page_id(), true);
-
-                    buffer_.offset_ += log->log_tot_len_;
-
-                    // 找到 txn 和 lsn 最后的状态
-                    max_lsn = std::max(max_lsn, log->lsn_);
-                    max_txn_id = std::max(max_txn_id, log->log_tid_);
-
-                    delete log;
+                    finished_txns.insert(log.log_tid_);
+                    active_txn_.erase(log.log_tid_);
+                    txn_logs.erase(log.log_tid_);
                     break;
-                }
-                case UPDATE: {
-                    auto *log = new UpdateLogRecord;
-                    log->deserialize(buffer_.buffer_ + buffer_.offset_);
+                case INSERT:
+                case DELETE:
+                case UPDATE:
                     // emplace 如果存在会插入失败，用下标插入
-                    active_txn_[log->log_tid_] = log->lsn_;
-                    // 在 log 文件中的 offset
-                    lsn_mapping_.emplace(log->lsn_, log_offset + buffer_.offset_);
-
-                    auto fh = sm_manager_->fhs_.at(log->table_name_).get();
-                    // 如果新建页面一次都没有落盘，可能会不存在
-                    try {
-                        fh->fetch_page_handle(log->rid_.page_no);
-                    } catch (RMDBError &e) {
-                        // throw InternalError(e.what());
-                        fh->create_new_page_handle();
-                    }
-                    auto &&rm_page_handle = fh->fetch_page_handle(log->rid_.page_no);
-                    // 判断需要 redo
-                    if (rm_page_handle.page->get_page_lsn() < log->lsn_) {
-                        dirty_page_table_.emplace_back(log->lsn_);
-                        rm_page_handle.page->set_page_lsn(log->lsn_);
-                    }
-                    buffer_pool_manager_->unpin_page(rm_page_handle.page->get_page_id(), true);
-                    buffer_pool_manager_->unpin_page(rm_page_handle.page->get_page_id(), true);
-
-                    buffer_.offset_ += log->log_tot_len_;
-
-                    // 找到 txn 和 lsn 最后的状态
-                    max_lsn = std::max(max_lsn, log->lsn_);
-                    max_txn_id = std::max(max_txn_id, log->log_tid_);
-
-                    delete log;
+                    active_txn_[log.log_tid_] = log.lsn_;
+                    txn_logs[log.log_tid_].emplace_back(log.lsn_, offset);
                     break;
-                }
                 default:
-                    break;
+                    // 检查点日志只需要维护 lsn
+                    continue;
             }
+            // 找到 txn 和 lsn 最后的状态
+            max_txn_id = std::max(max_txn_id, log.log_tid_);
+        }
+        if (buffer_.offset_ == 0) {
+            break;
         }
         // read_bytes - (read_bytes - offset)
         log_offset += buffer_.offset_;
         buffer_.offset_ = 0;
-        memset(buffer_.buffer_, 0, sizeof(LOG_BUFFER_SIZE));
+    }
+    // 检查点时活跃、之后没有结束的事务也需要回滚
+    for (auto &entry: checkpoint.att_) {
+        if (!finished_txns.count(entry.txn_id)) {
+            auto it = active_txn_.find(entry.txn_id);
+            if (it == active_txn_.end()) {
+                active_txn_.emplace(entry.txn_id, entry.last_lsn);
+            } else {
+                it->second = std::max(it->second, entry.last_lsn);
+            }
+        }
+    }
+    // undo 时通过 lsn 找到日志
+    for (auto &[txn_id, _]: active_txn_) {
+        std::ignore = _;
+        for (auto &[lsn, offset]: txn_logs[txn_id]) {
+            lsn_mapping_.emplace(lsn, offset);
+        }
     }
     log_manager_->set_global_lsn(max_lsn + 1);
     log_manager_->set_persist_lsn(max_lsn);
+    log_manager_->set_log_offset(max_lsn + 1, disk_manager_->get_log_size());
     transaction_manager_->set_next_txn_id(max_txn_id + 1);
 }
 
 /**
- * @description: 重做所有未落盘的操作
+ * @description: 读取日志主记录指向的检查点结束日志
+ * @return {bool} 存在检查点时返回true
+ * @param {EndCheckpointLogRecord*} checkpoint 返回检查点结束日志
+ * @param {off_t*} scan_offset 返回分析日志的起始位置
  */
-void RecoveryManager::redo() {
-    for (auto &lsn: dirty_page_table_) {
-        int log_offset = lsn_mapping_[lsn];
-        disk_manager_->read_log(buffer_.buffer_, LOG_BUFFER_SIZE, log_offset);
-        auto &log_type = *reinterpret_cast<const LogType *>(buffer_.buffer_ + OFFSET_LOG_TYPE);
-        switch (log_type) {
-            case INSERT: {
-                auto log = new InsertLogRecord;
-                log->deserialize(buffer_.buffer_);
+bool RecoveryManager::read_checkpoint(EndCheckpointLogRecord *checkpoint, off_t *scan_offset) {
+    std::ifstream ifs(LOG_MASTER_FILE_NAME, std::ios::binary);
+    LogMasterRecord master{};
+    if (!ifs.is_open() || !ifs.read(reinterpret_cast<char *>(&master), sizeof(master))) {
+        return false;
+    }
 
-                // redo 记录
-                auto fh = sm_manager_->fhs_.at(log->table_name_).get();
-                fh->insert_record(log->rid_, log->insert_value_.data);
+    off_t log_offset = master.checkpoint_offset;
+    int read_bytes;
+    while ((read_bytes = disk_manager_->read_log(buffer_.buffer_, LOG_BUFFER_SIZE, log_offset)) > 0) {
+        int offset = 0;
+        while (offset + LOG_HEADER_SIZE <= read_bytes) {
+            LogRecord header;
+            header.deserialize(buffer_.buffer_ + offset);
+            if (header.log_tot_len_ < LOG_HEADER_SIZE || header.log_tot_len_ > static_cast<uint32_t>(read_bytes - offset)) {
+                break;
+            }
+            if (header.lsn_ == master.checkpoint_lsn && header.log_type_ == END_CHECKPOINT) {
+                checkpoint->deserialize(buffer_.buffer_ + offset);
+                *scan_offset = master.scan_offset;
+                return true;
+            }
+            offset += header.log_tot_len_;
+        }
+        if (offset == 0) {
+            break;
+        }
+        log_offset += offset;
+    }
+    throw InternalError("RecoveryManager::read_checkpoint: checkpoint log record not found");
+}
 
-                // redo 索引
-                auto &indexes = sm_manager_->db_.get_table(log->table_name_).indexes;
-                for (auto &[index_name, index_meta]: indexes) {
-                    char *key = new char[index_meta.col_tot_len];
-                    auto &ih = sm_manager_->ihs_.at(index_name);
-                    for (auto &[offset, col_meta]: index_meta.cols) {
-                        memcpy(key + offset, log->insert_value_.data + col_meta.offset, col_meta.len);
-                    }
-                    ih->insert_entry(key, log->rid_, &transaction_);
-                    delete []key;
-                }
+/**
+ * @description: 先写临时文件再重命名，原子地更新日志主记录
+ * @param {LogMasterRecord&} master 新的主记录
+ */
+void RecoveryManager::write_master(const LogMasterRecord &master) {
+    std::string tmp_name = LOG_MASTER_FILE_NAME + ".tmp";
+    int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw UnixError();
+    }
+    bool ok = write(fd, &master, sizeof(master)) == sizeof(master) && fdatasync(fd) == 0;
+    close(fd);
+    if (!ok || rename(tmp_name.c_str(), LOG_MASTER_FILE_NAME.c_str()) != 0) {
+        throw UnixError();
+    }
+}
 
-                delete log;
+/**
+ * @description: 模糊检查点。写入检查点开始日志后记录活跃事务表和脏页表，再写入检查点结束日志，
+ *               期间事务可以继续执行。检查点落盘后更新日志主记录，并截断恢复不再需要的日志
+ */
+void RecoveryManager::checkpoint() {
+    std::lock_guard lock(checkpoint_latch_);
+    // 1. 写回上一个检查点之前就已经变脏的页面，使最小 rec_lsn 和日志截断位置向前推进
+    if (last_checkpoint_lsn_ != INVALID_LSN) {
+        buffer_pool_manager_->flush_pages_before(last_checkpoint_lsn_);
+    }
+
+    // 2. 检查点开始日志和活跃事务表
+    std::vector<CheckpointTxnEntry> att;
+    lsn_t begin_lsn = transaction_manager_->begin_checkpoint(log_manager_, &att);
+    lsn_t scan_start_lsn = begin_lsn;
+    for (auto &entry: att) {
+        scan_start_lsn = std::min(scan_start_lsn, entry.begin_lsn);
+    }
+
+    // 3. 脏页表
+    std::vector<std::pair<PageId, lsn_t>> dirty_pages;
+    buffer_pool_manager_->get_dirty_pages(&dirty_pages);
+    std::vector<CheckpointPageEntry> dpt;
+    dpt.reserve(dirty_pages.size());
+    for (auto &[page_id, rec_lsn]: dirty_pages) {
+        try {
+            dpt.push_back({disk_manager_->get_file_name(page_id.fd), page_id.page_no, rec_lsn});
+        } catch (FileNotOpenError &e) {
+            // 文件已经关闭（表被删除），不再需要恢复
+            continue;
+        }
+        scan_start_lsn = std::min(scan_start_lsn, rec_lsn);
+    }
+
+    // 4. 文件头不写日志，截断日志前写回；脏页表之外的页面已经写回，一并持久化
+    sm_manager_->flush_file_headers();
+
+    // 5. 检查点结束日志，等待落盘
+    EndCheckpointLogRecord end_checkpoint_log_record(begin_lsn, transaction_manager_->get_next_txn_id(),
+                                                     std::move(att), std::move(dpt));
+    lsn_t end_lsn = log_manager_->add_log_to_buffer(&end_checkpoint_log_record);
+    log_manager_->wait_for_flush(end_lsn);
+
+    // 6. 更新主记录，恢复时从 scan_offset 开始分析
+    off_t scan_offset = log_manager_->get_log_offset(scan_start_lsn);
+    write_master({end_lsn, log_manager_->get_log_offset(end_lsn), scan_offset});
+
+    // 7. 截断之前的日志。主记录已经指向 scan_offset，之前的位置索引总是可以删除；
+    // 磁盘空间释放失败时 discard_log_before 会报告，并在下一次检查点重试
+    disk_manager_->discard_log_before(scan_offset);
+    log_manager_->truncate_log_offsets(scan_offset);
+    last_checkpoint_lsn_ = begin_lsn;
+}
+
+/**
+ * @description: 启动后台线程，每隔interval做一次模糊检查点
+ */
+void RecoveryManager::start_checkpoint_thread(std::chrono::seconds interval) {
+    run_checkpoint_thread_ = true;
+    checkpoint_thread_ = std::thread([this, interval] {
+        std::unique_lock lk(checkpoint_thread_latch_);
+        while (!checkpoint_cv_.wait_for(lk, interval, [this] { return !run_checkpoint_thread_; })) {
+            lk.unlock();
+            checkpoint();
+            lk.lock();
+        }
+    });
+}
+
+void RecoveryManager::stop_checkpoint_thread() { {
+        std::lock_guard lock(checkpoint_thread_latch_);
+        run_checkpoint_thread_ = false;
+    }
+    checkpoint_cv_.notify_one();
+    if (checkpoint_thread_.joinable()) {
+        checkpoint_thread_.join();
+    }
+}
+
+/**
+ * @description: 不反序列化整条数据日志，直接取出它修改的记录位置和表名
+ * @param {char*} src 日志
+ * @param {LogType} log_type 日志类型，INSERT、DELETE 或 UPDATE
+ * @param {Rid*} rid 返回记录位置
+ * @param {string*} table_name 返回表名
+ */
+static void parse_rid_and_table(const char *src, LogType log_type, Rid *rid, std::string *table_name) {
+    int value_size = *reinterpret_cast<const int *>(src + OFFSET_LOG_DATA);
+    // update 日志中依次是旧值和新值，两者长度相同
+    int offset = OFFSET_LOG_DATA + sizeof(int) + (log_type == UPDATE ? 2 * value_size : value_size);
+    *rid = *reinterpret_cast<const Rid *>(src + offset);
+    offset += sizeof(Rid);
+    auto table_name_size = *reinterpret_cast<const size_t *>(src + offset);
+    offset += sizeof(size_t);
+    table_name->assign(src + offset, table_name_size);
+}
+
+/**
+ * @description: 重做所有未落盘的操作。由当前线程顺序读日志，按修改的页面把数据日志和索引页面日志分给多个工作线程，
+ *               同一页面的日志总在同一个线程中按 lsn 顺序重做，不同页面之间并行。索引文件头日志在当前线程中按顺序重做
+ */
+void RecoveryManager::redo() {
+    int num_workers = std::max(redo_workers_, 1);
+    std::vector<RedoQueue> queues(num_workers);
+    std::vector<std::thread> workers;
+    workers.reserve(num_workers);
+    // 分发完或者中途出错（补建页面、读日志抛出异常）时都要让工作线程退出并 join，
+    // 否则销毁可 join 的 std::thread 会调用 std::terminate
+    auto stop_workers = [&] {
+        if (workers.empty()) {
+            return;
+        }
+        for (auto &queue: queues) {
+            push_redo_batch(&queue, {});
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        workers.clear();
+    };
+    struct WorkerGuard {
+        decltype(stop_workers) &stop;
+        ~WorkerGuard() { stop(); }
+    } guard{stop_workers};
+    for (int i = 0; i < num_workers; ++i) {
+        workers.emplace_back([this, queue = &queues[i]] { redo_worker(queue); });
+    }
+
+    std::vector<std::vector<char>> batches(num_workers);
+    // 有数据日志需要重做的表，工作线程结束后重建它们的空闲页面链表
+    std::unordered_set<RmFileHandle *> redo_tables;
+    Rid rid{};
+    std::string table_name;
+    std::string index_name;
+    off_t log_offset = redo_offset_;
+    int read_bytes;
+    while ((read_bytes = disk_manager_->read_log(buffer_.buffer_, LOG_BUFFER_SIZE, log_offset)) > 0) {
+        int offset = 0;
+        while (offset + LOG_HEADER_SIZE <= read_bytes) {
+            LogRecord header;
+            header.deserialize(buffer_.buffer_ + offset);
+            if (header.log_tot_len_ < LOG_HEADER_SIZE || header.log_tot_len_ > static_cast<uint32_t>(read_bytes - offset)) {
                 break;
             }
-            case DELETE: {
-                auto log = new DeleteLogRecord;
-                log->deserialize(buffer_.buffer_);
-
-                auto fh = sm_manager_->fhs_.at(log->table_name_).get();
-                try {
-                    fh->delete_record(log->rid_, nullptr);
-                } catch (RecordNotFoundError &e) {
+            const char *src = buffer_.buffer_ + offset;
+            offset += header.log_tot_len_;
+            // redo 起点之前的修改都已经在磁盘上
+            if (header.lsn_ < redo_start_lsn_) {
+                continue;
+            }
+            PageId page_id;
+            if (header.log_type_ == INSERT || header.log_type_ == DELETE || header.log_type_ == UPDATE) {
+                parse_rid_and_table(src, header.log_type_, &rid, &table_name);
+                auto it = sm_manager_->fhs_.find(table_name);
+                if (it == sm_manager_->fhs_.end()) {
+                    // 表已经被删除
+                    continue;
                 }
-
-                // redo 索引
-                auto &indexes = sm_manager_->db_.get_table(log->table_name_).indexes;
-                for (auto &[index_name, index_meta]: indexes) {
-                    char *key = new char[index_meta.col_tot_len];
-                    auto &ih = sm_manager_->ihs_.at(index_name);
-                    for (auto &[offset, col_meta]: index_meta.cols) {
-                        memcpy(key + offset, log->delete_value_.data + col_meta.offset, col_meta.len);
-                    }
-                    ih->delete_entry(key, &transaction_);
-                    delete []key;
+                auto fh = it->second.get();
+                redo_tables.emplace(fh);
+                // 新建页面一次都没有落盘时文件头中不存在，按页号顺序在这里补建，工作线程只需要读取页面
+                while (rid.page_no >= fh->get_file_hdr().num_pages) {
+                    auto &&page_handle = fh->create_new_page_handle();
+                    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+                }
+                page_id = {fh->GetFd(), rid.page_no};
+            } else if (header.log_type_ == INDEX_PAGE) {
+                page_id_t page_no;
+                IndexPageLogRecord::parse_page(src, &page_no, &index_name);
+                auto it = sm_manager_->ihs_.find(index_name);
+                if (it == sm_manager_->ihs_.end()) {
+                    // 索引已经被删除
+                    continue;
+                }
+                auto ih = it->second.get();
+                // 同数据页面，按页号顺序补建文件头中不存在的结点
+                while (page_no >= ih->file_hdr_->num_pages_) {
+                    auto node = ih->create_node();
+                    buffer_pool_manager_->unpin_page(node->get_page_id(), true);
                 }
+                page_id = {ih->fd_, page_no};
+            } else if (header.log_type_ == INDEX_HEADER) {
+                IndexHeaderLogRecord header_log;
+                header_log.deserialize(src);
+                auto it = sm_manager_->ihs_.find(header_log.index_name_);
+                if (it != sm_manager_->ihs_.end()) {
+                    it->second->file_hdr_->root_page_ = header_log.root_page_;
+                    it->second->file_hdr_->last_leaf_ = header_log.last_leaf_;
+                }
+                continue;
+            } else {
+                continue;
+            }
 
-                delete log;
-                break;
+            auto &batch = batches[std::hash<PageId>{}(page_id) % num_workers];
+            batch.insert(batch.end(), src, src + header.log_tot_len_);
+            if (batch.size() >= REDO_BATCH_SIZE) {
+                push_redo_batch(&queues[&batch - batches.data()], std::move(batch));
+                batch.clear();
             }
-            case UPDATE: {
-                auto log = new UpdateLogRecord;
-                log->deserialize(buffer_.buffer_ + buffer_.offset_);
+        }
+        if (offset == 0) {
+            break;
+        }
+        log_offset += offset;
+    }
 
-                auto fh = sm_manager_->fhs_.at(log->table_name_).get();
-                fh->update_record(log->rid_, log->update_value_.data, nullptr);
+    for (int i = 0; i < num_workers; ++i) {
+        if (!batches[i].empty()) {
+            push_redo_batch(&queues[i], std::move(batches[i]));
+        }
+    }
+    stop_workers();
+    for (auto &queue: queues) {
+        if (queue.error_ != nullptr) {
+            std::rethrow_exception(queue.error_);
+        }
+    }
+    for (auto fh: redo_tables) {
+        fh->rebuild_free_page_list();
+    }
+}
 
-                // redo 索引
-                auto &indexes = sm_manager_->db_.get_table(log->table_name_).indexes;
-                for (auto &[index_name, index_meta]: indexes) {
-                    char *old_key = new char[index_meta.col_tot_len];
-                    char *new_key = new char[index_meta.col_tot_len];
-                    auto &ih = sm_manager_->ihs_.at(index_name);
-                    for (auto &[offset, col_meta]: index_meta.cols) {
-                        memcpy(old_key + offset, log->old_value_.data + col_meta.offset, col_meta.len);
-                        memcpy(new_key + offset, log->update_value_.data + col_meta.offset, col_meta.len);
-                    }
-                    ih->delete_entry(old_key, &transaction_);
-                    ih->insert_entry(new_key, log->rid_, &transaction_);
-                    delete []old_key;
-                    delete []new_key;
-                }
+/**
+ * @description: 把一批日志交给工作线程，队列满时等待，避免日志很大时占用过多内存。空的一批表示日志已经分发完
+ */
+void RecoveryManager::push_redo_batch(RedoQueue *queue, std::vector<char> &&batch) {
+    std::unique_lock lock(queue->latch_);
+    queue->cv_.wait(lock, [&] { return queue->batches_.size() < REDO_QUEUE_DEPTH; });
+    queue->batches_.emplace_back(std::move(batch));
+    queue->cv_.notify_all();
+}
 
-                delete log;
-                break;
+/**
+ * @description: redo 工作线程，依次重做队列中的日志。出错后记录异常，继续取走剩余的日志使分发线程不被阻塞
+ */
+void RecoveryManager::redo_worker(RedoQueue *queue) {
+    while (true) {
+        std::vector<char> batch;
+        {
+            std::unique_lock lock(queue->latch_);
+            queue->cv_.wait(lock, [&] { return !queue->batches_.empty(); });
+            batch = std::move(queue->batches_.front());
+            queue->batches_.pop_front();
+            queue->cv_.notify_all();
+        }
+        if (batch.empty()) {
+            return;
+        }
+        if (queue->error_ != nullptr) {
+            continue;
+        }
+        try {
+            for (size_t offset = 0; offset < batch.size();) {
+                redo_log(batch.data() + offset);
+                offset += *reinterpret_cast<const uint32_t *>(batch.data() + offset + OFFSET_LOG_TOT_LEN);
             }
-            default:
-                break;
+        } catch (...) {
+            queue->error_ = std::current_exception();
         }
     }
 }
 
+/**
+ * @description: 重做一条数据日志或索引页面日志，页面的lsn不小于日志的lsn时说明修改已经在磁盘上，跳过
+ * @param {char*} src 日志
+ */
+void RecoveryManager::redo_log(const char *src) {
+    auto log_type = *reinterpret_cast<const LogType *>(src + OFFSET_LOG_TYPE);
+    if (log_type == INDEX_PAGE) {
+        IndexPageLogRecord index_log;
+        index_log.deserialize(src);
+        auto ih = sm_manager_->ihs_.at(index_log.index_name_).get();
+        PageId page_id{ih->fd_, index_log.page_no_};
+        auto page = buffer_pool_manager_->fetch_page(page_id);
+        if (page->get_page_lsn() >= index_log.lsn_) {
+            buffer_pool_manager_->unpin_page(page_id, false);
+            return;
+        }
+        ix_redo_page_ops(page->get_data(), index_log.page_ops_.data(), index_log.page_ops_.size());
+        page->set_page_lsn(index_log.lsn_);
+        buffer_pool_manager_->unpin_page(page_id, true);
+        return;
+    }
+
+    std::unique_ptr<LogRecord> log;
+    RmRecord *value;
+    Rid rid;
+    std::string table_name;
+    switch (log_type) {
+        case INSERT: {
+            auto insert_log = std::make_unique<InsertLogRecord>();
+            insert_log->deserialize(src);
+            value = &insert_log->insert_value_;
+            rid = insert_log->rid_;
+            table_name = insert_log->get_table_name();
+            log = std::move(insert_log);
+            break;
+        }
+        case DELETE: {
+            auto delete_log = std::make_unique<DeleteLogRecord>();
+            delete_log->deserialize(src);
+            value = &delete_log->delete_value_;
+            rid = delete_log->rid_;
+            table_name = delete_log->get_table_name();
+            log = std::move(delete_log);
+            break;
+        }
+        case UPDATE: {
+            auto update_log = std::make_unique<UpdateLogRecord>();
+            update_log->deserialize(src);
+            value = &update_log->update_value_;
+            rid = update_log->rid_;
+            table_name = update_log->get_table_name();
+            log = std::move(update_log);
+            break;
+        }
+        default:
+            return;
+    }
+
+    auto fh = sm_manager_->fhs_.at(table_name).get();
+    // 分发线程可能正在补建页面，不通过 fetch_page_handle 读文件头中的 num_pages，页面一定已经补建
+    PageId page_id{fh->GetFd(), rid.page_no};
+    auto page = buffer_pool_manager_->fetch_page(page_id);
+    if (page == nullptr) {
+        throw PageNotExistError(table_name, rid.page_no);
+    }
+    RmPageHandle page_handle(&fh->get_file_hdr(), page);
+    // 判断需要 redo
+    if (page->get_page_lsn() >= log->lsn_) {
+        buffer_pool_manager_->unpin_page(page_id, false);
+        return;
+    }
+    // 只修改页面本身，空闲页面链表在所有工作线程结束后重建
+    if (log_type == INSERT) {
+        fh->redo_insert_record(page_handle, rid.slot_no, value->data);
+    } else if (log_type == DELETE) {
+        fh->redo_delete_record(page_handle, rid.slot_no);
+    } else {
+        fh->redo_update_record(page_handle, rid.slot_no, value->data);
+    }
+    page->set_page_lsn(log->lsn_);
+    buffer_pool_manager_->unpin_page(page_id, true);
+}
+
 /**
  * @description: 回滚未完成的事务
  */
@@ -302,7 +535,7 @@ void RecoveryManager::undo() {
     while (!lsn_heap.empty()) {
         lsn = lsn_heap.top();
         lsn_heap.pop();
-        int log_offset = lsn_mapping_[lsn];
+        off_t log_offset = lsn_mapping_[lsn];
         disk_manager_->read_log(buffer_.buffer_, LOG_BUFFER_SIZE, log_offset);
         auto &log_type = *reinterpret_cast<const LogType *>(buffer_.buffer_ + OFFSET_LOG_TYPE);
         switch (log_type) {
@@ -335,7 +568,7 @@ void RecoveryManager::undo() {
                 auto fh = sm_manager_->fhs_.at(log->table_name_).get();
                 fh->delete_record(log->rid_, nullptr);
 
-                // undo 索引
+                // undo 索引，索引已经 redo 到崩溃前的状态
                 auto &indexes = sm_manager_->db_.get_table(log->table_name_).indexes;
                 for (auto &[index_name, index_meta]: indexes) {
                     char *key = new char[index_meta.col_tot_len];
@@ -358,7 +591,7 @@ void RecoveryManager::undo() {
                 auto fh = sm_manager_->fhs_.at(log->table_name_).get();
                 fh->insert_record(log->rid_, log->delete_value_.data);
 
-                // undo 索引
+                // undo 索引，索引已经 redo 到崩溃前的状态
                 auto &indexes = sm_manager_->db_.get_table(log->table_name_).indexes;
                 for (auto &[index_name, index_meta]: indexes) {
                     char *key = new char[index_meta.col_tot_len];
@@ -382,7 +615,7 @@ void RecoveryManager::undo() {
                 auto fh = sm_manager_->fhs_.at(log->table_name_).get();
                 fh->update_record(log->rid_, log->old_value_.data, nullptr);
 
-                // undo 索引
+                // undo 索引，索引已经 redo 到崩溃前的状态
                 auto &indexes = sm_manager_->db_.get_table(log->table_name_).indexes;
                 for (auto &[index_name, index_meta]: indexes) {
                     char *old_key = new char[index_meta.col_tot_len];
@@ -411,29 +644,21 @@ void RecoveryManager::undo() {
         }
     }
 
-    // 重做索引
-    // if (!dirty_page_table_.empty() || !active_txn_.empty()) {
-    //     redo_indexes();
-    // }
-}
-
-/**
- * @description: 重做每个表的索引
- */
-void RecoveryManager::redo_indexes() {
-    std::vector<std::string> col_names;
-    auto *context = new Context(nullptr, nullptr, &transaction_);
-    for (auto &[table_name, _]: sm_manager_->fhs_) {
+    // 回滚数据页面不写日志，因此先把恢复修改过的页面写回磁盘，再为回滚的事务写入 abort 日志，
+    // 然后做一次检查点，之后的恢复不再需要这些日志
+    for (auto &[_, fh]: sm_manager_->fhs_) {
         std::ignore = _;
-        auto &table_meta = sm_manager_->db_.get_table(table_name);
-        for (auto &[index_name, index_meta]: table_meta.indexes) {
-            for (auto &[_, col]: index_meta.cols) {
-                std::ignore = _;
-                col_names.emplace_back(col.name);
-            }
-            sm_manager_->redo_index(table_name, table_meta, col_names, index_name, context);
-            col_names.clear();
-        }
+        buffer_pool_manager_->flush_all_pages(fh->GetFd());
+    }
+    for (auto &[_, ih]: sm_manager_->ihs_) {
+        std::ignore = _;
+        buffer_pool_manager_->flush_all_pages(ih->fd_);
+    }
+    for (auto &[txn_id, last_lsn]: active_txn_) {
+        AbortLogRecord abort_log_record(txn_id);
+        abort_log_record.prev_lsn_ = last_lsn;
+        log_manager_->add_log_to_buffer(&abort_log_record);
     }
-    delete context;
+    active_txn_.clear();
+    checkpoint();
 }
@@ -24,6 +24,21 @@ public:
     std::vector<lsn_t> redo_logs_; // 在该page上需要redo的操作的lsn
 };
 
+/* 并行 redo 中一个工作线程的任务队列，同一页面的日志总是进入同一个队列 */
+struct RedoQueue {
+    std::mutex latch_;
+    std::condition_variable cv_;
+    std::deque<std::vector<char>> batches_; // 每一批是连续存放的若干条日志，空的一批表示结束
+    std::exception_ptr error_; // 工作线程重做时抛出的异常
+};
+
+/* 日志主记录，保存在 LOG_MASTER_FILE_NAME 中，指向最近一次完成的模糊检查点 */
+struct LogMasterRecord {
+    lsn_t checkpoint_lsn; // END_CHECKPOINT 日志的lsn
+    off_t checkpoint_offset; // 从这里开始向后可以找到 END_CHECKPOINT 日志
+    off_t scan_offset; // 恢复时从这里开始分析日志，之前的日志已经不再需要
+};
+
 class RecoveryManager {
 public:
     RecoveryManager(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, SmManager *sm_manager,
@@ -32,15 +47,35 @@ public:
         log_manager_(log_manager), transaction_manager_(transaction_manager), transaction_(666) {
     }
 
+    ~RecoveryManager() {
+        stop_checkpoint_thread();
+    }
+
     void analyze();
 
     void redo();
 
     void undo();
 
-    void redo_indexes();
+    void set_redo_workers(int num_workers) { redo_workers_ = num_workers; }
+
+    void checkpoint();
+
+    void start_checkpoint_thread(std::chrono::seconds interval);
+
+    void stop_checkpoint_thread();
 
 private:
+    bool read_checkpoint(EndCheckpointLogRecord *checkpoint, off_t *scan_offset);
+
+    void push_redo_batch(RedoQueue *queue, std::vector<char> &&batch);
+
+    void redo_worker(RedoQueue *queue);
+
+    void redo_log(const char *src);
+
+    void write_master(const LogMasterRecord &master);
+
     LogBuffer buffer_; // 读入日志
     DiskManager *disk_manager_; // 用来读写文件
     BufferPoolManager *buffer_pool_manager_; // 对页面进行读写
@@ -50,9 +85,16 @@ private:
     /** Maintain active transactions and its corresponding latest lsn. */
     std::unordered_map<txn_id_t, lsn_t> active_txn_;
     /** Mapping the log sequence number to log file offset for undos. */
-    std::unordered_map<lsn_t, int> lsn_mapping_;
-    /** DPT for redo. */
-    std::deque<lsn_t> dirty_page_table_;
+    std::unordered_map<lsn_t, off_t> lsn_mapping_;
+    lsn_t redo_start_lsn_{INVALID_LSN}; // lsn 更小的修改都已经在磁盘上
+    off_t redo_offset_{0}; // redo 从这里开始读日志
+    int redo_workers_{REDO_WORKER_NUM}; // 并行 redo 的线程数
     Transaction transaction_;
-    bool is_need_redo_indexes{false};
+
+    std::mutex checkpoint_latch_; // 同一时间只做一个检查点
+    lsn_t last_checkpoint_lsn_{INVALID_LSN}; // 上一个检查点开始日志的lsn
+    std::thread checkpoint_thread_; // 定期做模糊检查点的后台线程
+    std::mutex checkpoint_thread_latch_;
+    std::condition_variable checkpoint_cv_;
+    bool run_checkpoint_thread_{false};
 };
@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <list>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -49,19 +50,24 @@ private:
 class ClockReplacer : public Replacer {
 public:
     /**
-     * @description: 创建一个新的LRUReplacer
-     * @param {size_t} num_pages LRUReplacer最多需要存储的page数量
+     * @description: 创建一个新的ClockReplacer
+     * @param {size_t} num_pages ClockReplacer需要管理的帧数量，与缓冲池实例的容量相同
      */
-    explicit ClockReplacer() {
+    explicit ClockReplacer(size_t num_pages = BUFFER_POOL_INSTANCE_SIZE)
+        : num_pages_(num_pages), pin_counter_(new int[num_pages]()), pin_(new bool[num_pages]()) {
     }
 
     ~ClockReplacer() {
     }
 
     bool victim(frame_id_t *frame_id) override {
-        int steps = 0;
+        // 没有可管理的帧
+        if (num_pages_ == 0) {
+            return false;
+        }
+        size_t steps = 0;
         do {
-            pointer_ = (pointer_ + 1) % BUFFER_POOL_INSTANCE_SIZE;
+            pointer_ = (pointer_ + 1) % num_pages_;
             if (pin_counter_[pointer_] == 0 && pin_[pointer_] == 0) {
                 *frame_id = pointer_;
                 return true;
@@ -70,7 +76,7 @@ public:
                 pin_[pointer_] = false;
             }
             ++steps;
-        } while (steps < 2 * BUFFER_POOL_INSTANCE_SIZE);
+        } while (steps < 2 * num_pages_);
         return false;
     }
 
@@ -86,10 +92,11 @@ public:
 
     int get_pin_count(frame_id_t frame_id) { return pin_counter_[frame_id]; }
 
-    size_t Size() override { return BUFFER_POOL_INSTANCE_SIZE; }
+    size_t Size() override { return num_pages_; }
 
 private:
-    int pin_counter_[BUFFER_POOL_INSTANCE_SIZE];
-    bool pin_[BUFFER_POOL_INSTANCE_SIZE];
-    int pointer_ = 0;
+    size_t num_pages_;
+    std::unique_ptr<int[]> pin_counter_;
+    std::unique_ptr<bool[]> pin_;
+    size_t pointer_ = 0;
 };
@@ -0,0 +1,122 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/result_protocol.h"
+#include "system/sm_meta.h"
+
+static_assert(static_cast<int>(result_protocol::COL_INT) == TYPE_INT &&
+              static_cast<int>(result_protocol::COL_FLOAT) == TYPE_FLOAT &&
+              static_cast<int>(result_protocol::COL_STRING) == TYPE_STRING,
+              "result protocol column types must match ColType");
+
+/**
+ * @description: 二进制协议下一个连接的结果发送器，和 RecordPrinter 对应。
+ * 行按列的二进制值编码，攒满 RESULT_CHUNK_SIZE 字节就作为一个 DATA_ROWS 帧发出，
+ * 不做字符串格式化，也不受 BUFFER_LENGTH 限制；socket 写阻塞时执行线程跟着阻塞。
+ * 连接断开以后后续的发送都被丢弃，由 client_handler 通过 broken() 结束连接
+ */
+class ResultWriter {
+    int fd_;
+    bool broken_ = false;
+    std::vector<ColMeta> cols_;
+    std::string chunk_; // 正在攒的 DATA_ROWS 帧负载，开头 4 字节是行数
+    uint32_t chunk_rows_ = 0;
+    uint64_t num_rows_ = 0; // 当前语句已经发送的行数
+
+    void send(result_protocol::FrameType type, const char *payload, size_t len) {
+        if (!broken_ && !result_protocol::send_frame(fd_, type, payload, len)) {
+            broken_ = true;
+        }
+    }
+
+    void flush_rows() {
+        if (chunk_rows_ == 0) {
+            return;
+        }
+        std::string count;
+        result_protocol::put_u32(count, chunk_rows_);
+        chunk_.replace(0, count.size(), count);
+        send(result_protocol::DATA_ROWS, chunk_.data(), chunk_.size());
+        chunk_.assign(4, '\0');
+        chunk_rows_ = 0;
+    }
+
+public:
+    explicit ResultWriter(int fd) : fd_(fd) {
+        chunk_.reserve(RESULT_CHUNK_SIZE + PAGE_SIZE);
+        reset();
+    }
+
+    bool broken() const { return broken_; }
+
+    // 开始一条新语句
+    void reset() {
+        cols_.clear();
+        chunk_.assign(4, '\0');
+        chunk_rows_ = 0;
+        num_rows_ = 0;
+    }
+
+    /**
+     * @description: 发送结果的列描述，之后 add_row 的元组按 cols 的偏移解析
+     * @param {vector<string>} captions 列名
+     * @param {vector<ColMeta>} cols 元组中每一列的类型、长度和偏移
+     */
+    void begin_rows(const std::vector<std::string> &captions, const std::vector<ColMeta> &cols) {
+        cols_ = cols;
+        std::string desc;
+        result_protocol::put_u16(desc, static_cast<uint16_t>(cols_.size()));
+        for (size_t i = 0; i < cols_.size(); ++i) {
+            desc.push_back(static_cast<char>(cols_[i].type));
+            result_protocol::put_u16(desc, static_cast<uint16_t>(captions[i].size()));
+            desc.append(captions[i]);
+        }
+        send(result_protocol::ROW_DESC, desc.data(), desc.size());
+    }
+
+    void add_row(const char *tuple) {
+        for (auto &col: cols_) {
+            const char *val = tuple + col.offset;
+            if (col.type == TYPE_STRING) {
+                size_t len = strnlen(val, col.len);
+                result_protocol::put_u16(chunk_, static_cast<uint16_t>(len));
+                chunk_.append(val, len);
+            } else {
+                uint32_t bits;
+                memcpy(&bits, val, sizeof(bits));
+                result_protocol::put_u32(chunk_, bits);
+            }
+        }
+        ++chunk_rows_;
+        ++num_rows_;
+        if (chunk_.size() >= RESULT_CHUNK_SIZE) {
+            flush_rows();
+        }
+    }
+
+    // 发出最后一块不满的结果
+    void end_rows() { flush_rows(); }
+
+    void send_message(const char *text, size_t len) { send(result_protocol::MESSAGE, text, len); }
+
+    void send_complete() {
+        std::string payload;
+        result_protocol::put_u64(payload, num_rows_);
+        send(result_protocol::COMPLETE, payload.data(), payload.size());
+    }
+
+    void send_error(const std::string &msg) { send(result_protocol::ERROR, msg.data(), msg.size()); }
+};
@@ -27,6 +27,7 @@ See the Mulan PSL v2 for more details. */
 #include "optimizer/plan.h"
 #include "optimizer/planner.h"
 #include "portal.h"
+#include "result_writer.h"
 #include "analyze/analyze.h"
 
 #define SOCK_PORT 8765
@@ -52,7 +53,8 @@ auto optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
 auto ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get(), planner.get());
 auto recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get(),
                                                   log_manager.get(), txn_manager.get());
-auto portal = std::make_unique<Portal>(sm_manager.get());
+auto spill_manager = std::make_unique<SpillManager>();
+auto portal = std::make_unique<Portal>(sm_manager.get(), spill_manager.get());
 auto analyze = std::make_unique<Analyze>(sm_manager.get());
 // pthread_mutex_t *buffer_mutex;
 pthread_mutex_t *sockfd_mutex;
@@ -116,6 +118,10 @@ void *client_handler(void *sock_fd) {
     int offset = 0;
     // 记录客户端当前正在执行的事务ID
     txn_id_t txn_id = INVALID_TXN_ID;
+    // 客户端发送握手请求以后切换为二进制结果协议，结果边执行边发送
+    bool binary_protocol = false;
+    ResultWriter result_writer(fd);
+    std::string request;
     // 每个 client 分配一个词法分析器解析 SQL 语句
     yyscan_t scanner;
     yylex_init(&scanner);
@@ -129,9 +135,21 @@ void *client_handler(void *sock_fd) {
 #ifdef ENABLE_COUT
         // std::cout << "Waiting for request..." << std::endl;
 #endif
-        memset(data_recv, 0, BUFFER_LENGTH);
-
-        i_recvBytes = recv(fd, data_recv, BUFFER_LENGTH, 0);
+        if (binary_protocol) {
+            // 二进制协议的请求是 u32 长度 + SQL，长度不受 BUFFER_LENGTH 限制
+            char len_buf[4];
+            uint32_t len = 0;
+            if (result_protocol::recv_all(fd, len_buf, sizeof(len_buf))) {
+                len = result_protocol::get_u32(len_buf);
+            }
+            request.resize(len <= MAX_REQUEST_SIZE ? len : 0);
+            i_recvBytes = len > 0 && len <= MAX_REQUEST_SIZE && result_protocol::recv_all(fd, &request[0], len)
+                              ? static_cast<int>(len) : 0;
+        } else {
+            memset(data_recv, 0, BUFFER_LENGTH);
+            i_recvBytes = recv(fd, data_recv, BUFFER_LENGTH, 0);
+            request.assign(data_recv, strnlen(data_recv, BUFFER_LENGTH));
+        }
 
         if (i_recvBytes == 0) {
 #ifdef ENABLE_COUT
@@ -151,12 +169,12 @@ void *client_handler(void *sock_fd) {
         // printf("i_recvBytes: %d \n ", i_recvBytes);
 #endif
 
-        if (strcmp(data_recv, "exit") == 0) {
+        if (request == "exit") {
             std::cout << "Client exit." << std::endl;
             break;
         }
 
-        if (strcmp(data_recv, "crash") == 0) {
+        if (request == "crash") {
             std::cout << "Server crash" << std::endl;
             delete []data_send;
             for (auto &[_, txn]: txn_manager->txn_map) {
@@ -166,10 +184,17 @@ void *client_handler(void *sock_fd) {
             exit(1);
         }
 
+        if (!binary_protocol && request == result_protocol::HANDSHAKE) {
+            binary_protocol = true;
+            result_writer.reset();
+            result_writer.send_complete();
+            continue;
+        }
+        result_writer.reset();
+
         // 处理数据
-        if (strncmp(data_recv, "load", 4) == 0 || strncmp(data_recv, "LOAD", 4) == 0) {
-            std::string str(data_recv);
-            std::stringstream ss(str);
+        if (strncmp(request.c_str(), "load", 4) == 0 || strncmp(request.c_str(), "LOAD", 4) == 0) {
+            std::stringstream ss(request);
             std::string load_keyword, path, into_keyword, table_name;
             ss >> load_keyword >> path >> into_keyword >> table_name;
 
@@ -183,6 +208,10 @@ void *client_handler(void *sock_fd) {
             // 将任务加入线程池
             futures.emplace_back(std::async(std::launch::async, load_data, std::move(path), std::move(table_name)));
 
+            if (binary_protocol) {
+                result_writer.send_complete();
+                continue;
+            }
             std::string s = "l\n";
             if (write(fd, s.c_str(), s.length()) == -1) {
                 throw UnixError();
@@ -207,19 +236,24 @@ void *client_handler(void *sock_fd) {
         futures.clear();
         pool_mutex.unlock();
 #ifdef ENABLE_COUT
-        std::cout << "Read from client " << fd << ": " << data_recv << std::endl;
+        std::cout << "Read from client " << fd << ": " << request << std::endl;
 #endif
         memset(data_send, '\0', BUFFER_LENGTH);
         offset = 0;
 
         // 开启事务，初始化系统所需的上下文信息（包括事务对象指针、锁管理器指针、日志管理器指针、存放结果的buffer、记录结果长度的变量）
         Context *context = new Context(lock_manager.get(), log_manager.get(), nullptr, data_send, &offset);
+        if (binary_protocol) {
+            context->result_ = &result_writer;
+        }
         SetTransaction(&txn_id, context);
+        // 二进制协议下语句失败时发给客户端的错误信息
+        std::string error;
 
         // 用于判断是否已经调用了 yy_delete_buffer 来删除 buf
         bool finish_analyze = false;
         // pthread_mutex_lock(buffer_mutex);
-        YY_BUFFER_STATE buf = yy_scan_string(data_recv, scanner);
+        YY_BUFFER_STATE buf = yy_scan_string(request.c_str(), scanner);
         if (yyparse(scanner) == 0) {
             if (ast::parse_tree != nullptr) {
                 try {
@@ -230,7 +264,8 @@ void *client_handler(void *sock_fd) {
                     finish_analyze = true;
                     // pthread_mutex_unlock(buffer_mutex);
                     // 全表 count 走 fast_count
-                    if (query->agg_types.size() == 1 && query->agg_types[0] == AGG_COUNT && query->conds.empty()) {
+                    if (query->agg_types.size() == 1 && query->agg_types[0] == AGG_COUNT && query->conds.empty() &&
+                        query->limit < 0 && query->offset == 0) {
                         // 后续支持笛卡尔积 count，这里先简化只有单个表
                         auto &col_name = query->alias.empty() ? query->cols[0].col_name : query->alias[0];
                         ql_manager->select_fast_count_star(fast_count_star(query->tables[0], context), col_name,
@@ -249,6 +284,7 @@ void *client_handler(void *sock_fd) {
                     memcpy(data_send, str.c_str(), str.length());
                     data_send[str.length()] = '\0';
                     offset = str.length();
+                    error = "abort";
 
                     // 回滚事务
                     txn_manager->abort(context->txn_, log_manager.get());
@@ -272,6 +308,7 @@ void *client_handler(void *sock_fd) {
                     data_send[e.get_msg_len()] = '\n';
                     data_send[e.get_msg_len() + 1] = '\0';
                     offset = e.get_msg_len() + 1;
+                    error = e.what();
 
                     // 将报错信息写入output.txt
                     if (planner->enable_output_file) {
@@ -291,6 +328,7 @@ void *client_handler(void *sock_fd) {
             // data_send[str.size()] = '\n';
             // data_send[str.size() + 1] = '\0';
             // offset = str.size() + 1;
+            error = "syntax error";
 
             // 将报错信息写入output.txt
             if (planner->enable_output_file) {
@@ -304,17 +342,34 @@ void *client_handler(void *sock_fd) {
             yy_delete_buffer(buf, scanner);
             // pthread_mutex_unlock(buffer_mutex);
         }
+        // 如果是单挑语句，需要按照一个完整的事务来执行，所以执行完当前语句后，自动提交事务
+        // 提交会等待日志落盘，之后再把结果返回给客户端
+        if (context->txn_->get_txn_mode() == false) {
+            txn_manager->commit(context->txn_, context->log_mgr_);
+        }
+        delete context;
+        if (binary_protocol) {
+            // select 的结果已经在执行时发出，这里只剩其他语句的文本输出和结束帧
+            if (!error.empty()) {
+                result_writer.send_error(error);
+            } else {
+                if (offset > 0) {
+                    result_writer.send_message(data_send, offset);
+                }
+                result_writer.send_complete();
+            }
+            if (result_writer.broken()) {
+                perror("Send failed");
+                break;
+            }
+            continue;
+        }
         // future TODO: 格式化 sql_handler.result, 传给客户端
         // send result with fixed format, use protobuf in the future
         if (send(fd, data_send, offset + 1, 0) == -1) {
             perror("Send failed");
             break;
         }
-        // 如果是单挑语句，需要按照一个完整的事务来执行，所以执行完当前语句后，自动提交事务
-        if (context->txn_->get_txn_mode() == false) {
-            txn_manager->commit(context->txn_, context->log_mgr_);
-        }
-        delete context;
     }
 
     // release memory
@@ -407,6 +462,9 @@ void start_server() {
     if (ret == -1) { printf("%s\n", strerror(errno)); }
     //    assert(ret != -1);
     std::cout << "before close db: " << std::endl;
+#ifdef ENABLE_LOGGING
+    recovery->stop_checkpoint_thread();
+#endif
     sm_manager->close_db();
     std::cout << "before delete txn: " << std::endl;
     for (auto &[_, txn]: txn_manager->txn_map) {
@@ -452,12 +510,16 @@ int main(int argc, char **argv) {
         }
         // Open database
         sm_manager->open_db(db_name);
+        // 溢出文件目录，open_db 以后工作目录是数据库目录
+        const char *spill_dir = getenv("RMDB_SPILL_DIR");
+        spill_manager->open(spill_dir != nullptr ? spill_dir : SPILL_DIR_NAME);
 
         // recovery database
 #ifdef ENABLE_LOGGING
         recovery->analyze();
         recovery->redo();
         recovery->undo();
+        recovery->start_checkpoint_thread(std::chrono::seconds(CHECKPOINT_INTERVAL_SEC));
 #endif
 
         // 静态 map 预留空间
@@ -858,6 +920,9 @@ void load_data(std::string filename, std::string tabname) {
         }
     }
 
+    // 写入最后一批不满 LOAD_WRITE_BATCH_PAGES 的页面
+    fh->finish_load();
+
     // Unmap the file and close the file descriptor
     if (munmap(file_content, file_size) == -1) {
         perror("Error unmapping file");
@@ -21,40 +21,138 @@ bool BufferPoolInstance::find_victim_page(frame_id_t *frame_id) {
 }
 
 /**
- * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
- * @param {Page*} page 写回页指针
+ * @description: 在持有latch_时为新页面预留帧：更新page table和page元数据，并把帧标记为I/O进行中，pin_count置1。
+ *               若旧页为脏页，其映射保留到写回完成，访问旧页的线程会在该帧上等待，避免从磁盘读到过期数据
+ * @return {bool} 旧页是否为脏页，需要在释放latch_后写回磁盘
+ * @param {Page*} page 预留的帧对应的页
  * @param {PageId} new_page_id 新的page_id
  * @param {frame_id_t} new_frame_id 新的帧frame_id
+ * @param {PageId*} old_page_id 返回帧中原先存放的page_id
  */
-void BufferPoolInstance::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
-    // Todo:
-    // 1 如果是脏页，写回磁盘，并且把dirty置为false
-    // 2 更新page table
-    // 3 重置page的data，更新page id
-    if (page->is_dirty()) {
-        // ++cnt_update;
+bool BufferPoolInstance::reserve_frame(Page *page, PageId new_page_id, frame_id_t new_frame_id, PageId *old_page_id) {
+    bool need_write_back = page->is_dirty();
+    *old_page_id = page->get_page_id();
+    if (!need_write_back) {
+        page_table_.erase(*old_page_id);
+    }
+    page_table_[new_page_id] = new_frame_id;
+
+    page->id_ = new_page_id;
+    page->is_dirty_ = false;
+    page->is_io_pending_ = true;
+    // 不知道是从freelist还是replacer来的，都pin一下，待优化
+    replacer_->pin(new_frame_id);
+    page->pin_count_ = 1;
+    return need_write_back;
+}
+
+/**
+ * @description: 在不持有latch_的情况下把被淘汰的脏页写回磁盘，写回完成后再移除旧页的映射并唤醒等待旧页的线程。
+ *               写回失败时恢复旧页的映射和脏标记，并抛出异常
+ * @param {unique_lock&} lk 调用时处于未加锁状态，返回时同样未加锁
+ * @param {Page*} page 被淘汰的帧对应的页，data_中仍为旧页数据
+ * @param {PageId} old_page_id 旧页的page_id
+ * @param {frame_id_t} frame_id 帧号
+ */
+void BufferPoolInstance::write_back_victim(std::unique_lock<std::mutex> &lk, Page *page, PageId old_page_id,
+                                           frame_id_t frame_id) {
 #ifdef ENABLE_LOGGING
-        // 置换出脏页且 lsn 大于 persist 时需要刷日志回磁盘
-        // if (log_manager_ != nullptr && page->get_page_lsn() > log_manager_->get_persist_lsn()) {
-        //     log_manager_->flush_log_to_disk();
-        // }
+    // 置换出脏页且 lsn 大于 persist 时需要刷日志回磁盘
+    // if (log_manager_ != nullptr && page->get_page_lsn() > log_manager_->get_persist_lsn()) {
+    //     log_manager_->flush_log_to_disk();
+    // }
 #endif
-        disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
-        page->is_dirty_ = false;
+    try {
+        disk_manager_->write_page(old_page_id.fd, old_page_id.page_no, page->get_data(), PAGE_SIZE);
+    } catch (...) {
+        restore_victim(lk, page, old_page_id, frame_id);
+        throw;
     }
+    // ++cnt_update;
+    release_victim(lk, old_page_id, frame_id);
+}
 
-    page_table_.erase(page->get_page_id());
-    page_table_[new_page_id] = new_frame_id;
+/**
+ * @description: 被淘汰的脏页已经写回，移除旧页的映射，等待旧页的线程重新查页表时会从磁盘读到刚写回的数据
+ * @param {unique_lock&} lk 调用时处于未加锁状态，返回时同样未加锁
+ */
+void BufferPoolInstance::release_victim(std::unique_lock<std::mutex> &lk, PageId old_page_id, frame_id_t frame_id) {
+    lk.lock();
+    page_table_.erase(old_page_id);
+    lk.unlock();
+    io_cvs_[frame_id].notify_all();
+}
 
-    // page->reset_memory();
-    page->id_ = new_page_id;
+/**
+ * @description: 脏页写回失败，撤销对帧的预留，帧中仍是旧页的脏数据
+ * @param {unique_lock&} lk 调用时处于未加锁状态，返回时同样未加锁
+ */
+void BufferPoolInstance::restore_victim(std::unique_lock<std::mutex> &lk, Page *page, PageId old_page_id,
+                                        frame_id_t frame_id) {
+    lk.lock();
+    page_table_.erase(page->id_);
+    page->id_ = old_page_id;
+    page->is_dirty_ = true;
+    page->is_io_pending_ = false;
     page->pin_count_ = 0;
+    replacer_->unpin(frame_id);
+    lk.unlock();
+    io_cvs_[frame_id].notify_all();
+}
+
+/**
+ * @description: 帧上的I/O完成，清除I/O标记并唤醒在该帧上等待的线程
+ * @param {unique_lock&} lk 调用时处于未加锁状态，返回时同样未加锁
+ * @param {Page*} page 完成I/O的页
+ * @param {frame_id_t} frame_id 帧号
+ */
+void BufferPoolInstance::finish_io(std::unique_lock<std::mutex> &lk, Page *page, frame_id_t frame_id) {
+    lk.lock();
+    page->is_io_pending_ = false;
+    page->rec_lsn_ = next_rec_lsn();
+    lk.unlock();
+    io_cvs_[frame_id].notify_all();
+}
+
+/**
+ * @description: 读入新页失败，撤销对帧的预留。帧中不再是有效页面，但仍可被replacer淘汰复用
+ * @param {unique_lock&} lk 调用时处于未加锁状态，返回时同样未加锁
+ * @param {Page*} page 预留的帧对应的页
+ * @param {frame_id_t} frame_id 帧号
+ */
+void BufferPoolInstance::cancel_io(std::unique_lock<std::mutex> &lk, Page *page, frame_id_t frame_id) {
+    lk.lock();
+    page_table_.erase(page->id_);
+    page->id_ = {-1, INVALID_PAGE_ID};
+    page->is_io_pending_ = false;
+    page->pin_count_ = 0;
+    replacer_->unpin(frame_id);
+    lk.unlock();
+    io_cvs_[frame_id].notify_all();
+}
+
+/**
+ * @description: 在帧上等待其I/O完成，或者page_id不再映射到该帧（被淘汰的旧页已写回），只会阻塞访问同一帧的线程。
+ *               返回后帧可能已经换成其他页面，调用者需要重新查页表
+ * @param {unique_lock&} lk 已加锁的latch_
+ * @param {PageId} page_id 等待的页面
+ * @param {frame_id_t} frame_id 帧号
+ */
+void BufferPoolInstance::wait_for_io(std::unique_lock<std::mutex> &lk, PageId page_id, frame_id_t frame_id) {
+    io_cvs_[frame_id].wait(lk, [&] {
+        if (!pages_[frame_id].is_io_pending_) {
+            return true;
+        }
+        auto it = page_table_.find(page_id);
+        return it == page_table_.end() || it->second != frame_id;
+    });
 }
 
 /**
  * @description: 从buffer pool获取需要的页。
  *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
  *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
+ *              脏页写回和读盘都在释放latch_之后进行，只有访问同一帧的线程需要等待
  * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
  * @param {PageId} page_id 需要获取的页的PageId
  */
@@ -63,50 +161,109 @@ Page *BufferPoolInstance::fetch_page(PageId page_id) {
     // 1.     从page_table_中搜寻目标页
     // 1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
     // 1.2    否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
-    // 2.     若获得的可用frame存储的为dirty page，则须调用updata_page将page写回到磁盘
-    // 3.     调用disk_manager_的read_page读取目标页到frame
-    // 4.     固定目标页，更新pin_count_
-    // 5.     返回目标页
-    // auto wait_start = std::chrono::high_resolution_clock::now();
+    // 2.     预留frame并标记I/O进行中，释放latch_
+    // 3.     若获得的可用frame存储的为dirty page，则须调用write_back_victim将page写回到磁盘
+    // 4.     调用disk_manager_的read_page读取目标页到frame
+    // 5.     清除I/O标记，唤醒等待该frame的线程，返回目标页
     std::unique_lock lk(latch_);
-    // auto wait_end = std::chrono::high_resolution_clock::now();
-    // wait_time += std::chrono::duration_cast<std::chrono::microseconds>(wait_end - wait_start).count();
-
-    // auto start = std::chrono::high_resolution_clock::now();  // 开始计时
 
     // ++cnt_fetch;
 
     frame_id_t frame_id = INVALID_FRAME_ID;
-    auto &&it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
-        // ++cnt_vitcm;
-        if (find_victim_page(&frame_id)) {
-            update_page(&pages_[frame_id], page_id, frame_id);
-            // lk.unlock();
-            // auto startt = std::chrono::high_resolution_clock::now();  // 开始计时
-            disk_manager_->read_page(page_id.fd, page_id.page_no, pages_[frame_id].get_data(), PAGE_SIZE);
-            // auto end = std::chrono::high_resolution_clock::now();  // 结束计时
-            // read_time += std::chrono::duration_cast<std::chrono::microseconds>(end - startt).count();
-            // 不知道是从freelist还是replacer来的，都pin一下，待优化
-            replacer_->pin(frame_id);
-            pages_[frame_id].pin_count_ = 1;
-            // end = std::chrono::high_resolution_clock::now();  // 结束计时
-            // fetch_time += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    auto it = page_table_.find(page_id);
+    while (it != page_table_.end()) {
+        frame_id = it->second;
+        if (!pages_[frame_id].is_io_pending_) {
+            // 如果已经在页表中，只有第一次使用需要pin
+            if (++pages_[frame_id].pin_count_ == 1) {
+                replacer_->pin(frame_id);
+                if (!pages_[frame_id].is_dirty_) {
+                    pages_[frame_id].rec_lsn_ = next_rec_lsn();
+                }
+            }
             return &pages_[frame_id];
         }
+        // 目标页正在读入，或者是正在被写回的旧页，等待后重新查找
+        wait_for_io(lk, page_id, frame_id);
+        it = page_table_.find(page_id);
+    }
+
+    // ++cnt_vitcm;
+    if (!find_victim_page(&frame_id)) {
         return nullptr;
     }
-    frame_id = it->second;
-    // lk.unlock();
+    auto *page = &pages_[frame_id];
+    PageId old_page_id;
+    bool need_write_back = reserve_frame(page, page_id, frame_id, &old_page_id);
+    lk.unlock();
+
+    if (need_write_back) {
+        write_back_victim(lk, page, old_page_id, frame_id);
+    }
+    try {
+        disk_manager_->read_page(page_id.fd, page_id.page_no, page->get_data(), PAGE_SIZE);
+    } catch (...) {
+        cancel_io(lk, page, frame_id);
+        throw;
+    }
+    finish_io(lk, page, frame_id);
+    return page;
+}
 
-    // 如果已经在页表中，只有第一次使用需要pin
-    if (++pages_[frame_id].pin_count_ == 1) {
-        replacer_->pin(frame_id);
+/**
+ * @description: 预读第一阶段：为不在缓冲池中的页面预留帧并标记I/O进行中，不做任何磁盘I/O
+ * @return {bool} 成功预留返回true；页面已在缓冲池中或没有可用帧时返回false
+ * @param {PageId} page_id 需要预读的页面
+ * @param {PrefetchSlot*} slot 返回预留的帧信息，写回和读入的请求由调用者合并提交
+ */
+bool BufferPoolInstance::reserve_prefetch(PageId page_id, PrefetchSlot *slot) {
+    std::lock_guard lock(latch_);
+    if (page_table_.count(page_id)) {
+        return false;
+    }
+    frame_id_t frame_id = INVALID_FRAME_ID;
+    if (!find_victim_page(&frame_id)) {
+        return false;
+    }
+    slot->page = &pages_[frame_id];
+    slot->page_id = page_id;
+    slot->frame_id = frame_id;
+    slot->need_write_back = reserve_frame(slot->page, page_id, frame_id, &slot->old_page_id);
+    return true;
+}
+
+/**
+ * @description: 预读第二阶段：被淘汰的脏页写回完成。写回失败时撤销预留，该页不再读入
+ * @param {PrefetchSlot&} slot 预留的帧
+ * @param {bool} ok 写回是否成功
+ */
+void BufferPoolInstance::finish_prefetch_write_back(const PrefetchSlot &slot, bool ok) {
+    std::unique_lock lk(latch_, std::defer_lock);
+    if (ok) {
+        release_victim(lk, slot.old_page_id, slot.frame_id);
+    } else {
+        restore_victim(lk, slot.page, slot.old_page_id, slot.frame_id);
     }
+}
 
-    // auto end = std::chrono::high_resolution_clock::now();  // 结束计时
-    // fetch_time += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-    return &pages_[frame_id];
+/**
+ * @description: 预读第三阶段：页面读入完成，取消预读时加的pin。读入失败时释放帧
+ * @param {PrefetchSlot&} slot 预留的帧
+ * @param {bool} ok 读入是否成功
+ */
+void BufferPoolInstance::finish_prefetch(const PrefetchSlot &slot, bool ok) {
+    std::unique_lock lk(latch_);
+    if (!ok) {
+        lk.unlock();
+        cancel_io(lk, slot.page, slot.frame_id);
+        return;
+    }
+    slot.page->is_io_pending_ = false;
+    if (--slot.page->pin_count_ == 0) {
+        replacer_->unpin(slot.frame_id);
+    }
+    lk.unlock();
+    io_cvs_[slot.frame_id].notify_all();
 }
 
 /**
@@ -126,7 +283,8 @@ bool BufferPoolInstance::unpin_page(PageId page_id, bool is_dirty) {
     // 2.2.1 若自减后等于0，则调用replacer_的Unpin
     // 3 根据参数is_dirty，更改P的is_dirty_
     // 缓冲池够用 没必要 unpin，决赛不行了
-    // std::lock_guard lock(latch_);
+    // fetch_page 在 latch_ 之外读盘，pin_count_ 必须在 latch_ 保护下修改
+    std::lock_guard lock(latch_);
     // ++cnt_unpin;
 
     auto &&it = page_table_.find(page_id);
@@ -156,9 +314,13 @@ bool BufferPoolInstance::flush_page(PageId page_id) {
     // 1.1 目标页P没有被page_table_记录 ，返回false
     // 2. 无论P是否为脏都将其写回磁盘。
     // 3. 更新P的is_dirty_
-    std::lock_guard lock(latch_);
+    std::unique_lock lock(latch_);
 
-    auto &&it = page_table_.find(page_id);
+    auto it = page_table_.find(page_id);
+    while (it != page_table_.end() && pages_[it->second].is_io_pending_) {
+        wait_for_io(lock, page_id, it->second);
+        it = page_table_.find(page_id);
+    }
     // 不在页表中
     if (it == page_table_.end()) {
         return false;
@@ -186,19 +348,28 @@ Page *BufferPoolInstance::new_page(PageId *page_id) {
     // 3.   将frame的数据写回磁盘
     // 4.   固定frame，更新pin_count_
     // 5.   返回获得的page
-    std::lock_guard lock(latch_);
+    std::unique_lock lk(latch_);
 
     frame_id_t frame_id = -1;
-    if (find_victim_page(&frame_id)) {
-        // page_id->page_no = disk_manager_->allocate_page(page_id->fd);
-        update_page(&pages_[frame_id], *page_id, frame_id);
-        pages_[frame_id].reset_memory();
-        // 不知道是从freelist还是replacer来的，都pin一下，待优化
-        replacer_->pin(frame_id);
-        pages_[frame_id].pin_count_ = 1;
-        return &pages_[frame_id];
-    }
-    return nullptr;
+    if (!find_victim_page(&frame_id)) {
+        return nullptr;
+    }
+    // page_id->page_no = disk_manager_->allocate_page(page_id->fd);
+    auto *page = &pages_[frame_id];
+    PageId old_page_id;
+    bool need_write_back = reserve_frame(page, *page_id, frame_id, &old_page_id);
+    if (!need_write_back) {
+        page->reset_memory();
+        page->is_io_pending_ = false;
+        page->rec_lsn_ = next_rec_lsn();
+        return page;
+    }
+    lk.unlock();
+
+    write_back_victim(lk, page, old_page_id, frame_id);
+    page->reset_memory();
+    finish_io(lk, page, frame_id);
+    return page;
 }
 
 /**
@@ -210,9 +381,13 @@ bool BufferPoolInstance::delete_page(PageId page_id) {
     // 1.   在page_table_中查找目标页，若不存在返回true
     // 2.   若目标页的pin_count不为0，则返回false
     // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
-    std::lock_guard lock(latch_);
+    std::unique_lock lock(latch_);
 
-    auto &&it = page_table_.find(page_id);
+    auto it = page_table_.find(page_id);
+    while (it != page_table_.end() && pages_[it->second].is_io_pending_) {
+        wait_for_io(lock, page_id, it->second);
+        it = page_table_.find(page_id);
+    }
     if (it == page_table_.end()) {
         return true;
     }
@@ -247,18 +422,45 @@ bool BufferPoolInstance::delete_page(PageId page_id) {
 void BufferPoolInstance::flush_all_pages(int fd) {
     std::lock_guard lock(latch_);
 
+    // 收集该文件的所有页面，一次提交给 I/O 后端
+    std::vector<IoRequest> requests;
+    std::vector<Page *> pages;
     for (auto &[pageId, frameId]: page_table_) {
         if (pageId.fd == fd && frameId != INVALID_FRAME_ID) {
             auto &page = pages_[frameId];
+            // 正在读入的页不是脏页，正在写回的旧页由写回线程负责落盘
+            if (page.is_io_pending_) {
+                continue;
+            }
 #ifdef ENABLE_LOGGING
             if (log_manager_ != nullptr && page.get_page_lsn() > log_manager_->get_persist_lsn()) {
                 log_manager_->flush_log_to_disk();
             }
 #endif
-            disk_manager_->write_page(page.id_.fd, page.id_.page_no, page.data_, PAGE_SIZE);
-            page.is_dirty_ = false;
+            requests.emplace_back(IoRequest::write(page.id_.fd, page.data_, PAGE_SIZE,
+                                                   static_cast<off_t>(page.id_.page_no) * PAGE_SIZE));
+            pages.emplace_back(&page);
         }
     }
+    submit_writes(requests, pages);
+}
+
+/**
+ * @description: 批量提交页面写请求，全部成功后清除脏标记
+ * @param {vector<IoRequest>&} requests 写请求
+ * @param {vector<Page*>&} pages 与请求一一对应的页面
+ */
+void BufferPoolInstance::submit_writes(std::vector<IoRequest> &requests, std::vector<Page *> &pages) {
+    if (requests.empty()) {
+        return;
+    }
+    disk_manager_->submit_io(requests.data(), requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (requests[i].result != PAGE_SIZE) {
+            throw InternalError("BufferPoolInstance::submit_writes: Write Error");
+        }
+        pages[i]->is_dirty_ = false;
+    }
 }
 
 /** 为创建检查点调用
@@ -268,17 +470,75 @@ void BufferPoolInstance::flush_all_pages(int fd) {
 void BufferPoolInstance::flush_all_pages_for_checkpoint(int fd) {
     std::lock_guard lock(latch_);
 
+    std::vector<IoRequest> requests;
+    std::vector<Page *> pages;
     for (auto &[pageId, frameId]: page_table_) {
         if (pageId.fd == fd) {
             auto &page = pages_[frameId];
+            if (page.is_io_pending_) {
+                continue;
+            }
             // 日志清空了，lsn 设置为初始状态
             page.set_page_lsn(INVALID_LSN);
-            disk_manager_->write_page(page.id_.fd, page.id_.page_no, page.data_, PAGE_SIZE);
-            page.is_dirty_ = false;
+            requests.emplace_back(IoRequest::write(page.id_.fd, page.data_, PAGE_SIZE,
+                                                   static_cast<off_t>(page.id_.page_no) * PAGE_SIZE));
+            pages.emplace_back(&page);
+        }
+    }
+    submit_writes(requests, pages);
+}
+
+lsn_t BufferPoolInstance::next_rec_lsn() const {
+    return log_manager_ != nullptr ? log_manager_->get_next_lsn() : INVALID_LSN;
+}
+
+/**
+ * @description: 获取缓冲池中的脏页及其rec_lsn，用于模糊检查点。正在写回的被淘汰脏页还没有落盘，同样计入
+ * @param {vector<pair<PageId, lsn_t>>*} dirty_pages 追加脏页的page_id和rec_lsn
+ */
+void BufferPoolInstance::get_dirty_pages(std::vector<std::pair<PageId, lsn_t>> *dirty_pages) {
+    std::lock_guard lock(latch_);
+    for (auto &[page_id, frame_id]: page_table_) {
+        auto &page = pages_[frame_id];
+        if (page.is_io_pending_) {
+            // 帧已经预留给新页面，但旧页面的映射保留到写回完成
+            if (page.id_ != page_id) {
+                dirty_pages->emplace_back(page_id, page.rec_lsn_);
+            }
+        } else if (page.is_dirty_) {
+            dirty_pages->emplace_back(page_id, page.rec_lsn_);
         }
     }
 }
 
+/**
+ * @description: 把rec_lsn小于lsn且没有被pin的脏页写回磁盘，用于推进检查点的日志截断位置，被pin的页面留到下次
+ * @param {lsn_t} lsn rec_lsn的上界
+ */
+void BufferPoolInstance::flush_pages_before(lsn_t lsn) {
+    std::lock_guard lock(latch_);
+
+    std::vector<IoRequest> requests;
+    std::vector<Page *> pages;
+    lsn_t max_page_lsn = INVALID_LSN;
+    for (auto &[page_id, frame_id]: page_table_) {
+        auto &page = pages_[frame_id];
+        if (page.is_io_pending_ || !page.is_dirty_ || page.pin_count_ > 0 || page.rec_lsn_ >= lsn) {
+            continue;
+        }
+        max_page_lsn = std::max(max_page_lsn, page.get_page_lsn());
+        requests.emplace_back(IoRequest::write(page.id_.fd, page.data_, PAGE_SIZE,
+                                               static_cast<off_t>(page.id_.page_no) * PAGE_SIZE));
+        pages.emplace_back(&page);
+    }
+#ifdef ENABLE_LOGGING
+    if (log_manager_ != nullptr && max_page_lsn > log_manager_->get_persist_lsn()) {
+        log_manager_->flush_log_to_disk();
+    }
+#endif
+    submit_writes(requests, pages);
+}
+
 /**
  * @description: 将buffer_pool中的所有页写回到磁盘
  * @param {int} fd 文件句柄
@@ -287,7 +547,7 @@ void BufferPoolInstance::delete_all_pages(int fd) {
     std::lock_guard lock(latch_);
 
     for (auto it = page_table_.begin(); it != page_table_.end();) {
-        if (it->first.fd == fd && it->second != INVALID_FRAME_ID) {
+        if (it->first.fd == fd && it->second != INVALID_FRAME_ID && !pages_[it->second].is_io_pending_) {
             // 清页面
             auto &page = pages_[it->second];
             page.reset_memory();
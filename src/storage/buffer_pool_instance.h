@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <list>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 #include "replacer/lru_replacer.h"
 
 #include "disk_manager.h"
@@ -14,6 +17,15 @@
 
 class LogManager;
 
+/* 预读时为一个页面预留的帧，由 BufferPoolManager 把多个实例的写回和读入合并成一次提交 */
+struct PrefetchSlot {
+    Page *page;
+    PageId page_id;
+    PageId old_page_id;
+    frame_id_t frame_id;
+    bool need_write_back;
+};
+
 class BufferPoolInstance {
 public:
     size_t pool_size_; // buffer_pool中可容纳页面的个数，即帧的个数
@@ -24,6 +36,7 @@ public:
     ClockReplacer *replacer_; // buffer_pool的置换策略，当前赛题中为LRU置换策略
     LogManager *log_manager_;
     std::mutex latch_; // 用于共享数据结构的并发控制
+    std::unique_ptr<std::condition_variable[]> io_cvs_; // 每个帧一个条件变量，等待该帧上的 I/O 完成，与 latch_ 配合使用
     int cnt_fetch = 0;
     int cnt_vitcm = 0;
     int cnt_update = 0;
@@ -37,7 +50,8 @@ public:
         : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
         // 为buffer pool分配一块连续的内存空间
         pages_ = new Page[pool_size_];
-        replacer_ = new ClockReplacer();
+        io_cvs_ = std::make_unique<std::condition_variable[]>(pool_size_);
+        replacer_ = new ClockReplacer(pool_size_);
         // 初始化时，所有的page都在free_list_中
         for (size_t i = 0; i < pool_size_; ++i) {
             free_list_.emplace_back(static_cast<frame_id_t>(i)); // static_cast转换数据类型
@@ -73,6 +87,16 @@ public:
 
     void delete_all_pages(int fd);
 
+    void get_dirty_pages(std::vector<std::pair<PageId, lsn_t>> *dirty_pages);
+
+    void flush_pages_before(lsn_t lsn);
+
+    bool reserve_prefetch(PageId page_id, PrefetchSlot *slot);
+
+    void finish_prefetch_write_back(const PrefetchSlot &slot, bool ok);
+
+    void finish_prefetch(const PrefetchSlot &slot, bool ok);
+
     // auto FetchPageBasic(PageId page_id) -> BasicPageGuard;
     //
     // auto FetchPageRead(PageId page_id) -> ReadPageGuard;
@@ -84,5 +108,22 @@ public:
 private:
     bool find_victim_page(frame_id_t *frame_id);
 
-    void update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id);
+    bool reserve_frame(Page *page, PageId new_page_id, frame_id_t new_frame_id, PageId *old_page_id);
+
+    void write_back_victim(std::unique_lock<std::mutex> &lk, Page *page, PageId old_page_id, frame_id_t frame_id);
+
+    void release_victim(std::unique_lock<std::mutex> &lk, PageId old_page_id, frame_id_t frame_id);
+
+    void restore_victim(std::unique_lock<std::mutex> &lk, Page *page, PageId old_page_id, frame_id_t frame_id);
+
+    void submit_writes(std::vector<IoRequest> &requests, std::vector<Page *> &pages);
+
+    void finish_io(std::unique_lock<std::mutex> &lk, Page *page, frame_id_t frame_id);
+
+    void cancel_io(std::unique_lock<std::mutex> &lk, Page *page, frame_id_t frame_id);
+
+    void wait_for_io(std::unique_lock<std::mutex> &lk, PageId page_id, frame_id_t frame_id);
+
+    // 干净页面被固定时记录当前的下一个lsn，之后对它的修改写入的日志lsn都不会更小
+    lsn_t next_rec_lsn() const;
 };
@@ -54,17 +54,41 @@ bool BufferPoolManager::delete_page(PageId page_id) {
  * @param {int} fd 文件句柄
  */
 void BufferPoolManager::flush_all_pages(int fd) {
-    for (auto &instance: instances_) {
+    for (std::size_t i = 0; i < num_instances_; ++i) {
+        auto *instance = instances_[i];
         instance->flush_all_pages(fd);
     }
 }
 
+/**
+ * @description: 获取所有实例中的脏页及其rec_lsn，用于模糊检查点
+ * @param {vector<pair<PageId, lsn_t>>*} dirty_pages 追加脏页的page_id和rec_lsn
+ */
+void BufferPoolManager::get_dirty_pages(std::vector<std::pair<PageId, lsn_t>> *dirty_pages) {
+    for (std::size_t i = 0; i < num_instances_; ++i) {
+        auto *instance = instances_[i];
+        instance->get_dirty_pages(dirty_pages);
+    }
+}
+
+/**
+ * @description: 把rec_lsn小于lsn的脏页写回磁盘，不会阻塞其他实例
+ * @param {lsn_t} lsn rec_lsn的上界
+ */
+void BufferPoolManager::flush_pages_before(lsn_t lsn) {
+    for (std::size_t i = 0; i < num_instances_; ++i) {
+        auto *instance = instances_[i];
+        instance->flush_pages_before(lsn);
+    }
+}
+
 /** 为创建检查点调用
  * @description: 将buffer_pool中的所有页写回到磁盘
  * @param {int} fd 文件句柄
  */
 void BufferPoolManager::flush_all_pages_for_checkpoint(int fd) {
-    for (auto &instance: instances_) {
+    for (std::size_t i = 0; i < num_instances_; ++i) {
+        auto *instance = instances_[i];
         instance->flush_all_pages_for_checkpoint(fd);
     }
 }
@@ -74,11 +98,86 @@ void BufferPoolManager::flush_all_pages_for_checkpoint(int fd) {
  * @param {int} fd 文件句柄
  */
 void BufferPoolManager::delete_all_pages(int fd) {
-    for (auto &instance: instances_) {
+    for (std::size_t i = 0; i < num_instances_; ++i) {
+        auto *instance = instances_[i];
         instance->delete_all_pages(fd);
     }
 }
 
+/**
+ * @description: 把一批页面预读到缓冲池中，不pin页面。所有实例上需要的脏页写回合并为一次提交，读入合并为一次提交
+ * @param {vector<PageId>&} page_ids 需要预读的页面，已在缓冲池中的页面会被跳过
+ */
+void BufferPoolManager::prefetch_pages(const std::vector<PageId> &page_ids) {
+    std::vector<std::pair<BufferPoolInstance *, PrefetchSlot> > slots;
+    slots.reserve(page_ids.size());
+    for (auto &page_id: page_ids) {
+        auto *instance = instances_[get_instance_no(page_id)];
+        PrefetchSlot slot{};
+        if (instance->reserve_prefetch(page_id, &slot)) {
+            slots.emplace_back(instance, slot);
+        }
+    }
+    if (slots.empty()) {
+        return;
+    }
+
+    // 1. 写回被淘汰的脏页
+    std::vector<IoRequest> requests;
+    std::vector<size_t> slot_idx;
+    for (size_t i = 0; i < slots.size(); ++i) {
+        auto &slot = slots[i].second;
+        if (slot.need_write_back) {
+            requests.emplace_back(IoRequest::write(slot.old_page_id.fd, slot.page->get_data(), PAGE_SIZE,
+                                                   static_cast<off_t>(slot.old_page_id.page_no) * PAGE_SIZE));
+            slot_idx.emplace_back(i);
+        }
+    }
+    std::vector<bool> dropped(slots.size(), false);
+    if (!requests.empty()) {
+        disk_manager_->submit_io(requests.data(), requests.size());
+        for (size_t i = 0; i < requests.size(); ++i) {
+            auto &[instance, slot] = slots[slot_idx[i]];
+            bool ok = requests[i].result == PAGE_SIZE;
+            instance->finish_prefetch_write_back(slot, ok);
+            dropped[slot_idx[i]] = !ok;
+        }
+    }
+
+    // 2. 读入目标页
+    requests.clear();
+    slot_idx.clear();
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (dropped[i]) {
+            continue;
+        }
+        auto &slot = slots[i].second;
+        requests.emplace_back(IoRequest::read(slot.page_id.fd, slot.page->get_data(), PAGE_SIZE,
+                                              static_cast<off_t>(slot.page_id.page_no) * PAGE_SIZE));
+        slot_idx.emplace_back(i);
+    }
+    disk_manager_->submit_io(requests.data(), requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        auto &[instance, slot] = slots[slot_idx[i]];
+        instance->finish_prefetch(slot, requests[i].result == PAGE_SIZE);
+    }
+}
+
+/**
+ * @description: 预读文件中连续的一段页面
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} start_page_no 起始页号
+ * @param {int} num_pages 页面个数
+ */
+void BufferPoolManager::prefetch_pages(int fd, page_id_t start_page_no, int num_pages) {
+    std::vector<PageId> page_ids;
+    page_ids.reserve(num_pages);
+    for (int i = 0; i < num_pages; ++i) {
+        page_ids.push_back({fd, start_page_no + i});
+    }
+    prefetch_pages(page_ids);
+}
+
 // auto BufferPoolManager::FetchPageBasic(PageId page_id) -> BasicPageGuard {
 //     auto *page = fetch_page(page_id);
 //     return {this, page};
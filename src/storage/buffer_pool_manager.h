@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
 
@@ -24,6 +25,7 @@ class BufferPoolManager {
 private:
     size_t pool_size_; // buffer_pool中可容纳页面的个数，即帧的个数
     BufferPoolInstance *instances_[BUFFER_POOL_INSTANCES]{}; // 缓冲池实例
+    std::size_t num_instances_; // 实际使用的实例个数，缓冲池较小时少于BUFFER_POOL_INSTANCES
     std::hash<PageId> hasher_;
     // Page *pages_; // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为BUFFER_POOL_SIZE
     // std::unordered_map<PageId, frame_id_t> page_table_; // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号
@@ -38,15 +40,19 @@ public:
         : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
         // 共享lru
         // replacer_ = new LRUReplacer(pool_size_);
-        for (auto &instance: instances_) {
-            instance = new BufferPoolInstance(pool_size / BUFFER_POOL_INSTANCES, disk_manager_, log_manager_);
+        // 缓冲池较小时减少实例个数，避免按哈希分区后每个实例只剩很少的帧
+        num_instances_ = std::clamp<std::size_t>(pool_size / BUFFER_POOL_MIN_INSTANCE_SIZE, 1, BUFFER_POOL_INSTANCES);
+        // 余数分给前面的实例，每个实例至少一帧
+        for (std::size_t i = 0; i < num_instances_; ++i) {
+            std::size_t instance_size = pool_size / num_instances_ + (i < pool_size % num_instances_ ? 1 : 0);
+            instances_[i] = new BufferPoolInstance(std::max<std::size_t>(instance_size, 1), disk_manager_, log_manager_);
         }
     }
 
     ~BufferPoolManager() {
         // delete replacer_;
-        for (auto &instance: instances_) {
-            delete instance;
+        for (std::size_t i = 0; i < num_instances_; ++i) {
+            delete instances_[i];
         }
     }
 
@@ -57,6 +63,8 @@ public:
     // static void mark_dirty(Page *page) { page->is_dirty_ = true; }
 
 public:
+    LogManager *get_log_manager() const { return log_manager_; }
+
     Page *fetch_page(PageId page_id);
 
     bool unpin_page(PageId page_id, bool is_dirty);
@@ -73,9 +81,18 @@ public:
 
     void delete_all_pages(int fd);
 
+    void get_dirty_pages(std::vector<std::pair<PageId, lsn_t>> *dirty_pages);
+
+    void flush_pages_before(lsn_t lsn);
+
+    void prefetch_pages(const std::vector<PageId> &page_ids);
+
+    void prefetch_pages(int fd, page_id_t start_page_no, int num_pages);
+
     void ouput_info() {
         // printf("page2instance size: %lu\n", page2instance_.size());
-        for (auto &instance: instances_) {
+        for (std::size_t i = 0; i < num_instances_; ++i) {
+            auto *instance = instances_[i];
             printf("bpm size: %lu\n", instance->page_table_.size());
             printf("free list size: %lu\n", instance->free_list_.size());
             printf("fetch cnt: %d\n", instance->cnt_fetch);
@@ -97,5 +114,5 @@ public:
     // auto NewPageGuarded(PageId *page_id) -> BasicPageGuard;
 
 private:
-    inline std::size_t get_instance_no(const PageId &page_id) { return hasher_(page_id) % BUFFER_POOL_INSTANCES; }
+    inline std::size_t get_instance_no(const PageId &page_id) { return hasher_(page_id) % num_instances_; }
 };
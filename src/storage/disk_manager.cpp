@@ -17,7 +17,9 @@ See the Mulan PSL v2 for more details. */
 
 #include "defs.h"
 
-DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
+DiskManager::DiskManager() : io_backend_(IoBackend::create()) {
+    memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char)));
+}
 
 /**
  * @description: 将数据写入文件的指定磁盘页面中
@@ -28,17 +30,12 @@ DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<
  */
 void DiskManager::write_page(int fd, page_id_t page_no, const char *data, int num_bytes) {
     // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    // 2.调用write()函数
+    // 1.通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
+    // 2.调用pwrite()函数，缓冲池在latch之外并发读写同一文件，不能共用lseek的文件偏移
     // 注意write返回值与num_bytes不等时 throw InternalError("DiskManager::write_page Error");
-    off_t offset = page_no * PAGE_SIZE;
-
-    if (lseek(fd, offset, SEEK_SET) == -1) {
-        perror("DiskManager::write_page");
-        throw InternalError("DiskManager::write_page: lSeek Error");
-    }
+    off_t offset = static_cast<off_t>(page_no) * PAGE_SIZE;
 
-    if (write(fd, data, num_bytes) != num_bytes) {
+    if (pwrite(fd, data, num_bytes, offset) != num_bytes) {
         throw InternalError("DiskManager::write_page: Write Error");
     }
 }
@@ -52,17 +49,12 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *data, int nu
  */
 void DiskManager::read_page(int fd, page_id_t page_no, char *data, int num_bytes) {
     // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    // 2.调用read()函数
+    // 1.通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
+    // 2.调用pread()函数，缓冲池在latch之外并发读写同一文件，不能共用lseek的文件偏移
     // 注意read返回值与num_bytes不等时，throw InternalError("DiskManager::read_page Error");
-    off_t offset = page_no * PAGE_SIZE;
+    off_t offset = static_cast<off_t>(page_no) * PAGE_SIZE;
 
-    if (lseek(fd, offset, SEEK_SET) == -1) {
-        perror("DiskManager::read_page");
-        throw InternalError("DiskManager::read_page: lSeek Error");
-    }
-
-    if (read(fd, data, num_bytes) != num_bytes) {
+    if (pread(fd, data, num_bytes, offset) != num_bytes) {
         throw InternalError("DiskManager::read_page: Read Error");
     }
 }
@@ -248,23 +240,22 @@ int DiskManager::get_file_fd(const std::string &file_name) {
  * @return {int} 返回读取的数据量，若为-1说明读取数据的起始位置超过了文件大小
  * @param {char} *log_data 读取内容到log_data中
  * @param {int} size 读取的数据量大小
- * @param {int} offset 读取的内容在文件中的位置
+ * @param {off_t} offset 读取的内容在文件中的位置，日志文件可能超过2GB
  */
-int DiskManager::read_log(char *log_data, int size, int offset) {
+int DiskManager::read_log(char *log_data, int size, off_t offset) {
     // read log file from the previous end
     if (log_fd_ == -1) {
         log_fd_ = open_file(LOG_FILE_NAME);
     }
-    int file_size = get_file_size(LOG_FILE_NAME);
+    off_t file_size = get_log_size();
     if (offset > file_size) {
         return -1;
     }
 
     // 得到实际读取的 size
-    size = std::min(size, file_size - offset);
+    size = static_cast<int>(std::min<off_t>(size, file_size - offset));
     if (size == 0) return 0;
-    lseek(log_fd_, offset, SEEK_SET);
-    ssize_t bytes_read = read(log_fd_, log_data, size);
+    ssize_t bytes_read = pread(log_fd_, log_data, size, offset);
     assert(bytes_read == size);
     return bytes_read;
 }
@@ -278,11 +269,112 @@ void DiskManager::write_log(char *log_data, int size) {
     if (log_fd_ == -1) {
         log_fd_ = open_file(LOG_FILE_NAME);
     }
+    if (log_write_offset_ == -1) {
+        log_write_offset_ = get_log_file_size();
+    }
 
     // write from the file_end
-    lseek(log_fd_, 0, SEEK_END);
-    ssize_t bytes_write = write(log_fd_, log_data, size);
-    if (bytes_write != size) {
+    auto request = IoRequest::write(log_fd_, log_data, size, log_write_offset_);
+    io_backend_->submit(&request, 1);
+    if (request.result != size) {
+        throw UnixError();
+    }
+    log_write_offset_ += size;
+}
+
+/**
+ * @description: 从文件系统获取日志文件的大小，get_file_size 返回 int，日志文件可能超过2GB
+ */
+off_t DiskManager::get_log_file_size() {
+    struct stat stat_buf;
+    return stat(LOG_FILE_NAME.c_str(), &stat_buf) == 0 ? stat_buf.st_size : 0;
+}
+
+/**
+ * @description: 日志文件的大小，即下一次写日志的位置
+ */
+off_t DiskManager::get_log_size() {
+    if (log_write_offset_ == -1) {
+        log_write_offset_ = get_log_file_size();
+    }
+    return log_write_offset_;
+}
+
+/**
+ * @description: 释放日志文件中offset之前的磁盘空间。文件大小和之后的日志位置不变，被释放的部分读出来全是0，
+ *               恢复时不会再读取这部分日志。文件系统不支持打洞时输出一次警告，之后不再尝试；
+ *               其他错误输出警告，已释放的位置不前进，下一次检查点重新释放整个范围
+ * @return {bool} 空间是否已经释放到offset（按块对齐）
+ * @param {off_t} offset 不再需要的日志的结束位置
+ */
+bool DiskManager::discard_log_before(off_t offset) {
+    if (log_discard_unsupported_) {
+        return false;
+    }
+    if (log_fd_ == -1) {
+        log_fd_ = open_file(LOG_FILE_NAME);
+    }
+    // 按文件系统块对齐，只释放整块
+    offset -= offset % 4096;
+    if (offset <= log_discarded_offset_) {
+        return true;
+    }
+    if (fallocate(log_fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, log_discarded_offset_,
+                  offset - log_discarded_offset_) != 0) {
+        if (errno == EOPNOTSUPP || errno == ENOSYS) {
+            log_discard_unsupported_ = true;
+            std::cerr << "DiskManager: file system does not support punching holes, log space will not be reclaimed"
+                      << std::endl;
+        } else {
+            std::cerr << "DiskManager: failed to discard log before offset " << offset << ": " << strerror(errno)
+                      << std::endl;
+        }
+        return false;
+    }
+    log_discarded_offset_ = offset;
+    return true;
+}
+
+/**
+ * @description: 把已经写入日志文件的内容持久化到磁盘（fdatasync）
+ */
+void DiskManager::sync_log() {
+    if (log_fd_ == -1) {
+        return;
+    }
+    auto request = IoRequest::fsync(log_fd_);
+    io_backend_->submit(&request, 1);
+    if (request.result < 0) {
+        errno = static_cast<int>(-request.result);
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 把数据文件已经写入的内容持久化到磁盘（fdatasync），检查点截断日志前调用
+ * @param {int} fd 文件句柄
+ */
+void DiskManager::sync_file(int fd) {
+    auto request = IoRequest::fsync(fd);
+    io_backend_->submit(&request, 1);
+    if (request.result < 0) {
+        errno = static_cast<int>(-request.result);
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 文件不足num_pages页时补齐（补齐的部分读出来全为0），保证文件头中记录的页面都可以读取
+ * @param {int} fd 文件句柄
+ * @param {int} num_pages 页面个数
+ */
+void DiskManager::extend_file(int fd, int num_pages) {
+    struct stat stat_buf;
+    if (fstat(fd, &stat_buf) < 0) {
+        throw UnixError();
+    }
+    off_t size = static_cast<off_t>(num_pages) * PAGE_SIZE;
+    if (stat_buf.st_size < size && ftruncate(fd, size) < 0) {
         throw UnixError();
     }
 }
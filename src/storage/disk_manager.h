@@ -22,6 +22,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/config.h"
 #include "errors.h"  
+#include "io_backend.h"
 
 /**
  * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
@@ -36,6 +37,15 @@ class DiskManager {
 
     void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
 
+    /**
+     * @description: 批量提交页面 I/O，由 I/O 后端一次提交并等待全部完成，结果见每个请求的 result
+     * @param {IoRequest*} requests 请求数组
+     * @param {size_t} num 请求个数
+     */
+    void submit_io(IoRequest *requests, size_t num) { io_backend_->submit(requests, num); }
+
+    const char *get_io_backend_name() const { return io_backend_->name(); }
+
     page_id_t allocate_page(int fd);
 
     void deallocate_page(page_id_t page_id);
@@ -65,11 +75,24 @@ class DiskManager {
     int get_file_fd(const std::string &file_name);
 
     /*日志操作*/
-    int read_log(char *log_data, int size, int offset);
+    int read_log(char *log_data, int size, off_t offset);
 
     void write_log(char *log_data, int size);
 
-    void SetLogFd(int log_fd) { log_fd_ = log_fd; }
+    void sync_log();
+
+    off_t get_log_size();
+
+    bool discard_log_before(off_t offset);
+
+    void sync_file(int fd);
+
+    void extend_file(int fd, int num_pages);
+
+    void SetLogFd(int log_fd) {
+        log_fd_ = log_fd;
+        log_write_offset_ = -1;
+    }
 
     int GetLogFd() { return log_fd_; }
 
@@ -90,10 +113,16 @@ class DiskManager {
     static constexpr int MAX_FD = 8192;
 
    private:
+    off_t get_log_file_size();
+
     // 文件打开列表，用于记录文件是否被打开
     std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
     std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
 
     int log_fd_ = -1;                             // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
+    off_t log_write_offset_ = -1;                 // 日志文件的写入位置，打开日志文件时初始化为文件大小
+    off_t log_discarded_offset_ = 0;              // 日志文件中这个位置之前的空间已经释放（重启后从0开始）
+    bool log_discard_unsupported_ = false;        // 文件系统不支持打洞，不再尝试释放日志空间
+    std::unique_ptr<IoBackend> io_backend_;       // 批量磁盘 I/O 后端
     std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
 };
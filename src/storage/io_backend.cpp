@@ -0,0 +1,271 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/io_backend.h"
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+std::unique_ptr<IoBackend> IoBackend::create() {
+#ifdef ENABLE_IO_URING
+    auto uring = std::make_unique<UringIoBackend>();
+    if (uring->is_valid()) {
+        return uring;
+    }
+#endif
+    return std::make_unique<PosixIoBackend>();
+}
+
+/**
+ * @description: 同步执行单个请求，短读短写时继续读写剩余部分
+ * @return {ssize_t} 读写的字节数，失败时为 -errno
+ * @param {IoRequest&} request 请求
+ */
+ssize_t IoBackend::execute(IoRequest &request) {
+    if (request.op == IoOp::FSYNC) {
+        return fdatasync(request.fd) == 0 ? 0 : -errno;
+    }
+    size_t done = 0;
+    while (done < request.len) {
+        ssize_t n = request.op == IoOp::READ
+                        ? pread(request.fd, request.buf + done, request.len - done, request.offset + done)
+                        : pwrite(request.fd, request.buf + done, request.len - done, request.offset + done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        // 读到文件末尾
+        if (n == 0) {
+            break;
+        }
+        done += n;
+    }
+    return static_cast<ssize_t>(done);
+}
+
+void PosixIoBackend::submit(IoRequest *requests, size_t num) {
+    for (size_t i = 0; i < num; ++i) {
+        requests[i].result = execute(requests[i]);
+    }
+}
+
+#ifdef ENABLE_IO_URING
+
+static int io_uring_setup(unsigned entries, io_uring_params *params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+UringIoBackend::UringIoBackend(unsigned entries) {
+    io_uring_params params{};
+    int fd = io_uring_setup(entries, &params);
+    if (fd < 0) {
+        return;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        close(fd);
+        return;
+    }
+    if (single_mmap) {
+        cq_ring_ = sq_ring_;
+    } else {
+        cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                        IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            cq_ring_ = nullptr;
+            munmap(sq_ring_, sq_ring_size_);
+            sq_ring_ = nullptr;
+            close(fd);
+            return;
+        }
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        if (!single_mmap) {
+            munmap(cq_ring_, cq_ring_size_);
+        }
+        munmap(sq_ring_, sq_ring_size_);
+        sq_ring_ = cq_ring_ = nullptr;
+        close(fd);
+        return;
+    }
+    sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+    auto *sq = static_cast<char *>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    sq_entries_ = params.sq_entries;
+    ring_fd_ = fd;
+}
+
+UringIoBackend::~UringIoBackend() {
+    if (ring_fd_ < 0) {
+        return;
+    }
+    munmap(sqes_, sqes_size_);
+    if (cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+}
+
+void UringIoBackend::submit(IoRequest *requests, size_t num) {
+    std::lock_guard lock(latch_);
+    if (is_broken_) {
+        for (size_t i = 0; i < num; ++i) {
+            requests[i].result = execute(requests[i]);
+        }
+        return;
+    }
+    size_t done = 0;
+    while (done < num) {
+        done += submit_batch(requests + done, num - done);
+    }
+}
+
+/**
+ * @description: 收割完成队列中已有的完成事件，结果写入对应的请求
+ * @return {unsigned} 收割的事件个数
+ */
+unsigned UringIoBackend::reap_completions(IoRequest *requests) {
+    unsigned head = *cq_head_;
+    unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    unsigned reaped = 0;
+    while (head != cq_tail) {
+        io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+        requests[cqe->user_data].result = cqe->res;
+        ++head;
+        ++reaped;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    return reaped;
+}
+
+/**
+ * @description: 把不超过 sq_entries_ 个请求放入提交队列，一次 io_uring_enter 提交并等待它们全部完成。
+ *               出错或短读短写的请求回退到同步执行
+ * @return {size_t} 本次处理的请求个数
+ */
+size_t UringIoBackend::submit_batch(IoRequest *requests, size_t num) {
+    unsigned count = static_cast<unsigned>(std::min<size_t>(num, sq_entries_));
+    unsigned tail = *sq_tail_;
+    for (unsigned i = 0; i < count; ++i) {
+        auto &request = requests[i];
+        unsigned index = tail & *sq_mask_;
+        io_uring_sqe *sqe = &sqes_[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->fd = request.fd;
+        sqe->user_data = i;
+        switch (request.op) {
+            case IoOp::READ:
+                sqe->opcode = IORING_OP_READ;
+                sqe->addr = reinterpret_cast<uint64_t>(request.buf);
+                sqe->len = request.len;
+                sqe->off = request.offset;
+                break;
+            case IoOp::WRITE:
+                sqe->opcode = IORING_OP_WRITE;
+                sqe->addr = reinterpret_cast<uint64_t>(request.buf);
+                sqe->len = request.len;
+                sqe->off = request.offset;
+                break;
+            case IoOp::FSYNC:
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+                break;
+        }
+        sq_array_[index] = index;
+        ++tail;
+    }
+    // 内核通过 tail 看到新的 sqe，需要 release 语义
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    unsigned to_submit = count;
+    unsigned completed = 0;
+    while (completed < count) {
+        int ret = io_uring_enter(ring_fd_, to_submit, count - completed, IORING_ENTER_GETEVENTS);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // ring 出错后不再使用。已经被内核取走的 sqe 仍会写入请求的缓冲区，必须先等它们完成，
+            // 只有还没提交的请求才同步执行（读写都是幂等的）
+            is_broken_ = true;
+            unsigned submitted = count - (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE));
+            // 撤回没有提交的 sqe
+            __atomic_store_n(sq_tail_, tail - (count - submitted), __ATOMIC_RELEASE);
+            while (completed < submitted) {
+                completed += reap_completions(requests);
+                if (completed < submitted && io_uring_enter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+                    errno != EINTR) {
+                    // 连等待也失败时只能轮询完成队列
+                    sched_yield();
+                }
+            }
+            for (unsigned i = submitted; i < count; ++i) {
+                requests[i].result = execute(requests[i]);
+            }
+            break;
+        }
+        if (to_submit > 0) {
+            to_submit -= std::min<unsigned>(to_submit, ret);
+        }
+        completed += reap_completions(requests);
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        auto &request = requests[i];
+        if (request.op != IoOp::FSYNC && request.result >= 0 && static_cast<uint32_t>(request.result) < request.len) {
+            // 短读短写，剩余部分同步完成
+            IoRequest rest = request;
+            rest.buf += request.result;
+            rest.len -= request.result;
+            rest.offset += request.result;
+            ssize_t n = execute(rest);
+            request.result = n < 0 ? n : request.result + n;
+        } else if (request.result == -EINTR || request.result == -EAGAIN) {
+            request.result = execute(request);
+        }
+    }
+    return count;
+}
+
+#endif
@@ -0,0 +1,130 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "common/config.h"
+
+#ifdef ENABLE_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+/* 一次磁盘 I/O 请求的类型 */
+enum class IoOp { READ, WRITE, FSYNC };
+
+/**
+ * @description: 一次磁盘 I/O 请求，提交后由后端填写 result（成功时为读写的字节数，失败时为 -errno）
+ */
+struct IoRequest {
+    IoOp op;
+    int fd;
+    char *buf;
+    uint32_t len;
+    off_t offset;
+    ssize_t result = 0;
+
+    static IoRequest read(int fd, char *buf, uint32_t len, off_t offset) { return {IoOp::READ, fd, buf, len, offset}; }
+
+    static IoRequest write(int fd, const char *buf, uint32_t len, off_t offset) {
+        return {IoOp::WRITE, fd, const_cast<char *>(buf), len, offset};
+    }
+
+    // fdatasync，只保证数据落盘
+    static IoRequest fsync(int fd) { return {IoOp::FSYNC, fd, nullptr, 0, 0}; }
+};
+
+/**
+ * @description: 磁盘 I/O 后端，一次提交一批请求并等待它们全部完成
+ */
+class IoBackend {
+public:
+    virtual ~IoBackend() = default;
+
+    /**
+     * @description: 提交一批 I/O 请求并等待全部完成，结果写入每个请求的 result。
+     *               同一批中的请求之间没有顺序保证，需要先写后刷盘时应分两批提交
+     * @param {IoRequest*} requests 请求数组
+     * @param {size_t} num 请求个数
+     */
+    virtual void submit(IoRequest *requests, size_t num) = 0;
+
+    virtual const char *name() const = 0;
+
+    // 优先创建 io_uring 后端，未开启或内核不支持时回退到 pread/pwrite
+    static std::unique_ptr<IoBackend> create();
+
+protected:
+    // 同步执行单个请求
+    static ssize_t execute(IoRequest &request);
+};
+
+/**
+ * @description: 默认后端，逐个调用 pread/pwrite/fdatasync
+ */
+class PosixIoBackend : public IoBackend {
+public:
+    void submit(IoRequest *requests, size_t num) override;
+
+    const char *name() const override { return "pread/pwrite"; }
+};
+
+#ifdef ENABLE_IO_URING
+/**
+ * @description: io_uring 后端，直接使用 io_uring_setup/io_uring_enter 系统调用，不依赖 liburing。
+ *               一批请求只需要一次 io_uring_enter 完成提交和收割；多个线程共用一个 ring，提交时互斥
+ */
+class UringIoBackend : public IoBackend {
+public:
+    explicit UringIoBackend(unsigned entries = IO_URING_QUEUE_DEPTH);
+
+    ~UringIoBackend() override;
+
+    // io_uring_setup 失败（内核过旧或被 seccomp 禁止）时为 false
+    bool is_valid() const { return ring_fd_ >= 0; }
+
+    void submit(IoRequest *requests, size_t num) override;
+
+    const char *name() const override { return "io_uring"; }
+
+private:
+    size_t submit_batch(IoRequest *requests, size_t num);
+
+    unsigned reap_completions(IoRequest *requests);
+
+    int ring_fd_ = -1;
+    unsigned sq_entries_ = 0;
+
+    void *sq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_mask_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    io_uring_sqe *sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    void *cq_ring_ = nullptr;
+    size_t cq_ring_size_ = 0;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned *cq_mask_ = nullptr;
+    io_uring_cqe *cqes_ = nullptr;
+
+    bool is_broken_ = false; // io_uring_enter 出错后回退到同步执行
+    std::mutex latch_; // ring 的提交和收割互斥
+};
+#endif
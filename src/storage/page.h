@@ -100,6 +100,8 @@ public:
 
     inline int get_pin_count() const { return pin_count_; }
 
+    inline bool is_io_pending() const { return is_io_pending_; }
+
 private:
     void reset_memory() {
         // 将 data_ 的 PAGE_SIZE 个字节填充为 0
@@ -122,6 +124,12 @@ private:
     /** The pin count of this page. */
     int pin_count_ = 0;
 
+    /** 帧正在进行磁盘 I/O（脏页写回或读入），此时 data_ 内容不可用 */
+    bool is_io_pending_ = false;
+
+    /** 干净页面被固定时的下一个lsn，之前的修改都已在磁盘上，用于检查点的脏页表 */
+    lsn_t rec_lsn_ = INVALID_LSN;
+
     /** 页读写锁 */
     RWLatch rwlatch_;
 };
@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 #include <unistd.h>
 
 #include <fstream>
+#include <iomanip>
+#include <random>
 
 #include "index/ix.h"
 #include "record/rm.h"
@@ -107,6 +109,12 @@ void SmManager::open_db(const std::string &db_name) {
     }
     ifs >> db_; // 注意：此处重载了操作符>>
 
+    // 统计信息文件只在执行过 ANALYZE 之后才存在
+    std::ifstream stats_ifs(DB_STATS_NAME);
+    if (!stats_ifs.fail()) {
+        stats_ifs >> stats_;
+    }
+
     // 打开数据库中每个表的记录文件并读入
     for (auto &[table_name, tab_meta]: db_.tabs_) {
         fhs_[table_name] = rm_manager_->open_file(table_name);
@@ -127,6 +135,109 @@ void SmManager::flush_meta() {
     ofs << db_;
 }
 
+/**
+ * @description: 把统计信息刷入磁盘中
+ */
+void SmManager::flush_stats() {
+    std::ofstream ofs(DB_STATS_NAME, std::ios::trunc);
+    ofs << std::setprecision(17) << stats_;
+}
+
+/**
+ * @description: 扫描表收集统计信息：行数，以及每一列的不同值个数、最值和等深直方图。
+ * 行数和最值是精确的；直方图由蓄水池抽样得到的至多 STATS_SAMPLE_ROWS 行构造，不同值个数用
+ * HyperLogLog 估计，内存占用和表的大小无关
+ * @param {string&} tab_name 表的名称，为空时收集所有表
+ * @param {Context*} context
+ */
+void SmManager::analyze(const std::string &tab_name, Context *context) {
+    if (tab_name.empty()) {
+        for (auto &[name, _]: db_.tabs_) {
+            std::ignore = _;
+            analyze(name, context);
+        }
+        return;
+    }
+    TabMeta &tab = db_.get_table(tab_name);
+    auto *fh = fhs_.at(tab_name).get();
+    if (context != nullptr && context->lock_mgr_ != nullptr) {
+        context->lock_mgr_->lock_shared_on_table(context->txn_, fh->GetFd());
+    }
+
+    size_t num_cols = tab.cols.size();
+    std::vector<HyperLogLog> distinct(num_cols, HyperLogLog(STATS_HLL_PRECISION));
+    std::vector<std::vector<double> > samples(num_cols);
+    std::vector<double> min_vals(num_cols), max_vals(num_cols);
+    // 固定种子，同样的数据得到同样的统计信息
+    std::mt19937_64 rng(1);
+    TabStats stats;
+    for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+        // 直接读 pin 住的页面中的记录
+        const char *record = scan.get_slot();
+        // 前 STATS_SAMPLE_ROWS 行直接进入样本，之后的第 n 行以 STATS_SAMPLE_ROWS / n 的概率替换样本中随机的一行
+        bool filling = stats.rows < static_cast<size_t>(STATS_SAMPLE_ROWS);
+        size_t slot = filling ? stats.rows : std::uniform_int_distribution<size_t>(0, stats.rows)(rng);
+        for (size_t i = 0; i < num_cols; ++i) {
+            auto &col = tab.cols[i];
+            const char *data = record + col.offset;
+            double key = stats_key(col.type, data, col.len);
+            distinct[i].add(data, col.len);
+            min_vals[i] = stats.rows == 0 ? key : std::min(min_vals[i], key);
+            max_vals[i] = stats.rows == 0 ? key : std::max(max_vals[i], key);
+            if (filling) {
+                samples[i].emplace_back(key);
+            } else if (slot < samples[i].size()) {
+                samples[i][slot] = key;
+            }
+        }
+        ++stats.rows;
+    }
+
+    for (size_t i = 0; i < num_cols; ++i) {
+        ColStats col_stats;
+        auto &col_keys = samples[i];
+        if (!col_keys.empty()) {
+            col_stats.ndv = std::clamp<size_t>(distinct[i].estimate(), 1, stats.rows);
+            col_stats.min_val = min_vals[i];
+            col_stats.max_val = max_vals[i];
+            std::sort(col_keys.begin(), col_keys.end());
+            size_t buckets = std::min<size_t>(STATS_HISTOGRAM_BUCKETS, col_keys.size());
+            for (size_t b = 0; b <= buckets; ++b) {
+                col_stats.bounds.emplace_back(col_keys[b * (col_keys.size() - 1) / buckets]);
+            }
+            // 样本未必抽到最值，直方图两端用精确的最值
+            col_stats.bounds.front() = col_stats.min_val;
+            col_stats.bounds.back() = col_stats.max_val;
+        }
+        stats.cols.emplace(tab.cols[i].name, std::move(col_stats));
+    }
+    stats_.tabs_[tab_name] = std::move(stats);
+    flush_stats();
+}
+
+/**
+ * @description: 把所有表和索引的文件头写回磁盘并持久化数据文件。文件头的修改不写日志，
+ *               检查点截断日志之前需要调用，之后恢复时文件头中记录的页面都可以读取
+ */
+void SmManager::flush_file_headers() {
+    std::lock_guard lock(handles_latch_);
+    for (auto &[_, fh]: fhs_) {
+        std::ignore = _;
+        auto &file_hdr = fh->get_file_hdr();
+        disk_manager_->write_page(fh->GetFd(), RM_FILE_HDR_PAGE, (char *) &file_hdr, sizeof(file_hdr));
+        disk_manager_->extend_file(fh->GetFd(), file_hdr.num_pages);
+        disk_manager_->sync_file(fh->GetFd());
+    }
+    for (auto &[_, ih]: ihs_) {
+        std::ignore = _;
+        std::vector<char> data(ih->file_hdr_->tot_len_);
+        ih->file_hdr_->serialize(data.data());
+        disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data.data(), ih->file_hdr_->tot_len_);
+        disk_manager_->extend_file(ih->fd_, ih->file_hdr_->num_pages_);
+        disk_manager_->sync_file(ih->fd_);
+    }
+}
+
 /**
  * @description: 关闭数据库并把数据落盘
  */
@@ -138,6 +249,7 @@ void SmManager::close_db() {
     flush_meta();
     db_.name_.clear();
     db_.tabs_.clear();
+    stats_.tabs_.clear();
 
     // 记录文件落盘
     std::cout << "before file: " << std::endl;
@@ -269,7 +381,10 @@ void SmManager::create_table(const std::string &tab_name, const std::vector<ColD
     rm_manager_->create_file(tab_name, record_size);
     db_.tabs_[tab_name] = std::move(tab);
     // fhs_[tab_name] = rm_manager_->open_file(tab_name);
-    fhs_.emplace(tab_name, rm_manager_->open_file(tab_name));
+    {
+        std::lock_guard lock(handles_latch_);
+        fhs_.emplace(tab_name, rm_manager_->open_file(tab_name));
+    }
 
     flush_meta();
 
@@ -295,6 +410,7 @@ void SmManager::drop_table(const std::string &tab_name, Context *context) {
     // }
 
     auto &tab_meta = db_.get_table(tab_name);
+    std::unique_lock lock(handles_latch_);
 
     // 先关闭再删除表文件
     rm_manager_->close_file(fhs_[tab_name].get());
@@ -309,9 +425,13 @@ void SmManager::drop_table(const std::string &tab_name, Context *context) {
     }
 
     fhs_.erase(tab_name);
+    lock.unlock();
     db_.tabs_.erase(tab_name);
 
     flush_meta();
+    if (stats_.tabs_.erase(tab_name) > 0) {
+        flush_stats();
+    }
 }
 
 /**
@@ -352,10 +472,10 @@ void SmManager::create_index(std::string &tab_name, std::vector<std::string> &co
     char *key = new char[total_len];
     for (auto &&scan = std::make_unique<RmScan>(fh.get()); !scan->is_end(); scan->next()) {
         auto &&rid = scan->rid();
-        auto &&record = fh->get_record(rid, context);
+        const char *record = scan->get_slot();
         offset = 0;
         for (auto &col_meta: col_metas) {
-            memcpy(key + offset, record->data + col_meta.offset, col_meta.len);
+            memcpy(key + offset, record + col_meta.offset, col_meta.len);
             offset += col_meta.len;
         }
         // 插入B+树
@@ -376,7 +496,10 @@ void SmManager::create_index(std::string &tab_name, std::vector<std::string> &co
     table_meta.indexes.emplace(ix_name, IndexMeta(std::move(tab_name), total_len, static_cast<int>(col_names.size()),
                                                   std::move(col_metas)));
     // 插入索引句柄
-    ihs_[std::move(ix_name)] = std::move(ih);
+    {
+        std::lock_guard lock(handles_latch_);
+        ihs_[std::move(ix_name)] = std::move(ih);
+    }
     // 持久化
     flush_meta();
 }
@@ -400,9 +523,12 @@ void SmManager::drop_index(const std::string &tab_name, const std::vector<std::s
     //     context->lock_mgr_->lock_shared_on_table(context->txn_, fhs_[tab_name]->GetFd());
     // }
 
-    ix_manager_->close_index(ihs_[ix_name].get());
-    ix_manager_->destroy_index(ix_name);
-    ihs_.erase(ix_name);
+    {
+        std::lock_guard lock(handles_latch_);
+        ix_manager_->close_index(ihs_[ix_name].get());
+        ix_manager_->destroy_index(ix_name);
+        ihs_.erase(ix_name);
+    }
     table_meta.indexes.erase(ix_name);
     // 持久化
     flush_meta();
@@ -432,62 +558,13 @@ void SmManager::drop_index(const std::string &tab_name, const std::vector<ColMet
     //     context->lock_mgr_->lock_shared_on_table(context->txn_, fhs_[tab_name]->GetFd());
     // }
 
-    ix_manager_->close_index(ihs_[ix_name].get());
-    ix_manager_->destroy_index(ix_name);
-    ihs_.erase(ix_name);
+    {
+        std::lock_guard lock(handles_latch_);
+        ix_manager_->close_index(ihs_[ix_name].get());
+        ix_manager_->destroy_index(ix_name);
+        ihs_.erase(ix_name);
+    }
     table_meta.indexes.erase(ix_name);
     // 持久化
     flush_meta();
 }
-
-/**
- * @description: 仅用于恢复索引
- * @param {string&} tab_name 表名称
- * @param {vector<ColMeta>&} 索引包含的字段元数据
- * @param {Context*} context
- */
-void SmManager::redo_index(const std::string &tab_name, TabMeta &table_meta, const std::vector<std::string> &col_names,
-                           const std::string &index_name, Context *context) {
-    ix_manager_->close_index(ihs_[index_name].get());
-    ix_manager_->destroy_index(index_name);
-
-    std::vector<ColMeta> col_metas;
-    col_metas.reserve(col_names.size());
-    auto total_len = 0;
-    for (auto &col_name: col_names) {
-        col_metas.emplace_back(*table_meta.get_col(col_name));
-        total_len += col_metas.back().len;
-    }
-
-    // auto ix_name = std::move(ix_manager_->get_index_name(tab_name, col_names));
-    ix_manager_->create_index(index_name, col_metas);
-    auto &&ih = ix_manager_->open_index(index_name);
-    auto &&fh = fhs_[tab_name];
-
-    int offset = 0;
-    char *key = new char[total_len];
-    for (auto &&scan = std::make_unique<RmScan>(fh.get()); !scan->is_end(); scan->next()) {
-        auto &&rid = scan->rid();
-        auto &&record = fh->get_record(rid, context);
-        offset = 0;
-        for (auto &col_meta: col_metas) {
-            memcpy(key + offset, record->data + col_meta.offset, col_meta.len);
-            offset += col_meta.len;
-        }
-        // 插入B+树
-        if (ih->insert_entry(key, rid, context->txn_) == IX_NO_PAGE) {
-            // 释放内存
-            delete []key;
-            // 重复了
-            ix_manager_->close_index(ih.get());
-            ix_manager_->destroy_index(index_name);
-            // drop_index(tab_name, col_names, context);
-            throw NonUniqueIndexError(tab_name, col_names);
-        }
-    }
-    // 释放内存
-    delete []key;
-
-    // 插入索引句柄
-    ihs_[index_name] = std::move(ih);
-}
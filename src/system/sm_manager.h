@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 #include "record/rm_file_handle.h"
 #include "sm_defs.h"
 #include "sm_meta.h"
+#include "sm_stats.h"
 #include "common/context.h"
 
 class Context;
@@ -28,10 +29,12 @@ struct ColDef {
 class SmManager {
 public:
     DbMeta db_; // 当前打开的数据库的元数据
+    DbStats stats_; // 当前打开的数据库的统计信息
     std::unordered_map<std::string, std::unique_ptr<RmFileHandle> > fhs_;
     // file name -> record file handle, 当前数据库中每张表的数据文件
     std::unordered_map<std::string, std::unique_ptr<IxIndexHandle> > ihs_;
     // file name -> index file handle, 当前数据库中每个索引的文件
+    std::mutex handles_latch_; // 保护 fhs_ 和 ihs_ 中句柄的增删，检查点遍历句柄时持有
 private:
     DiskManager *disk_manager_;
     BufferPoolManager *buffer_pool_manager_;
@@ -70,6 +73,12 @@ public:
 
     void flush_meta();
 
+    void flush_file_headers();
+
+    void flush_stats();
+
+    void analyze(const std::string &tab_name, Context *context);
+
     void show_tables(Context *context);
 
     void show_indexs(std::string &table_name, Context *context);
@@ -85,6 +94,4 @@ public:
     void drop_index(const std::string &tab_name, const std::vector<std::string> &col_names, Context *context);
 
     void drop_index(const std::string &tab_name, const std::vector<ColMeta> &col_names, Context *context);
-
-    void redo_index(const std::string &tab_name, TabMeta& table_meta, const std::vector<std::string> &col_names, const std::string &index_name, Context *context);
 };
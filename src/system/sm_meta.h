@@ -271,7 +271,9 @@ public:
         for (size_t i = 0; i < n; i++) {
             TabMeta tab;
             is >> tab;
-            db_meta.tabs_[tab.name] = tab;
+            // cols_map 中保存的是 cols 的迭代器，移动才能保持有效
+            auto tab_name = tab.name;
+            db_meta.tabs_[tab_name] = std::move(tab);
         }
         return is;
     }
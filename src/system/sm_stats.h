@@ -0,0 +1,194 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "defs.h"
+
+/**
+ * @description: 把列值映射成保序的 double，统计信息中的最值和直方图都以它为单位。
+ * 字符串取前 6 个字节按 256 进制折算，只用于估计
+ */
+inline double stats_key(ColType type, const char *data, int len) {
+    switch (type) {
+        case TYPE_INT:
+            return *reinterpret_cast<const int *>(data);
+        case TYPE_FLOAT:
+            return *reinterpret_cast<const float *>(data);
+        default: {
+            double key = 0;
+            for (int i = 0; i < 6; ++i) {
+                key = key * 256 + (i < len ? static_cast<unsigned char>(data[i]) : 0);
+            }
+            return key;
+        }
+    }
+}
+
+/**
+ * @description: HyperLogLog 估计不同值的个数，占用 2^precision 个字节，和行数无关。
+ * 基数较小时用线性计数修正，标准误差约为 1.04 / sqrt(2^precision)
+ */
+class HyperLogLog {
+public:
+    explicit HyperLogLog(int precision) : precision_(precision), registers_(size_t{1} << precision, 0) {}
+
+    void add(const char *data, size_t len) {
+        uint64_t hash = mix(std::hash<std::string_view>{}(std::string_view(data, len)));
+        size_t idx = hash >> (64 - precision_);
+        uint64_t rest = hash << precision_;
+        uint8_t rank = rest == 0 ? 64 - precision_ + 1 : __builtin_clzll(rest) + 1;
+        registers_[idx] = std::max(registers_[idx], rank);
+    }
+
+    size_t estimate() const {
+        double m = registers_.size();
+        double sum = 0;
+        size_t zeros = 0;
+        for (uint8_t reg: registers_) {
+            sum += std::ldexp(1.0, -reg);
+            zeros += reg == 0;
+        }
+        double est = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+        if (est <= 2.5 * m && zeros > 0) {
+            est = m * std::log(m / zeros);
+        }
+        return static_cast<size_t>(std::llround(est));
+    }
+
+private:
+    // std::hash 对短键的高位分布不够均匀，再做一次 splitmix64 的混合
+    static uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    int precision_;
+    std::vector<uint8_t> registers_;
+};
+
+/* 列统计信息 */
+struct ColStats {
+    size_t ndv = 0; // 不同值的个数
+    double min_val = 0; // 最小值
+    double max_val = 0; // 最大值
+    std::vector<double> bounds; // 等深直方图的桶边界，相邻两个边界之间的行数相同
+
+    /**
+     * @description: 估计列值小于 key 的行所占的比例，桶内按均匀分布插值
+     */
+    double fraction_below(double key) const {
+        if (bounds.size() < 2 || key <= bounds.front()) {
+            return 0;
+        }
+        if (key > bounds.back()) {
+            return 1;
+        }
+        size_t buckets = bounds.size() - 1;
+        size_t i = std::lower_bound(bounds.begin(), bounds.end(), key) - bounds.begin() - 1;
+        double width = bounds[i + 1] - bounds[i];
+        double inner = width > 0 ? (key - bounds[i]) / width : 0;
+        return (static_cast<double>(i) + inner) / buckets;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const ColStats &col) {
+        os << col.ndv << ' ' << col.min_val << ' ' << col.max_val << ' ' << col.bounds.size();
+        for (double bound: col.bounds) {
+            os << ' ' << bound;
+        }
+        return os;
+    }
+
+    friend std::istream &operator>>(std::istream &is, ColStats &col) {
+        size_t n;
+        is >> col.ndv >> col.min_val >> col.max_val >> n;
+        col.bounds.resize(n);
+        for (auto &bound: col.bounds) {
+            is >> bound;
+        }
+        return is;
+    }
+};
+
+/* 表统计信息 */
+struct TabStats {
+    size_t rows = 0; // 收集时的行数
+    std::unordered_map<std::string, ColStats> cols; // 列名 -> 列统计信息
+
+    const ColStats *get_col(const std::string &col_name) const {
+        auto pos = cols.find(col_name);
+        return pos == cols.end() ? nullptr : &pos->second;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const TabStats &tab) {
+        os << tab.rows << ' ' << tab.cols.size() << '\n';
+        for (auto &[col_name, col]: tab.cols) {
+            os << col_name << ' ' << col << '\n';
+        }
+        return os;
+    }
+
+    friend std::istream &operator>>(std::istream &is, TabStats &tab) {
+        size_t n;
+        is >> tab.rows >> n;
+        for (size_t i = 0; i < n; ++i) {
+            std::string col_name;
+            ColStats col;
+            is >> col_name >> col;
+            tab.cols.emplace(std::move(col_name), std::move(col));
+        }
+        return is;
+    }
+};
+
+/* 数据库统计信息，由 ANALYZE 收集，保存在 DB_STATS_NAME 文件中 */
+class DbStats {
+    friend class SmManager;
+
+private:
+    std::unordered_map<std::string, TabStats> tabs_; // 表名 -> 表统计信息
+
+public:
+    /* 获取表的统计信息，没有执行过 ANALYZE 时返回 nullptr */
+    const TabStats *get_table(const std::string &tab_name) const {
+        auto pos = tabs_.find(tab_name);
+        return pos == tabs_.end() ? nullptr : &pos->second;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const DbStats &stats) {
+        os << stats.tabs_.size() << '\n';
+        for (auto &[tab_name, tab]: stats.tabs_) {
+            os << tab_name << ' ' << tab;
+        }
+        return os;
+    }
+
+    friend std::istream &operator>>(std::istream &is, DbStats &stats) {
+        size_t n = 0;
+        is >> n;
+        for (size_t i = 0; i < n; ++i) {
+            std::string tab_name;
+            TabStats tab;
+            is >> tab_name >> tab;
+            stats.tabs_.emplace(std::move(tab_name), std::move(tab));
+        }
+        return is;
+    }
+};
@@ -0,0 +1,137 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// 缓冲池并发 fetch 压测：缓冲池小于数据文件，大部分 fetch 都会缺页读盘（其中一部分需要写回脏页），
+// 统计不同线程数下的 fetch 吞吐量；另外比较顺序读时逐页读盘与批量预读的吞吐量
+// 用法: buffer_pool_bench [max_threads] [ops_per_thread]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_FILE_NAME = "buffer_pool_bench.db";
+constexpr int BENCH_NUM_PAGES = 4096;                          // 数据文件页数
+constexpr size_t BENCH_POOL_SIZE = 64 * BUFFER_POOL_INSTANCES; // 缓冲池帧数，约为文件的 1/4
+constexpr int BENCH_DIRTY_PERCENT = 10;                        // 以脏页 unpin 的比例
+
+static void prepare_file(DiskManager *disk_manager, int fd) {
+    std::vector<char> buf(PAGE_SIZE);
+    for (int page_no = 0; page_no < BENCH_NUM_PAGES; ++page_no) {
+        memset(buf.data(), 0, PAGE_SIZE);
+        memcpy(buf.data() + Page::OFFSET_PAGE_HDR, &page_no, sizeof(int));
+        disk_manager->write_page(fd, page_no, buf.data(), PAGE_SIZE);
+    }
+}
+
+static double run_round(DiskManager *disk_manager, int fd, int num_threads, int ops_per_thread) {
+    auto bpm = std::make_unique<BufferPoolManager>(BENCH_POOL_SIZE, disk_manager);
+    std::atomic<int> errors{0};
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < num_threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937 rng(t + 1);
+            std::uniform_int_distribution<int> page_dist(0, BENCH_NUM_PAGES - 1);
+            std::uniform_int_distribution<int> dirty_dist(0, 99);
+            for (int i = 0; i < ops_per_thread; ++i) {
+                PageId page_id{fd, page_dist(rng)};
+                Page *page = bpm->fetch_page(page_id);
+                if (page == nullptr) {
+                    // 所有帧都被 pin 住，稍后重试
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (*reinterpret_cast<int *>(page->get_data() + Page::OFFSET_PAGE_HDR) != page_id.page_no) {
+                    ++errors;
+                }
+                bpm->unpin_page(page_id, dirty_dist(rng) < BENCH_DIRTY_PERCENT);
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    if (errors > 0) {
+        fprintf(stderr, "threads=%d: %d fetches returned wrong page content\n", num_threads, errors.load());
+        exit(1);
+    }
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return static_cast<double>(num_threads) * ops_per_thread / seconds;
+}
+
+// 顺序读完整个文件：逐页缺页读入，或者每 batch 页先通过 I/O 后端批量预读再 fetch
+static double run_sequential(DiskManager *disk_manager, int fd, int batch) {
+    auto bpm = std::make_unique<BufferPoolManager>(BENCH_POOL_SIZE, disk_manager);
+    auto start = std::chrono::steady_clock::now();
+    for (int page_no = 0; page_no < BENCH_NUM_PAGES; ++page_no) {
+        if (batch > 1 && page_no % batch == 0) {
+            bpm->prefetch_pages(fd, page_no, std::min(batch, BENCH_NUM_PAGES - page_no));
+        }
+        PageId page_id{fd, page_no};
+        Page *page = bpm->fetch_page(page_id);
+        if (page == nullptr || *reinterpret_cast<int *>(page->get_data() + Page::OFFSET_PAGE_HDR) != page_no) {
+            fprintf(stderr, "sequential read returned wrong page %d\n", page_no);
+            exit(1);
+        }
+        bpm->unpin_page(page_id, false);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return BENCH_NUM_PAGES / std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char **argv) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency()) * 2;
+    int ops_per_thread = argc > 2 ? atoi(argv[2]) : 20000;
+    max_threads = std::max(max_threads, 1);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    if (disk_manager->is_file(BENCH_FILE_NAME)) {
+        disk_manager->destroy_file(BENCH_FILE_NAME);
+    }
+    disk_manager->create_file(BENCH_FILE_NAME);
+    int fd = disk_manager->open_file(BENCH_FILE_NAME);
+    prepare_file(disk_manager.get(), fd);
+
+    printf("io backend: %s\n", disk_manager->get_io_backend_name());
+    printf("%8s %16s\n", "prefetch", "seq pages/s");
+    for (int batch: {1, 16, 64}) {
+        printf("%8d %16.0f\n", batch, run_sequential(disk_manager.get(), fd, batch));
+    }
+
+    printf("pages: %d, pool frames: %zu, dirty unpin: %d%%, ops/thread: %d\n", BENCH_NUM_PAGES, BENCH_POOL_SIZE,
+           BENCH_DIRTY_PERCENT, ops_per_thread);
+    printf("%8s %16s %10s\n", "threads", "fetch/s", "speedup");
+    double base = 0;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        double ops = run_round(disk_manager.get(), fd, threads, ops_per_thread);
+        if (threads == 1) {
+            base = ops;
+        }
+        printf("%8d %16.0f %10.2f\n", threads, ops, ops / base);
+    }
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(BENCH_FILE_NAME);
+    return 0;
+}
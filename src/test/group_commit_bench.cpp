@@ -0,0 +1,124 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// 提交延迟/吞吐压测：多个线程不断执行 begin + commit 并等待 commit 日志落盘，
+// 比较刷盘线程被唤醒后立即刷盘（max batch = 1）与等待一组提交凑齐再刷盘在不同线程数下的提交吞吐量和延迟
+// 用法: group_commit_bench [max_threads] [commits_per_thread]
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "recovery/log_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_DIR_NAME = "group_commit_bench_db";
+
+struct RoundResult {
+    double commits_per_sec;
+    double avg_us;
+    double p99_us;
+};
+
+static RoundResult run_round(DiskManager *disk_manager, int max_batch, std::chrono::microseconds max_wait,
+                             int num_threads, int commits_per_thread) {
+    auto log_manager = std::make_unique<LogManager>(disk_manager);
+    log_manager->set_group_commit(max_batch, max_wait);
+    std::vector<std::vector<double>> latencies(num_threads);
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < num_threads; ++t) {
+        workers.emplace_back([&, t] {
+            auto &lat = latencies[t];
+            lat.reserve(commits_per_thread);
+            for (int i = 0; i < commits_per_thread; ++i) {
+                txn_id_t txn_id = t * commits_per_thread + i;
+                auto begin_time = std::chrono::steady_clock::now();
+                BeginLogRecord begin_log_record(txn_id);
+                lsn_t prev_lsn = log_manager->add_log_to_buffer(&begin_log_record);
+                CommitLogRecord commit_log_record(txn_id);
+                commit_log_record.prev_lsn_ = prev_lsn;
+                log_manager->wait_for_flush(log_manager->add_log_to_buffer(&commit_log_record));
+                auto end_time = std::chrono::steady_clock::now();
+                lat.push_back(std::chrono::duration<double, std::micro>(end_time - begin_time).count());
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::vector<double> all;
+    for (auto &lat: latencies) {
+        all.insert(all.end(), lat.begin(), lat.end());
+    }
+    std::sort(all.begin(), all.end());
+    double sum = 0;
+    for (double us: all) {
+        sum += us;
+    }
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return {all.size() / seconds, sum / all.size(), all[std::min(all.size() - 1, all.size() * 99 / 100)]};
+}
+
+int main(int argc, char **argv) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : 32;
+    int commits_per_thread = argc > 2 ? atoi(argv[2]) : 200;
+    max_threads = std::max(max_threads, 1);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    if (disk_manager->is_dir(BENCH_DIR_NAME)) {
+        disk_manager->destroy_dir(BENCH_DIR_NAME);
+    }
+    disk_manager->create_dir(BENCH_DIR_NAME);
+    if (chdir(BENCH_DIR_NAME.c_str()) < 0) {
+        perror("chdir");
+        return 1;
+    }
+    disk_manager->create_file(LOG_FILE_NAME);
+
+    struct Mode {
+        const char *name;
+        int max_batch;
+        std::chrono::microseconds max_wait;
+    };
+    const Mode modes[] = {
+        {"no-delay", 1, std::chrono::microseconds(0)},
+        {"group-delay", GROUP_COMMIT_MAX_BATCH, std::chrono::microseconds(GROUP_COMMIT_MAX_WAIT_US)},
+    };
+
+    printf("commits/thread: %d, group commit: max batch %d, max wait %dus\n", commits_per_thread,
+           GROUP_COMMIT_MAX_BATCH, GROUP_COMMIT_MAX_WAIT_US);
+    printf("%18s %8s %14s %12s %12s\n", "mode", "threads", "commits/s", "avg(us)", "p99(us)");
+    for (auto &mode: modes) {
+        for (int threads = 1; threads <= max_threads; threads *= 2) {
+            auto result = run_round(disk_manager.get(), mode.max_batch, mode.max_wait, threads, commits_per_thread);
+            printf("%18s %8d %14.0f %12.1f %12.1f\n", mode.name, threads, result.commits_per_sec, result.avg_us,
+                   result.p99_us);
+        }
+    }
+
+    disk_manager->close_file(disk_manager->GetLogFd());
+    if (chdir("..") < 0) {
+        perror("chdir");
+        return 1;
+    }
+    disk_manager->destroy_dir(BENCH_DIR_NAME);
+    return 0;
+}
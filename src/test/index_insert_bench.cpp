@@ -0,0 +1,134 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// B+ 树并发插入压测：多个线程向同一个 int 索引插入互不相同的随机 key，缓冲池足够大，不会换出页面，
+// 统计不同线程数下的插入吞吐量，然后检查每个 key 都能查到、叶子链表按顺序包含全部 key，
+// 最后并发删除一半 key 并再次检查
+// 用法: index_insert_bench [max_threads] [num_keys]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "index/ix_manager.h"
+#include "index/ix_scan.h"
+
+static const std::string BENCH_INDEX_FILE = "index_insert_bench";
+constexpr size_t BENCH_POOL_SIZE = 65536; // 缓冲池帧数，大于索引的页面数
+
+static const std::vector<ColMeta> BENCH_INDEX_COLS = {{BENCH_INDEX_FILE, "id", TYPE_INT, sizeof(int), 0}};
+
+// 在 num_threads 个线程中对 keys 的各个分段执行 op，返回耗时（秒）
+template <typename Op>
+static double run_threads(int num_threads, const std::vector<int> &keys, Op op) {
+    std::vector<std::thread> threads;
+    size_t per_thread = (keys.size() + num_threads - 1) / num_threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            Transaction txn(t);
+            size_t end = std::min(keys.size(), (t + 1) * per_thread);
+            for (size_t i = t * per_thread; i < end; ++i) {
+                op(keys[i], &txn);
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 检查 [0, num_keys) 中 present(key) 为真的 key 都能查到，叶子链表按顺序恰好包含这些 key
+template <typename Pred>
+static void check_index(IxIndexHandle *ih, BufferPoolManager *bpm, int num_keys, int num_threads, Pred present) {
+    Transaction txn(0);
+    std::vector<int> expected;
+    for (int key = 0; key < num_keys; ++key) {
+        std::vector<Rid> rids;
+        bool found = ih->get_value(reinterpret_cast<const char *>(&key), &rids, &txn);
+        if (found != present(key) || (found && rids[0] != Rid{key, key})) {
+            fprintf(stderr, "threads=%d: wrong lookup result for key %d\n", num_threads, key);
+            exit(1);
+        }
+        if (found) {
+            expected.push_back(key);
+        }
+    }
+    size_t pos = 0;
+    for (IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), bpm); !scan.is_end(); scan.next(), ++pos) {
+        if (pos >= expected.size() || scan.rid() != Rid{expected[pos], expected[pos]}) {
+            fprintf(stderr, "threads=%d: leaf chain out of order at entry %zu\n", num_threads, pos);
+            exit(1);
+        }
+    }
+    if (pos != expected.size()) {
+        fprintf(stderr, "threads=%d: %zu entries in leaves, expected %zu\n", num_threads, pos, expected.size());
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency());
+    int num_keys = argc > 2 ? atoi(argv[2]) : 1000000;
+    max_threads = std::max(max_threads, 1);
+
+    std::vector<int> keys(num_keys);
+    for (int key = 0; key < num_keys; ++key) {
+        keys[key] = key;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+    // 删除偶数 key，各个线程删除的 key 仍然随机分布在整棵树上
+    std::vector<int> even_keys;
+    for (int key: keys) {
+        if (key % 2 == 0) {
+            even_keys.push_back(key);
+        }
+    }
+
+    printf("keys: %d\n", num_keys);
+    printf("%8s %14s %14s\n", "threads", "insert/s", "delete/s");
+    double base = 0;
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        auto disk_manager = std::make_unique<DiskManager>();
+        auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BENCH_POOL_SIZE, disk_manager.get());
+        auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+        std::string index_name = ix_manager->get_index_name(BENCH_INDEX_FILE, BENCH_INDEX_COLS);
+        if (disk_manager->is_file(index_name)) {
+            disk_manager->destroy_file(index_name);
+        }
+        ix_manager->create_index(index_name, BENCH_INDEX_COLS);
+        auto ih = ix_manager->open_index(BENCH_INDEX_FILE, BENCH_INDEX_COLS);
+
+        double insert_secs = run_threads(num_threads, keys, [&](int key, Transaction *txn) {
+            ih->insert_entry(reinterpret_cast<const char *>(&key), {key, key}, txn);
+        });
+        check_index(ih.get(), buffer_pool_manager.get(), num_keys, num_threads, [](int) { return true; });
+        double delete_secs = run_threads(num_threads, even_keys, [&](int key, Transaction *txn) {
+            ih->delete_entry(reinterpret_cast<const char *>(&key), txn);
+        });
+        check_index(ih.get(), buffer_pool_manager.get(), num_keys, num_threads, [](int key) { return key % 2 != 0; });
+
+        double insert_rate = num_keys / insert_secs;
+        if (num_threads == 1) {
+            base = insert_rate;
+        }
+        printf("%8d %14.0f %14.0f   (insert x%.2f)\n", num_threads, insert_rate, even_keys.size() / delete_secs,
+               insert_rate / base);
+        ix_manager->close_index(ih.get());
+        disk_manager->destroy_file(index_name);
+    }
+    return 0;
+}
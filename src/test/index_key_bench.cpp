@@ -0,0 +1,225 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// B+ 树变长 key 压测：向 CHAR(64) x 2 的联合索引随机插入 key（前缀相同、尾部补 0，和常见的编号类字符串一样），
+// 统计叶子结点数、每个叶子的平均 key 数和树高，和定长存储 key 时每个结点能放下的 key 数对比，并统计点查吞吐量；
+// 然后检查点查、范围查找和叶子链表的顺序，删除九成 key 后再检查一遍。
+// 最后用 INT + FLOAT 的联合索引检查负数和浮点数编码后的顺序
+// 用法: index_key_bench [num_keys]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "index/ix_manager.h"
+#include "index/ix_scan.h"
+
+static const std::string BENCH_INDEX_FILE = "index_key_bench";
+constexpr size_t BENCH_POOL_SIZE = 65536; // 缓冲池帧数，大于索引的页面数
+constexpr int BENCH_COL_LEN = 64;
+constexpr int BENCH_GROUP = 1000; // 第二列的取值个数
+
+static const std::vector<ColMeta> BENCH_STRING_COLS = {
+    {BENCH_INDEX_FILE, "warehouse", TYPE_STRING, BENCH_COL_LEN, 0},
+    {BENCH_INDEX_FILE, "customer", TYPE_STRING, BENCH_COL_LEN, BENCH_COL_LEN}};
+
+static const std::vector<ColMeta> BENCH_NUMBER_COLS = {
+    {BENCH_INDEX_FILE, "id", TYPE_INT, sizeof(int), 0},
+    {BENCH_INDEX_FILE, "price", TYPE_FLOAT, sizeof(float), sizeof(int)}};
+
+// 第 id 个 key，key 的顺序和 id 的顺序相同
+static void make_key(int id, char *key) {
+    memset(key, 0, 2 * BENCH_COL_LEN);
+    snprintf(key, BENCH_COL_LEN, "warehouse-%06d", id / BENCH_GROUP);
+    snprintf(key + BENCH_COL_LEN, BENCH_COL_LEN, "customer-%010d", id % BENCH_GROUP);
+}
+
+static void fail(const char *msg, int id) {
+    fprintf(stderr, "%s (key %d)\n", msg, id);
+    exit(1);
+}
+
+// 检查 present(id) 为真的 key 都能查到、其他的查不到，lower_bound 的位置正确，叶子链表按顺序恰好包含这些 key
+template <typename Pred>
+static void check_index(IxIndexHandle *ih, BufferPoolManager *bpm, int num_keys, Pred present) {
+    Transaction txn(0);
+    char key[2 * BENCH_COL_LEN];
+    std::vector<int> expected;
+    for (int id = 0; id < num_keys; ++id) {
+        make_key(id, key);
+        std::vector<Rid> rids;
+        bool found = ih->get_value(key, &rids, &txn);
+        if (found != present(id) || (found && rids[0] != Rid{id, id})) {
+            fail("wrong lookup result", id);
+        }
+        if (found) {
+            expected.push_back(id);
+        }
+    }
+    size_t pos = 0;
+    for (IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), bpm); !scan.is_end(); scan.next(), ++pos) {
+        if (pos >= expected.size() || scan.rid() != Rid{expected[pos], expected[pos]}) {
+            fail("leaf chain out of order", pos < expected.size() ? expected[pos] : -1);
+        }
+        make_key(expected[pos], key);
+        if (memcmp(scan.get_key().data, key, sizeof(key)) != 0) {
+            fail("wrong key in leaf", expected[pos]);
+        }
+    }
+    if (pos != expected.size()) {
+        fail("wrong number of entries in leaves", static_cast<int>(pos));
+    }
+    // 每隔一段检查 lower_bound 落在第一个不小于它的 key 上
+    for (int id = 0; id < num_keys; id += 97) {
+        make_key(id, key);
+        auto next = std::lower_bound(expected.begin(), expected.end(), id);
+        IxScan scan(ih, ih->lower_bound(key), ih->leaf_end(), bpm);
+        if (next == expected.end() ? !scan.is_end() : scan.is_end() || scan.rid() != Rid{*next, *next}) {
+            fail("wrong lower_bound", id);
+        }
+    }
+}
+
+// 统计叶子结点数、树高和索引页数
+static void print_shape(IxIndexHandle *ih, BufferPoolManager *bpm, int num_keys) {
+    int leaves = 0;
+    page_id_t page_no = ih->leaf_begin().page_no;
+    while (true) {
+        auto node = ih->fetch_node(page_no);
+        ++leaves;
+        page_id_t next = node->get_next_leaf();
+        bpm->unpin_page(node->get_page_id(), false);
+        if (page_no == ih->file_hdr_->last_leaf_) {
+            break;
+        }
+        page_no = next;
+    }
+    int height = 1;
+    for (page_no = ih->file_hdr_->root_page_;; ++height) {
+        auto node = ih->fetch_node(page_no);
+        bool leaf = node->is_leaf_page();
+        page_no = leaf ? IX_NO_PAGE : node->value_at(0);
+        bpm->unpin_page(node->get_page_id(), false);
+        if (leaf) {
+            break;
+        }
+    }
+    int fixed_capacity = (PAGE_SIZE - sizeof(IxPageHdr)) / (2 * BENCH_COL_LEN + sizeof(Rid));
+    printf("pages: %d, leaves: %d, height: %d\n", ih->file_hdr_->num_pages_.load(), leaves, height);
+    printf("keys per leaf: %.1f (fixed-width key capacity per node: %d)\n", static_cast<double>(num_keys) / leaves,
+           fixed_capacity);
+}
+
+// INT + FLOAT 联合索引：负数、0、-0.0 和正数编码后的顺序与数值顺序一致
+static void check_number_order(IxManager *ix_manager, BufferPoolManager *bpm) {
+    std::string index_name = ix_manager->get_index_name(BENCH_INDEX_FILE, BENCH_NUMBER_COLS);
+    ix_manager->create_index(index_name, BENCH_NUMBER_COLS);
+    auto ih = ix_manager->open_index(BENCH_INDEX_FILE, BENCH_NUMBER_COLS);
+    std::vector<std::pair<int, float>> keys;
+    for (int i = -300; i < 300; ++i) {
+        for (float f: {-1e30f, -2.5f, -0.0f, 0.5f, 3e20f}) {
+            keys.emplace_back(i * 7919, f * static_cast<float>(i % 3 + 1));
+        }
+    }
+    std::vector<std::pair<int, float>> shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(2));
+    Transaction txn(0);
+    for (auto &[i, f]: shuffled) {
+        char key[sizeof(int) + sizeof(float)];
+        memcpy(key, &i, sizeof(int));
+        memcpy(key + sizeof(int), &f, sizeof(float));
+        ih->insert_entry(key, {i, 0}, &txn);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    size_t pos = 0;
+    for (IxScan scan(ih.get(), ih->leaf_begin(), ih->leaf_end(), bpm); !scan.is_end(); scan.next(), ++pos) {
+        auto record = scan.get_key();
+        int i;
+        float f;
+        memcpy(&i, record.data, sizeof(int));
+        memcpy(&f, record.data + sizeof(int), sizeof(float));
+        if (pos >= keys.size() || keys[pos].first != i || keys[pos].second != f) {
+            fail("numeric keys out of order", i);
+        }
+    }
+    if (pos != keys.size()) {
+        fail("wrong number of numeric keys", static_cast<int>(pos));
+    }
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(index_name);
+}
+
+int main(int argc, char **argv) {
+    int num_keys = argc > 1 ? atoi(argv[1]) : 500000;
+
+    std::vector<int> ids(num_keys);
+    for (int id = 0; id < num_keys; ++id) {
+        ids[id] = id;
+    }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(1));
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BENCH_POOL_SIZE, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    for (auto *cols: {&BENCH_STRING_COLS, &BENCH_NUMBER_COLS}) {
+        std::string index_name = ix_manager->get_index_name(BENCH_INDEX_FILE, *cols);
+        if (disk_manager->is_file(index_name)) {
+            disk_manager->destroy_file(index_name);
+        }
+    }
+    std::string index_name = ix_manager->get_index_name(BENCH_INDEX_FILE, BENCH_STRING_COLS);
+    ix_manager->create_index(index_name, BENCH_STRING_COLS);
+    auto ih = ix_manager->open_index(BENCH_INDEX_FILE, BENCH_STRING_COLS);
+
+    Transaction txn(0);
+    char key[2 * BENCH_COL_LEN];
+    auto start = std::chrono::steady_clock::now();
+    for (int id: ids) {
+        make_key(id, key);
+        ih->insert_entry(key, {id, id}, &txn);
+    }
+    double insert_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int id: ids) {
+        make_key(id, key);
+        std::vector<Rid> rids;
+        ih->get_value(key, &rids, &txn);
+    }
+    double lookup_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("keys: %d, key length: %d\n", num_keys, 2 * BENCH_COL_LEN);
+    print_shape(ih.get(), buffer_pool_manager.get(), num_keys);
+    printf("insert/s: %.0f, lookup/s: %.0f\n", num_keys / insert_secs, num_keys / lookup_secs);
+    check_index(ih.get(), buffer_pool_manager.get(), num_keys, [](int) { return true; });
+
+    // 删除九成 key，叶子结点删空或者变得很小时会被删除或合并
+    for (int id: ids) {
+        if (id % 10 != 0) {
+            make_key(id, key);
+            ih->delete_entry(key, &txn);
+        }
+    }
+    check_index(ih.get(), buffer_pool_manager.get(), num_keys, [](int id) { return id % 10 == 0; });
+    printf("after deleting 90%% of the keys:\n");
+    print_shape(ih.get(), buffer_pool_manager.get(), (num_keys + 9) / 10);
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(index_name);
+
+    check_number_order(ix_manager.get(), buffer_pool_manager.get());
+    printf("ok\n");
+    return 0;
+}
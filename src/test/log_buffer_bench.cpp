@@ -0,0 +1,140 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// 日志写入压测：多个线程并发写入 insert 日志（不等待落盘），统计不同线程数下的日志写入吞吐量，
+// 结束后读回日志文件，检查日志按lsn递增排列且没有丢失或损坏
+// 用法: log_buffer_bench [max_threads] [records_per_thread]
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "recovery/log_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_DIR_NAME = "log_buffer_bench_db";
+static const std::string BENCH_TABLE_NAME = "bench_table";
+constexpr int BENCH_RECORD_SIZE = 100; // 每条 insert 日志中记录的大小
+
+// 读回整个日志文件，返回日志条数，顺序或内容不对时返回-1
+static long verify_log(DiskManager *disk_manager) {
+    std::vector<char> buf(LOG_BUFFER_SIZE);
+    int file_offset = 0;
+    long count = 0;
+    lsn_t prev_lsn = INVALID_LSN;
+    while (true) {
+        int bytes = disk_manager->read_log(buf.data(), LOG_BUFFER_SIZE, file_offset);
+        if (bytes <= 0) {
+            break;
+        }
+        int offset = 0;
+        while (offset + LOG_HEADER_SIZE <= bytes) {
+            uint32_t len = *reinterpret_cast<const uint32_t *>(buf.data() + offset + OFFSET_LOG_TOT_LEN);
+            if (offset + static_cast<int>(len) > bytes) {
+                break;
+            }
+            InsertLogRecord record;
+            record.deserialize(buf.data() + offset);
+            if (record.lsn_ <= prev_lsn || record.log_type_ != INSERT || record.insert_value_.size != BENCH_RECORD_SIZE ||
+                record.get_table_name() != BENCH_TABLE_NAME ||
+                *reinterpret_cast<int *>(record.insert_value_.data) != record.rid_.slot_no) {
+                return -1;
+            }
+            prev_lsn = record.lsn_;
+            offset += len;
+            ++count;
+        }
+        if (offset == 0) {
+            return -1;
+        }
+        file_offset += offset;
+    }
+    return count;
+}
+
+static double run_round(DiskManager *disk_manager, int num_threads, int records_per_thread) {
+    if (disk_manager->GetLogFd() != -1) {
+        disk_manager->close_file(disk_manager->GetLogFd());
+        disk_manager->SetLogFd(-1);
+    }
+    disk_manager->destroy_file(LOG_FILE_NAME);
+    disk_manager->create_file(LOG_FILE_NAME);
+
+    auto log_manager = std::make_unique<LogManager>(disk_manager);
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads);
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < num_threads; ++t) {
+        workers.emplace_back([&, t] {
+            RmRecord value(BENCH_RECORD_SIZE);
+            for (int i = 0; i < records_per_thread; ++i) {
+                *reinterpret_cast<int *>(value.data) = i;
+                Rid rid{t, i};
+                InsertLogRecord record(t, value, rid, BENCH_TABLE_NAME);
+                log_manager->add_log_to_buffer(&record);
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    log_manager->flush_log_to_disk();
+    log_manager.reset();
+
+    long count = verify_log(disk_manager);
+    if (count != static_cast<long>(num_threads) * records_per_thread) {
+        fprintf(stderr, "threads=%d: log verification failed, %ld records read back\n", num_threads, count);
+        exit(1);
+    }
+    return static_cast<double>(num_threads) * records_per_thread / std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char **argv) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency()) * 2;
+    int records_per_thread = argc > 2 ? atoi(argv[2]) : 200000;
+    max_threads = std::max(max_threads, 1);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    if (disk_manager->is_dir(BENCH_DIR_NAME)) {
+        disk_manager->destroy_dir(BENCH_DIR_NAME);
+    }
+    disk_manager->create_dir(BENCH_DIR_NAME);
+    if (chdir(BENCH_DIR_NAME.c_str()) < 0) {
+        perror("chdir");
+        return 1;
+    }
+    disk_manager->create_file(LOG_FILE_NAME);
+
+    printf("records/thread: %d, log buffers: %d x %d bytes\n", records_per_thread, LOG_BUFFER_NUM, LOG_BUFFER_SIZE);
+    printf("%8s %16s %10s\n", "threads", "records/s", "speedup");
+    double base = 0;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        double ops = run_round(disk_manager.get(), threads, records_per_thread);
+        if (threads == 1) {
+            base = ops;
+        }
+        printf("%8d %16.0f %10.2f\n", threads, ops, ops / base);
+    }
+
+    disk_manager->close_file(disk_manager->GetLogFd());
+    if (chdir("..") < 0) {
+        perror("chdir");
+        return 1;
+    }
+    disk_manager->destroy_dir(BENCH_DIR_NAME);
+    return 0;
+}
@@ -0,0 +1,261 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// 恢复压测：生成一份只有日志、数据页面和索引页面一次都没有落盘的数据库（先按随机顺序插入填满若干页并插入 id 上的索引，
+// 再随机更新直到日志达到指定大小，最后每 BENCH_DELETE_STRIDE 页删除一条记录），然后用不同的 redo 线程数重放日志，
+// 统计 analyze 和 redo 的耗时，并检查重放后每条记录都是最后一次更新的值，索引中每个 id 都指向对应的记录，
+// 空闲页面链表恰好包含删除过记录的页面
+// 用法: recovery_bench [log_mb] [max_workers]
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "index/ix_manager.h"
+#include "record/rm_manager.h"
+#include "record/rm_scan.h"
+#include "recovery/log_recovery.h"
+#include "system/sm_manager.h"
+#include "transaction/transaction_manager.h"
+
+static const std::string BENCH_DB_NAME = "recovery_bench_db";
+static const std::string BENCH_TABLE_NAME = "bench";
+static const std::string BENCH_INDEX_NAME = BENCH_TABLE_NAME + "_id.idx";
+constexpr int BENCH_VALUE_LEN = 124;       // 记录中字符串字段的长度，记录大小为 128 字节
+constexpr int BENCH_NUM_PAGES = 1024;      // 数据页面个数
+constexpr size_t BENCH_POOL_SIZE = 2048;   // 缓冲池帧数，大于数据页面个数
+constexpr int BENCH_TXN_SIZE = 1000;       // 每个事务包含的修改个数
+constexpr int BENCH_DELETE_STRIDE = 8;     // 每隔这么多页删除页面中的第一条记录，使这些页面回到空闲页面链表
+constexpr uint32_t BENCH_DELETED = UINT32_MAX; // 已删除记录的版本号
+
+/* 一次恢复需要的全部组件 */
+struct BenchDb {
+    std::unique_ptr<DiskManager> disk_manager = std::make_unique<DiskManager>();
+    std::unique_ptr<LogManager> log_manager = std::make_unique<LogManager>(disk_manager.get());
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager =
+        std::make_unique<BufferPoolManager>(BENCH_POOL_SIZE, disk_manager.get(), log_manager.get());
+    std::unique_ptr<RmManager> rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::unique_ptr<IxManager> ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::unique_ptr<SmManager> sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(),
+                                                                        rm_manager.get(), ix_manager.get());
+    std::unique_ptr<LockManager> lock_manager = std::make_unique<LockManager>();
+    std::unique_ptr<TransactionManager> txn_manager =
+        std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
+};
+
+// 记录内容：id 和版本号，版本号在每次更新时加一
+static void fill_record(RmRecord &record, int id, uint32_t version) {
+    memset(record.data, 0, record.size);
+    memcpy(record.data, &id, sizeof(int));
+    memcpy(record.data + sizeof(int), &version, sizeof(uint32_t));
+}
+
+/**
+ * @description: 生成日志，返回每条记录最终的版本号，已删除的记录为 BENCH_DELETED
+ */
+static std::vector<uint32_t> generate_log(BenchDb &db, long log_bytes, int records_per_page) {
+    auto *log_manager = db.log_manager.get();
+    auto *ih = db.sm_manager->ihs_.at(BENCH_INDEX_NAME).get();
+    int num_records = BENCH_NUM_PAGES * records_per_page;
+    std::vector<uint32_t> versions(num_records, 0);
+    RmRecord record(sizeof(int) + BENCH_VALUE_LEN);
+    RmRecord old_record(sizeof(int) + BENCH_VALUE_LEN);
+
+    txn_id_t txn_id = 0;
+    lsn_t prev_lsn = INVALID_LSN;
+    int ops_in_txn = BENCH_TXN_SIZE;
+    auto next_op = [&]() {
+        if (ops_in_txn == BENCH_TXN_SIZE) {
+            if (prev_lsn != INVALID_LSN) {
+                CommitLogRecord commit_log_record(txn_id);
+                commit_log_record.prev_lsn_ = prev_lsn;
+                log_manager->add_log_to_buffer(&commit_log_record);
+                ++txn_id;
+            }
+            BeginLogRecord begin_log_record(txn_id);
+            prev_lsn = log_manager->add_log_to_buffer(&begin_log_record);
+            ops_in_txn = 0;
+        }
+        ++ops_in_txn;
+    };
+
+    // 表文件中第 0 页是文件头，数据页面从 1 开始；索引按随机顺序插入，结点分裂分布在整棵树上
+    std::vector<int> ids(num_records);
+    for (int id = 0; id < num_records; ++id) {
+        ids[id] = id;
+    }
+    std::mt19937 rng(1);
+    std::shuffle(ids.begin(), ids.end(), rng);
+    Transaction txn(0);
+    for (int id: ids) {
+        next_op();
+        Rid rid{id / records_per_page + 1, id % records_per_page};
+        fill_record(record, id, 0);
+        InsertLogRecord insert_log_record(txn_id, record, rid, BENCH_TABLE_NAME);
+        insert_log_record.prev_lsn_ = prev_lsn;
+        prev_lsn = log_manager->add_log_to_buffer(&insert_log_record);
+        ih->insert_entry(reinterpret_cast<const char *>(&id), rid, &txn);
+    }
+    std::uniform_int_distribution<int> id_dist(0, num_records - 1);
+    long num_updates = 0;
+    while (db.disk_manager->get_log_size() < log_bytes) {
+        next_op();
+        int id = id_dist(rng);
+        Rid rid{id / records_per_page + 1, id % records_per_page};
+        fill_record(old_record, id, versions[id]);
+        fill_record(record, id, ++versions[id]);
+        UpdateLogRecord update_log_record(txn_id, old_record, record, rid, BENCH_TABLE_NAME);
+        update_log_record.prev_lsn_ = prev_lsn;
+        prev_lsn = log_manager->add_log_to_buffer(&update_log_record);
+        ++num_updates;
+    }
+    for (int page = 0; page < BENCH_NUM_PAGES; page += BENCH_DELETE_STRIDE) {
+        next_op();
+        int id = page * records_per_page;
+        Rid rid{page + 1, 0};
+        fill_record(record, id, versions[id]);
+        DeleteLogRecord delete_log_record(txn_id, record, rid, BENCH_TABLE_NAME);
+        delete_log_record.prev_lsn_ = prev_lsn;
+        prev_lsn = log_manager->add_log_to_buffer(&delete_log_record);
+        versions[id] = BENCH_DELETED;
+    }
+    CommitLogRecord commit_log_record(txn_id);
+    commit_log_record.prev_lsn_ = prev_lsn;
+    log_manager->add_log_to_buffer(&commit_log_record);
+    log_manager->flush_log_to_disk();
+    printf("records: %d, updates: %ld, txns: %d, log: %ld MB\n", num_records, num_updates, txn_id + 1,
+           static_cast<long>(db.disk_manager->get_log_size() >> 20));
+    return versions;
+}
+
+/**
+ * @description: 用num_workers个线程恢复，检查结果并返回analyze和redo的耗时（秒）
+ */
+static std::pair<double, double> run_round(int num_workers, int record_size, int records_per_page,
+                                           const std::vector<uint32_t> &versions) {
+    BenchDb db;
+    // 还原到数据页面和索引页面都没有落盘的状态
+    std::string table_path = BENCH_DB_NAME + "/" + BENCH_TABLE_NAME;
+    db.disk_manager->destroy_file(table_path);
+    db.rm_manager->create_file(table_path, record_size);
+    std::string index_path = BENCH_DB_NAME + "/" + BENCH_INDEX_NAME;
+    db.disk_manager->destroy_file(index_path);
+    db.ix_manager->create_index(index_path, {{BENCH_TABLE_NAME, "id", TYPE_INT, sizeof(int), 0}});
+    db.sm_manager->open_db(BENCH_DB_NAME);
+
+    RecoveryManager recovery(db.disk_manager.get(), db.buffer_pool_manager.get(), db.sm_manager.get(),
+                             db.log_manager.get(), db.txn_manager.get());
+    recovery.set_redo_workers(num_workers);
+    auto start = std::chrono::steady_clock::now();
+    recovery.analyze();
+    auto analyzed = std::chrono::steady_clock::now();
+    recovery.redo();
+    auto end = std::chrono::steady_clock::now();
+
+    auto *fh = db.sm_manager->fhs_.at(BENCH_TABLE_NAME).get();
+    size_t count = 0;
+    for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+        auto rid = scan.rid();
+        auto record = fh->get_record(rid, nullptr);
+        int id = *reinterpret_cast<int *>(record->data);
+        uint32_t version = *reinterpret_cast<uint32_t *>(record->data + sizeof(int));
+        if (id != (rid.page_no - 1) * records_per_page + rid.slot_no || version != versions[id]) {
+            fprintf(stderr, "workers=%d: wrong record at (%d, %d)\n", num_workers, rid.page_no, rid.slot_no);
+            exit(1);
+        }
+        ++count;
+    }
+    size_t expected = versions.size() - std::count(versions.begin(), versions.end(), BENCH_DELETED);
+    if (count != expected) {
+        fprintf(stderr, "workers=%d: %zu records recovered, expected %zu\n", num_workers, count, expected);
+        exit(1);
+    }
+    // 空闲页面链表按页号从小到大连接删除过记录的页面
+    page_id_t free_page_no = fh->get_file_hdr().first_free_page_no;
+    for (int page = 0; page < BENCH_NUM_PAGES; page += BENCH_DELETE_STRIDE) {
+        if (free_page_no != page + 1) {
+            fprintf(stderr, "workers=%d: page %d is not in the free page list\n", num_workers, page + 1);
+            exit(1);
+        }
+        auto page_handle = fh->fetch_page_handle(free_page_no);
+        free_page_no = page_handle.page_hdr->next_free_page_no;
+        db.buffer_pool_manager->unpin_page(page_handle.page->get_page_id(), false);
+    }
+    if (free_page_no != RM_NO_PAGE) {
+        fprintf(stderr, "workers=%d: full page %d is in the free page list\n", num_workers, free_page_no);
+        exit(1);
+    }
+    auto *ih = db.sm_manager->ihs_.at(BENCH_INDEX_NAME).get();
+    Transaction txn(0);
+    for (int id = 0; id < static_cast<int>(versions.size()); ++id) {
+        if (versions[id] == BENCH_DELETED) {
+            continue;
+        }
+        std::vector<Rid> rids;
+        if (!ih->get_value(reinterpret_cast<const char *>(&id), &rids, &txn) ||
+            rids[0] != Rid{id / records_per_page + 1, id % records_per_page}) {
+            fprintf(stderr, "workers=%d: wrong index entry for id %d\n", num_workers, id);
+            exit(1);
+        }
+    }
+    db.sm_manager->close_db();
+    return {std::chrono::duration<double>(analyzed - start).count(), std::chrono::duration<double>(end - analyzed).count()};
+}
+
+int main(int argc, char **argv) {
+    long log_mb = argc > 1 ? atol(argv[1]) : 2048;
+    int max_workers = argc > 2 ? atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency()) * 2;
+    max_workers = std::max(max_workers, 1);
+
+    int record_size = sizeof(int) + BENCH_VALUE_LEN;
+    int records_per_page;
+    std::vector<uint32_t> versions;
+    {
+        BenchDb db;
+        if (db.sm_manager->is_dir(BENCH_DB_NAME)) {
+            db.disk_manager->destroy_dir(BENCH_DB_NAME);
+        }
+        db.sm_manager->create_db(BENCH_DB_NAME);
+        db.sm_manager->open_db(BENCH_DB_NAME);
+        db.sm_manager->create_table(BENCH_TABLE_NAME, {{"id", TYPE_INT, sizeof(int)}, {"v", TYPE_STRING, BENCH_VALUE_LEN}},
+                                    nullptr);
+        std::string table_name = BENCH_TABLE_NAME;
+        std::vector<std::string> index_cols{"id"};
+        Transaction txn(0);
+        Context context(nullptr, nullptr, &txn);
+        db.sm_manager->create_index(table_name, index_cols, &context);
+        records_per_page = db.sm_manager->fhs_.at(BENCH_TABLE_NAME)->get_file_hdr().num_records_per_page;
+        versions = generate_log(db, log_mb << 20, records_per_page);
+        db.sm_manager->close_db();
+    }
+
+    printf("%8s %12s %12s %10s\n", "workers", "analyze(s)", "redo(s)", "speedup");
+    double base = 0;
+    for (int workers = 1; workers <= max_workers; workers *= 2) {
+        auto [analyze_sec, redo_sec] = run_round(workers, record_size, records_per_page, versions);
+        if (workers == 1) {
+            base = redo_sec;
+        }
+        printf("%8d %12.2f %12.2f %10.2f\n", workers, analyze_sec, redo_sec, base / redo_sec);
+    }
+
+    BenchDb db;
+    db.disk_manager->destroy_dir(BENCH_DB_NAME);
+    return 0;
+}
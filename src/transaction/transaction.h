@@ -51,6 +51,9 @@ public:
     inline lsn_t get_prev_lsn() { return prev_lsn_; }
     inline void set_prev_lsn(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
 
+    inline lsn_t get_begin_lsn() { return begin_lsn_; }
+    inline void set_begin_lsn(lsn_t begin_lsn) { begin_lsn_ = begin_lsn; }
+
     inline std::shared_ptr<std::deque<WriteRecord *> > get_write_set() { return write_set_; }
     inline void append_write_record(WriteRecord *write_record) { write_set_->push_back(write_record); }
 
@@ -68,6 +71,7 @@ private:
     IsolationLevel isolation_level_; // 事务的隔离级别，默认隔离级别为可串行化
     std::thread::id thread_id_; // 当前事务对应的线程id
     lsn_t prev_lsn_; // 当前事务执行的最后一条操作对应的lsn，用于系统故障恢复
+    lsn_t begin_lsn_ = INVALID_LSN; // 事务 begin 日志的lsn，检查点据此保留回滚需要的日志
     txn_id_t txn_id_; // 事务的ID，唯一标识符
     timestamp_t start_ts_; // 事务的开始时间戳
 
@@ -33,19 +33,40 @@ Transaction *TransactionManager::begin(Transaction *txn, LogManager *log_manager
         txn = new Transaction(next_txn_id_++);
     }
     txn->set_start_ts(next_timestamp_++);
+    // begin 日志和加入事务表在同一个临界区内，检查点开始之前写了 begin 日志的事务一定在活跃事务表中
     latch_.lock();
-    txn_map.emplace(txn->get_transaction_id(), txn);
-    latch_.unlock();
 #ifdef ENABLE_LOGGING
     auto *begin_log_record = new BeginLogRecord(txn->get_transaction_id());
     begin_log_record->prev_lsn_ = txn->get_prev_lsn();
     // TODO 日志管理
     txn->set_prev_lsn(log_manager->add_log_to_buffer(begin_log_record));
+    txn->set_begin_lsn(txn->get_prev_lsn());
     delete begin_log_record;
 #endif
+    txn_map.emplace(txn->get_transaction_id(), txn);
+    latch_.unlock();
     return txn;
 }
 
+/**
+ * @description: 写入检查点开始日志，并获取此时的活跃事务表
+ * @return {lsn_t} 检查点开始日志的lsn
+ * @param {LogManager*} log_manager 日志管理器指针
+ * @param {vector<CheckpointTxnEntry>*} att 返回活跃事务表
+ */
+lsn_t TransactionManager::begin_checkpoint(LogManager *log_manager, std::vector<CheckpointTxnEntry> *att) {
+    std::lock_guard lock(latch_);
+    BeginCheckpointLogRecord begin_checkpoint_log_record;
+    lsn_t begin_lsn = log_manager->add_log_to_buffer(&begin_checkpoint_log_record);
+    for (auto &[txn_id, txn]: txn_map) {
+        if (txn->get_state() != TransactionState::COMMITTED && txn->get_state() != TransactionState::ABORTED &&
+            txn->get_begin_lsn() != INVALID_LSN) {
+            att->push_back({txn_id, txn->get_begin_lsn(), txn->get_prev_lsn()});
+        }
+    }
+    return begin_lsn;
+}
+
 /**
  * @description: 事务的提交方法
  * @param {Transaction*} txn 需要提交的事务
@@ -76,7 +97,8 @@ void TransactionManager::commit(Transaction *txn, LogManager *log_manager) {
     commit_log_record->prev_lsn_ = txn->get_prev_lsn();
     // TODO 日志管理
     txn->set_prev_lsn(log_manager->add_log_to_buffer(commit_log_record));
-    // log_manager->flush_log_to_disk();
+    // 等待 commit 日志落盘后才算提交成功，同一时间段内的提交共用一次刷盘
+    log_manager->wait_for_flush(txn->get_prev_lsn());
     delete commit_log_record;
 #endif
     txn->set_state(TransactionState::COMMITTED);
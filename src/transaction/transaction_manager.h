@@ -44,6 +44,8 @@ public:
 
     void abort(Transaction *txn, LogManager *log_manager);
 
+    lsn_t begin_checkpoint(LogManager *log_manager, std::vector<CheckpointTxnEntry> *att);
+
     ConcurrencyMode get_concurrency_mode() { return concurrency_mode_; }
 
     void set_concurrency_mode(ConcurrencyMode concurrency_mode) { concurrency_mode_ = concurrency_mode; }
@@ -82,6 +84,7 @@ public:
     static std::unordered_map<txn_id_t, Transaction *> txn_map; // 全局事务表，存放事务ID与事务对象的映射关系
 
     inline void set_next_txn_id(txn_id_t next_txn_id) { next_txn_id_.store(next_txn_id); }
+    inline txn_id_t get_next_txn_id() const { return next_txn_id_.load(); }
 
 private:
     ConcurrencyMode concurrency_mode_; // 事务使用的并发控制算法，目前只需要考虑2PL
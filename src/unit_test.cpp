@@ -18,6 +18,7 @@ See the Mulan PSL v2 for more details. */
 #undef private
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
@@ -32,7 +33,16 @@ See the Mulan PSL v2 for more details. */
 #include <unordered_map>
 #include <vector>
 
+#include "analyze/analyze.h"
+#include "execution/executor_hash_join.h"
+#include "execution/executor_sort.h"
+#include "execution/spill_manager.h"
 #include "gtest/gtest.h"
+#include "index/ix_manager.h"
+#include "index/ix_scan.h"
+#include "optimizer/optimizer.h"
+#include "parser/parser.h"
+#include "portal.h"
 #include "replacer/lru_replacer.h"
 #include "storage/disk_manager.h"
 
@@ -718,3 +728,505 @@ TEST(RecordManagerTest, SimpleTest) {
     rm_manager->close_file(file_handle.get());
     rm_manager->destroy_file(filename);
 }
+
+/**
+ * @brief 按位逐个判断的参照实现，和 Bitmap 中一次处理一个字的实现对比
+ */
+static int ref_next_bit(bool bit, const char *bm, int max_n, int curr) {
+    for (int pos = curr + 1; pos < max_n; ++pos) {
+        if (Bitmap::is_set(bm, pos) == bit) {
+            return pos;
+        }
+    }
+    return max_n;
+}
+
+TEST(BitmapTest, WordAtATimeMatchesBitByBit) {
+    std::mt19937 rng(1);
+    for (int round = 0; round < 2000; round++) {
+        // 长度覆盖不足一个字节、不足一个字和跨多个 256 位块的情况，密度覆盖全 0、稀疏、稠密和全 1
+        int max_n = 1 + static_cast<int>(rng() % (round % 4 == 0 ? 16 : 1200));
+        double density = std::array<double, 5>{0.0, 0.01, 0.5, 0.99, 1.0}[rng() % 5];
+        int bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        // 恰好分配 bytes 个字节，读越界时会被 sanitizer 发现；max_n 之后的填充位随机，不应影响结果
+        std::vector<char> bm(bytes);
+        for (auto &c: bm) {
+            c = static_cast<char>(rng());
+        }
+        std::bernoulli_distribution coin(density);
+        for (int pos = 0; pos < max_n; ++pos) {
+            coin(rng) ? Bitmap::set(bm.data(), pos) : Bitmap::reset(bm.data(), pos);
+        }
+
+        int expected_count = 0;
+        std::vector<int> set_bits;
+        for (int pos = 0; pos < max_n; ++pos) {
+            if (Bitmap::is_set(bm.data(), pos)) {
+                ++expected_count;
+                set_bits.push_back(pos);
+            }
+        }
+        ASSERT_EQ(expected_count, Bitmap::count(bm.data(), max_n));
+        for (bool bit: {false, true}) {
+            ASSERT_EQ(ref_next_bit(bit, bm.data(), max_n, -1), Bitmap::first_bit(bit, bm.data(), max_n));
+            for (int curr = -1; curr <= max_n; ++curr) {
+                ASSERT_EQ(ref_next_bit(bit, bm.data(), max_n, curr), Bitmap::next_bit(bit, bm.data(), max_n, curr))
+                    << "max_n " << max_n << " curr " << curr << " bit " << bit;
+            }
+        }
+        // 从随机位置开始批量取出为 1 的位，输出缓冲区大小也随机
+        std::vector<int> out(max_n + 1);
+        for (int curr = -1; curr < max_n; curr += 1 + static_cast<int>(rng() % 37)) {
+            int max_out = static_cast<int>(rng() % (max_n + 1));
+            int n = Bitmap::collect_set_bits(bm.data(), max_n, curr, out.data(), max_out);
+            auto first = std::upper_bound(set_bits.begin(), set_bits.end(), curr);
+            int expected_n = std::min<int>(max_out, static_cast<int>(set_bits.end() - first));
+            ASSERT_EQ(expected_n, n);
+            ASSERT_TRUE(std::equal(out.begin(), out.begin() + n, first));
+        }
+
+        // set_prefix 只置 [0, n) 位，其余位不变
+        int n = static_cast<int>(rng() % (max_n + 1));
+        std::vector<char> prefix = bm;
+        Bitmap::set_prefix(prefix.data(), n);
+        for (int pos = 0; pos < max_n; ++pos) {
+            ASSERT_EQ(pos < n || Bitmap::is_set(bm.data(), pos), Bitmap::is_set(prefix.data(), pos));
+        }
+    }
+}
+
+/**
+ * @brief 依次输出内存中的元组，给要测试的算子提供输入
+ */
+class MockTupleExecutor : public AbstractExecutor {
+private:
+    std::vector<ColMeta> cols_;
+    size_t len_;
+    std::vector<char> data_;
+    size_t pos_{0};
+
+public:
+    explicit MockTupleExecutor(std::vector<ColMeta> cols) : cols_(std::move(cols)) {
+        len_ = cols_.back().offset + cols_.back().len;
+    }
+
+    void append(const char *rec) { data_.insert(data_.end(), rec, rec + len_); }
+
+    size_t size() const { return data_.size() / len_; }
+
+    void beginTuple() override { pos_ = 0; }
+
+    void nextTuple() override { ++pos_; }
+
+    bool is_end() const override { return pos_ >= size(); }
+
+    std::unique_ptr<RmRecord> Next() override {
+        auto record = std::make_unique<RmRecord>(len_);
+        memcpy(record->data, data_.data() + pos_ * len_, len_);
+        return record;
+    }
+
+    Rid &rid() override { return _abstract_rid; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    size_t tupleLen() const override { return len_; }
+};
+
+// 两列 INT (k, v) 的元组
+static std::unique_ptr<MockTupleExecutor> make_int_pairs(const std::string &tab_name,
+                                                         const std::vector<std::pair<int, int> > &rows) {
+    auto exec = std::make_unique<MockTupleExecutor>(std::vector<ColMeta>{
+        {tab_name, "k", TYPE_INT, sizeof(int), 0}, {tab_name, "v", TYPE_INT, sizeof(int), sizeof(int)}});
+    for (auto &[k, v]: rows) {
+        int rec[2] = {k, v};
+        exec->append(reinterpret_cast<const char *>(rec));
+    }
+    return exec;
+}
+
+static uint64_t join_pair_hash(int lv, int rv) {
+    uint64_t x = (static_cast<uint64_t>(static_cast<uint32_t>(lv)) << 32) | static_cast<uint32_t>(rv);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    return x ^ (x >> 31);
+}
+
+TEST(HashJoinTest, SpillMatchesInMemoryJoin) {
+    // 查询的内存预算只有两块，build 侧放不下，必须分区写到溢出文件
+    SpillManager spill_manager(2 * SPILL_RESERVE_CHUNK);
+    spill_manager.open("unit_test_spill");
+
+    std::mt19937 rng(1);
+    std::vector<std::pair<int, int> > left_rows, right_rows;
+    for (int i = 0; i < 200000; i++) {
+        left_rows.emplace_back(static_cast<int>(rng() % 50000) - 25000, i);
+    }
+    // 同一个 key 的元组再分区也分不开，超过预算时只能在最深一层整体装入内存
+    for (int i = 0; i < 120000; i++) {
+        left_rows.emplace_back(7, -i);
+    }
+    for (int i = 0; i < 100000; i++) {
+        right_rows.emplace_back(static_cast<int>(rng() % 60000) - 30000, i);
+    }
+    for (int i = 0; i < 3; i++) {
+        right_rows.emplace_back(7, 1000000 + i);
+    }
+    std::shuffle(left_rows.begin(), left_rows.end(), rng);
+
+    std::unordered_map<int, std::vector<int> > right_by_key;
+    for (auto &[k, v]: right_rows) {
+        right_by_key[k].push_back(v);
+    }
+    size_t expected_rows = 0;
+    uint64_t expected_sum = 0;
+    for (auto &[k, lv]: left_rows) {
+        auto pos = right_by_key.find(k);
+        if (pos != right_by_key.end()) {
+            for (int rv: pos->second) {
+                ++expected_rows;
+                expected_sum += join_pair_hash(lv, rv);
+            }
+        }
+    }
+
+    Condition cond;
+    cond.lhs_col = {"l", "k"};
+    cond.op = OP_EQ;
+    cond.is_rhs_val = false;
+    cond.is_sub_query = false;
+    cond.rhs_col = {"r", "k"};
+    for (bool build_left: {true, false}) {
+        auto spill = spill_manager.begin_query();
+        auto join = std::make_unique<HashJoinExecutor>(make_int_pairs("l", left_rows),
+                                                       make_int_pairs("r", right_rows),
+                                                       std::vector<Condition>{cond}, build_left, spill);
+        ASSERT_EQ(4 * sizeof(int), join->tupleLen());
+        size_t rows = 0;
+        uint64_t sum = 0;
+        auto check = [&](const char *data) {
+            int rec[4];
+            memcpy(rec, data, sizeof(rec));
+            ASSERT_EQ(rec[0], rec[2]);
+            ++rows;
+            sum += join_pair_hash(rec[1], rec[3]);
+        };
+        if (build_left) {
+            for (join->beginTuple(); !join->is_end(); join->nextTuple()) {
+                check(join->Next()->data);
+            }
+        } else {
+            TupleBatch batch;
+            for (join->beginBatch(); join->NextBatch(batch);) {
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    check(batch.get(i));
+                }
+            }
+        }
+        EXPECT_EQ(expected_rows, rows);
+        EXPECT_EQ(expected_sum, sum);
+        EXPECT_GT(spill->bytes_written(), 0u);
+        // 算子析构后内存预留全部归还
+        join = nullptr;
+        EXPECT_EQ(0u, spill->reserved());
+    }
+    EXPECT_GT(spill_manager.files_created(), 0u);
+}
+
+TEST(SortTest, ExternalSortAndTopNMatchReference) {
+    // 内存预算只有两块，全部排序时必须生成多个有序段再归并
+    SpillManager spill_manager(2 * SPILL_RESERVE_CHUNK);
+    spill_manager.open("unit_test_spill");
+
+    // (a INT, c FLOAT, b CHAR(12))，ORDER BY a DESC, c, b；b 互不相同，所以顺序是唯一的
+    struct Row {
+        int a;
+        float c;
+        char b[12];
+    };
+    const std::vector<ColMeta> cols = {{"t", "a", TYPE_INT, sizeof(int), 0},
+                                       {"t", "c", TYPE_FLOAT, sizeof(float), sizeof(int)},
+                                       {"t", "b", TYPE_STRING, 12, sizeof(int) + sizeof(float)}};
+    const std::vector<OrderCol> order_cols = {{{"t", "a"}, true}, {{"t", "c"}, false}, {{"t", "b"}, false}};
+    const float floats[] = {-2.5f, -0.0f, 0.0f, 1.5f, 1e20f, -1e-20f};
+    std::mt19937 rng(1);
+    std::vector<Row> rows(200000);
+    for (size_t i = 0; i < rows.size(); i++) {
+        rows[i].a = static_cast<int>(rng() % 100) - 50;
+        rows[i].c = floats[rng() % 6];
+        memset(rows[i].b, 0, sizeof(rows[i].b));
+        snprintf(rows[i].b, sizeof(rows[i].b), "s%09zu", i);
+    }
+    std::shuffle(rows.begin(), rows.end(), rng);
+
+    std::vector<Row> expected = rows;
+    std::sort(expected.begin(), expected.end(), [](const Row &x, const Row &y) {
+        if (x.a != y.a) {
+            return x.a > y.a;
+        }
+        if (x.c != y.c) {
+            return x.c < y.c;
+        }
+        return memcmp(x.b, y.b, 12) < 0;
+    });
+
+    // limit 为 100 时 Top-N 放得进内存；150000 个条目超出预算，和不带 limit 一样外部排序
+    for (int limit: {-1, 100, 150000}) {
+        auto spill = spill_manager.begin_query();
+        auto input = std::make_unique<MockTupleExecutor>(cols);
+        for (auto &row: rows) {
+            input->append(reinterpret_cast<const char *>(&row));
+        }
+        auto sort = std::make_unique<SortExecutor>(std::move(input), order_cols, spill, limit);
+        ASSERT_EQ(sizeof(Row), sort->tupleLen());
+        size_t expected_n = limit < 0 ? expected.size() : std::min<size_t>(limit, expected.size());
+        bool top_n = limit >= 0 && limit * 2 * sizeof(Row) <= 2 * SPILL_RESERVE_CHUNK;
+        // 第二遍从头重新输出，外部排序时重新打开最后一轮归并
+        for (int pass = 0; pass < 2; pass++) {
+            std::vector<char> out;
+            if (pass == 0) {
+                TupleBatch batch;
+                for (sort->beginBatch(); sort->NextBatch(batch);) {
+                    for (size_t i = 0; i < batch.size(); ++i) {
+                        out.insert(out.end(), batch.get(i), batch.get(i) + sizeof(Row));
+                    }
+                }
+            } else {
+                for (sort->beginTuple(); !sort->is_end(); sort->nextTuple()) {
+                    auto record = sort->Next();
+                    out.insert(out.end(), record->data, record->data + sizeof(Row));
+                }
+            }
+            // Top-N 只输出 limit 个元组，外部排序输出全部元组，由上层截断
+            ASSERT_EQ(top_n ? expected_n : expected.size(), out.size() / sizeof(Row));
+            for (size_t i = 0; i < expected_n; i++) {
+                ASSERT_EQ(0, memcmp(out.data() + i * sizeof(Row), &expected[i], sizeof(Row))) << "row " << i;
+            }
+        }
+        EXPECT_EQ(top_n, spill->bytes_written() == 0);
+        sort = nullptr;
+        EXPECT_EQ(0u, spill->reserved());
+    }
+}
+
+constexpr int IX_TEST_COL_LEN = 64;
+constexpr int IX_TEST_GROUP = 300; // 第一列相同的 key 个数
+
+// 第 id 个 key：前缀很长且大量相同，第二列尾部补上长短不一的后缀；key 的顺序和 id 的顺序相同
+static void make_index_key(int id, char *key) {
+    memset(key, 0, 2 * IX_TEST_COL_LEN);
+    snprintf(key, IX_TEST_COL_LEN, "warehouse-%06d", id / IX_TEST_GROUP);
+    snprintf(key + IX_TEST_COL_LEN, IX_TEST_COL_LEN, "customer-%06d%.*s", id % IX_TEST_GROUP, id % 7,
+             "xxxxxxx");
+}
+
+// 检查 present(id) 为真的 key 都能查到、其他的查不到，叶子链表按顺序恰好包含这些 key，lower_bound 落在正确的位置
+template <typename Pred>
+static void check_compressed_index(IxIndexHandle *ih, BufferPoolManager *bpm, int num_keys, Pred present) {
+    Transaction txn(0);
+    char key[2 * IX_TEST_COL_LEN];
+    std::vector<int> expected;
+    for (int id = 0; id < num_keys; ++id) {
+        make_index_key(id, key);
+        std::vector<Rid> rids;
+        bool found = ih->get_value(key, &rids, &txn);
+        ASSERT_EQ(present(id), found) << "key " << id;
+        if (found) {
+            ASSERT_EQ((Rid{id, id}), rids[0]);
+            expected.push_back(id);
+        }
+    }
+    size_t pos = 0;
+    for (IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), bpm); !scan.is_end(); scan.next(), ++pos) {
+        ASSERT_LT(pos, expected.size());
+        ASSERT_EQ((Rid{expected[pos], expected[pos]}), scan.rid());
+        make_index_key(expected[pos], key);
+        ASSERT_EQ(0, memcmp(scan.get_key().data, key, sizeof(key))) << "key " << expected[pos];
+    }
+    ASSERT_EQ(expected.size(), pos);
+    for (int id = 0; id < num_keys; id += 37) {
+        make_index_key(id, key);
+        auto next = std::lower_bound(expected.begin(), expected.end(), id);
+        IxScan scan(ih, ih->lower_bound(key), ih->leaf_end(), bpm);
+        if (next == expected.end()) {
+            ASSERT_TRUE(scan.is_end());
+        } else {
+            ASSERT_FALSE(scan.is_end());
+            ASSERT_EQ((Rid{*next, *next}), scan.rid());
+        }
+    }
+}
+
+TEST(IndexTest, PrefixCompressedKeys) {
+    const std::string file_name = "prefix_index_test";
+    const std::vector<ColMeta> cols = {{file_name, "warehouse", TYPE_STRING, IX_TEST_COL_LEN, 0},
+                                       {file_name, "customer", TYPE_STRING, IX_TEST_COL_LEN, IX_TEST_COL_LEN}};
+    constexpr int num_keys = 30000;
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(8192, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string index_name = ix_manager->get_index_name(file_name, cols);
+    if (disk_manager->is_file(index_name)) {
+        disk_manager->destroy_file(index_name);
+    }
+    ix_manager->create_index(index_name, cols);
+    auto ih = ix_manager->open_index(file_name, cols);
+
+    std::vector<int> ids(num_keys);
+    for (int id = 0; id < num_keys; ++id) {
+        ids[id] = id;
+    }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(1));
+    Transaction txn(0);
+    char key[2 * IX_TEST_COL_LEN];
+    for (int id: ids) {
+        make_index_key(id, key);
+        ih->insert_entry(key, {id, id}, &txn);
+    }
+    check_compressed_index(ih.get(), buffer_pool_manager.get(), num_keys, [](int) { return true; });
+
+    // 压缩后每个叶子放下的 key 应该比定长存储时多
+    int leaves = 0;
+    for (page_id_t page_no = ih->leaf_begin().page_no;;) {
+        auto node = ih->fetch_node(page_no);
+        ++leaves;
+        page_id_t next = node->get_next_leaf();
+        buffer_pool_manager->unpin_page(node->get_page_id(), false);
+        if (page_no == ih->file_hdr_->last_leaf_) {
+            break;
+        }
+        page_no = next;
+    }
+    int fixed_capacity = (PAGE_SIZE - sizeof(IxPageHdr)) / (sizeof(key) + sizeof(Rid));
+    EXPECT_GT(num_keys / leaves, fixed_capacity);
+
+    // 删除九成 key，结点变小时会合并或者重新分配，再插回一部分
+    for (int id: ids) {
+        if (id % 10 != 0) {
+            make_index_key(id, key);
+            ASSERT_TRUE(ih->delete_entry(key, &txn));
+        }
+    }
+    check_compressed_index(ih.get(), buffer_pool_manager.get(), num_keys, [](int id) { return id % 10 == 0; });
+    for (int id: ids) {
+        if (id % 10 == 5) {
+            make_index_key(id, key);
+            ih->insert_entry(key, {id, id}, &txn);
+        }
+    }
+    check_compressed_index(ih.get(), buffer_pool_manager.get(), num_keys,
+                           [](int id) { return id % 10 == 0 || id % 10 == 5; });
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(index_name);
+}
+
+/**
+ * @brief 和服务器一样解析、分析、生成计划并执行一条 select，返回根算子输出的元组和选中的计划
+ */
+static std::vector<std::vector<char> > run_select(const std::string &sql, SmManager *sm_manager, Portal *portal,
+                                                  Context *context, std::shared_ptr<Plan> *plan_out) {
+    Analyze analyze(sm_manager);
+    Planner planner(sm_manager);
+    Optimizer optimizer(sm_manager, &planner);
+    yyscan_t scanner;
+    yylex_init(&scanner);
+    YY_BUFFER_STATE buf = yy_scan_string(sql.c_str(), scanner);
+    EXPECT_EQ(0, yyparse(scanner)) << sql;
+    std::shared_ptr<Query> query = analyze.do_analyze(std::move(ast::parse_tree));
+    yy_delete_buffer(buf, scanner);
+    yylex_destroy(scanner);
+
+    std::shared_ptr<Plan> plan = optimizer.plan_query(query, context);
+    std::shared_ptr<PortalStmt> stmt = portal->start(plan, context);
+    std::vector<std::vector<char> > rows;
+    auto &root = stmt->root;
+    for (root->beginTuple(); !root->is_end(); root->nextTuple()) {
+        auto record = root->Next();
+        rows.emplace_back(record->data, record->data + root->tupleLen());
+    }
+    portal->drop();
+    *plan_out = plan;
+    return rows;
+}
+
+TEST(PlannerTest, IndexScanKeepsNonIndexConditions) {
+    const std::string db_name = "planner_test_db";
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(4096, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    auto sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(),
+                                                  ix_manager.get());
+    SpillManager spill_manager;
+    Portal portal(sm_manager.get(), &spill_manager);
+    LockManager lock_manager;
+    Transaction txn(1);
+    Context context(&lock_manager, nullptr, &txn);
+
+    if (disk_manager->is_dir(db_name)) {
+        sm_manager->drop_db(db_name);
+    }
+    sm_manager->create_db(db_name);
+    sm_manager->open_db(db_name);
+    spill_manager.open(SPILL_DIR_NAME);
+
+    // t(id, a, b)：a = id % 10，b = id % 7，索引 (a, id) 和 (b, id)
+    sm_manager->create_table("t", {{"id", TYPE_INT, sizeof(int)}, {"a", TYPE_INT, sizeof(int)},
+                                   {"b", TYPE_INT, sizeof(int)}}, &context);
+    constexpr int num_rows = 300;
+    for (int id = 0; id < num_rows; id++) {
+        int rec[3] = {id, id % 10, id % 7};
+        sm_manager->fhs_.at("t")->insert_record(reinterpret_cast<char *>(rec), nullptr);
+    }
+    for (auto cols: {std::vector<std::string>{"a", "id"}, std::vector<std::string>{"b", "id"}}) {
+        std::string tab_name = "t";
+        sm_manager->create_index(tab_name, cols, &context);
+    }
+
+    // 索引列上的等值条件加上另一列上索引不能处理的条件：<>、IN 列表和列与列的比较
+    struct Case {
+        std::string where;
+        std::function<bool(int, int, int)> pred;
+    };
+    std::vector<Case> cases = {
+        {"a = 1 and b <> 5", [](int, int a, int b) { return a == 1 && b != 5; }},
+        {"a = 3 and b in (4, 5)", [](int, int a, int b) { return a == 3 && (b == 4 || b == 5); }},
+        {"b = 2 and a <> 3 and a in (2, 3, 4)",
+         [](int, int a, int b) { return b == 2 && a != 3 && (a == 2 || a == 3 || a == 4); }},
+        {"a = 4 and id > 20 and id < 200 and id <> 24 and id <> 114",
+         [](int id, int a, int) { return a == 4 && id > 20 && id < 200 && id != 24 && id != 114; }},
+        {"a = 5 and b < id", [](int id, int a, int b) { return a == 5 && b < id; }},
+    };
+    for (auto &c: cases) {
+        std::string sql = "select id, a, b from t where " + c.where + ";";
+        std::shared_ptr<Plan> plan;
+        auto rows = run_select(sql, sm_manager.get(), &portal, &context, &plan);
+        // 确认走的是索引扫描
+        auto dml = std::dynamic_pointer_cast<DMLPlan>(plan);
+        ASSERT_NE(nullptr, dml) << sql;
+        auto proj = std::dynamic_pointer_cast<ProjectionPlan>(dml->subplan_);
+        ASSERT_NE(nullptr, proj) << sql;
+        auto scan = std::dynamic_pointer_cast<ScanPlan>(proj->subplan_);
+        ASSERT_NE(nullptr, scan) << sql;
+        EXPECT_EQ(T_IndexScan, scan->tag) << sql;
+
+        std::set<int> expected;
+        for (int id = 0; id < num_rows; id++) {
+            if (c.pred(id, id % 10, id % 7)) {
+                expected.insert(id);
+            }
+        }
+        std::set<int> got;
+        for (auto &row: rows) {
+            int rec[3];
+            memcpy(rec, row.data(), sizeof(rec));
+            EXPECT_TRUE(c.pred(rec[0], rec[1], rec[2])) << sql << " returned id " << rec[0];
+            got.insert(rec[0]);
+        }
+        EXPECT_EQ(expected.size(), rows.size()) << sql;
+        EXPECT_EQ(expected, got) << sql;
+    }
+
+    sm_manager->close_db();
+    sm_manager->drop_db(db_name);
+}